@@ -0,0 +1,74 @@
+/*
+  EpochPublication  -  copy-on-write publication with wait-free readers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file epoch-publication.cpp
+ ** Assignment of reader slots to threads, for the
+ ** [epoch based publication](\ref lib::EpochPublication).
+ ** Each thread participating as reader claims a slot index on first use;
+ ** this index is used for all EpochDomain instances and released
+ ** when the thread terminates.
+ */
+
+
+#include "lib/epoch-publication.hpp"
+
+#include <atomic>
+
+using std::atomic_bool;
+
+
+namespace lib {
+  
+  namespace { // reader slot allocation
+    
+    atomic_bool slotTaken[EpochDomain::MAX_READERS];
+    
+    /** claims a free slot index and holds it for the lifetime of the thread */
+    struct ThreadSlot
+      : util::NonCopyable
+      {
+        uint idx;
+        
+        ThreadSlot()
+          : idx{claim()}
+          { }
+       
+       ~ThreadSlot()
+          {
+            slotTaken[idx].store (false);
+          }
+        
+        static uint
+        claim()
+          {
+            for (uint i=0; i < EpochDomain::MAX_READERS; ++i)
+              {
+                bool expected{false};
+                if (slotTaken[i].compare_exchange_strong (expected, true))
+                  return i;
+              }
+            throw error::State ("more than EpochDomain::MAX_READERS threads reading concurrently");
+          }
+      };
+  }
+  
+  
+  uint
+  EpochDomain::threadSlot()
+  {
+    thread_local ThreadSlot slot;
+    return slot.idx;
+  }
+  
+  
+} // namespace lib
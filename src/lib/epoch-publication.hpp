@@ -0,0 +1,263 @@
+/*
+  EPOCH-PUBLICATION.hpp  -  copy-on-write publication with wait-free readers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file epoch-publication.hpp
+ ** Publish a new version of some immutable data structure, while concurrent readers
+ ** continue to use the previous version. This is a variation of the »read-copy-update«
+ ** scheme: a writer prepares a completely new version and then switches the published
+ ** pointer atomically; the old version is _retired,_ but kept alive until it can be
+ ** proven that no reader still accesses it. To establish this proof, an _epoch based_
+ ** reclamation is used:
+ ** - a global epoch counter is advanced with each publication
+ ** - a reader announces the current epoch in a slot reserved for its thread, while
+ **   accessing the data and clears this slot afterwards. Both operations are plain
+ **   atomic stores, thus reading is _wait-free._ Nested read access is possible.
+ ** - a retired version can be discarded when no reader slot holds this or an earlier
+ **   epoch, since any reader starting later will see the new version.
+ ** Reclaiming retired versions is never done by readers; rather a writer, or some
+ ** maintenance activity invokes EpochPublication::reclaim, possibly with an additional
+ ** predicate to retain the version (or parts of it) beyond the last reader.
+ ** Alternatively, a writer may block in EpochDomain::synchronise until all readers
+ ** possibly still accessing the previous version have left.
+ ** @note the number of threads participating as readers is limited by the number of
+ **       reader slots (EpochDomain::MAX_READERS); the slot is assigned to a thread
+ **       on first use and released when the thread terminates.
+ ** @see EpochPublication_test
+ ** @see steam::fixture::FixtureSwitch
+ ** @see steam::fixture::ModelPortRegistry
+ */
+
+
+#ifndef LIB_EPOCH_PUBLICATION_H
+#define LIB_EPOCH_PUBLICATION_H
+
+
+#include "lib/error.hpp"
+#include "lib/nocopy.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+namespace lib {
+  
+  namespace error = lumiera::error;
+  
+  
+  /**
+   * Epoch counter and reader slots to track read access to published data.
+   * Readers enter a _read-side critical section_ by instantiating a Guard.
+   */
+  class EpochDomain
+    : util::NonCopyable
+    {
+    public:
+      static const uint MAX_READERS = 128;
+      
+    private:
+      struct alignas(64) Slot
+        {
+          std::atomic<uint64_t> epoch{0};      ///< epoch announced by the reader, 0 ≙ quiescent
+          uint depth{0};                       ///< nesting of Guards; only touched by the owning thread
+        };
+      
+      std::atomic<uint64_t> epoch_{1};
+      Slot slots_[MAX_READERS];
+      
+      /** @return reader slot index of the current thread, assigned on first use
+       *  @throw error::State when all reader slots are taken */
+      static uint threadSlot();
+      
+    public:
+      /** RAII marker for a read-side critical section; wait-free */
+      class Guard
+        : util::NonCopyable
+        {
+          Slot& slot_;
+          
+        public:
+          explicit
+          Guard (EpochDomain& domain)
+            : slot_{domain.slots_[threadSlot()]}
+            {
+              if (0 == slot_.depth++)
+                slot_.epoch.store (domain.epoch_.load());
+            }
+         
+         ~Guard()
+            {
+              if (0 == --slot_.depth)
+                slot_.epoch.store (0);
+            }
+        };
+      
+      
+      /** close the current epoch
+       *  @return the epoch just closed */
+      uint64_t
+      advance()
+        {
+          return epoch_.fetch_add (1);
+        }
+      
+      /** @return true when no reader remains in the given epoch or any earlier epoch */
+      bool
+      isQuiescent (uint64_t epoch)  const
+        {
+          for (Slot const& slot : slots_)
+            {
+              uint64_t announced = slot.epoch.load();
+              if (announced != 0 and announced <= epoch)
+                return false;
+            }
+          return true;
+        }
+      
+      /** close the current epoch and block until all readers entered before have left.
+       *  Data switched away from readers prior to this call can be discarded afterwards.
+       * @warning must not be invoked from within a read-side critical section
+       */
+      void
+      synchronise()
+        {
+          uint64_t closed = advance();
+          while (not isQuiescent (closed))
+            std::this_thread::yield();
+        }
+    };
+  
+  
+  
+  /**
+   * Holder for the currently published version of a data structure `T`.
+   * Readers get a read-only #Access, while a new version can be published
+   * concurrently; retired versions are discarded by #reclaim.
+   * @note publishing and reclaiming are serialised by a mutex.
+   */
+  template<class T>
+  class EpochPublication
+    : util::NonCopyable
+    {
+      struct Retired
+        {
+          std::unique_ptr<T> version;
+          uint64_t epoch;
+        };
+      
+      mutable EpochDomain domain_;
+      std::atomic<T*> current_;
+      
+      std::mutex writeLock_;
+      std::deque<Retired> retired_;
+      
+    public:
+      explicit
+      EpochPublication (std::unique_ptr<T> initial =nullptr)
+        : current_{initial.release()}
+        { }
+     
+     ~EpochPublication()
+        {
+          delete current_.load();
+        }
+      
+      
+      /** read access to the version published at the time of creation */
+      class Access
+        : util::NonCopyable
+        {
+          EpochDomain::Guard guard_;
+          T const* version_;
+          
+        public:
+          explicit
+          Access (EpochPublication const& publication)
+            : guard_{publication.domain_}
+            , version_{publication.current_.load()}
+            { }
+          
+          explicit operator bool()  const { return bool(version_); }
+          
+          T const&
+          operator*()  const
+            {
+              if (not version_)
+                throw error::State ("nothing published yet");
+              return *version_;
+            }
+          
+          T const* operator->()  const { return & **this; }
+        };
+      
+      /** @return a RAII handle to read the current version (wait-free) */
+      Access
+      access()  const
+        {
+          return Access{*this};
+        }
+      
+      
+      /** switch to a new version; the previous version is retired */
+      void
+      publish (std::unique_ptr<T> newVersion)
+        {
+          std::lock_guard<std::mutex> lock{writeLock_};
+          T* previous = current_.exchange (newVersion.release());
+          if (previous)
+            retired_.push_back (Retired{std::unique_ptr<T>{previous}, domain_.advance()});
+        }
+      
+      /** discard all retired versions no longer accessed by any reader
+       *  @return number of retired versions still retained */
+      size_t
+      reclaim()
+        {
+          return reclaim ([](T&){ return true; });
+        }
+      
+      /** discard retired versions no longer accessed by any reader,
+       *  provided the given function consents.
+       * @param release `bool(T&)` invoked for each retired version no longer
+       *        accessed by readers; may release parts of the version and
+       *        returns `true` when the version can be discarded altogether.
+       * @return number of retired versions still retained
+       */
+      template<class FUN>
+      size_t
+      reclaim (FUN&& release)
+        {
+          std::lock_guard<std::mutex> lock{writeLock_};
+          for (auto pos = retired_.begin(); pos != retired_.end(); )
+            if (domain_.isQuiescent (pos->epoch) and release (*pos->version))
+              pos = retired_.erase (pos);
+            else
+              ++pos;
+          return retired_.size();
+        }
+      
+      size_t
+      cntRetired()
+        {
+          std::lock_guard<std::mutex> lock{writeLock_};
+          return retired_.size();
+        }
+    };
+  
+  
+} // namespace lib
+#endif /*LIB_EPOCH_PUBLICATION_H*/
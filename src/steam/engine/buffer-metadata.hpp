@@ -55,7 +55,11 @@
 #include "steam/engine/buffer-local-tag.hpp"
 #include "lib/nocopy.hpp"
 
-#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <array>
+#include <mutex>
+#include <new>
 
 
 namespace steam {
@@ -240,6 +244,7 @@ namespace engine {
         
         LocalTag const& localTag() const { return specifics_;}
         size_t storageSize() const { return storageSize_; }
+        bool isPlainData()   const { return not nontrivial (instanceFunc_) or instanceFunc_.plainData; }
         
         HashVal parentKey()  const { return parent_;}
         operator HashVal()   const { return hashID_;}
@@ -425,7 +430,24 @@ namespace engine {
       };
     
     
+    
+    namespace { // parametrisation of the metadata table
+      
+      const size_t TABLE_INITIAL = 64;       ///< number of buckets allocated initially (power of two)
+      const size_t TABLE_MAX_LOAD = 75;      ///< percentage of buckets in a segment to use at most
+      const uint   TABLE_SEGMENTS = 24;      ///< limit for extension steps; capacity doubles with each step
       
+      inline size_t
+      bucketsFor (size_t entries)
+      {
+        size_t capacity = TABLE_INITIAL;
+        while (capacity * TABLE_MAX_LOAD / 100 < entries)
+          capacity *= 2;
+        return capacity;
+      }
+    }
+    
+    
     /**
      * (Hash)Table to store and manage buffer metadata.
      * Buffer metadata entries are comprised of a Key part and an extended
@@ -434,15 +456,272 @@ namespace engine {
      * The hash values for lookup are based on the key part, chained with
      * the actual memory location of the concrete buffer corresponding
      * to the metadata entry to be retrieved.
+     * 
+     * Entries are stored in place, within flat arrays of buckets using open
+     * addressing with linear probing. Each bucket holds an atomic slot marker,
+     * and inserting or removing an entry is a state transition on this marker,
+     * so that workers can lock and release different buffers concurrently, while
+     * lookups proceed without any lock. When the table is filled beyond the
+     * #TABLE_MAX_LOAD, a further segment of twice the size is added; existing
+     * segments are never moved, and thus entries retain their storage location.
+     * @note removed entries leave a tombstone, to be reused by later insertions
+     *       on the same probing sequence; a buffer frame recycled by the provider
+     *       thus typically ends up in the same bucket again. Tombstones not needed
+     *       to reach further entries (i.e. followed by an EMPTY bucket) are cleared
+     *       right away. Since entries can not be moved, tombstones enclosed by other
+     *       entries remain; a segment choked by such tombstones is _retired:_ it does
+     *       not accept new entries, and is reset to empty state once drained.
+     *       Clearing a tombstone can break the probing sequence of an insertion
+     *       under way; this is detected through the Segment::sweeping generation,
+     *       in which case the insertion leaves a tombstone and starts over.
+     * @warning concurrent access is safe for _different_ keys only; locking and
+     *       releasing the same buffer concurrently is a lifecycle error anyway.
      */
     class Table
+      : util::NonCopyable
       {
-        typedef std::unordered_map<HashVal,Entry> MetadataStore;
+        enum Slot : uint { EMPTY = 0  ///< never used; terminates a probing sequence
+                         , BUSY       ///< claimed by a thread to place or remove an entry
+                         , USED       ///< holds a valid entry
+                         , DELETED    ///< tombstone of an entry removed
+                         };
+        
+        struct Bucket
+          {
+            std::atomic<uint>    slot{EMPTY};
+            std::atomic<HashVal> hash{0};
+            alignas(Entry) std::byte storage[sizeof(Entry)];
+            
+            Entry&
+            entry()
+              {
+                return * std::launder (reinterpret_cast<Entry*> (&storage));
+              }
+          };
+        
+        struct Segment
+          {
+            const size_t mask;
+            const size_t limit;
+            std::atomic<size_t> occupied{0};   ///< buckets not EMPTY (including tombstones)
+            std::atomic<size_t> live{0};       ///< buckets holding a valid entry
+            std::atomic<uint>   sweeping{0};   ///< generation of tombstone clearing, odd while in progress
+            std::atomic<bool>   retiring{false};///< accepts no new entries until drained
+            std::unique_ptr<Bucket[]> buckets;
+            
+            Segment (size_t capacity)
+              : mask{capacity-1}
+              , limit{capacity * TABLE_MAX_LOAD / 100}
+              , buckets{new Bucket[capacity]}
+              {
+                REQUIRE (0 == (capacity & mask), "capacity must be a power of two");
+              }
+            
+            size_t capacity()  const { return mask+1; }
+            
+            Bucket*
+            find (HashVal hashID)  const
+              {
+                for (size_t i=0; i<=mask; ++i)
+                  {
+                    Bucket& bucket = buckets[(hashID+i) & mask];
+                    uint slot = bucket.slot.load (std::memory_order_acquire);
+                    if (EMPTY == slot)
+                      return nullptr;
+                    if (USED == slot and hashID == bucket.hash.load (std::memory_order_relaxed))
+                      return &bucket;
+                  }
+                return nullptr;
+              }
+            
+            /** claim a free bucket on the probing sequence for the hashID
+             * @return the bucket, now marked BUSY, or `nullptr` when full or retiring
+             * @remark when tombstones were cleared meanwhile, the probing sequence
+             *         up to the claimed bucket might be broken; the claim is then
+             *         turned into a tombstone and the search starts over. */
+            Bucket*
+            claim (HashVal hashID)
+              {
+                while (not retiring.load (std::memory_order_acquire))
+                  {
+                    uint gen = sweeping.load (std::memory_order_seq_cst);
+                    Bucket* bucket = probeFree (hashID);
+                    if (not bucket)
+                      return nullptr;
+                    if (0 == gen % 2 and gen == sweeping.load (std::memory_order_seq_cst))
+                      return bucket;
+                    bucket->slot.store (DELETED, std::memory_order_release);
+                  }
+                return nullptr;
+              }
+            
+            /** after removing the entry in the given bucket,
+             *  clear tombstones not required anymore for probing */
+            void
+            release (Bucket& bucket)
+              {
+                bucket.slot.store (DELETED, std::memory_order_release);
+                live.fetch_sub (1, std::memory_order_relaxed);
+                uint gen;
+                if (not lockSweep (gen)) return;
+                if (retiring.load (std::memory_order_acquire)
+                    and 0 == live.load (std::memory_order_relaxed))
+                  resetDrained();
+                else
+                  clearRun (size_t(&bucket - buckets.get()));
+                unlockSweep (gen);
+              }
+            
+            /** clear all tombstones not required for probing, and reset
+             *  a retiring segment when it holds no entries anymore.
+             * @return `true` if the segment accepts new entries */
+            bool
+            compact()
+              {
+                uint gen;
+                if (lockSweep (gen))
+                  {
+                    if (retiring.load (std::memory_order_acquire))
+                      resetDrained();
+                    else
+                      for (size_t i=0; i<=mask; ++i)
+                        if (EMPTY == buckets[i].slot.load (std::memory_order_seq_cst))
+                          clearRun ((i-1) & mask);
+                    unlockSweep (gen);
+                  }
+                return not retiring.load (std::memory_order_acquire);
+              }
+            
+            /** stop accepting new entries when choked by tombstones,
+             *  yet holding less than half of the entries permitted */
+            void
+            maybeRetire()
+              {
+                if (limit <= occupied.load (std::memory_order_relaxed)
+                    and live.load (std::memory_order_relaxed) <= limit/2)
+                  retiring.store (true, std::memory_order_release);
+              }
+            
+            /** @return number of entries guaranteed to find a bucket in this segment
+             * @remark tombstones are not counted, since #claim can reach them only when
+             *         placed on the probing sequence before the first EMPTY bucket. */
+            size_t
+            cntFree()  const
+              {
+                if (retiring.load (std::memory_order_acquire)) return 0;
+                return limit - util::min (limit, occupied.load (std::memory_order_relaxed));
+              }
+            
+          private:
+            Bucket*
+            probeFree (HashVal hashID)
+              {
+                for (size_t i=0; i<=mask; ++i)
+                  {
+                    Bucket& bucket = buckets[(hashID+i) & mask];
+                    uint slot = bucket.slot.load (std::memory_order_relaxed);
+                    while (DELETED == slot or EMPTY == slot)
+                      {
+                        if (EMPTY == slot and limit <= occupied.fetch_add (1, std::memory_order_relaxed))
+                          {
+                            occupied.fetch_sub (1, std::memory_order_relaxed);
+                            return nullptr;
+                          }
+                        uint expected = slot;
+                        if (bucket.slot.compare_exchange_strong (slot, BUSY, std::memory_order_seq_cst))
+                          return &bucket;
+                        if (EMPTY == expected)  // lost the race, slot now holds the new state
+                          occupied.fetch_sub (1, std::memory_order_relaxed);
+                      }
+                  }
+                return nullptr;
+              }
+            
+            /** only one thread at a time may clear tombstones within a segment */
+            bool
+            lockSweep (uint& gen)
+              {
+                gen = sweeping.load (std::memory_order_relaxed);
+                return 0 == gen % 2
+                   and sweeping.compare_exchange_strong (gen, gen+1, std::memory_order_seq_cst);
+              }
+            
+            void
+            unlockSweep (uint gen)
+              {
+                sweeping.store (gen+2, std::memory_order_seq_cst);
+              }
+            
+            /** @internal clear the run of tombstones ending at the given position,
+             *  provided it is followed by an EMPTY bucket; no probing sequence
+             *  of an existing entry can pass through such a run. */
+            void
+            clearRun (size_t pos)
+              {
+                for (size_t i=0; i<=mask; ++i, pos = (pos-1) & mask)
+                  {
+                    uint expected = DELETED;
+                    if (EMPTY != buckets[(pos+1) & mask].slot.load (std::memory_order_seq_cst)
+                        or not buckets[pos].slot.compare_exchange_strong (expected, EMPTY, std::memory_order_seq_cst))
+                      return;
+                    occupied.fetch_sub (1, std::memory_order_relaxed);
+                  }
+              }
+            
+            /** @internal reset a retiring segment to empty state, unless some bucket
+             *  is still in use; insertions under way are detected by the sweep lock. */
+            void
+            resetDrained()
+              {
+                for (size_t i=0; i<=mask; ++i)
+                  {
+                    uint slot = buckets[i].slot.load (std::memory_order_seq_cst);
+                    if (USED == slot or BUSY == slot)
+                      return;
+                  }
+                for (size_t i=0; i<=mask; ++i)
+                  {
+                    uint expected = DELETED;
+                    if (buckets[i].slot.compare_exchange_strong (expected, EMPTY, std::memory_order_seq_cst))
+                      occupied.fetch_sub (1, std::memory_order_relaxed);
+                  }
+                retiring.store (false, std::memory_order_release);
+              }
+            
+          public:
+            template<class FUN>
+            void
+            forEachEntry (FUN doIt)
+              {
+                for (size_t i=0; i<=mask; ++i)
+                  if (USED == buckets[i].slot.load (std::memory_order_acquire))
+                    doIt (buckets[i].entry());
+              }
+          };
+        
+        std::array<std::atomic<Segment*>, TABLE_SEGMENTS> segments_;
+        std::atomic<uint> cntSegments_{0};
+        std::mutex extensionLock_;
+        size_t reserved_{0};                   ///< total of entries reserved (protected by extensionLock_)
         
-        MetadataStore entries_;
-
       public:
-       ~Table() { verify_all_buffers_freed(); }
+        Table()
+          {
+            for (auto& seg : segments_)
+              seg.store (nullptr, std::memory_order_relaxed);
+            addSegment (TABLE_INITIAL);
+          }
+       
+       ~Table()
+          {
+            verify_all_buffers_freed();
+            for (uint i=0; i < cntSegments_.load(); ++i)
+              {
+                Segment* seg = segments_[i].load();
+                seg->forEachEntry ([](Entry& entry){ entry.~Entry(); });
+                delete seg;
+              }
+          }
         
         /** fetch metadata record, if any
          * @param hashID for the Key part of the metadata entry
@@ -451,21 +730,15 @@ namespace engine {
         Entry*
         fetch (HashVal hashID)
           {
-            MetadataStore::iterator pos = entries_.find (hashID);
-            if (pos != entries_.end())
-              return &(pos->second);
-            else
-              return NULL;
+            Bucket* bucket = locate (hashID);
+            return bucket? & bucket->entry() : nullptr;
           }
         
         const Entry*
         fetch (HashVal hashID)  const
           {
-            MetadataStore::const_iterator pos = entries_.find (hashID);
-            if (pos != entries_.end())
-              return &(pos->second);
-            else
-              return NULL;
+            Bucket* bucket = locate (hashID);
+            return bucket? & bucket->entry() : nullptr;
           }
         
         /** store a copy of the given new metadata entry.
@@ -473,40 +746,130 @@ namespace engine {
          *  Consequently, this will be the hashID of the parent Key (type), when the entry holds
          *  a NULL buffer (i.e a "pseudo entry"). Otherwise, it will be this parent Key hash,
          *  extended by hashing the actual buffer address.
-         * @return reference to relevant entry for this Key. This might be a copy
-         *         of the new entry, or an already existing entry with the same Key
+         * @return reference to the new entry within the table
+         * @remark the entry is placed into the first segment with a free bucket;
+         *         when all segments are filled up, the table is extended.
          */
         Entry&
         store (Entry const& newEntry)
           {
             REQUIRE (!fetch (newEntry), "duplicate buffer metadata entry");
-            MetadataStore::iterator pos = entries_.emplace (HashVal(newEntry), newEntry)
-                                                  .first;
-            
-            ENSURE (pos != entries_.end());
-            return pos->second;
+            HashVal hashID{newEntry};
+            while (true)
+              {
+                uint cnt = cntSegments_.load (std::memory_order_acquire);
+                for (uint i=0; i<cnt; ++i)
+                  {
+                    Segment& seg = * segments_[i].load (std::memory_order_relaxed);
+                    if (Bucket* bucket = seg.claim (hashID))
+                      {
+                        Entry& entry = * new(&bucket->storage) Entry{newEntry};
+                        bucket->hash.store (hashID, std::memory_order_relaxed);
+                        seg.live.fetch_add (1, std::memory_order_relaxed);
+                        bucket->slot.store (USED, std::memory_order_release);
+                        return entry;
+                      }
+                  }
+                extend (cnt, 0);
+              }
           }
         
         void
         remove (HashVal hashID)
           {
-            uint cnt = entries_.erase (hashID);
-            ENSURE (cnt, "entry to remove didn't exist");
+            Segment* seg{nullptr};
+            Bucket* bucket = locate (hashID, &seg);
+            uint expected = USED;
+            if (not (bucket and bucket->slot.compare_exchange_strong (expected, BUSY, std::memory_order_acquire)))
+              throw error::Logic ("entry to remove didn't exist", LERR_(LIFECYCLE));
+            bucket->entry().~Entry();
+            seg->release (*bucket);
+          }
+        
+        /** ensure the given number of further entries can be stored without extension
+         * @remark invoked when announcing buffers, i.e. before rendering starts.
+         *         Reservations add up: the table is extended until the total
+         *         of all entries reserved so far finds free buckets. */
+        void
+        reserve (size_t cntEntries)
+          {
+            extend (cntSegments_.load (std::memory_order_acquire), cntEntries);
+          }
+        
+        size_t
+        capacity()  const
+          {
+            size_t capacity{0};
+            for (uint i=0; i < cntSegments_.load (std::memory_order_acquire); ++i)
+              capacity += segments_[i].load (std::memory_order_relaxed)->limit;
+            return capacity;
           }
         
       private:
+        Bucket*
+        locate (HashVal hashID, Segment** seg =nullptr)  const
+          {
+            uint cnt = cntSegments_.load (std::memory_order_acquire);
+            for (uint i=0; i<cnt; ++i)
+              if (Bucket* bucket = segments_[i].load (std::memory_order_relaxed)->find (hashID))
+                {
+                  if (seg) *seg = segments_[i].load (std::memory_order_relaxed);
+                  return bucket;
+                }
+            return nullptr;
+          }
+        
+        /** @internal add a further segment to the table, unless another thread did so,
+         *  or clearing tombstones in the existing segments makes room.
+         * @param seenSegments number of segments the caller found to be insufficient
+         * @param reserve number of further entries to reserve (0 means: ensure at least one)
+         */
+        void
+        extend (uint seenSegments, size_t reserve)
+          {
+            std::lock_guard<std::mutex> guard{extensionLock_};
+            uint cnt = cntSegments_.load (std::memory_order_relaxed);
+            if (cnt != seenSegments and 0 == reserve)
+              return;
+            reserved_ += reserve;
+            size_t required = reserve? reserved_ : 1;
+            size_t free{0};
+            for (uint i=0; i<cnt; ++i)
+              {
+                Segment& seg = * segments_[i].load (std::memory_order_relaxed);
+                if (seg.compact())
+                  seg.maybeRetire();
+                free += seg.cntFree();
+              }
+            if (required <= free)
+              return;
+            size_t lastSize = segments_[cnt-1].load (std::memory_order_relaxed)->capacity();
+            addSegment (util::max (2*lastSize, bucketsFor (required - util::min (required, free))));
+          }
+        
+        void
+        addSegment (size_t capacity)
+          {
+            uint cnt = cntSegments_.load (std::memory_order_relaxed);
+            if (cnt >= TABLE_SEGMENTS)
+              throw error::Fatal ("BufferMetadata table exhausted");
+            segments_[cnt].store (new Segment{capacity}, std::memory_order_relaxed);
+            cntSegments_.store (cnt+1, std::memory_order_release);
+          }
+        
         void
         verify_all_buffers_freed()
           try
             {
-              for_each (entries_, verify_is_free);
+              for (uint i=0; i < cntSegments_.load(); ++i)
+                segments_[i].load()->forEachEntry (verify_is_free);
             }
           ERROR_LOG_AND_IGNORE (engine,"Shutdown of BufferProvider metadata store")
-          
+        
         static void
-        verify_is_free (std::pair<HashVal, Entry> const& e)
+        verify_is_free (Entry const& entry)
           {
-            WARN_IF (e.second.isLocked(), engine,
+            WARN_IF (entry.isLocked(), engine,
                      "Buffer still in use while shutting down BufferProvider? ");
           }
       };
@@ -539,7 +902,7 @@ namespace engine {
       HashVal family_;
       
       metadata::Table table_;
-                                          ///////////////////////////TICKET #854 : ensure proper locking happens "somewhere" when mutating metadata
+                                          ///////////////////////////TICKET #854 : locking / releasing different buffers is threadsafe now; type keys should be established beforehand
       
     public:
       using Key   = metadata::Key;
@@ -682,6 +1045,24 @@ namespace engine {
           return *entry;
         }
       
+      /** prepare the metadata table to accommodate the given
+       *  number of further buffer entries without allocation.
+       * @remark typically invoked when announcing buffers;
+       *         the entries reserved by several announcements add up.
+       */
+      void
+      reserve (size_t cntEntries)
+        {
+          table_.reserve (cntEntries);
+        }
+      
+      /** number of entries the metadata table can accommodate currently */
+      size_t
+      capacity()  const
+        {
+          return table_.capacity();
+        }
+      
       bool
       isKnown (HashVal key)  const
         {
@@ -746,7 +1127,7 @@ namespace engine {
       
       
     private: 
-            
+      
       template<typename PAR, typename DEF>
       Key
       trackKey (PAR parent, DEF specialisation)
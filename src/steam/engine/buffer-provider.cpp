@@ -64,6 +64,17 @@ namespace engine {
   }
   
   
+  /** @internal verify the given buffer is of the kind designated by the typeID.
+   *  @remark the metadata entry of a locked buffer is a child of its type key
+   */
+  bool
+  BufferProvider::verifyKind (BuffDescr const& bufferID, HashVal typeID)  const
+  {
+    return HashVal(bufferID) == typeID
+        or meta_->get(bufferID).parentKey() == typeID;
+  }
+  
+  
   BuffDescr
   BufferProvider::getDescriptorFor (size_t storageSize)
   {
@@ -86,6 +97,14 @@ namespace engine {
   }
   
   
+  bool
+  BufferProvider::isPlainData (HashVal typeID)  const
+  {
+    metadata::Key& typeKey = meta_->get (typeID);
+    return typeKey.isPlainData();
+  }
+  
+  
   /** callback from implementation to build and enrol a BufferHandle,
    * to be returned to the client as result of the #lockBuffer call.
    * Performs the necessary metadata state transition leading from an
@@ -108,7 +127,8 @@ namespace engine {
    *  client may reasonably assume to get the actual number of buffers, as
    *  indicated by the return value. A provider may be able to handle
    *  various kinds of buffers (e.g. of differing size), which are
-   *  distinguished by _the type embodied into_ the BuffDescr.
+   *  distinguished by _the type embodied into_ the BuffDescr. Moreover, the
+   *  metadata table is extended to accommodate the corresponding entries.
    * @return maximum number of simultaneously usable buffers of this type,
    *         to be retrieved later through calls to #lockBuffer.
    * @throw error::State when no buffer of this kind can be provided
@@ -121,6 +141,7 @@ namespace engine {
     if (!actually_possible)
       throw error::State ("unable to fulfil request for buffers"
                          ,LUMIERA_ERROR_BUFFER_MANAGEMENT);
+    meta_->reserve (actually_possible);
     return actually_possible;
   }
   
@@ -260,6 +281,14 @@ namespace engine {
   }
   
   
+  bool
+  BuffDescr::isPlainData()  const
+  {
+    ENSURE (provider_);
+    return provider_->isPlainData (*this);
+  }
+  
+  
   uint
   BuffDescr::announce (uint count)
   {
@@ -297,6 +326,15 @@ namespace engine {
   }
   
   
+  bool
+  BuffHandle::isKindOf (BuffDescr const& type)  const
+  {
+    return pBuffer_
+       and isSameAdr (descriptor_.provider_, type.provider_)
+       and descriptor_.provider_->verifyKind (descriptor_, type);
+  }
+  
+  
   void
   BuffHandle::emergencyCleanup()
   {
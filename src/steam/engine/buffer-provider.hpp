@@ -123,7 +123,9 @@ namespace engine {
       /* === API for BuffHandle internal access === */
       
       bool verifyValidity (BuffDescr const&)  const;
+      bool verifyKind (BuffDescr const&, HashVal typeID) const;
       size_t getBufferSize (HashVal typeID)   const;
+      bool   isPlainData (HashVal typeID)     const;
       
     protected:
       BuffHandle buildHandle (HashVal typeID, Buff* storage, LocalTag const& =LocalTag::UNKNOWN);
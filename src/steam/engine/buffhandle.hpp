@@ -93,12 +93,22 @@ namespace engine {
       
       bool verifyValidity()  const;
       size_t determineBufferSize() const;
+      bool isPlainData()  const;
       
       operator HashVal()  const { return subClassification_; }
       
       /** convenience shortcut to start a buffer handling cycle */
       uint announce (uint count);
       BuffHandle lockBuffer();
+      
+      /// buffers of same kind, as managed by the same provider
+      friend bool
+      operator== (BuffDescr const& d1, BuffDescr const& d2)
+        {
+          return d1.provider_ == d2.provider_
+             and d1.subClassification_ == d2.subClassification_;
+        }
+      friend bool operator!= (BuffDescr const& d1, BuffDescr const& d2) { return not (d1 == d2); }
     };
   
   
@@ -170,6 +180,17 @@ namespace engine {
           return descriptor_.determineBufferSize();
         }
       
+      /** @return `true` if the buffer data can be copied as plain bytes,
+       *          i.e. unless holding an object of non trivially copyable type */
+      bool
+      isPlainData()  const
+        {
+          return descriptor_.isPlainData();
+        }
+      
+      /** @return `true` if this handle refers to a buffer of the given kind */
+      bool isKindOf (BuffDescr const& type)  const;
+      
     private:
       template<typename BU>
       void takeOwnershipFor();
@@ -28,6 +28,16 @@ namespace engine {
   Dispatcher::~Dispatcher() { }  // emit VTables and Typeinfo here....
   
   
+  /** fall-back for a Dispatcher without direct access to the Segmentation:
+   *  the JobTicket returned applies only to the given frame itself */
+  Dispatcher::TicketRun
+  Dispatcher::getJobTicketRun (size_t portIDX, TimeValue nominalTime, Time)
+  {
+    return TicketRun{getJobTicketFor (portIDX, nominalTime)
+                    ,Time{nominalTime} + TimeValue{1}};
+  }
+  
+  
   
   
   
@@ -135,6 +135,29 @@ namespace engine {
        */
       virtual JobTicket& getJobTicketFor (size_t portIDX, TimeValue nominalTime)   =0;
       
+      /** JobTicket together with the end of the Segment it was drawn from */
+      struct TicketRun
+        {
+          JobTicket& ticket;
+          Time       after;   ///< the same JobTicket applies to all frames before this point
+        };
+      
+      /**
+       * Batch variant of the core operation: locate the Segment only once
+       * for a whole run of frames; any further frames starting before
+       * the returned end point can be planned with the same JobTicket.
+       * @param retainUntil latest deadline of any job to be planned from
+       *        this Segment; the Segment is marked to be retained accordingly
+       *        (see fixture::Segment::retainUntil), while the lookup still
+       *        holds read access to the Segmentation. Thus a superseded
+       *        Segment can not be discarded before its retention is set.
+       * @remark default implementation resolves each frame individually
+       *        through #getJobTicketFor and thus marks nothing for retention.
+       * @see PlanningBatch
+       */
+      virtual TicketRun getJobTicketRun (size_t portIDX, TimeValue nominalTime
+                                                       , Time retainUntil);
+      
       /** Convenience shortcut for tests: JobTicket ⟼ Job */
       Job createJobFor (size_t portIDX, TimeValue nominalTime);
     };
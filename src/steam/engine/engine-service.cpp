@@ -179,7 +179,8 @@ namespace engine{
   enum CalcType {
     PLAYBACK,
     RENDER,
-    BACKGROUND
+    BACKGROUND,
+    SPECULATIVE
   };
   
   
@@ -220,6 +221,7 @@ namespace engine{
   EngineService::QoS_Definition  EngineService::QoS_COMPROMISE      = QoS_Definition::build<Compromise> (PLAYBACK);
   EngineService::QoS_Definition  EngineService::QoS_PERFECT_RESULT  = QoS_Definition::build<DefaultQoS> (RENDER);
   EngineService::QoS_Definition  EngineService::QoS_SYNC_PRIORITY   = QoS_Definition::build<PriorityQoS>();
+  EngineService::QoS_Definition  EngineService::QoS_SPECULATIVE     = QoS_Definition::build<DefaultQoS> (SPECULATIVE);
   
   
   
@@ -125,6 +125,7 @@ namespace engine{
       static QoS_Definition  QoS_SYNC_PRIORITY;
       static QoS_Definition  QoS_PERFECT_RESULT;
       static QoS_Definition  QoS_COMPROMISE;
+      static QoS_Definition  QoS_SPECULATIVE;  ///< use idle capacity only, see LookAheadRender
       
       
       /** access point to the Engine Interface.
@@ -133,6 +133,19 @@ namespace engine {
                                   ///////////////////////////////////////////////////////////////////////////TICKET #1283 : lay foundation how to observe timing behaviour for a render pipeline
           return runtimeBound_;
         }
+      
+      /** @return `true` if both render through the same pipeline and prerequisites */
+      friend bool
+      operator== (ExitNode const& n1, ExitNode const& n2)
+      {
+        return n1.pipelineIdentity_ == n2.pipelineIdentity_
+           and n1.action_           == n2.action_
+           and n1.prerequisites_    == n2.prerequisites_;
+      }
+      
+      friend bool
+      operator!= (ExitNode const& n1, ExitNode const& n2)
+      { return not (n1 == n2); }
     };
   
   
@@ -52,6 +52,16 @@
  **   several parameters, then the processing functor should be written such as to
  **   accept a std::tuple or a std::array.
  ** 
+ ** \par Batch processing
+ ** Audio-rate processing and other operations on small frames are dominated by the per-invocation
+ ** overhead; such operations can be written as _batch processing functor,_ taking each argument
+ ** wrapped into a FrameBatch — an array holding the argument for each of \a K consecutive frames.
+ ** Such a functor is detected by the builder and wrapped into a BatchPrototype; the corresponding
+ ** BatchFeed embeds a FeedManifold for the single-frame signature for each of these frames and
+ ** gathers their parameters and buffer pointers for a single invocation, so that the inner loops
+ ** of the processing functor can run over the data of all frames, e.g. with vectorised code.
+ ** Only the first FrameBatch::cnt frames must be processed; further entries are not connected.
+ ** 
  ** \par Implementation remarks
  ** A suitable storage layout is chosen at compile type, based on the given functor type.
  ** - essentially, FeedManifold is structured storage with some default-wiring.
@@ -76,6 +86,7 @@
 #include "lib/error.hpp"
 #include "lib/nocopy.hpp"
 #include "steam/engine/buffhandle.hpp"
+#include "steam/engine/turnout-system.hpp"
 #include "lib/uninitialised-storage.hpp"
 #include "lib/meta/function.hpp"
 #include "lib/meta/trait.hpp"
@@ -85,11 +96,35 @@
 #include "lib/test/test-helper.hpp"
 
 #include <tuple>
+#include <array>
 
 
 namespace steam {
 namespace engine {
   
+  using lib::time::TimeValue;
+  using lib::time::TimeVar;
+  
+  
+  /**
+   * Argument type for a _batch processing functor,_ which processes the data
+   * of \a K consecutive frames within a single invocation. Each argument of such
+   * a functor must be a FrameBatch, holding for each frame what the corresponding
+   * argument of a single-frame processing functor would accept (i.e. a parameter,
+   * a buffer pointer, or a tuple or array thereof).
+   * @remark a plain std::array of buffer pointers designates _several channels_
+   *         of a single frame and is thus distinct from a batch of frames.
+   * @note a batch may be invoked for fewer frames than \a K, in which case only
+   *       the first #cnt entries are populated and must be processed.
+   */
+  template<typename X, size_t K>
+  struct FrameBatch
+    : std::array<X,K>
+    {
+      uint cnt{K};   ///< number of frames actually to process
+    };
+  
+  
   namespace {// Introspection helpers....
     
     using lib::meta::_Fun;
@@ -114,6 +149,8 @@ namespace engine {
     using std::conditional_t;
     using std::__and_;
     using std::__not_;
+    using std::forward;
+    using std::move;
     
     
     template<typename V>
@@ -289,6 +326,47 @@ namespace engine {
         static constexpr bool canActivate() { return isSuitable<PF>() and isConfigurable<PF>(); }
       };
     
+    template<typename X>
+    struct _BatchArg
+      : std::false_type
+      {
+        enum{ SIZ = 0 };
+        using Elm = X;
+      };
+    template<typename X, size_t K>
+    struct _BatchArg<FrameBatch<X,K>>
+      : std::true_type
+      {
+        enum{ SIZ = K };
+        using Elm = X;
+      };
+    
+    /**
+     * Trait template to detect a _batch processing functor,_
+     * where all arguments are FrameBatch arrays of the same size.
+     * @remark `ElmSig` is the signature of the corresponding
+     *         processing function for a single frame.
+     */
+    template<class SIG>
+    struct _BatchSig
+      : std::false_type
+      { };
+    template<typename RET, typename A1, typename...ARGS>
+    struct _BatchSig<RET(A1,ARGS...)>
+      : std::bool_constant<_BatchArg<std::decay_t<A1>>::value
+                           and ((_BatchArg<std::decay_t<ARGS>>::SIZ == _BatchArg<std::decay_t<A1>>::SIZ) and ...)>
+      {
+        template<typename X>
+        using _Elm = typename _BatchArg<std::decay_t<X>>::Elm;
+        
+        enum{ BATCH = _BatchArg<std::decay_t<A1>>::SIZ };
+        using ElmSig = RET(_Elm<A1>, _Elm<ARGS>...);
+      };
+    
+    template<class FUN>
+    using is_BatchFun = _BatchSig<typename _Fun<FUN>::Sig>;
+    
+    
      /// a function of total void
     struct _Disabled
       {
@@ -302,6 +380,9 @@ namespace engine {
   template<class FUN, class PAM =_Disabled>
   class FeedPrototype;
   
+  template<class FUN, class PAM =_Disabled>
+  class BatchPrototype;
+  
   
   /**
    * Configuration context for a FeedManifold.
@@ -726,5 +807,277 @@ namespace engine {
 
     };
   
+  
+  
+  /**
+   * Adapter to invoke a _batch processing functor_ for several consecutive frames.
+   * For each of the \a K frames, a FeedManifold for the corresponding single-frame
+   * processing function is embedded, together with a derived TurnoutSystem to render
+   * this frame. Buffer handling is performed per frame, through #frame(k); only the
+   * invocation of the processing functor is combined: the arguments of all frames
+   * are gathered into FrameBatch arrays and passed in a single call.
+   * @note the first frame is rendered within the given TurnoutSystem,
+   *       while each further frame is offset by the given frame step.
+   * @remark the feed can be set up for less than \a BATCH frames; only these frames
+   *       are then prepared and processed, down to rendering just a single frame.
+   */
+  template<class FUN>
+  class BatchFeed
+    : util::NonCopyable
+    {
+      using _Batch = is_BatchFun<FUN>;
+      static_assert (_Batch(), "batch processing functor expected");
+    
+    public:
+      enum{ BATCH = _Batch::BATCH };
+      
+      /** signature of the processing for a single frame (never invoked) */
+      using ElmFun = add_pointer_t<typename _Batch::ElmSig>;
+      using Frame  = FeedManifold<ElmFun>;
+      
+      using ArgI  = typename Frame::ArgI;
+      using ArgO  = typename Frame::ArgO;
+      using Param = typename Frame::Param;
+      enum{ FAN_I = Frame::FAN_I
+          , FAN_O = Frame::FAN_O
+          , FAN_P = Frame::FAN_P
+          };
+      
+      static constexpr bool hasInput() { return Frame::hasInput(); }
+      static constexpr bool hasParam() { return Frame::hasParam(); }
+    
+    private:
+      FUN process_;
+      uint cnt_;
+      TurnoutSystem* turnoutSys_[BATCH];
+      lib::UninitialisedStorage<TurnoutSystem, BATCH-1> frameSys_;
+      lib::UninitialisedStorage<Frame, BATCH> frames_;
+    
+    public:
+      /**
+       * @param cnt number of frames to render, starting with the frame of \a turnoutSys
+       * @param buildFrame functor to create the FeedManifold for a single frame,
+       *        when invoked with the TurnoutSystem for this frame.
+       */
+      template<class BUI>
+      BatchFeed (FUN const& fun, TurnoutSystem& turnoutSys, TimeValue frameStep, uint cnt, BUI buildFrame)
+        : process_{fun}
+        , cnt_{cnt}
+        {
+          REQUIRE (0 < cnt and cnt <= BATCH);
+          turnoutSys_[0] = &turnoutSys;
+          for (uint k=1; k<cnt_; ++k)
+            turnoutSys_[k] = & frameSys_.createAt (k-1, turnoutSys
+                                                      , Time{TimeVar{turnoutSys.getNomTime()} + TimeVar{frameStep} * int(k)});
+          uint k{0};
+          try {
+              for ( ; k<cnt_; ++k)
+                new(&frames_[k]) Frame(buildFrame (*turnoutSys_[k]));
+            }
+          catch(...)
+            {
+              discard (k);
+              throw;
+            }
+        }
+     
+     ~BatchFeed()
+        {
+          discard (cnt_);
+        }
+      
+      uint           cnt()  const        { return cnt_; }
+      Frame&         frame (uint k)      { return frames_[k]; }
+      TurnoutSystem& turnoutSys (uint k) { return *turnoutSys_[k]; }
+      
+      
+      void
+      connect()
+        {
+          for (uint k=0; k<cnt_; ++k)
+            frames_[k].connect();
+        }
+      
+      void
+      invoke()
+        {
+          auto outArgs = gather<ArgO> ([](Frame& f){ return f.outArgs; });
+          if constexpr (hasParam())
+            {
+              auto param = gather<Param> ([](Frame& f){ return f.param; });
+              if constexpr (hasInput())
+                process_ (param, gather<ArgI> ([](Frame& f){ return f.inArgs; }), outArgs);
+              else
+                process_ (param, outArgs);
+            }
+          else
+            if constexpr (hasInput())
+              process_ (gather<ArgI> ([](Frame& f){ return f.inArgs; }), outArgs);
+            else
+              process_ (outArgs);
+        }
+    
+    private:
+      template<typename ARG, class GET>
+      FrameBatch<ARG,BATCH>
+      gather (GET get)
+        {
+          FrameBatch<ARG,BATCH> batch{};
+          batch.cnt = cnt_;
+          for (uint k=0; k<cnt_; ++k)
+            batch[k] = get (frames_[k]);
+          return batch;
+        }
+      
+      /** @note does not touch the BuffHandle entries, same as FeedManifold */
+      void
+      discard (uint cntFrames)
+        {
+          for (uint k=0; k<cntFrames; ++k)
+            frames_.destroyAt (k);
+          for (uint k=1; k<cnt_; ++k)
+            frameSys_.destroyAt (k-1);
+        }
+    };
+  
+  
+  
+  /**
+   * Builder-Prototype to create BatchFeed instances for a _batch processing functor._
+   * Analogous to the FeedPrototype, yet the parameter-functor is evaluated for each
+   * frame separately, based on the TurnoutSystem of the individual frame; for this
+   * purpose, a FeedPrototype for the single-frame processing function is embedded.
+   * @tparam FUN type of the batch processing-functor, accepting FrameBatch arguments
+   * @tparam PAM type of an optional parameter-functor for a single frame
+   * @remark adapting the parameter argument of the processing-functor
+   *         (`moveTransformedParam`) is not supported for batch processing.
+   */
+  template<class FUN, class PAM>
+  class BatchPrototype
+    : util::MoveOnly
+    {
+    public:
+      using Feed = BatchFeed<FUN>;
+      using ElmProto = FeedPrototype<typename Feed::ElmFun, PAM>;
+    
+    private:
+      FUN procFun_;
+      ElmProto elmProto_;
+      TimeVar frameStep_;
+    
+    public:
+      enum{ BATCH = Feed::BATCH
+          , FAN_I = ElmProto::FAN_I
+          , FAN_O = ElmProto::FAN_O
+          , FAN_P = ElmProto::FAN_P
+      };
+      using ElmsI = typename ElmProto::ElmsI;
+      using ElmsO = typename ElmProto::ElmsO;
+      using ElmsP = typename ElmProto::ElmsP;
+      using Param = typename ElmProto::Param;
+      
+      template<template<class> class META>
+      using OutTypesApply = typename ElmProto::template OutTypesApply<META>;
+      
+      
+      /** setup with processing-functor only */
+      BatchPrototype (FUN&& proc)
+        : procFun_{move (proc)}
+        , elmProto_{typename Feed::ElmFun{nullptr}}
+        , frameStep_{Time::ZERO}
+        { }
+      
+      BatchPrototype (FUN&& proc, ElmProto&& elmProto, TimeVar frameStep)
+        : procFun_{move (proc)}
+        , elmProto_{move (elmProto)}
+        , frameStep_{frameStep}
+        { }
+      
+      static constexpr bool hasParam()    { return ElmProto::hasParam();    }
+      static constexpr bool hasParamFun() { return ElmProto::hasParamFun(); }
+      static constexpr bool canActivate() { return ElmProto::canActivate(); }
+      
+      bool isActivated()  const           { return elmProto_.isActivated(); }
+      
+      /** define the distance of the consecutive frames processed together */
+      void setFrameStep (TimeValue frameDuration) { frameStep_ = frameDuration; }
+      bool hasFrameStep()  const                  { return frameStep_ > Time::ZERO; }
+      TimeValue frameStep()  const                { return frameStep_; }
+      
+      
+      /** create a BatchFeed to process the frame of the given TurnoutSystem,
+       *  together with the \a cnt-1 following frames */
+      Feed
+      buildFeed (TurnoutSystem& turnoutSys, uint cnt =BATCH)
+        {
+          REQUIRE (hasFrameStep());
+          return Feed{procFun_, turnoutSys, frameStep_, cnt
+                     ,[this](TurnoutSystem& frameSys){ return elmProto_.buildFeed (frameSys); }
+                     };
+        }
+      
+      
+      
+      /* ======= cross-builder API ======= */
+      
+      using ProcFun = FUN;
+      using ParamFun = PAM;
+      
+      template<typename PFX>
+      using Adapted = BatchPrototype<FUN,PFX>;
+      
+      template<typename PFX>
+      static constexpr bool isSuitableParamFun()
+        {
+          return ElmProto::template isSuitableParamFun<PFX>();
+        }
+      template<typename PFX>
+      static constexpr bool isSuitableParamAdaptor()
+        {
+          return false;
+        }
+      template<typename TRA>
+      using Decorated = BatchPrototype;   ///< adapting the parameter argument is not supported
+      
+      /** Cross-Builder to add configuration with a parameter-functor for each frame */
+      template<typename PFX>
+      auto
+      moveAdaptedParam (PFX otherParamFun =PFX{})
+        {
+          using OtherParamFun = std::decay_t<PFX>;
+          return Adapted<OtherParamFun>{move(procFun_)
+                                       ,elmProto_.moveAdaptedParam (move(otherParamFun))
+                                       ,frameStep_
+                                       };
+        }
+    };
+  
+  
+  template<class PROT>
+  struct is_BatchPrototype
+    : std::false_type
+    { };
+  
+  template<class FUN, class PAM>
+  struct is_BatchPrototype<BatchPrototype<FUN,PAM>>
+    : std::true_type
+    { };
+  
+  
+  /**
+   * Type rebinding helper to pick the Prototype for a given processing-functor.
+   * @return a BatchPrototype for a _batch processing functor,_ else a FeedPrototype.
+   */
+  template<class FUN,  typename SEL =void>
+  struct ProcPrototype
+    {
+      using Type = FeedPrototype<FUN>;
+    };
+  template<class FUN>
+  struct ProcPrototype<FUN,  enable_if<is_BatchFun<FUN>>>
+    {
+      using Type = BatchPrototype<FUN>;
+    };
+
 }} // namespace steam::engine
 #endif /*ENGINE_FEED_MANIFOLD_H*/
@@ -0,0 +1,446 @@
+/*
+  FrameCache  -  bounded cache for rendered frames with adaptive replacement
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file frame-cache.cpp
+ ** Implementation of frame lookup and adaptive replacement for the FrameCache.
+ */
+
+
+#include "lib/error.hpp"
+#include "include/logging.h"
+#include "steam/engine/frame-cache.hpp"
+#include "steam/engine/proc-id.hpp"
+#include "steam/fixture/segment.hpp"
+#include "lib/hash-combine.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using std::lock_guard;
+
+
+namespace steam {
+namespace engine {
+  
+  namespace error = lumiera::error;
+  
+  using Buff = StreamType::ImplFacade::DataBuffer;
+  
+  
+  HashVal
+  hash_value (FrameKey const& key)
+  {
+    HashVal hash = key.procHash;
+    lib::hash::combine (hash, hash_value (key.nomTime));
+    lib::hash::combine (hash, key.procKey);
+    return hash;
+  }
+  
+  
+  namespace cache {
+    
+    /** @internal discard frame storage allocated with extended alignment */
+    void
+    FrameRelease::operator() (char* frame)
+    {
+      ::operator delete (frame, std::align_val_t{FRAME_ALIGNMENT});
+    }
+  }
+  
+  
+  
+  FrameCache::FrameCache (size_t budget)
+    : BufferProvider{"FrameCache"}
+    , budget_{budget}
+    { }
+  
+  FrameCache::~FrameCache()
+    {
+      if (cntLent_)
+        ERROR (engine, "%zu frames from the FrameCache still in use on shutdown.", cntLent_.load());
+    }
+  
+  
+  
+  /* === render engine API === */
+  
+  /**
+   * Retrieve the cached data for a frame.
+   * @param outBuff (optional) a locked buffer to receive a copy of the data
+   * @return a handle to emitted data, either \a outBuff or a buffer
+   *         provided by this cache, or an empty result on cache miss.
+   * @note frames found in the cache are promoted into the frequency list.
+   * @remark the data is copied after leaving the lock, while shared ownership
+   *         keeps the cached frame alive, even if evicted concurrently.
+   */
+  std::optional<BuffHandle>
+  FrameCache::recall (FrameKey const& key, OptionalBuff outBuff)
+  {
+    if (outBuff and not outBuff->isPlainData())
+      return std::nullopt;
+    cache::Storage data;
+    size_t size{0};
+    {
+      lock_guard<std::mutex> guard{lock_};
+      auto pos = index_.find (key);
+      if (pos == index_.end()
+          or pos->second->list >= B1
+          or (outBuff and outBuff->size() < pos->second->size))
+        {
+          ++misses_;
+          return std::nullopt;
+        }
+      ++hits_;
+      moveTo (T2, pos->second);
+      data = pos->second->data;
+      size = pos->second->size;
+    }
+    char* frame = outBuff? reinterpret_cast<char*> (& **outBuff)
+                         : allocate (size);
+    std::memcpy (frame, data.get(), size);
+    BuffHandle result = outBuff? *outBuff
+                               : lend (size, frame);
+    result.emit();
+    return result;
+  }
+  
+  
+  /**
+   * Store a copy of the result data for a frame.
+   * Frames not known to the cache are added to the recency list,
+   * while a frame remembered as ghost is inserted into the frequency list,
+   * adapting the balance of both lists towards the list where the ghost was found.
+   * @note frames larger than the memory budget are not cached, and neither
+   *       buffers holding an object which can not be copied bytewise.
+   * @remark the copy is prepared outside the lock, which is only acquired
+   *         to link the new entry into the index and the ARC lists.
+   */
+  void
+  FrameCache::remember (FrameKey const& key, BuffHandle const& result)
+  {
+    REQUIRE (result.isValid());
+    size_t size = result.size();
+    if (size > budget_ or not result.isPlainData()) return;
+    
+    cache::Storage data{allocate (size), cache::FrameRelease{}};
+    std::memcpy (data.get(), & *result, size);
+    
+    lock_guard<std::mutex> guard{lock_};
+    uint targetList = T1;
+    auto pos = index_.find (key);
+    if (pos != index_.end())
+      {
+        cache::Entry& entry = *pos->second;
+        if (entry.list < B1 and entry.size == size)
+          return;                            // already cached (concurrent calculation)
+        if (entry.list == B1)
+          {
+            size_t delta = std::max (size, bytes_[B2] * size / std::max (bytes_[B1], size_t(1)));
+            target_ = std::min (budget_, target_ + delta);
+          }
+        else
+        if (entry.list == B2)
+          {
+            size_t delta = std::max (size, bytes_[B1] * size / std::max (bytes_[B2], size_t(1)));
+            target_ = target_ > delta? target_ - delta : 0;
+          }
+        targetList = entry.list < B1? entry.list : T2;
+        bool ghostOfFrequent = (entry.list == B2);
+        drop (pos->second);
+        replace (size, ghostOfFrequent);
+      }
+    else
+      replace (size, false);
+    
+    list_[targetList].push_front (cache::Entry{key, size, move (data), targetList});
+    bytes_[targetList] += size;
+    index_[key] = list_[targetList].begin();
+    trimGhosts();
+  }
+  
+  
+  namespace {
+    /** only ports with a media weaving pattern are cached, and only
+     *  the exit port of the invocation, unless the port opted in */
+    bool
+    isCached (Port& port, TurnoutSystem& turnoutSys)
+    {
+      return port.procID.hasManifoldPatt()
+         and (turnoutSys.isExitPort (port) or port.procID.isCached());
+    }
+  }
+  
+  /** @internal consult the cache from within Turnout::weave() */
+  std::optional<BuffHandle>
+  FrameCache::recall (Port& port, TurnoutSystem& turnoutSys, OptionalBuff outBuff)
+  {
+    if (not isCached (port, turnoutSys))
+      return std::nullopt;
+    return recall (FrameKey{port.procHash(), turnoutSys.getNomTime(), turnoutSys.getProcKey()}, outBuff);
+  }
+  
+  void
+  FrameCache::remember (Port& port, TurnoutSystem& turnoutSys, BuffHandle const& result)
+  {
+    if (not isCached (port, turnoutSys))
+      return;
+    remember (FrameKey{port.procHash(), turnoutSys.getNomTime(), turnoutSys.getProcKey()}, result);
+  }
+  
+  
+  /**
+   * Discard all cached frames (and ghost entries) with a nominal time
+   * within the given time span. To be invoked when the corresponding
+   * part of the Fixture has been rebuilt.
+   * @return number of cached frames discarded
+   */
+  size_t
+  FrameCache::invalidate (TimeSpan range)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    size_t cnt{0};
+    for (uint l=T1; l<=B2; ++l)
+      for (auto pos = list_[l].begin(); pos != list_[l].end(); )
+        {
+          auto entry = pos++;
+          if (not range.contains (entry->key.nomTime))
+            continue;
+          if (entry->list < B1)
+            ++cnt;
+          drop (entry);
+        }
+    return cnt;
+  }
+  
+  size_t
+  FrameCache::invalidate (fixture::Segment const& segment)
+  {
+    return invalidate (TimeSpan{segment.start(), segment.after()});
+  }
+  
+  
+  void
+  FrameCache::clear()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    for (uint l=T1; l<=B2; ++l)
+      {
+        list_[l].clear();
+        bytes_[l] = 0;
+      }
+    index_.clear();
+    target_ = 0;
+  }
+  
+  
+  bool
+  FrameCache::contains (FrameKey const& key)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    auto pos = index_.find (key);
+    return pos != index_.end()
+       and pos->second->list < B1;
+  }
+  
+  
+  
+  /* === BufferProvider interface === */
+  
+  /** buffers handed out by the cache are allocated on demand */
+  uint
+  FrameCache::prepareBuffers (uint count, HashVal)
+  {
+    return count;
+  }
+  
+  
+  BuffHandle
+  FrameCache::provideLockedBuffer (HashVal typeID)
+  {
+    char* frame = allocate (getBufferSize (typeID));
+    ++cntLent_;
+    return buildHandle (typeID, reinterpret_cast<Buff*> (frame));
+  }
+  
+  
+  void
+  FrameCache::mark_emitted (HashVal, LocalTag const&)
+  {
+    /* NOP */
+  }
+  
+  
+  /** discard a buffer handed out by the cache */
+  void
+  FrameCache::detachBuffer (HashVal, LocalTag const&, Buff& storage)
+  {
+    REQUIRE (cntLent_);
+    cache::FrameRelease{} (reinterpret_cast<char*> (&storage));
+    --cntLent_;
+  }
+  
+  
+  
+  /* === diagnostics === */
+  
+  size_t
+  FrameCache::cntHits()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return hits_;
+  }
+  
+  size_t
+  FrameCache::cntMisses()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return misses_;
+  }
+  
+  size_t
+  FrameCache::cntEvictions()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return evictions_;
+  }
+  
+  size_t
+  FrameCache::adaptiveTarget()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return target_;
+  }
+  
+  size_t
+  FrameCache::usedBytes()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return bytes_[T1] + bytes_[T2];
+  }
+  
+  size_t
+  FrameCache::cntFrames()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return list_[T1].size() + list_[T2].size();
+  }
+  
+  size_t
+  FrameCache::cntRecent()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return list_[T1].size();
+  }
+  
+  size_t
+  FrameCache::cntFrequent()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return list_[T2].size();
+  }
+  
+  size_t
+  FrameCache::cntGhosts()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return list_[B1].size() + list_[B2].size();
+  }
+  
+  
+  
+  /* ==== Implementation details ==== */
+  
+  /** @internal get frame storage with extended alignment
+   *  @remark to be released through cache::FrameRelease */
+  char*
+  FrameCache::allocate (size_t size)
+  {
+    return static_cast<char*> (::operator new (std::max (size, size_t(1))
+                                              , std::align_val_t{cache::FRAME_ALIGNMENT}));
+  }
+  
+  /** @internal hand out a frame copied from the cache as buffer of this provider */
+  BuffHandle
+  FrameCache::lend (size_t size, char* frame)
+  {
+    ++cntLent_;
+    return buildHandle (getDescriptorFor (size), reinterpret_cast<Buff*> (frame));
+  }
+  
+  
+  /** @internal evict frames until the required bytes fit into the budget.
+   *  Following ARC, the recency list is reduced while exceeding the adaptive target,
+   *  otherwise the frequency list; evicted frames are retained as ghost entries.
+   */
+  void
+  FrameCache::replace (size_t required, bool ghostOfFrequent)
+  {
+    while (bytes_[T1] + bytes_[T2] + required > budget_)
+      {
+        bool reduceRecent = not list_[T1].empty()
+                        and (bytes_[T1] > target_
+                             or (ghostOfFrequent and bytes_[T1] == target_)
+                             or list_[T2].empty());
+        evictFrom (reduceRecent? T1 : T2);
+      }
+  }
+  
+  
+  void
+  FrameCache::evictFrom (uint list)
+  {
+    REQUIRE (list < B1 and not list_[list].empty());
+    auto victim = std::prev (list_[list].end());
+    victim->data.reset();
+    moveTo (list == T1? B1 : B2, victim);
+    ++evictions_;
+  }
+  
+  
+  /** @internal limit the ghost entries: recency list and its ghosts within the budget,
+   *  and the total of all lists within twice the budget. */
+  void
+  FrameCache::trimGhosts()
+  {
+    while (not list_[B1].empty() and bytes_[T1] + bytes_[B1] > budget_)
+      drop (std::prev (list_[B1].end()));
+    while (not list_[B2].empty() and bytes_[T1] + bytes_[T2] + bytes_[B1] + bytes_[B2] > 2*budget_)
+      drop (std::prev (list_[B2].end()));
+  }
+  
+  
+  void
+  FrameCache::drop (cache::EntryList::iterator entry)
+  {
+    uint list = entry->list;
+    bytes_[list] -= entry->size;
+    index_.erase (entry->key);
+    list_[list].erase (entry);
+  }
+  
+  
+  /** @internal relocate an entry to the front (MRU position) of the given list */
+  void
+  FrameCache::moveTo (uint list, cache::EntryList::iterator entry)
+  {
+    bytes_[entry->list] -= entry->size;
+    list_[list].splice (list_[list].begin(), list_[entry->list], entry);
+    entry->list = list;
+    bytes_[list] += entry->size;
+  }
+  
+  
+  
+}} // namespace steam::engine
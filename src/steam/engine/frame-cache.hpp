@@ -0,0 +1,207 @@
+/*
+  FRAME-CACHE.hpp  -  bounded cache for rendered frames with adaptive replacement
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+/** @file frame-cache.hpp
+ ** A cache to retain frames computed by render nodes, avoiding repeated calculation.
+ ** When scrubbing or playing a section repeatedly, the same frames are pulled over and
+ ** over again from the render node network. Each result of a Port with a media weaving
+ ** pattern is determined by the processing chain below this port, the nominal time and
+ ** the process key of the invocation; thus a \ref FrameKey is formed from these three
+ ** elements, using the [processing hash](\ref Port::procHash) of the port, which covers
+ ** the predecessor ports and the state of the parameter bindings as well.
+ **
+ ** The FrameCache is a BufferProvider; it can be attached to the TurnoutSystem of a render
+ ** invocation, and is then consulted by the Turnout before pulling input data and invoking
+ ** the processing function. On a cache hit, the cached data is copied into the output buffer,
+ ** or into a buffer provided by the cache itself; on a miss, the result of the calculation
+ ** is copied into the cache. Cached frames are thus never handed out directly, and client
+ ** code may manipulate the buffers obtained from the cache freely. Since data is copied as
+ ** plain bytes, buffers holding an object of non trivially copyable type are not cached.
+ **
+ ** Only the results of the _exit port_ of an invocation are cached, since intermediary
+ ** results are rarely requested on their own; a port can be built to
+ ** [opt in](\ref PortBuilder::cacheResults) to be cached also when pulled as lead.
+ **
+ ** The cache is limited by a budget of memory for the cached frames. Replacement follows
+ ** the _Adaptive Replacement Cache_ scheme (ARC, Megiddo & Modha 2003), adapted to account
+ ** for frame sizes in bytes: frames seen only once are kept in a _recency list,_ frames
+ ** requested repeatedly in a _frequency list;_ for each list, the keys of evicted frames
+ ** are remembered as »ghost entries«, which are used to shift the balance between both lists
+ ** adaptively. A sequential pass over a long stretch of frames thus can not flush out the
+ ** frames requested frequently.
+ **
+ ** When the Fixture is rebuilt, any cached frames within the time range of changed segments
+ ** are [invalidated](\ref FrameCache::invalidate) by the fixture::FixtureSwitch.
+ **
+ ** @note the FrameCache is protected by a single lock, which is held only to look up
+ **       or link an entry; data is copied and allocated outside the lock, while the
+ **       cached frame is kept alive by shared ownership.
+ ** @see FrameCache_test
+ ** @see turnout.hpp
+ */
+
+#ifndef STEAM_ENGINE_FRAME_CACHE_H
+#define STEAM_ENGINE_FRAME_CACHE_H
+
+
+#include "lib/error.hpp"
+#include "lib/hash-value.h"
+#include "lib/time/timevalue.hpp"
+#include "steam/engine/buffer-provider.hpp"
+#include "steam/engine/proc-node.hpp"
+
+#include <unordered_map>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <list>
+
+
+namespace steam {
+namespace fixture {
+  class Segment;
+}
+namespace engine {
+  
+  using lib::HashVal;
+  using lib::time::Time;
+  using lib::time::TimeSpan;
+  
+  
+  /** Identity of a rendered frame, as produced by a specific Port */
+  struct FrameKey
+    {
+      HashVal    procHash;
+      Time       nomTime;
+      ProcessKey procKey;
+      
+      friend bool
+      operator== (FrameKey const& k1, FrameKey const& k2)
+      {
+        return k1.procHash == k2.procHash
+           and k1.nomTime  == k2.nomTime
+           and k1.procKey  == k2.procKey;
+      }
+      
+      friend HashVal hash_value (FrameKey const&);
+    };
+  
+  
+  namespace cache {
+    
+    const size_t FRAME_ALIGNMENT = 64;   ///< alignment of frames handed out by the cache
+    
+    struct FrameRelease
+      {
+        void operator() (char*);
+      };
+    
+    using Storage = std::shared_ptr<char>;
+    
+    /** Entry in one of the ARC lists; data is empty for ghost entries */
+    struct Entry
+      {
+        FrameKey key;
+        size_t   size;
+        Storage  data;
+        uint     list;
+      };
+    
+    using EntryList = std::list<Entry>;
+    
+    struct KeyHash
+      {
+        size_t operator() (FrameKey const& key) const { return hash_value (key); }
+      };
+  }
+  
+  
+  
+  /**
+   * BufferProvider retaining rendered frames within a memory budget.
+   * Cached data is looked up by FrameKey and copied into output buffers;
+   * eviction follows an adaptive replacement policy (ARC).
+   */
+  class FrameCache
+    : public BufferProvider
+    {
+      enum { T1,T2, B1,B2 };           ///< ARC lists: recent, frequent; ghosts of both
+      
+      std::mutex lock_;
+      size_t budget_;
+      size_t target_{0};               ///< adaptive target size for T1 (in bytes)
+      
+      cache::EntryList list_[4];
+      size_t bytes_[4] = {0,0,0,0};
+      std::unordered_map<FrameKey, cache::EntryList::iterator, cache::KeyHash> index_;
+      std::atomic<size_t> cntLent_{0};
+      
+      size_t hits_{0};
+      size_t misses_{0};
+      size_t evictions_{0};
+      
+    public:
+      explicit FrameCache (size_t budget);
+     ~FrameCache();
+      
+      /* === render engine API === */
+      
+      std::optional<BuffHandle> recall (FrameKey const&, OptionalBuff outBuff =std::nullopt);
+      void remember (FrameKey const&, BuffHandle const& result);
+      
+      std::optional<BuffHandle> recall (Port&, TurnoutSystem&, OptionalBuff);
+      void remember (Port&, TurnoutSystem&, BuffHandle const& result);
+      
+      size_t invalidate (TimeSpan);
+      size_t invalidate (fixture::Segment const&);
+      void clear();
+      
+      bool contains (FrameKey const&);
+      
+      
+      /* === BufferProvider interface === */
+      
+      virtual uint prepareBuffers (uint count, HashVal typeID)    override;
+      virtual BuffHandle provideLockedBuffer  (HashVal typeID)    override;
+      virtual void mark_emitted (HashVal, LocalTag const&)        override;
+      virtual void detachBuffer (HashVal, LocalTag const&, Buff&) override;
+      
+      
+      /* === diagnostics === */
+      
+      size_t cntHits();
+      size_t cntMisses();
+      size_t cntEvictions();
+      size_t budget()   const  { return budget_; }
+      size_t adaptiveTarget();
+      size_t usedBytes();
+      size_t cntFrames();
+      size_t cntRecent();      ///< frames in the recency list (seen once)
+      size_t cntFrequent();    ///< frames in the frequency list (requested repeatedly)
+      size_t cntGhosts();
+      
+    private:
+      static char* allocate (size_t);
+      BuffHandle lend (size_t, char* frame);
+      void replace (size_t required, bool ghostOfFrequent);
+      void evictFrom (uint list);
+      void trimGhosts();
+      void drop (cache::EntryList::iterator);
+      void moveTo (uint list, cache::EntryList::iterator);
+    };
+  
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_FRAME_CACHE_H*/
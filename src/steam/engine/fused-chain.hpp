@@ -0,0 +1,251 @@
+/*
+  FUSED-CHAIN.hpp  -  combine a linear chain of element-wise operations into a single processing function
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+/** @file fused-chain.hpp
+ ** Composition of simple element-wise operations into a single processing function.
+ ** Many media processing steps are essentially trivial per sample or per pixel — think of
+ ** gain, offset or clipping for sound, or a colour matrix followed by a lookup table for images.
+ ** When configured as separate Render Nodes, each of these steps allocates an output buffer and
+ ** performs a full pass over the data in memory, while the actual computation per element is
+ ** negligible. Processing time is then dominated by memory bandwidth.
+ **
+ ** A FusedChain instead combines the _element operations_ by template composition: the whole chain
+ ** is applied to each element in turn within a single loop, without any intermediary buffers; since
+ ** all operations are known at compile time, the optimiser can inline and vectorise the combined loop.
+ ** The [Node Builder](\ref PortBuilderRoot::invokeFused()) generates a processing functor from such
+ ** a chain, to be invoked through a single Turnout, taking one input and one output buffer.
+ **
+ ** Each element operation must accept the element as (last) argument and return the processed element;
+ ** optionally it may take a parameter as first argument. The parameters of all stages are passed to
+ ** the fused processing function — as plain value if there is only one, or as tuple otherwise.
+ ** @remark to keep the fused node traceable, each element operation is given a name (\ref elmOp),
+ **         and the port spec must list these names in order, joined by `'+'` —
+ **         e.g. `"gain+offset+clip(Samples)(Samples)"`.
+ ** @see NodeFused_test
+ */
+
+
+#ifndef STEAM_ENGINE_FUSED_CHAIN_H
+#define STEAM_ENGINE_FUSED_CHAIN_H
+
+
+#include "lib/error.hpp"
+#include "lib/meta/function.hpp"
+#include "lib/meta/typeseq-util.hpp"
+
+#include <initializer_list>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <iterator>
+#include <tuple>
+
+
+namespace steam {
+namespace engine {
+  
+  using lib::meta::_Fun;
+  
+  
+  namespace {// Helpers to analyse the element operations
+    
+    /** an element operation takes the element, optionally preceded by a parameter */
+    template<class OP, typename SEL =void>
+    struct _ElmOp
+      {
+        static_assert(_Fun<OP>::ARITY == 1, "element operation expects the element as (last) argument, "
+                                            "optionally preceded by a single parameter");
+        static constexpr bool hasParam = false;
+        using ParamTup = std::tuple<>;
+      };
+    
+    template<class OP>
+    struct _ElmOp<OP, std::enable_if_t<_Fun<OP>::ARITY == 2>>
+      {
+        static constexpr bool hasParam = true;
+        using Param = std::decay_t<typename lib::meta::Pick<typename _Fun<OP>::Args, 0>::Type>;
+        using ParamTup = std::tuple<Param>;
+      };
+    
+    /** a single parameter is passed plain, several as tuple */
+    template<class TUP>
+    struct _ParamArg
+      { using Type = TUP; };
+    
+    template<class PAR>
+    struct _ParamArg<std::tuple<PAR>>
+      { using Type = PAR; };
+  }
+  
+  
+  /** an element operation, tagged with a name to trace it in the port spec */
+  template<class OP>
+  struct NamedElmOp
+    {
+      std::string_view name;
+      OP op;
+    };
+  
+  /** mark an element operation to be fused into a chain */
+  template<class OP>
+  inline NamedElmOp<OP>
+  elmOp (std::string_view name, OP op)
+  {
+    return NamedElmOp<OP>{name, std::move (op)};
+  }
+  
+  
+  /**
+   * count the constituents named in the qualifier of a port spec for a fused chain.
+   * @return number of non-empty names joined by `'+'` before the argument lists,
+   *         or zero if the qualifier is missing or contains an empty name.
+   */
+  inline size_t
+  countFusedConstituents (std::string_view portSpec)
+  {
+    std::string_view qualifier = portSpec.substr (0, portSpec.find('('));
+    size_t cnt{0};
+    while (true)
+      {
+        size_t p = qualifier.find('+');
+        if (0 == p or qualifier.empty())
+          return 0;
+        ++cnt;
+        if (p == std::string_view::npos)
+          return cnt;
+        qualifier.remove_prefix (p+1);
+      }
+  }
+  
+  /**
+   * verify the constituents named in the qualifier of a port spec for a fused chain.
+   * @return `true` if the qualifier lists exactly the given names, in this order
+   */
+  inline bool
+  matchFusedConstituents (std::string_view portSpec, std::initializer_list<std::string_view> names)
+  {
+    if (names.size() != countFusedConstituents (portSpec))
+      return false;
+    std::string_view qualifier = portSpec.substr (0, portSpec.find('('));
+    for (std::string_view name : names)
+      {
+        size_t p = std::min (qualifier.find('+'), qualifier.size());
+        if (qualifier.substr (0,p) != name)
+          return false;
+        qualifier.remove_prefix (std::min (p+1, qualifier.size()));
+      }
+    return true;
+  }
+  
+  
+  
+  /**
+   * A linear chain of element-wise operations, applied to all elements of a buffer in a single pass.
+   * @tparam BUF buffer type, must be indexable and provide `std::size()` (e.g. a `std::array`)
+   * @tparam OPS element operations, applied in order; the element type is passed by value.
+   */
+  template<class BUF, class...OPS>
+  class FusedChain
+    {
+      static_assert (0 < sizeof...(OPS), "at least one element operation required");
+      
+      using Elm = std::remove_cv_t<std::remove_reference_t<decltype(std::declval<BUF&>()[0])>>;
+      using ParamTup = decltype(std::tuple_cat (std::declval<typename _ElmOp<OPS>::ParamTup>()...));
+      
+      template<size_t s>
+      using Op = std::tuple_element_t<s, std::tuple<OPS...>>;
+      
+      std::tuple<OPS...> ops_;
+      
+    public:
+      static constexpr size_t STAGES = sizeof...(OPS);
+      static constexpr size_t PARAMS = std::tuple_size_v<ParamTup>;
+      
+      using Param = typename _ParamArg<ParamTup>::Type;
+      
+      static constexpr bool hasParam() { return 0 < PARAMS; }
+      
+      FusedChain (OPS ...elmOps)
+        : ops_{std::move (elmOps)...}
+        { }
+      
+      
+      /** apply the complete chain to each element of the input buffer */
+      template<class PAR>
+      void
+      render (PAR const& par, BUF const& in, BUF& out)  const
+        {
+          for (size_t i=0; i < std::size(out); ++i)
+            out[i] = apply<0> (par, in[i]);
+        }
+      
+      /** generate a processing functor suitable for a Turnout,
+       *  taking the parameter(s) (if any), an input and an output buffer */
+      auto
+      buildProcFun()  &&
+        {
+          if constexpr (hasParam())
+            return [chain = std::move(*this)]
+                   (Param par, BUF const* in, BUF* out)
+                      {
+                        chain.render (par, *in, *out);
+                      };
+          else
+            return [chain = std::move(*this)]
+                   (BUF const* in, BUF* out)
+                      {
+                        chain.render (std::tuple<>{}, *in, *out);
+                      };
+        }
+      
+      
+    private:
+      template<size_t s, class PAR>
+      Elm
+      apply (PAR const& par, Elm elm)  const
+        {
+          if constexpr (s == STAGES)
+            return elm;
+          else
+          if constexpr (_ElmOp<Op<s>>::hasParam)
+            return apply<s+1> (par, std::get<s>(ops_) (paramFor<s> (par), elm));
+          else
+            return apply<s+1> (par, std::get<s>(ops_) (elm));
+        }
+      
+      /** @return the index of the parameter for stage \a s within the ParamTup */
+      static constexpr size_t
+      paramIdx (size_t s)
+        {
+          constexpr bool stageParam[] = {_ElmOp<OPS>::hasParam...};
+          size_t idx{0};
+          for (size_t i=0; i<s; ++i)
+            idx += stageParam[i];
+          return idx;
+        }
+      
+      template<size_t s, class PAR>
+      static auto const&
+      paramFor (PAR const& par)
+        {
+          if constexpr (PARAMS == 1)
+            return par;
+          else
+            return std::get<paramIdx(s)> (par);
+        }
+    };
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_FUSED_CHAIN_H*/
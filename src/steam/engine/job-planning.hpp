@@ -157,11 +157,15 @@ namespace engine {
        * @return tolerance duration
        *         - Duration::NIL if deadline has to be matched with maximum precision
        *         - Duration::MAX for unlimited leeway to start anytime before the deadline
+       * @remark for time-bound playback, the output buffer of a frame is assumed to be
+       *         allotted when the preceding frame is delivered, i.e. one frame ahead.
        */
       Duration
-      determineLeeway(Timings const&)
+      determineLeeway(Timings const& timings)
         {
-          UNIMPLEMENTED ("Job planning logic to establish Leeway for scheduling");
+          if (not timings.isTimebound())
+            return Duration::MAX;
+          return timings.getFrameDurationAt (frameNr_);
         }
       
       
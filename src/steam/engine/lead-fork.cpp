@@ -0,0 +1,253 @@
+/*
+  LeadFork  -  spread out the pull of independent lead nodes to concurrent workers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file lead-fork.cpp
+ ** Implementation of fork and join for pulling lead nodes concurrently.
+ */
+
+
+#include "lib/error.hpp"
+#include "include/logging.h"
+#include "steam/engine/lead-fork.hpp"
+#include "steam/engine/proc-id.hpp"
+#include "steam/engine/turnout-system.hpp"
+#include "vault/gear/special-job-fun.hpp"
+#include "vault/gear/scheduler.hpp"
+#include "lib/util.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+#include <mutex>
+
+using std::lock_guard;
+using std::unique_lock;
+using std::chrono_literals::operator ""us;
+
+
+namespace steam {
+namespace engine {
+  
+  using vault::gear::SpecialJobFun;
+  using vault::gear::JobParameter;
+  using vault::gear::Job;
+  
+  
+  LeadFork::~LeadFork() { }  // emit VTable here...
+  
+  
+  namespace fork {
+    
+    /**
+     * @internal shared state of the sub-tasks forked to pull the leads of a single Port.
+     * Each slot is _claimed_ atomically by the worker performing the pull; the Junction
+     * is kept alive by the dispatched sub-tasks, since these may still be pending in some
+     * queue after the fork was joined.
+     */
+    class Junction
+      : util::NonCopyable
+      {
+        enum State : uint { OPEN, CLAIMED, DONE };
+        
+        struct Slot
+          {
+            std::atomic<uint> state{OPEN};
+            OptionalBuff result;
+            std::exception_ptr failure;
+          };
+        
+        lib::Several<PortRef>& leads_;
+        TurnoutSystem& turnoutSys_;
+        std::unique_ptr<Slot[]> slots_;
+        
+        std::mutex lock_;
+        std::condition_variable done_;
+        
+      public:
+        Junction (lib::Several<PortRef>& leads, TurnoutSystem& turnoutSys)
+          : leads_{leads}
+          , turnoutSys_{turnoutSys}
+          , slots_{new Slot[leads.size()]}
+          { }
+        
+        bool
+        claim (uint i)
+          {
+            uint expected{OPEN};
+            return slots_[i].state.compare_exchange_strong (expected, CLAIMED, std::memory_order_acq_rel);
+          }
+        
+        /** pull from a claimed lead; the TurnoutSystem is valid until marked as done */
+        void
+        perform (uint i)
+          {
+            Slot& slot = slots_[i];
+            try {
+                slot.result = leads_[i].get().weave (turnoutSys_);
+              }
+            catch (...)
+              {
+                slot.failure = std::current_exception();
+              }
+            {
+              lock_guard<std::mutex> guard{lock_};
+              slot.state.store (DONE, std::memory_order_release);
+            }
+            done_.notify_all();
+          }
+        
+        void
+        join (OptionalBuff* results)
+          {
+            uint cnt = leads_.size();
+            {
+              unique_lock<std::mutex> guard{lock_};
+              done_.wait (guard, [&]{
+                                      for (uint i=0; i<cnt; ++i)
+                                        if (DONE != slots_[i].state.load (std::memory_order_acquire))
+                                          return false;
+                                      return true;
+                                    });
+            }
+            std::exception_ptr failure;
+            for (uint i=0; i<cnt; ++i)
+              if (slots_[i].failure and not failure)
+                failure = slots_[i].failure;
+            if (failure)
+              {
+                for (uint i=0; i<cnt; ++i)
+                  if (slots_[i].result)
+                    slots_[i].result->release();
+                std::rethrow_exception (failure);
+              }
+            for (uint i=0; i<cnt; ++i)
+              results[i] = move (slots_[i].result);
+          }
+      };
+    
+    
+    bool
+    Task::perform()
+    {
+      if (not junction_->claim (slot_))
+        return false;
+      junction_->perform (slot_);
+      return true;
+    }
+    
+    
+    namespace {
+      bool
+      involvesParamAgent (Port& port)
+      {
+        if (port.procID.hasProxyPatt())
+          return true;
+        for (Port& lead : watch(port).srcPorts())
+          if (involvesParamAgent (lead))
+            return true;
+        return false;
+      }
+    }
+    
+    /**
+     * Estimate the cost to calculate the result of a port:
+     * count of processing steps (ports with media weaving pattern)
+     * involved, including all predecessors.
+     * @remark a rough heuristic; lacking further information about the
+     *         processing functions, each step is assumed to be equally costly.
+     */
+    uint
+    estimateCost (Port& port)
+    {
+      uint cost = port.procID.hasManifoldPatt()? 1 : 0;
+      for (Port& lead : watch(port).srcPorts())
+        {
+          cost += estimateCost (lead);
+          if (cost >= COST_LIMIT)
+            return COST_LIMIT;
+        }
+      return cost;
+    }
+    
+    /**
+     * Decide which leads of a port are worth being spread out as sub-task.
+     * @return bit mask marking the selected leads, or zero if the leads
+     *         should rather be pulled sequentially by the invoking worker.
+     * @note never forking when some lead involves a Param Agent Node,
+     *       since it would extend the TurnoutSystem concurrently.
+     */
+    uint64_t
+    selectLeads (lib::Several<PortRef> const& leads)
+    {
+      uint64_t forkMask{0};
+      if (leads.size() < 2)
+        return forkMask;
+      for (uint i=0; i < leads.size(); ++i)
+        {
+          Port& lead = util::unConst(leads)[i];
+          if (involvesParamAgent (lead))
+            return 0;
+          if (i < MAX_LEADS and estimateCost (lead) >= MIN_COST)
+            forkMask |= uint64_t(1) << i;
+        }
+      return forkMask;
+    }
+    
+    
+    void
+    pullLeads (lib::Several<PortRef>& leads, uint64_t forkMask
+              ,TurnoutSystem& turnoutSys, LeadFork& leadFork
+              ,OptionalBuff* results)
+    {
+      auto junction = std::make_shared<Junction> (leads, turnoutSys);
+      auto isForked = [&](uint i){ return i < MAX_LEADS and (forkMask & (uint64_t(1) << i)); };
+      uint cnt = leads.size();
+      for (uint i=0; i<cnt; ++i)
+        if (isForked(i))
+          try {
+              leadFork.dispatch (Task{junction, i});
+            }
+          ERROR_LOG_AND_IGNORE (engine, "dispatching lead pull as sub-task")
+      
+      for (uint i=0; i<cnt; ++i)
+        if (not isForked(i) and junction->claim (i))
+          junction->perform (i);
+      for (uint i=cnt; i>0; --i)     // pick up sub-tasks not yet started
+        if (junction->claim (i-1))
+          junction->perform (i-1);
+      junction->join (results);
+    }
+  }// namespace fork
+  
+  
+  
+  /**
+   * Post the sub-task as one-time job, to be started immediately.
+   * @note a sub-task not picked up within the life window is discarded
+   *       by the Scheduler; the joining worker performs it then.
+   */
+  void
+  ScheduledLeadFork::dispatch (fork::Task task)
+  {
+    SpecialJobFun jobFun{[task](JobParameter) mutable { task.perform(); }};
+    Job job{jobFun, InvocationInstanceID(), lib::time::Time::ANYTIME};
+    scheduler_.defineSchedule(job)
+              .startOffset(0us)
+              .lifeWindow(lifeWindow_)
+              .post();
+  }
+  
+  
+  
+}} // namespace steam::engine
@@ -0,0 +1,154 @@
+/*
+  LEAD-FORK.hpp  -  spread out the pull of independent lead nodes to concurrent workers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+/** @file lead-fork.hpp
+ ** Support for pulling input data from several predecessor nodes concurrently.
+ ** The recursive `weave()` invocation through the render nodes network is performed
+ ** depth-first on the stack of the worker processing a render job. Yet a node combining
+ ** several inputs — e.g. a compositor for several layers — retrieves its input data from
+ ** _independent_ lead nodes; if those are expensive to calculate, some of these
+ ** calculations may be spread out to other workers, which are idle otherwise.
+ **
+ ** Whether this is worth the effort is decided by the Builder for each port, based on an
+ ** [estimated cost](\ref fork::estimateCost) of calculating each lead. If at least one
+ ** lead is expensive enough, a ParallelWeavingPattern is installed into this port.
+ ** When actually invoked with a LeadFork service attached to the TurnoutSystem, this
+ ** weaving pattern offers the selected leads as _sub-tasks_ to the LeadFork, while pulling
+ ** all other leads directly. Subsequently, any sub-task not yet picked up by another worker
+ ** is performed by the invoking worker itself, and finally the invoking worker waits for the
+ ** sub-tasks currently in progress to complete, before invoking the processing function.
+ ** Since waiting is limited to sub-tasks actively in progress, a fork can not deadlock,
+ ** even when no other worker is available.
+ **
+ ** The sub-tasks refer to the TurnoutSystem of the invoking worker, which is retained on
+ ** the stack until the join; the parameters for the invocation are thus accessible for
+ ** the leads. However, a [Param Agent Node](\ref param-weaving-pattern.hpp) extends the
+ ** parameter chain of the TurnoutSystem temporarily, which would not be safe while used
+ ** concurrently; the leads of a port are thus never spread out when any of them involves
+ ** a Param Agent Node.
+ **
+ ** @see ScheduledLeadFork for spreading out by sub-tasks to the Scheduler
+ ** @see LeadFork_test
+ */
+
+#ifndef STEAM_ENGINE_LEAD_FORK_H
+#define STEAM_ENGINE_LEAD_FORK_H
+
+
+#include "lib/error.hpp"
+#include "lib/nocopy.hpp"
+#include "lib/several.hpp"
+#include "steam/engine/proc-node.hpp"
+
+#include <memory>
+#include <chrono>
+
+
+namespace vault {
+namespace gear {
+  class Scheduler;
+}}
+
+namespace steam {
+namespace engine {
+  
+  class TurnoutSystem;
+  
+  namespace fork {
+    
+    const uint   MIN_COST  = 4;        ///< estimated cost of a lead required to justify a sub-task
+    const uint   MAX_LEADS = 64;       ///< leads beyond this index are always pulled directly
+    const uint   COST_LIMIT = 1000;    ///< saturation limit for the cost estimation
+    
+    class Junction;
+    
+    /** Sub-task to pull from a single lead port into a shared Junction */
+    class Task
+      {
+        std::shared_ptr<Junction> junction_;
+        uint slot_;
+        
+      public:
+        Task (std::shared_ptr<Junction> junction, uint slot)
+          : junction_{move (junction)}
+          , slot_{slot}
+          { }
+        
+        /** perform the sub-task, unless already picked up by another worker
+         *  @return `true` when actually performed by this invocation */
+        bool perform();
+      };
+    
+    
+    uint estimateCost (Port&);
+    uint64_t selectLeads (lib::Several<PortRef> const&);
+  }
+  
+  
+  /**
+   * Interface: service to spread out sub-tasks of a render job to concurrent workers.
+   * A sub-task may be performed at any time later, or not at all; it is also valid to
+   * drop a task, since any sub-task not yet started will be performed by the worker
+   * joining the fork.
+   */
+  class LeadFork
+    : util::NonCopyable
+    {
+    public:
+      virtual ~LeadFork();  ///< this is an interface
+      
+      virtual void dispatch (fork::Task) =0;
+    };
+  
+  
+  /**
+   * LeadFork to spread out sub-tasks as one-time jobs to the Scheduler,
+   * to be picked up immediately by any available worker.
+   */
+  class ScheduledLeadFork
+    : public LeadFork
+    {
+      vault::gear::Scheduler& scheduler_;
+      std::chrono::microseconds lifeWindow_;
+      
+    public:
+      explicit
+      ScheduledLeadFork (vault::gear::Scheduler& scheduler
+                        ,std::chrono::microseconds lifeWindow =std::chrono::milliseconds{100})
+        : scheduler_{scheduler}
+        , lifeWindow_{lifeWindow}
+        { }
+      
+      void dispatch (fork::Task)  override;
+    };
+  
+  
+  
+  namespace fork {
+    /**
+     * @internal retrieve input data from all lead ports.
+     * Leads marked in the \a forkMask are dispatched as sub-tasks to the LeadFork,
+     * while all other leads are pulled directly; the function returns after all
+     * leads have delivered data.
+     * @param results array to receive the BuffHandle for each lead
+     * @throw any exception raised by pulling a lead, after the join;
+     *        the buffers retrieved by other leads are released then.
+     */
+    void pullLeads (lib::Several<PortRef>& leads, uint64_t forkMask
+                   ,TurnoutSystem&, LeadFork&
+                   ,OptionalBuff* results);
+  }
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_LEAD_FORK_H*/
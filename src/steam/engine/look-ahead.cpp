@@ -0,0 +1,183 @@
+/*
+  LookAhead  -  speculative pre-rendering of frames around the playhead
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file look-ahead.cpp
+ ** Implementation of speculative render jobs to fill the FrameCache around the playhead.
+ */
+
+
+#include "lib/error.hpp"
+#include "include/logging.h"
+#include "steam/engine/look-ahead.hpp"
+#include "steam/engine/frame-cache.hpp"
+#include "steam/engine/turnout-system.hpp"
+#include "vault/gear/special-job-fun.hpp"
+#include "vault/gear/scheduler.hpp"
+
+#include <cstdlib>
+#include <atomic>
+
+using std::make_shared;
+
+
+namespace steam {
+namespace engine {
+  
+  using vault::gear::SpecialJobFun;
+  using vault::gear::JobParameter;
+  using vault::gear::Job;
+  using lib::time::Offset;
+  
+  namespace lookahead {
+    
+    /** @internal shared with the jobs, which may outlive the LookAheadRender */
+    struct Target
+      {
+        Port& port;
+        FrameCache& cache;
+        std::atomic_size_t rendered{0};
+        std::atomic_size_t skipped{0};
+        
+        Target (Port& exitPort, FrameCache& frameCache)
+          : port{exitPort}
+          , cache{frameCache}
+          { }
+        
+        /** pull the exit port into the cache, unless already cached */
+        void
+        render (Time nomTime)
+          {
+            if (cache.contains (FrameKey{port.procHash(), nomTime, ProcessKey{0}}))
+              {
+                ++skipped;
+                return;
+              }
+            TurnoutSystem turnoutSys{nomTime};
+            turnoutSys.attachFrameCache (cache);
+            port.weave(turnoutSys).release();
+            ++rendered;
+          }
+      };
+  }
+  
+  
+  LookAheadRender::LookAheadRender (vault::gear::Scheduler& scheduler
+                                   ,Port& exitPort
+                                   ,FrameCache& cache
+                                   ,FrameRate fps
+                                   ,uint radius)
+    : scheduler_{scheduler}
+    , target_{make_shared<lookahead::Target> (exitPort, cache)}
+    , fps_{fps}
+    , radius_{radius}
+    , manID_{ManifestationID::allocate()}
+    {
+      scheduler_.enableManifestation (manID_);
+    }
+  
+  LookAheadRender::~LookAheadRender()
+    {
+      try {
+          scheduler_.dropManifestation (manID_);
+        }
+      ERROR_LOG_AND_IGNORE (engine, "discarding speculative render jobs")
+    }
+  
+  
+  Time
+  LookAheadRender::frameTime (FrameCnt frame)  const
+  {
+    return Time{Offset{frame, fps_}};
+  }
+  
+  size_t
+  LookAheadRender::cntRendered()  const
+  {
+    return target_->rendered;
+  }
+  
+  size_t
+  LookAheadRender::cntSkipped()  const
+  {
+    return target_->skipped;
+  }
+  
+  
+  /**
+   * Place the playhead and post speculative jobs for all frames within the radius.
+   * A small move keeps the speculation already posted; when jumping beyond the radius,
+   * any work not yet started is dropped and a new ManifestationID is used.
+   */
+  void
+  LookAheadRender::moveTo (FrameCnt playhead)
+  {
+    if (playhead_ and radius_ < std::abs (playhead - *playhead_))
+      retire();
+    
+    auto isPosted = [&](FrameCnt frame){ return playhead_ and lo_ <= frame and frame < hi_; };
+    for (FrameCnt d=0; d <= radius_; ++d)
+      {
+        if (not isPosted (playhead+d))
+          post (playhead+d, playhead);
+        if (d > 0 and not isPosted (playhead-d))
+          post (playhead-d, playhead);
+      }
+    playhead_ = playhead;
+    lo_ = playhead - radius_;
+    hi_ = playhead + radius_ + 1;
+  }
+  
+  /** discard all speculative work not yet started, e.g. when starting playback */
+  void
+  LookAheadRender::stop()
+  {
+    if (playhead_)
+      retire();
+  }
+  
+  
+  /**
+   * @internal post a speculative job to render the given frame;
+   * the start time is staggered by distance to the playhead,
+   * preferring frames ahead over frames behind.
+   */
+  void
+  LookAheadRender::post (FrameCnt frame, FrameCnt playhead)
+  {
+    FrameCnt rank = frame < playhead? 2*(playhead-frame)
+                                    : std::max (FrameCnt(0), 2*(frame-playhead) - 1);
+    Time nomTime = frameTime (frame);
+    SpecialJobFun jobFun{[target=target_, nomTime](JobParameter){ target->render (nomTime); }};
+    Job job{jobFun, InvocationInstanceID(), nomTime};
+    scheduler_.defineSchedule(job)
+              .startOffset(rank * lookahead::STAGGER)
+              .lifeWindow(lookahead::LIFE_WINDOW)
+              .manifestation(manID_)
+              .speculative()
+              .post();
+    ++posted_;
+  }
+  
+  /** @internal drop the current speculation and switch to a new ManifestationID */
+  void
+  LookAheadRender::retire()
+  {
+    scheduler_.dropManifestation (manID_);
+    manID_ = ManifestationID::allocate();
+    scheduler_.enableManifestation (manID_);
+    playhead_ = std::nullopt;
+  }
+  
+  
+}} // namespace steam::engine
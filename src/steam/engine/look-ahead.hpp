@@ -0,0 +1,125 @@
+/*
+  LOOK-AHEAD.hpp  -  speculative pre-rendering of frames around the playhead
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+/** @file look-ahead.hpp
+ ** Speculative render mode to fill the FrameCache while playback is paused or scrubbing.
+ ** When the user stops the playhead or moves it slowly by hand, the render engine is mostly
+ ** idle, while the next request will most likely concern a frame close to the current position.
+ ** A LookAheadRender thus uses the spare capacity to pre-render frames around the playhead into
+ ** the FrameCache, so that subsequent scrubbing or playback can be served from the cache.
+ **
+ ** The jobs are marked as _speculative_ for the Scheduler, which keeps them aside and dispatches
+ ** them only to workers classified as idle capacity by the LoadController, and only while no
+ ** regular work is due; real-time jobs thus always take precedence. Frames closest to the
+ ** playhead are started first, frames ahead of the playhead before frames behind.
+ ** - when the playhead moves only slightly (within the radius), the already posted
+ **   speculation remains valid and only the additional frames are posted
+ ** - when the playhead jumps, the speculation is obsolete; all work not yet started is
+ **   dropped at once by its ManifestationID, and a new manifestation is used henceforth;
+ **   each manifestation is drawn from ManifestationID::allocate() and thus can not collide
+ **   with the manifestation of any other calculation stream.
+ ** Frames already present in the cache are skipped when the job is performed.
+ **
+ ** @todo 2026 integrate into the CalcStream / PlayProcess, once the EngineService
+ **       actually dispatches its calculation streams through the Scheduler.
+ ** @see LookAhead_test
+ ** @see vault::gear::SchedulerInvocation::pullSpeculative()
+ */
+
+
+#ifndef STEAM_ENGINE_LOOK_AHEAD_H
+#define STEAM_ENGINE_LOOK_AHEAD_H
+
+
+#include "lib/error.hpp"
+#include "lib/nocopy.hpp"
+#include "lib/time/timevalue.hpp"
+#include "vault/gear/activity.hpp"
+
+#include <optional>
+#include <memory>
+#include <chrono>
+
+
+namespace vault {
+namespace gear {
+  class Scheduler;
+}}
+
+namespace steam {
+namespace engine {
+  
+  using lib::time::Time;
+  using lib::time::FrameCnt;
+  using lib::time::FrameRate;
+  using vault::gear::ManifestationID;
+  
+  class FrameCache;
+  class Port;
+  
+  namespace lookahead {
+    
+    const std::chrono::microseconds STAGGER{20};        ///< start time increment per rank of distance to the playhead
+    const std::chrono::milliseconds LIFE_WINDOW{2000};  ///< speculative jobs not started within this window are discarded
+    
+    struct Target;
+  }
+  
+  
+  /**
+   * Speculative pre-rendering of the frames around a playhead, using idle capacity only.
+   * For each frame within the radius around the playhead, a speculative job is posted to
+   * the Scheduler, to pull the given exit Port with the FrameCache attached.
+   * @warning not threadsafe; to be controlled from a single thread, like the PlayProcess.
+   * @note the Port and FrameCache must outlive any job already started.
+   */
+  class LookAheadRender
+    : util::NonCopyable
+    {
+      vault::gear::Scheduler& scheduler_;
+      std::shared_ptr<lookahead::Target> target_;
+      FrameRate fps_;
+      FrameCnt radius_;
+      ManifestationID manID_;
+      
+      std::optional<FrameCnt> playhead_{};
+      FrameCnt lo_{0}, hi_{0};          ///< range of frames posted for the current manifestation
+      size_t posted_{0};
+      
+    public:
+      LookAheadRender (vault::gear::Scheduler&
+                      ,Port& exitPort
+                      ,FrameCache&
+                      ,FrameRate fps
+                      ,uint radius);
+     ~LookAheadRender();
+      
+      void moveTo (FrameCnt playhead);
+      void stop();
+      
+      Time frameTime (FrameCnt)  const;
+      
+      /* === diagnostics === */
+      ManifestationID manifestation() const { return manID_;  }
+      size_t cntPosted()              const { return posted_; }
+      size_t cntRendered()            const;
+      size_t cntSkipped()             const;
+      
+    private:
+      void post (FrameCnt frame, FrameCnt playhead);
+      void retire();
+    };
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_LOOK_AHEAD_H*/
@@ -122,6 +122,23 @@
  ** generated as a by-product of the processing function invocation, but are actually not passed
  ** as output up the node invocation chain.
  ** 
+ ** Since each input buffer is consumed by the processing step, it is _dead_ after this step and could
+ ** be reused. For a processing function able to work _in-place,_ the Builder can thus mark some output
+ ** slots to reuse the input buffer with the same slot index, provided this input is known to deliver
+ ** a buffer of the same kind (type and BufferProvider); this reduces the number of buffers held at
+ ** any time during a recursive invocation and avoids touching further memory. Since the input data
+ ** is delivered by the lead node as »emitted« buffer, the state transition to _emit_ the result is
+ ** omitted then. An output designated to receive the result into a buffer given by the caller
+ ** is never aliased; likewise, an input buffer of different kind (e.g. handed out from the
+ ** FrameCache) is detected at invocation and then a separate output buffer is allocated.
+ ** 
+ ** For nodes combining several inputs, the ParallelWeavingPattern is a variant to pull independent
+ ** lead nodes concurrently, by spreading out some of these recursive invocations as sub-tasks
+ ** to other workers (\ref lead-fork.hpp). For a _batch processing functor,_ the BatchWeavingPattern
+ ** renders several consecutive frames with a single invocation and hands over the additional results
+ ** to the FrameCache, where the invocations for the following frames will pick them up. Without a
+ ** FrameCache, or when the following frames are already cached, only a single frame is rendered.
+ ** 
  ** @see feed-manifold.hpp
  ** @see weaving-pattern-builder.hpp
  ** @see \ref proc-node.hpp "Overview of Render Node structures"
@@ -138,6 +155,7 @@
 #include "steam/engine/turnout.hpp"
 #include "steam/engine/turnout-system.hpp"
 #include "steam/engine/feed-manifold.hpp"
+#include "steam/engine/lead-fork.hpp"
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////TICKET #1367 : Rebuild the Node Invocation
 //#include "vault/gear/job.h"
 //#include "steam/engine/exit-node.hpp"
@@ -151,6 +169,7 @@
 //#include "lib/util.hpp"      ////////OOO wegen manifoldSiz<FUN>()
 
 //#include <stack>
+#include <array>
 
 
 namespace steam {
@@ -159,6 +178,13 @@ namespace engine {
   using lib::Several;
   
   
+  /** marker to designate output slots which may reuse the input buffer with the same index */
+  struct InPlaceSlots
+    {
+      uint64_t mask{0};
+    };
+  
+  
     /**
      * Standard implementation for a _Weaving Pattern_ to connect
      * the input and output data feeds (buffers) into a processing function.
@@ -185,6 +211,7 @@ namespace engine {
       Several<BuffDescr> outTypes_;
       
       uint resultSlot_{0};
+      uint64_t inPlace_{0};
       
       INVO prototype_;
       
@@ -200,6 +227,18 @@ namespace engine {
         , prototype_{forward<ARGS>(args)...}
         { }
       
+      /** variant to allow for in-place processing in the output slots marked by \a inPlace */
+      template<typename...ARGS>
+      MediaWeavingPattern (Several<PortRef>&&   pr
+                          ,Several<BuffDescr>&& dr
+                          ,uint resultIdx
+                          ,InPlaceSlots inPlace
+                          ,ARGS&& ...args)
+        : MediaWeavingPattern{move(pr), move(dr), resultIdx, forward<ARGS>(args)...}
+        {
+          inPlace_ = inPlace.mask;
+        }
+      
       
       Feed
       mount (TurnoutSystem& turnoutSys)
@@ -227,7 +266,7 @@ namespace engine {
               {
                 BuffHandle resultData =
                   i == resultSlot_ and outBuff? *outBuff
-                                              : outTypes_[i].lockBuffer();
+                                              : provideBuffer (feed,i);
                 feed.outBuff.createAt(i, move(resultData));
               }
           feed.connect();
@@ -242,14 +281,17 @@ namespace engine {
       BuffHandle
       fix (Feed& feed, TurnoutSystem&)
         {
+          uint64_t aliased = detectAliased (feed);
           if constexpr (Feed::hasInput())
             for (uint i=0; i<leadPort_.size(); ++i)
               {
-                feed.inBuff[i].release();
-              }
+                if (not isMarked (aliased, i))
+                  feed.inBuff[i].release();
+              }                            // (otherwise handed over as output)
           for (uint i=0; i<outTypes_.size(); ++i)
               {
-                feed.outBuff[i].emit();    // state transition: data ready
+                if (not isMarked (aliased, i))
+                  feed.outBuff[i].emit();  // state transition: data ready
                 if (i != resultSlot_)
                   feed.outBuff[i].release();
               }
@@ -262,11 +304,227 @@ namespace engine {
       friend auto
       _accessInternal(MediaWeavingPattern& patt)
       {
-        return std::tie (patt.leadPort_, patt.outTypes_);
+        return std::tie (patt.leadPort_, patt.outTypes_, patt.resultSlot_, patt.inPlace_);
       }
+      
+    private:
+      static bool
+      isMarked (uint64_t slotMask, uint i)
+        {
+          return i < 64 and (slotMask & (uint64_t(1) << i));
+        }
+      
+      bool isInPlace (uint i) { return isMarked (inPlace_, i); }
+      
+      /** output buffer for slot \a i: reuse the input with same index, which is
+       *  dead after processing — provided it is of the kind expected for this output */
+      BuffHandle
+      provideBuffer (Feed& feed, uint i)
+        {
+          if constexpr (Feed::hasInput())
+            if (isInPlace(i) and feed.inBuff[i].isKindOf (outTypes_[i]))
+              return feed.inBuff[i];
+          return outTypes_[i].lockBuffer();
+        }
+      
+      /** @return bitmask of output slots actually placed into the input buffer */
+      uint64_t
+      detectAliased (Feed& feed)
+        {
+          uint64_t aliased{0};
+          if constexpr (Feed::hasInput())
+            for (uint i=0; i<leadPort_.size() and i<outTypes_.size(); ++i)
+              if (isInPlace(i) and & *feed.inBuff[i] == & *feed.outBuff[i])
+                aliased |= uint64_t(1) << i;
+          return aliased;
+      }
+    };
+  
+  
+  
+  /**
+   * Variant of the standard _Weaving Pattern_ to pull independent leads concurrently.
+   * Installed by the Builder when some leads are [expensive](\ref fork::selectLeads);
+   * these are spread out as sub-tasks, provided that a LeadFork service is attached
+   * to the TurnoutSystem, and the results are joined before invoking the processing.
+   * @note layout compatible to MediaWeavingPattern, to allow for diagnostic access.
+   */
+  template<class INVO>
+  struct ParallelWeavingPattern
+    : MediaWeavingPattern<INVO>
+    {
+      using _Base = MediaWeavingPattern<INVO>;
+      using Feed = typename _Base::Feed;
+      
+      uint64_t forkLeads_;
+      
+      template<typename...ARGS>
+      ParallelWeavingPattern (uint64_t forkMask, ARGS&& ...args)
+        : _Base{forward<ARGS>(args)...}
+        , forkLeads_{forkMask}
+        { }
+      
+      void
+      pull (Feed& feed, TurnoutSystem& turnoutSys)
+        {
+          LeadFork* leadFork = turnoutSys.getLeadFork();
+          if (not leadFork)
+            return _Base::pull (feed, turnoutSys);
+          
+          std::array<OptionalBuff, INVO::FAN_I> inputData;
+          fork::pullLeads (_Base::leadPort_, forkLeads_, turnoutSys, *leadFork, inputData.data());
+          for (uint i=0; i<_Base::leadPort_.size(); ++i)
+            feed.inBuff.createAt(i, move(*inputData[i]));
+        }
     };
   
   
   
+  /**
+   * Variant of the _Weaving Pattern_ to render a batch of consecutive frames with a single
+   * invocation of a _batch processing functor._ The first frame is rendered into the given
+   * output buffer as usual, while the results for the following frames are handed over to
+   * the FrameCache, where they will be picked up by the invocations for these frames;
+   * this way, consecutive frame jobs targeting this port are effectively grouped.
+   * Without a FrameCache, the functor is invoked for a single frame; moreover, the batch
+   * ends before the first following frame already present in the cache, so that no
+   * frame is rendered repeatedly.
+   * @tparam INVO a BatchPrototype to build a BatchFeed with FeedManifold per frame
+   * @note in-place processing is not supported.
+   * @note layout compatible to MediaWeavingPattern, to allow for diagnostic access.
+   */
+  template<class INVO>
+  struct BatchWeavingPattern
+    : util::NonCopyable
+    {
+      using Feed = typename INVO::Feed;
+      enum{ BATCH = Feed::BATCH };
+      
+      static_assert (_verify_usable_as_InvocationAdapter<Feed>());
+      
+      Several<PortRef>   leadPort_;
+      Several<BuffDescr> outTypes_;
+      
+      uint resultSlot_{0};
+      uint64_t inPlace_{0};
+      
+      INVO prototype_;
+      
+      template<typename...ARGS>
+      BatchWeavingPattern (Several<PortRef>&&   pr
+                          ,Several<BuffDescr>&& dr
+                          ,uint resultIdx
+                          ,InPlaceSlots
+                          ,ARGS&& ...args)
+        : leadPort_{move(pr)}
+        , outTypes_{move(dr)}
+        , resultSlot_{resultIdx}
+        , prototype_{forward<ARGS>(args)...}
+        { }
+      
+      
+      Feed
+      mount (TurnoutSystem& turnoutSys)
+        {
+          ENSURE (leadPort_.size() <= INVO::FAN_I);
+          ENSURE (outTypes_.size() <= INVO::FAN_O);
+          return prototype_.buildFeed (turnoutSys, batchSize (turnoutSys));
+        }
+      
+      void
+      pull (Feed& feed, TurnoutSystem&)
+        {
+          if constexpr (Feed::hasInput())
+            for (uint k=0; k<feed.cnt(); ++k)
+              for (uint i=0; i<leadPort_.size(); ++i)
+                {
+                  BuffHandle inputData = leadPort_[i].get().weave (feed.turnoutSys(k));
+                  feed.frame(k).inBuff.createAt(i, move(inputData));
+                }
+        }
+      
+      void
+      shed (Feed& feed, TurnoutSystem&, OptionalBuff outBuff)
+        {
+          for (uint k=0; k<feed.cnt(); ++k)
+            for (uint i=0; i<outTypes_.size(); ++i)
+              {
+                BuffHandle resultData =
+                  k == 0 and i == resultSlot_ and outBuff? *outBuff
+                                                         : outTypes_[i].lockBuffer();
+                feed.frame(k).outBuff.createAt(i, move(resultData));
+              }
+          feed.connect();
+        }
+      
+      void
+      weft (Feed& feed, TurnoutSystem&)
+        {
+          feed.invoke();                 // process data of all frames
+        }
+      
+      BuffHandle
+      fix (Feed& feed, TurnoutSystem&)
+        {
+          ENSURE (resultSlot_ < INVO::FAN_O, "invalid result buffer configured.");
+          for (uint k=0; k<feed.cnt(); ++k)
+            {
+              auto& frame = feed.frame(k);
+              if constexpr (Feed::hasInput())
+                for (uint i=0; i<leadPort_.size(); ++i)
+                  frame.inBuff[i].release();
+              for (uint i=0; i<outTypes_.size(); ++i)
+                {
+                  frame.outBuff[i].emit();   // state transition: data ready
+                  if (i != resultSlot_)
+                    frame.outBuff[i].release();
+                }
+              if (k > 0)
+                handOver (feed.turnoutSys(k), frame.outBuff[resultSlot_]);
+            }
+          return feed.frame(0).outBuff[resultSlot_];
+        }
+      
+      
+      /** @internal expose data not dependent on the template params */
+      friend auto
+      _accessInternal(BatchWeavingPattern& patt)
+      {
+        return std::tie (patt.leadPort_, patt.outTypes_, patt.resultSlot_, patt.inPlace_);
+      }
+    
+    private:
+      /** @return number of frames to render: a single frame without FrameCache,
+       *          otherwise up to the first following frame found in the cache */
+      uint
+      batchSize (TurnoutSystem& turnoutSys)
+        {
+          FrameCache* cache = turnoutSys.getFrameCache();
+          if (not cache)
+            return 1;
+          HashVal procHash = static_cast<Turnout<BatchWeavingPattern>&> (*this).procHash();
+          TimeVar frameStep{prototype_.frameStep()};
+          uint cnt{1};
+          for ( ; cnt < BATCH; ++cnt)
+            {
+              Time nomTime{TimeVar{turnoutSys.getNomTime()} + frameStep * int(cnt)};
+              if (cache->contains (FrameKey{procHash, nomTime, turnoutSys.getProcKey()}))
+                break;
+            }
+          return cnt;
+        }
+      
+      /** results of the following frames can only be used through the FrameCache */
+      void
+      handOver (TurnoutSystem& frameSys, BuffHandle& result)
+        {
+          if (FrameCache* cache = frameSys.getFrameCache())
+            cache->remember (static_cast<Turnout<BatchWeavingPattern>&> (*this), frameSys, result);
+          result.release();
+        }
+    };
+
+  
+  
 }}// namespace steam::engine
 #endif /*STEAM_ENGINE_MEDIA_WEAVING_PATTERN_H*/
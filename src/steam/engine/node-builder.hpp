@@ -83,6 +83,10 @@
  ** signature of the actual function supplied. The accepted variations are described in detail
  ** [here](\ref feed-manifold.hpp). Basically, a function can take parameters, input- and output-buffers,
  ** yet only the output-buffers are mandatory. Several elements of one kind can be passed as tuple.
+ ** \par fused element operations
+ ** Simple operations working on each sample or pixel independently can be combined into a single
+ ** processing function, to save the memory traffic of separate nodes; the Port builder function
+ ** [invokeFused](\ref PortBuilderRoot::invokeFused()) composes such a chain at compile time.
  ** 
  ** ## Handling of Invocation Parameters
  ** Typically, a processing operation can be configured in various ways, by passing additional
@@ -95,6 +99,10 @@
  ** accepts a parameter argument, optionally a such parameter-functor can be installed; this functor
  ** is supplied with the \ref TurnoutSystem of the actual invocation, which acts as front-end to
  ** access contextual parameters.
+ ** \par automation curves
+ ** A parameter controlled by keyframes can be bound with `attachAutomation (curve, range)`;
+ ** the interpolation is then precomputed for the time range and evaluated incrementally
+ ** for consecutive frames by a per-Port cursor, see param-automation.hpp
  ** \par synthesised additional parameters
  ** As an extension for (rare and elaborate) special cases, a special evaluation scheme is provided,
  ** which relies on a »Param Agent Node« as entry point, to invoke additional functors and compute
@@ -123,6 +131,8 @@
 #include "steam/engine/weaving-pattern-builder.hpp"
 #include "steam/engine/media-weaving-pattern.hpp"
 #include "steam/engine/param-weaving-pattern.hpp"
+#include "steam/engine/fused-chain.hpp"
+#include "steam/engine/param-automation.hpp"
 #include "steam/engine/proc-node.hpp"
 #include "steam/engine/turnout.hpp"
 #include "lib/several-builder.hpp"
@@ -291,6 +301,11 @@ namespace engine {
       template<typename FUN>
       auto invoke (StrView portSpec, FUN fun);
       
+      /** fuse a linear chain of element-wise operations into a single processing function.
+       * @return a PortBuilder specialised to wrap the fused chain, working on buffers \a BUF */
+      template<class BUF, typename...OPS>
+      auto invokeFused (StrView portSpec, NamedElmOp<OPS> ...elmOps);
+      
       /** setup a »ParamAgentNode« to compute additional parameters
        *  and then delegate into an existing node invocation. */
       template<class SPEC>
@@ -359,6 +374,43 @@ namespace engine {
           return move(*this);
         }
       
+      /** allow the processing function to place results into its input buffers
+       * @remark applied to each output slot where the lead connected to the input slot
+       *         with the same index delivers a buffer of the same kind; the function
+       *         must thus be able to work with input and output in the same buffer.
+       */
+      PortBuilder&&
+      allowInPlace()
+        {
+          weavingBuilder_.allowInPlace();
+          return move(*this);
+        }
+      
+      /** retain the results of this port in the FrameCache, if attached to the invocation
+       * @remark by default, only the results of the exit port of an invocation are cached;
+       *         a port opting in here is also cached when pulled as lead of another port.
+       *         Ports with a _batch processing functor_ are always cached, since the
+       *         following frames can be picked up only from the FrameCache.
+       */
+      PortBuilder&&
+      cacheResults()
+        {
+          weavingBuilder_.cacheResults();
+          return move(*this);
+        }
+      
+      /** define the duration of a frame, when a _batch processing functor_ is used
+       * @remark such a functor renders several consecutive frames, by processing
+       *         all arguments as FrameBatch; the results of the following frames
+       *         are handed over to the FrameCache, if attached to the invocation.
+       */
+      PortBuilder&&
+      batchFrameStep (Duration frameDuration)
+        {
+          weavingBuilder_.batchFrameStep (frameDuration);
+          return move(*this);
+        }
+      
       /** connect the next input slot to existing lead-node given by index
        * @note the port to use on this lead is implicitly defaulted to use the same port-number
        *       as the port which is currently about to be built; this is a common pattern, since
@@ -435,16 +487,44 @@ namespace engine {
                                    };
         }
       
+      /** Embed a parameter-functor, explicitly stating the parameters it supplies
+       * @param paramState hash to identify those parameters, which is folded into
+       *        the processing hash of the Port; pass a freshParamState() to opt out
+       *        from sharing cached results with any other Port.
+       */
+      template<class PFX>
+      auto
+      attachParamFun (PFX paramFunctor, HashVal paramState)
+        {
+          using AdaptedWeavingBuilder = typename WAB::template Adapted<PFX>;
+          using AdaptedPortBuilder = PortBuilder<POL,DAT,AdaptedWeavingBuilder>;
+          //
+          return AdaptedPortBuilder{move(*this)
+                                   ,weavingBuilder_.adaptParam (move (paramFunctor), paramState)
+                                   };
+        }
+      
       /** control parameter(s) by an automation function, based on nominal timeline time */
       template<class AUTO>
       auto
       attachAutomation (AUTO&& aFun)
         {
+          HashVal paramState = paramStateOf (aFun);
           return attachParamFun ([automation = forward<AUTO>(aFun)]
                                  (TurnoutSystem& turnoutSys)
                                     {
                                       return automation (turnoutSys.getNomTime());
-                                    });
+                                    }
+                                ,paramState);
+        }
+      
+      /** control the parameter by an automation curve, precomputed for the given time range
+       *  (typically of the Segment) and evaluated incrementally for consecutive frames.
+       * @see param-automation.hpp */
+      auto
+      attachAutomation (AutomationCurve const& curve, TimeSpan range)
+        {
+          return attachParamFun (AutomationCursor{AutomationPlan::build (curve, range)});
         }
       
       /** embed a fixed value to use for the parameter(s) */
@@ -455,7 +535,8 @@ namespace engine {
           return attachParamFun ([=](TurnoutSystem&) -> PAR
                                     {
                                       return paramVal;
-                                    });
+                                    }
+                                ,paramValueState (paramVal));
         }
       
       template<typename PAR, typename...PARS>
@@ -465,11 +546,14 @@ namespace engine {
           return attachParamFun ([=](TurnoutSystem&) -> tuple<PAR,PARS...>
                                     {
                                       return std::make_tuple (v1,vs...);
-                                    });
+                                    }
+                                ,paramValueState (v1,vs...));
         }
       
       /** retrieve the parameter(s) at invocation time through a getter functor,
-       *  which is typically constructed in conjunction with a »Param Agent« node. */
+       *  which is typically constructed in conjunction with a »Param Agent« node.
+       * @remark the values are supplied by the invoking context and can not be
+       *         identified here; thus results of this Port are never shared. */
       template<typename GET>
       auto
       retrieveParam (GET&& getter)
@@ -478,7 +562,8 @@ namespace engine {
                                  (TurnoutSystem& turnoutSys)
                                     {
                                       return turnoutSys.get(accessor);
-                                    });
+                                    }
+                                ,freshParamState());
         }
       
       template<typename ADA>
@@ -493,6 +578,18 @@ namespace engine {
                                    };
         }
       
+      template<typename ADA>
+      auto
+      adaptParam (ADA&& paramAdaptor, HashVal paramState)
+        {
+          using DecoratedPrototype = typename WAB::template Decorated<ADA>;
+          using AdaptedPortBuilder = PortBuilder<POL,DAT,DecoratedPrototype>;
+          //
+          return AdaptedPortBuilder{move(*this)
+                                   ,weavingBuilder_.adaptProcFunParam (move (paramAdaptor), paramState)
+                                   };
+        }
+      
       /** immediately close (≙ fix) some values in a parameter tuple,
        *  starting from left, while leaving the remaining values open
        *  to be supplied by automation or another parameter binding. */
@@ -500,9 +597,11 @@ namespace engine {
       auto
       closeParamFront (PAR v1, PARS ...vs)
         {
+          HashVal paramState = paramValueState (v1,vs...);
           return adaptParam(
                     WAB::ParamClosure::template closeFront (forward<PAR> (v1)
-                                                           ,forward<PARS>(vs)...));
+                                                           ,forward<PARS>(vs)...)
+                   ,paramState);
         }
       
       /** immediately close the rightmost parameter positions,
@@ -511,9 +610,11 @@ namespace engine {
       auto
       closeParamBack (PAR v1, PARS ...vs)
         {
+          HashVal paramState = paramValueState (v1,vs...);
           return adaptParam(
                     WAB::ParamClosure::template closeBack  (forward<PAR> (v1)
-                                                           ,forward<PARS>(vs)...));
+                                                           ,forward<PARS>(vs)...)
+                   ,paramState);
         }
       
       /** immediately close a single parameter at designated position
@@ -523,8 +624,10 @@ namespace engine {
       auto
       closeParam (PAR val)
         {
+          HashVal paramState = paramValueState (val);
           return adaptParam(
-                    WAB::ParamClosure::template close<idx> (forward<PAR> (val)));
+                    WAB::ParamClosure::template close<idx> (forward<PAR> (val))
+                   ,paramState);
         }
       
       
@@ -587,17 +690,51 @@ namespace engine {
    *  - notably this implies that the implementation code of a lambda will be _inlined_ into the
    *    actual invocation call, while possibly _creating a copy_ of value-captured closure data;
    *    this arrangement aims at exposing the actual invocation for the optimiser.
+   *  - a function taking all arguments wrapped as FrameBatch is a _batch processing functor,_
+   *    invoked to render several consecutive frames at once; see \ref PortBuilder::batchFrameStep()
    */
   template<class POL, class DAT>
   template<typename FUN>
   auto
   PortBuilderRoot<POL,DAT>::invoke (StrView portSpec, FUN fun)
     {
-      using Prototype = typename FeedManifold<FUN>::Prototype;
+      using Prototype = typename ProcPrototype<FUN>::Type;
       using WeavingBuilder_FUN = WeavingBuilder<POL, Prototype>;
       return PortBuilder<POL,DAT, WeavingBuilder_FUN>{move(*this), move(fun), portSpec};
     }
   
+  /**
+   * @param portSpec qualifier and argument lists; the qualifier must name each element
+   *        operation in order, joined by `'+'`, so to trace the constituents in diagnostics
+   * @param elmOps a sequence of element-wise operations, applied to each element in turn;
+   *        each operation is tagged with its name by \ref elmOp()
+   * @remarks
+   *  - rather than building a separate node for each of those operations, the generated
+   *    processing functor applies the complete chain in a single pass over the buffer,
+   *    without intermediary buffers (see fused-chain.hpp)
+   *  - the fused functor takes one input and one output buffer, and the parameters of all
+   *    element operations, which can be supplied by a single parameter-functor
+   *  - since each element is processed independently, the fused chain can work in-place
+   * @throw err::Invalid when the constituents named in the spec do not match the chain
+   */
+  template<class POL, class DAT>
+  template<class BUF, typename...OPS>
+  auto
+  PortBuilderRoot<POL,DAT>::invokeFused (StrView portSpec, NamedElmOp<OPS> ...elmOps)
+    {
+      if (not matchFusedConstituents (portSpec, {elmOps.name...}))
+        {
+          string names;
+          ((names += (names.empty()? "":"+") + string{elmOps.name}), ...);
+          throw err::Invalid{_Fmt{"Spec for a fused chain must name each of the %d element operations "
+                                  "in order, joined by '+' (expected: %s). Node:%s Spec:%s"}
+                                 % sizeof...(OPS) % names % this->symbol_ % portSpec
+                            };
+        }
+      FusedChain<BUF,OPS...> chain{move(elmOps.op)...};
+      return invoke (portSpec, move(chain).buildProcFun());
+    }
+  
   
   
   
@@ -0,0 +1,276 @@
+/*
+  ParamAutomation  -  evaluation of parameter automation curves with incremental interpolation
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file param-automation.cpp
+ ** Implementation of keyframe interpolation and incremental evaluation of automation.
+ */
+
+
+#include "lib/error.hpp"
+#include "lib/hash-combine.hpp"
+#include "steam/engine/param-automation.hpp"
+#include "steam/fixture/segment.hpp"
+
+#include <functional>
+#include <algorithm>
+
+
+namespace steam {
+namespace engine {
+  
+  using lib::time::Offset;
+  using automation::Keyframe;
+  using automation::Span;
+  
+  namespace {
+    inline double
+    seconds (TimeValue a, TimeValue b)
+    {
+      return double(_raw(b) - _raw(a)) / TimeValue::SCALE;
+    }
+    
+    inline Span
+    constantSpan (TimeValue start, TimeValue end, double value)
+    {
+      return Span{TimeVar{start}, TimeVar{end}, {value, 0, 0, 0}};
+    }
+    
+    /** evaluate the polynomial, clamping the time into the span */
+    inline double
+    valueAt (Span const& span, TimeValue t)
+    {
+      double u = std::max (0.0, span.offset (t));
+      if (span.end < t)
+        u = seconds (span.start, span.end);
+      return span.evaluate (u);
+    }
+  }
+  
+  
+  
+  /* ======= AutomationCurve ======= */
+  
+  /** define a keyframe; an existing keyframe at the same time is replaced */
+  AutomationCurve&
+  AutomationCurve::addKeyframe (Time time, double value)
+  {
+    auto pos = std::lower_bound (keys_.begin(), keys_.end(), time
+                                ,[](Keyframe const& k, Time t){ return k.time < t; });
+    if (pos != keys_.end() and pos->time == time)
+      pos->value = value;
+    else
+      keys_.insert (pos, Keyframe{time, value});
+    return *this;
+  }
+  
+  
+  /** compute the interpolation polynomial between keyframe \a i and its successor */
+  Span
+  AutomationCurve::span (size_t i)  const
+  {
+    REQUIRE (i+1 < keys_.size());
+    Keyframe const& k0 = keys_[i];
+    Keyframe const& k1 = keys_[i+1];
+    double v0 = k0.value;
+    double len = seconds (k0.time, k1.time);
+    double slope = (k1.value - v0) / len;
+    switch (mode_)
+      {
+      case automation::STEP:
+        return constantSpan (k0.time, k1.time, v0);
+      case automation::LINEAR:
+        return Span{TimeVar{k0.time}, TimeVar{k1.time}, {v0, slope, 0, 0}};
+      case automation::SMOOTH:
+      default:
+        {
+          auto tangent = [&](size_t k)
+                            {
+                              size_t prev = k > 0? k-1 : k;
+                              size_t next = k+1 < keys_.size()? k+1 : k;
+                              return (keys_[next].value - keys_[prev].value)
+                                   / seconds (keys_[prev].time, keys_[next].time);
+                            };
+          double m0 = tangent (i);
+          double m1 = tangent (i+1);
+          return Span{TimeVar{k0.time}, TimeVar{k1.time}
+                     ,{v0
+                      ,m0
+                      ,(3*slope - 2*m0 - m1) / len
+                      ,(m0 + m1 - 2*slope) / (len*len)
+                     }};
+        }
+      }
+  }
+  
+  
+  /** direct evaluation: search the keyframe interval and interpolate */
+  double
+  AutomationCurve::evaluate (Time t)  const
+  {
+    if (keys_.empty())
+      return 0;
+    if (t <= keys_.front().time)
+      return keys_.front().value;
+    if (keys_.back().time <= t)
+      return keys_.back().value;
+    auto pos = std::upper_bound (keys_.begin(), keys_.end(), t
+                                ,[](Time t, Keyframe const& k){ return t < k.time; });
+    Span interval = span (pos - keys_.begin() - 1);
+    return interval.evaluate (interval.offset (t));
+  }
+  
+  
+  
+  /* ======= AutomationPlan ======= */
+  
+  /**
+   * Precompute the interpolation for all keyframe intervals overlapping the given range.
+   * Spans of constant value are added where the range extends beyond the keyframes.
+   */
+  AutomationPlan::AutomationPlan (AutomationCurve const& curve, TimeSpan range)
+    : spans_{}
+    {
+      Time start = range.start();
+      Time end   = range.end();
+      size_t n = curve.size();
+      if (0 == n)
+        {
+          spans_.emplace_back (constantSpan (start, end, 0.0));
+          return;
+        }
+      if (start < curve[0].time)
+        spans_.emplace_back (constantSpan (start, curve[0].time, curve[0].value));
+      for (size_t i=0; i+1 < n; ++i)
+        if (curve[i].time < end and start < curve[i+1].time)
+          spans_.emplace_back (curve.span (i));
+      if (curve[n-1].time < end)
+        spans_.emplace_back (constantSpan (std::max (start, Time{curve[n-1].time}), end, curve[n-1].value));
+      ENSURE (not spans_.empty());
+    }
+  
+  AutomationPlan::AutomationPlan (AutomationCurve const& curve, fixture::Segment const& segment)
+    : AutomationPlan{curve, TimeSpan{segment.start(), segment.after()}}
+    { }
+  
+  AutomationPlan::Shared
+  AutomationPlan::build (AutomationCurve const& curve, TimeSpan range)
+  {
+    return std::make_shared<const AutomationPlan> (curve, range);
+  }
+  
+  
+  /**
+   * Find the span covering the given time, trying the \a hint and its successor first.
+   * @return index of the span; clamped to the first / last span outside the plan
+   */
+  size_t
+  AutomationPlan::locate (Time t, size_t hint)  const
+  {
+    auto covers = [&](size_t i){ return i < spans_.size() and spans_[i].start <= t and t < spans_[i].end; };
+    if (covers (hint))   return hint;
+    if (covers (hint+1)) return hint+1;
+    auto pos = std::upper_bound (spans_.begin(), spans_.end(), t
+                                ,[](Time t, Span const& s){ return t < s.start; });
+    return pos == spans_.begin()? 0 : pos - spans_.begin() - 1;
+  }
+  
+  double
+  AutomationPlan::evaluate (Time t)  const
+  {
+    return valueAt (spans_[locate (t)], t);
+  }
+  
+  /** @return hash over the time spans and polynomial coefficients */
+  HashVal
+  AutomationPlan::hash()  const
+  {
+    HashVal hash{spans_.size()};
+    for (Span const& span : spans_)
+      {
+        lib::hash::combine (hash, HashVal(_raw(span.start)));
+        lib::hash::combine (hash, HashVal(_raw(span.end)));
+        for (double c : span.c)
+          lib::hash::combine (hash, std::hash<double>{}(c));
+      }
+    return hash;
+  }
+  
+  
+  
+  /* ======= AutomationCursor ======= */
+  
+  /** evaluate at the given time; falls back to direct evaluation when used concurrently */
+  double
+  AutomationCursor::evaluate (Time t)
+  {
+    if (busy_.test_and_set (std::memory_order_acquire))
+      return plan_->evaluate (t);
+    double val = advance (t);
+    busy_.clear (std::memory_order_release);
+    return val;
+  }
+  
+  
+  /**
+   * @internal compute the next value by forward differencing when the request continues
+   * the sequence with the same step; otherwise evaluate directly and prepare the differences
+   * for the next step, provided this request advanced the nominal time within the same span.
+   * @remark the differences are re-initialised at each span boundary and after
+   *         #REANCHOR_STEPS, which bounds the accumulation of rounding errors.
+   */
+  double
+  AutomationCursor::advance (Time t)
+  {
+    AutomationPlan const& plan = *plan_;
+    if (primed_ and t == next_ and t < plan[idx_].end
+        and steps_ < REANCHOR_STEPS)
+      {
+        double val = diff_[0];
+        diff_[0] += diff_[1];
+        diff_[1] += diff_[2];
+        diff_[2] += diff_[3];
+        next_ += Offset{last_, t};
+        last_ = t;
+        ++steps_;
+        ++incremental_;
+        return val;
+      }
+    
+    idx_ = plan.locate (t, idx_);
+    Span const& span = plan[idx_];
+    double val = valueAt (span, t);
+    primed_ = last_ < t
+          and span.start <= t and t < span.end;
+    if (primed_)
+      {
+        double h = seconds (last_, t);
+        double u = span.offset (t);
+        double p0 = span.evaluate (u +   h),
+               p1 = span.evaluate (u + 2*h),
+               p2 = span.evaluate (u + 3*h),
+               p3 = span.evaluate (u + 4*h);
+        diff_[0] = p0;
+        diff_[1] = p1 - p0;
+        diff_[2] = p2 - 2*p1 + p0;
+        diff_[3] = p3 - 3*p2 + 3*p1 - p0;
+        next_ = t + Offset{last_, t};
+      }
+    last_ = t;
+    steps_ = 0;
+    ++direct_;
+    return val;
+  }
+  
+  
+}} // namespace steam::engine
@@ -0,0 +1,229 @@
+/*
+  PARAM-AUTOMATION.hpp  -  evaluation of parameter automation curves with incremental interpolation
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+/** @file param-automation.hpp
+ ** Evaluation of _parameter automation_ for render node invocations.
+ ** A [parameter functor](\ref PortBuilder::attachParamFun) is invoked for every frame rendered
+ ** through a Port, typically to retrieve the value of some automated parameter at the nominal time
+ ** of this frame. A naive implementation would locate the enclosing pair of keyframes and evaluate the
+ ** interpolation for each invocation anew — while frames are rendered mostly in sequence, and thus
+ ** the same spline is looked up and evaluated over and over again at equidistant points.
+ **
+ ** The evaluation is thus split into three stages:
+ ** - an AutomationCurve holds the keyframes of some parameter, as defined in the Session
+ ** - for each Segment of the timeline, the Builder derives an AutomationPlan, which holds
+ **   the interpolation polynomials for all keyframe intervals within the Segment's time range,
+ **   precomputed into a compact array; this is the only allocation involved.
+ ** - each Port is outfitted with its own AutomationCursor, acting as parameter functor.
+ **   The cursor remembers the current interval and the step between consecutive frames;
+ **   as long as frames are requested with the same step in increasing nominal time,
+ **   the next value is computed by _forward differencing,_ i.e. by three additions.
+ **   Any other request is served by direct evaluation and re-initialises the differences.
+ **
+ ** The value computed incrementally deviates from direct evaluation by accumulated rounding
+ ** errors, which grow with the third power of the number of steps. To keep this deviation
+ ** bounded, the differences are re-anchored to the exact value at each span boundary and
+ ** after at most AutomationCursor::REANCHOR_STEPS; the remaining deviation is in the order
+ ** of 1e-11 relative to the magnitude of the curve values. Since it depends on the sequence
+ ** of invocations, a frame may be rendered with either value and cached under the same key;
+ ** the difference is far below the resolution of any media parameter.
+ **
+ ** Since several workers may render frames through the same Port concurrently, the state
+ ** of the cursor is protected by an atomic flag; a concurrent invocation does not wait,
+ ** but rather falls back to direct evaluation from the plan. The cursor never allocates.
+ ** @remark the interpolation is a cubic Hermite spline with tangents based on the neighbouring
+ **         keyframes (»Catmull-Rom«); alternatively linear or stepped interpolation can be used.
+ ** @todo 2026 mobject::Interpolator and session::Auto are still placeholders; the curve
+ **       defined here shall be populated from the Session by the Builder eventually.
+ ** @see ParamAutomation_test
+ */
+
+
+#ifndef STEAM_ENGINE_PARAM_AUTOMATION_H
+#define STEAM_ENGINE_PARAM_AUTOMATION_H
+
+
+#include "lib/error.hpp"
+#include "lib/hash-value.h"
+#include "lib/time/timevalue.hpp"
+#include "steam/engine/turnout-system.hpp"
+
+#include <memory>
+#include <vector>
+#include <atomic>
+
+
+namespace steam {
+namespace fixture {
+  class Segment;
+}
+namespace engine {
+  
+  using lib::HashVal;
+  using lib::time::Time;
+  using lib::time::TimeVar;
+  using lib::time::TimeValue;
+  using lib::time::TimeSpan;
+  
+  namespace automation {
+    
+    enum Interpolation { STEP, LINEAR, SMOOTH };
+    
+    struct Keyframe
+      {
+        TimeVar time;
+        double  value;
+      };
+    
+    /** interpolation polynomial for a time interval, based on offset in seconds */
+    struct Span
+      {
+        TimeVar start;
+        TimeVar end;
+        double  c[4];
+        
+        double
+        evaluate (double u)  const
+          {
+            return c[0] + u*(c[1] + u*(c[2] + u*c[3]));
+          }
+        
+        /** offset of the given time against the start of this span, in seconds */
+        double
+        offset (TimeValue t)  const
+          {
+            return double(_raw(t) - _raw(start)) / TimeValue::SCALE;
+          }
+      };
+  }
+  
+  
+  /**
+   * Keyframes of an automated parameter, to be interpolated in between.
+   * Before the first and after the last keyframe, the value is held constant.
+   * @note direct evaluation searches the keyframe interval on each invocation;
+   *       use an AutomationPlan and AutomationCursor for rendering.
+   */
+  class AutomationCurve
+    {
+      std::vector<automation::Keyframe> keys_;
+      automation::Interpolation mode_;
+      
+    public:
+      explicit
+      AutomationCurve (automation::Interpolation mode =automation::SMOOTH)
+        : keys_{}
+        , mode_{mode}
+        { }
+      
+      AutomationCurve& addKeyframe (Time, double value);
+      
+      double evaluate (Time)  const;
+      automation::Span span (size_t i)  const;   ///< interpolation between keyframe i and i+1
+      
+      size_t size()  const { return keys_.size(); }
+      bool  empty()  const { return keys_.empty(); }
+      automation::Keyframe const& operator[] (size_t i) const { return keys_[i]; }
+    };
+  
+  
+  /**
+   * Interpolation polynomials of an AutomationCurve, precomputed for a time range.
+   * The spans cover the range without gaps, including constant spans before the first
+   * and after the last keyframe; evaluation outside the range is clamped.
+   */
+  class AutomationPlan
+    {
+      std::vector<automation::Span> spans_;
+      
+    public:
+      AutomationPlan (AutomationCurve const&, TimeSpan range);
+      AutomationPlan (AutomationCurve const&, fixture::Segment const&);
+      
+      using Shared = std::shared_ptr<const AutomationPlan>;
+      static Shared build (AutomationCurve const&, TimeSpan range);
+      
+      size_t locate (Time, size_t hint =0)  const;
+      double evaluate (Time)  const;
+      HashVal hash()  const;   ///< identity of the interpolation (to key cached frames)
+      
+      size_t size()  const { return spans_.size(); }
+      automation::Span const& operator[] (size_t i) const { return spans_[i]; }
+    };
+  
+  
+  /**
+   * Parameter functor to evaluate an AutomationPlan for each invocation of a Port.
+   * Consecutive frames are computed incrementally by forward differencing.
+   * @remark copying yields a cursor on the same plan with pristine state;
+   *         each Port should thus own a separate cursor.
+   */
+  class AutomationCursor
+    {
+      AutomationPlan::Shared plan_;
+      
+      std::atomic_flag busy_ = ATOMIC_FLAG_INIT;
+      bool    primed_{false};
+      size_t  idx_{0};
+      uint    steps_{0};
+      TimeVar last_{Time::NEVER};
+      TimeVar next_{Time::NEVER};
+      double  diff_[4];
+      
+      size_t  incremental_{0};
+      size_t  direct_{0};
+      
+    public:
+      /** maximum number of incremental steps before evaluating directly */
+      static constexpr uint REANCHOR_STEPS = 32;
+      
+      explicit
+      AutomationCursor (AutomationPlan::Shared plan)
+        : plan_{std::move (plan)}
+        {
+          REQUIRE (plan_ and 0 < plan_->size());
+        }
+      
+      AutomationCursor (AutomationCursor const& o)
+        : AutomationCursor{o.plan_}
+        { }
+      
+      AutomationCursor& operator= (AutomationCursor const&) =delete;
+      
+      double evaluate (Time);
+      
+      double
+      operator() (TurnoutSystem& turnoutSys)
+        {
+          return evaluate (turnoutSys.getNomTime());
+        }
+      
+      /** @remark picked up by the Builder to discern frames rendered with other automation */
+      HashVal
+      paramState()  const
+        {
+          return plan_->hash();
+        }
+      
+      /* === diagnostics === */
+      size_t cntIncremental()  const { return incremental_; }
+      size_t cntDirect()       const { return direct_; }
+      
+    private:
+      double advance (Time);
+    };
+  
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_PARAM_AUTOMATION_H*/
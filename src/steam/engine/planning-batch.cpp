@@ -0,0 +1,164 @@
+/*
+  PlanningBatch  -  job-planning for a run of frames in one chunk
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file planning-batch.cpp
+ ** Implementation of chunk-wise job-planning with batched JobTicket resolution.
+ */
+
+
+#include "steam/engine/planning-batch.hpp"
+#include "vault/real-clock.hpp"
+
+#include <utility>
+
+using std::move;
+using vault::RealClock;
+using std::chrono::microseconds;
+
+
+namespace steam {
+namespace engine {
+  
+  namespace { // implementation helpers
+    
+    /** number of JobPlanning steps for a JobTicket, including all prerequisites */
+    size_t
+    cntPlanningSteps (JobTicket& ticket)
+    {
+      size_t cnt{1};
+      for (auto prereq = ticket.getPrerequisites(); prereq; ++prereq)
+        cnt += cntPlanningSteps (*prereq);
+      return cnt;
+    }
+  }
+  
+  
+  
+  PlanningBatch::PlanningBatch (Dispatcher& dispatcher, Timings timings, ModelPort port)
+    : dispatcher_{dispatcher}
+    , timings_{timings}
+    , portIDX_{dispatcher.resolveModelPort (port)}
+    { }
+  
+  
+  /**
+   * Establish the job-planning for all frames starting within `[start, after[`.
+   * A first pass establishes the frame coordinates and retrieves the JobTicket
+   * once per Segment; since the structure of the prerequisites is known then,
+   * the second pass can emit all JobPlanning records into pre-sized storage.
+   * Each Segment is marked to be retained while jobs planned from it may still run,
+   * since its JobTickets must remain accessible even after a switch to a new version
+   * of the Fixture. This retention is set by the Dispatcher as part of the lookup,
+   * while read access to the Segmentation is still held; it covers the time due
+   * for the last frame of the chunk, which bounds the deadline of every job.
+   * @remark the planning records of the preceding chunk are discarded.
+   * @remark jobs without deadline expire after SchedulerFrontend::FREEWHEELING_WINDOW,
+   *         counted from the commit of the transaction; for these, the Segment is
+   *         retained for twice this window, allowing for #feedTo to happen later.
+   */
+  PlanningBatch&
+  PlanningBatch::plan (Time start, Time after)
+  {
+    plans_.clear();
+    dependent_.clear();
+    frames_.clear();
+    cntRuns_ = 0;
+    FrameCnt first = timings_.getBreakPointAfter (start);
+    FrameCnt end   = timings_.getBreakPointAfter (after);
+    if (end <= first) return *this;
+    frames_.reserve (end - first);   // JobPlanning refers into this storage, which thus must not be reallocated
+    
+    Time retention = timings_.isTimebound()? timings_.getTimeDue (end-1)
+                                           : Time{RealClock::now() + TimeValue{2 * microseconds{SchedulerFrontend::FREEWHEELING_WINDOW}.count()}};
+    JobTicket* ticket{nullptr};
+    TimeVar segmentEnd{Time::NEVER};
+    size_t cntSteps{0}, cntPlans{0};
+    for (FrameCnt frameNr = first; frameNr < end; ++frameNr)
+      {
+        Time frameStart = timings_.getFrameStartAt (frameNr);
+        if (not ticket or segmentEnd <= frameStart)
+          {
+            auto run = dispatcher_.getJobTicketRun (portIDX_, frameStart, retention);
+            ticket = & run.ticket;
+            segmentEnd = run.after;
+            cntSteps = cntPlanningSteps (*ticket);
+            ++cntRuns_;
+          }
+        frames_.push_back (FramePoint{frameStart, frameNr, ticket});
+        cntPlans += cntSteps;
+      }
+    
+    plans_.reserve (cntPlans);       // likewise prerequisites are linked to their dependent JobPlanning
+    dependent_.reserve (cntPlans);
+    for (FramePoint& frame : frames_)
+      emitPlanning (JobPlanning{*frame.ticket, frame.nominalTime, frame.frameNr}, TOP_LEVEL);
+    
+    ENSURE (plans_.size() == cntPlans);
+    return *this;
+  }
+  
+  
+  /** @internal store the planning and recursively all prerequisite plannings (depth-first) */
+  void
+  PlanningBatch::emitPlanning (JobPlanning&& planning, size_t dependent)
+  {
+    size_t idx = plans_.size();
+    plans_.emplace_back (move (planning));
+    dependent_.push_back (dependent);
+    for (auto prereq = plans_[idx].buildDependencyPlanning(); prereq; ++prereq)
+      emitPlanning (move (*prereq), idx);
+  }
+  
+  
+  /**
+   * Build the jobs for the current chunk and add them to the given transaction.
+   * Depending on the playback urgency, these are defined as time-bound jobs with
+   * a deadline and a planned start (allowing for the leeway before the deadline),
+   * or as freewheeling or background jobs; prerequisites are marked
+   * to precede their dependent job.
+   * @note the JobTickets are protected only by the retention of their Segment,
+   *       as established by #plan; thus the jobs must be fed into the transaction
+   *       and committed before the deadlines of the chunk.
+   */
+  void
+  PlanningBatch::feedTo (JobTransaction& tx)
+  {
+    size_t base = tx.size();
+    tx.reserve (base + plans_.size());
+    for (size_t idx=0; idx < plans_.size(); ++idx)
+      {
+        JobPlanning& planning = plans_[idx];
+        switch (timings_.playbackUrgency)
+          {
+          case play::TIMEBOUND:
+            {
+              Time deadline = planning.determineDeadline (timings_);
+              tx.addJob (deadline - planning.determineLeeway (timings_), deadline, planning.buildJob());
+            }
+            break;
+          case play::ASAP:
+            tx.addFreewheeling (planning.buildJob());
+            break;
+          case play::NICE:
+            tx.addBackground (planning.buildJob());
+            break;
+          }
+        if (dependent_[idx] != TOP_LEVEL)
+          tx.prerequisiteOf (base + dependent_[idx]);
+      }
+  }
+  
+  
+  
+}} // namespace steam::engine
@@ -0,0 +1,117 @@
+/*
+  PLANNING-BATCH.hpp  -  job-planning for a run of frames in one chunk
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file planning-batch.hpp
+ ** Batched variant of the job-planning pipeline, for high frame rates.
+ ** The [planning pipeline](\ref Dispatcher::PlanningPipeline) pulls each frame through
+ ** a chain of on-demand processing steps and looks up the JobTicket from the Segmentation
+ ** for every single frame. This is adequate for video, but for small audio blocks (e.g. 1000
+ ** blocks per second) the per-frame overhead becomes significant. Yet the Segmentation changes
+ ** only rarely; all frames within a Segment use the same JobTicket. Thus the PlanningBatch
+ ** - resolves the Segment only once for each run of frames, by Dispatcher::getJobTicketRun,
+ **   which also marks the Segment to be retained until the deadlines of the chunk
+ ** - counts the prerequisites of each JobTicket up-front, to size the storage exactly
+ ** - emits the JobPlanning records in depth-first order into a contiguous array,
+ **   each prerequisite indicating the index of the dependent planning
+ ** - finally feeds all the resulting jobs into a single JobTransaction
+ ** The storage is retained from one chunk to the next, so that after warm-up the planning
+ ** of further chunks performs no allocations. The sequence of generated jobs is the same
+ ** as produced by the pipeline built with Dispatcher::PipelineBuilder::expandPrerequisites()
+ ** @warning the JobPlanning records refer to the frame data within the batch; they are
+ **          valid only until the next chunk is planned.
+ ** @see JobPlanningBatch_test
+ ** @see JobPlanningPipeline_test
+ */
+
+
+#ifndef STEAM_ENGINE_PLANNING_BATCH_H
+#define STEAM_ENGINE_PLANNING_BATCH_H
+
+#include "steam/common.hpp"
+#include "steam/engine/dispatcher.hpp"
+#include "steam/engine/job-planning.hpp"
+#include "vault/gear/scheduler-frontend.hpp"
+#include "lib/nocopy.hpp"
+
+#include <vector>
+
+
+namespace steam {
+namespace engine {
+  
+  using vault::gear::SchedulerFrontend;
+  using JobTransaction = SchedulerFrontend::JobTransaction;
+  
+  
+  /**
+   * Job-planning for a chunk of frames, backed by a Dispatcher.
+   * Intended to be placed into a CalcStream and to be reused for
+   * planning consecutive chunks of the same data feed.
+   */
+  class PlanningBatch
+    : util::NonCopyable
+    {
+      struct FramePoint
+        {
+          TimeVar    nominalTime;
+          FrameCnt   frameNr;
+          JobTicket* ticket;
+        };
+      
+      Dispatcher&   dispatcher_;
+      const Timings timings_;
+      const size_t  portIDX_;
+      
+      std::vector<FramePoint>  frames_;
+      std::vector<JobPlanning> plans_;
+      std::vector<size_t>      dependent_;
+      size_t cntRuns_{0};
+      
+    public:
+      static constexpr size_t TOP_LEVEL = size_t(-1);
+      
+      PlanningBatch (Dispatcher&, Timings, ModelPort);
+      
+      PlanningBatch& plan (Time start, Time after);
+      void feedTo (JobTransaction&);
+      
+      
+      size_t size()      const { return plans_.size();  }
+      bool   empty()     const { return plans_.empty(); }
+      size_t cntFrames() const { return frames_.size(); }
+      size_t cntRuns()   const { return cntRuns_;       } ///< Segment lookups while planning the current chunk
+      
+      JobPlanning&
+      operator[] (size_t idx)
+        {
+          REQUIRE (idx < plans_.size());
+          return plans_[idx];
+        }
+      
+      /** @return index of the JobPlanning depending on the given one, or #TOP_LEVEL */
+      size_t
+      dependentOf (size_t idx)  const
+        {
+          REQUIRE (idx < dependent_.size());
+          return dependent_[idx];
+        }
+      
+    private:
+      void emitPlanning (JobPlanning&&, size_t dependent);
+    };
+  
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_PLANNING_BATCH_H*/
@@ -0,0 +1,515 @@
+/*
+  PooledBufferProvider  -  BufferProvider recycling frames from size-class pools
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file pooled-buffer-provider.cpp
+ ** Implementation of frame pools per size class and thread-local frame caches.
+ */
+
+
+#include "lib/error.hpp"
+#include "include/logging.h"
+#include "steam/engine/pooled-buffer-provider.hpp"
+#include "lib/nocopy.hpp"
+#include "lib/util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <new>
+
+using std::lock_guard;
+
+
+namespace steam {
+namespace engine {
+  
+  namespace error = lumiera::error;
+  
+  using Buff = StreamType::ImplFacade::DataBuffer;
+  
+  
+  namespace pool {
+    
+    namespace { // implementation details
+      
+      const uint TYPE_CACHE = 8;       ///< buffer types remembered per thread
+      
+      std::atomic<uint64_t> providerSerial{0};
+      
+      size_t
+      frameSizeFor (size_t bufferSize)
+      {
+        return (bufferSize + FRAME_ALIGNMENT-1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+      }
+    }
+    
+    
+    /** @internal discard a slab of frame storage allocated with extended alignment */
+    struct SlabRelease
+      {
+        void
+        operator() (char* slab)
+          {
+            ::operator delete (slab, std::align_val_t{FRAME_ALIGNMENT});
+          }
+      };
+    
+    
+    /**
+     * @internal Pool of frames sharing a common (rounded) size.
+     * Free frames are chained into an intrusive list.
+     * @note all operations must be performed under the provider's lock.
+     */
+    class SizeClass
+      : util::NonCopyable
+      {
+        struct FreeFrame
+          {
+            FreeFrame* next;
+          };
+        
+        std::vector<std::unique_ptr<char, SlabRelease>> slabs_;
+        FreeFrame* freeList_{nullptr};
+        size_t cntFree_{0};
+        size_t capacity_{0};
+        size_t announced_{0};
+        size_t headroom_{0};       ///< frames possibly parked in thread-local Magazines
+        
+      public:
+        const uint   index;
+        const size_t frameSize;
+        const uint   cacheLimit;   ///< maximum frames to retain in a thread-local Magazine
+        
+        SizeClass (uint idx, size_t frameSiz)
+          : index{idx}
+          , frameSize{frameSiz}
+          , cacheLimit{uint(util::limited (size_t(1), MAGAZINE_BYTES / frameSiz, size_t(MAGAZINE_SIZE)))}
+          { }
+        
+        size_t capacity()  const { return capacity_; }
+        size_t announced() const { return announced_; }
+        size_t cntFree()   const { return cntFree_; }
+        size_t cntSlabs()  const { return slabs_.size(); }
+        
+        
+        /** allocate a further slab holding the given number of frames */
+        void
+        grow (size_t cnt)
+          {
+            REQUIRE (cnt);
+            std::unique_ptr<char, SlabRelease> slab{
+                static_cast<char*> (::operator new (cnt * frameSize, std::align_val_t{FRAME_ALIGNMENT}))};
+            char* storage = slab.get();
+            slabs_.emplace_back (std::move (slab));
+            for (size_t i=cnt; 0 < i; --i)  // chain frames in ascending order
+              put (storage + (i-1)*frameSize);
+            capacity_ += cnt;
+          }
+        
+        /** add to the total demand of frames announced for this size class
+         *  and extend the pool to hold this total without further allocation */
+        void
+        reserve (size_t cnt)
+          {
+            announced_ += cnt;
+            ensureCapacity();
+          }
+        
+        /** account for frames held in the Magazines of the given number of threads */
+        void
+        provideFor (size_t threads)
+          {
+            headroom_ = threads * cacheLimit;
+            ensureCapacity();
+          }
+        
+        /** when frames were announced, the capacity must cover this demand
+         *  plus all frames possibly parked in Magazines; otherwise the pool
+         *  could run dry while frames are idle in the cache of some thread */
+        void
+        ensureCapacity()
+          {
+            if (not announced_) return;
+            size_t required = announced_ + headroom_;
+            if (capacity_ < required)
+              grow (required - capacity_);
+          }
+        
+        void
+        put (void* frame)
+          {
+            freeList_ = new(frame) FreeFrame{freeList_};
+            ++cntFree_;
+          }
+        
+        /** @note extends the pool when exhausted */
+        void*
+        take()
+          {
+            if (not freeList_)
+              {
+                bool established = capacity_;
+                grow (util::max (capacity_/2, MIN_GROWTH));
+                if (established)
+                  WARN (proc_mem, "frame pool exhausted; extended to %zu frames of %zu bytes"
+                                 , capacity_, frameSize);
+              }
+            FreeFrame* entry = freeList_;
+            freeList_ = entry->next;
+            --cntFree_;
+            return entry;
+          }
+      };
+    
+    
+    /** @internal free frames cached by one thread for a single size class */
+    struct Magazine
+      {
+        uint cnt{0};
+        std::array<void*, MAGAZINE_SIZE> frame;
+      };
+    
+    
+    /**
+     * @internal free frames cached by one thread, together with
+     * a small lookup table to find the size class for a buffer type.
+     * @remark only the owning thread accesses the magazines, except for
+     *         diagnostics, and for reclaiming the frames after the owner
+     *         has [abandoned](\ref #abandon) this cache.
+     */
+    class LocalCache
+      : util::NonCopyable
+      {
+        struct TypeEntry
+          {
+            HashVal typeID{0};
+            SizeClass* cls{nullptr};
+          };
+        
+        std::array<TypeEntry, TYPE_CACHE> types_;
+        uint next_{0};
+        std::atomic<bool> abandoned_{false};
+        
+      public:
+        std::array<Magazine, MAX_SIZE_CLASSES> magazine;
+        
+        /** mark as detached from the owning thread (on thread exit) */
+        void abandon()           { abandoned_.store (true, std::memory_order_release); }
+        bool isAbandoned() const { return abandoned_.load (std::memory_order_acquire); }
+        
+        SizeClass*
+        knownClass (HashVal typeID)
+          {
+            for (TypeEntry& entry : types_)
+              if (entry.cls and entry.typeID == typeID)
+                return entry.cls;
+            return nullptr;
+          }
+        
+        void
+        remember (HashVal typeID, SizeClass& cls)
+          {
+            types_[next_] = TypeEntry{typeID, &cls};
+            next_ = (next_+1) % TYPE_CACHE;
+          }
+      };
+    
+    
+    /** thread-local attachment to the cache used with a specific provider;
+     *  when the thread terminates, the cache is abandoned, so that
+     *  the provider returns the cached frames into the pool. */
+    struct CacheHandle
+      {
+        uint64_t serial{0};
+        std::shared_ptr<LocalCache> cache;
+        
+       ~CacheHandle() { if (cache) cache->abandon(); }
+      };
+    
+    thread_local CacheHandle currentCache;
+    
+  }//(End)namespace pool
+  
+  
+  
+  
+  PooledBufferProvider::PooledBufferProvider()
+    : BufferProvider ("PooledBufferProvider")
+    , serial_{1 + pool::providerSerial.fetch_add (1, std::memory_order_relaxed)}
+    { }
+  
+  PooledBufferProvider::~PooledBufferProvider()
+    {
+      INFO (proc_mem, "discarding frame pools: %zu bytes in %zu slabs", allocatedBytes(), cntSlabs());
+    }
+  
+  
+  /* ==== Implementation of the BufferProvider interface ==== */
+  
+  /** establish capacity for the announced number of buffers
+   * @remark this is the point where heap storage is allocated,
+   *         thus should be invoked before starting playback.
+   * @note announcements add up: the size class is extended to hold
+   *       the total of all buffers announced for types of this size,
+   *       plus the frames the attached threads may keep in their caches.
+   */
+  uint
+  PooledBufferProvider::prepareBuffers (uint count, HashVal typeID)
+  {
+    pool::SizeClass& cls = classFor (typeID);
+    lock_guard<std::mutex> guard{lock_};
+    cls.reserve (count);
+    return count;
+  }
+  
+  
+  BuffHandle
+  PooledBufferProvider::provideLockedBuffer (HashVal typeID)
+  {
+    pool::SizeClass& cls = classFor (typeID);
+    pool::LocalCache& cache = localCache();
+    pool::Magazine& mag = cache.magazine[cls.index];
+    if (0 == mag.cnt)
+      refill (cls, cache);
+    void* frame = mag.frame[--mag.cnt];
+    return buildHandle (typeID, static_cast<Buff*> (frame));
+  }
+  
+  
+  /** emitting has no further consequences for pooled frames;
+   *  the frame remains in use until the buffer is released. */
+  void
+  PooledBufferProvider::mark_emitted (HashVal, LocalTag const&)
+  {
+    /* NOP */
+  }
+  
+  
+  /** return the frame into the cache of the current thread */
+  void
+  PooledBufferProvider::detachBuffer (HashVal typeID, LocalTag const&, Buff& storage)
+  {
+    pool::SizeClass& cls = classFor (typeID);
+    pool::LocalCache& cache = localCache();
+    pool::Magazine& mag = cache.magazine[cls.index];
+    if (mag.cnt >= cls.cacheLimit)
+      flush (cls, cache, cls.cacheLimit / 2);
+    mag.frame[mag.cnt++] = &storage;
+  }
+  
+  
+  
+  /* ==== Implementation details ==== */
+  
+  /** @internal find the size class for a buffer type,
+   *  preferably from the types remembered by the current thread */
+  pool::SizeClass&
+  PooledBufferProvider::classFor (HashVal typeID)
+  {
+    pool::LocalCache& cache = localCache();
+    pool::SizeClass* cls = cache.knownClass (typeID);
+    if (not cls)
+      {
+        lock_guard<std::mutex> guard{lock_};
+        cls = & lookupClass (typeID);
+        cache.remember (typeID, *cls);
+      }
+    return *cls;
+  }
+  
+  
+  /** @internal find or create the size class for a buffer type (under lock)
+   * @throw error::State when exceeding the limit of distinct size classes
+   */
+  pool::SizeClass&
+  PooledBufferProvider::lookupClass (HashVal typeID)
+  {
+    auto pos = typeClass_.find (typeID);
+    if (pos != typeClass_.end())
+      return *pos->second;
+    
+    size_t frameSize = pool::frameSizeFor (getBufferSize (typeID));
+    pool::SizeClass* cls = findClass (frameSize);
+    if (not cls)
+      {
+        if (classes_.size() >= pool::MAX_SIZE_CLASSES)
+          throw error::State{"PooledBufferProvider: too many distinct buffer sizes"
+                            , LUMIERA_ERROR_BUFFER_MANAGEMENT};
+        classes_.emplace_back (new pool::SizeClass{uint(classes_.size()), frameSize});
+        cls = classes_.back().get();
+        cls->provideFor (caches_.size());
+      }
+    typeClass_[typeID] = cls;
+    return *cls;
+  }
+  
+  
+  pool::SizeClass*
+  PooledBufferProvider::findClass (size_t frameSize)
+  {
+    for (auto& cls : classes_)
+      if (cls->frameSize == frameSize)
+        return cls.get();
+    return nullptr;
+  }
+  
+  
+  pool::LocalCache&
+  PooledBufferProvider::localCache()
+  {
+    if (pool::currentCache.serial != serial_)
+      return attachCurrentThread();
+    return *pool::currentCache.cache;
+  }
+  
+  
+  /** @internal attach the current thread to a new frame cache;
+   *  the pools are extended to account for the frames it may hold.
+   * @remark a thread previously attached to another provider
+   *         abandons its former cache.
+   */
+  pool::LocalCache&
+  PooledBufferProvider::attachCurrentThread()
+  {
+    auto cache = std::make_shared<pool::LocalCache>();
+    lock_guard<std::mutex> guard{lock_};
+    reclaimAbandoned();
+    caches_.push_back (cache);
+    for (auto& cls : classes_)
+      cls->provideFor (caches_.size());
+    if (pool::currentCache.cache)
+      pool::currentCache.cache->abandon();
+    pool::currentCache.cache = std::move (cache);
+    pool::currentCache.serial = serial_;
+    return *pool::currentCache.cache;
+  }
+  
+  
+  /** @internal return the frames of caches abandoned by their thread into the pools
+   *  and discard these caches (under lock) */
+  void
+  PooledBufferProvider::reclaimAbandoned()
+  {
+    bool reclaimed{false};
+    for (auto& cache : caches_)
+      if (cache->isAbandoned())
+        {
+          for (auto& cls : classes_)
+            {
+              pool::Magazine& mag = cache->magazine[cls->index];
+              for (uint i=0; i < mag.cnt; ++i)
+                cls->put (mag.frame[i]);
+              mag.cnt = 0;
+            }
+          cache.reset();
+          reclaimed = true;
+        }
+    if (not reclaimed) return;
+    caches_.erase (std::remove (caches_.begin(), caches_.end(), nullptr), caches_.end());
+    for (auto& cls : classes_)
+      cls->provideFor (caches_.size());
+  }
+  
+  
+  /** @internal transfer a batch of free frames from the pool into the thread's cache */
+  void
+  PooledBufferProvider::refill (pool::SizeClass& cls, pool::LocalCache& cache)
+  {
+    pool::Magazine& mag = cache.magazine[cls.index];
+    lock_guard<std::mutex> guard{lock_};
+    reclaimAbandoned();
+    uint batch = util::max (cls.cacheLimit / 2, 1u);
+    batch = util::min (batch, util::max (cls.cntFree(), size_t(1)));
+    while (mag.cnt < batch)
+      mag.frame[mag.cnt++] = cls.take();
+  }
+  
+  
+  /** @internal return the least recently cached frames back into the pool,
+   *  retaining at most the given number of frames in the thread's cache */
+  void
+  PooledBufferProvider::flush (pool::SizeClass& cls, pool::LocalCache& cache, uint keep)
+  {
+    pool::Magazine& mag = cache.magazine[cls.index];
+    if (mag.cnt <= keep) return;
+    uint surplus = mag.cnt - keep;
+    lock_guard<std::mutex> guard{lock_};
+    for (uint i=0; i < surplus; ++i)
+      cls.put (mag.frame[i]);
+    std::copy (mag.frame.begin()+surplus, mag.frame.begin()+mag.cnt, mag.frame.begin());
+    mag.cnt = keep;
+  }
+  
+  
+  
+  /* ==== Diagnostics ==== */
+  
+  size_t
+  PooledBufferProvider::cntSizeClasses()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return classes_.size();
+  }
+  
+  size_t
+  PooledBufferProvider::capacity (size_t bufferSize)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    pool::SizeClass* cls = findClass (pool::frameSizeFor (bufferSize));
+    return cls? cls->capacity() : 0;
+  }
+  
+  size_t
+  PooledBufferProvider::cntFree (size_t bufferSize)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    pool::SizeClass* cls = findClass (pool::frameSizeFor (bufferSize));
+    if (not cls) return 0;
+    size_t cnt = cls->cntFree();
+    for (auto& cache : caches_)
+      cnt += cache->magazine[cls->index].cnt;
+    return cnt;
+  }
+  
+  size_t
+  PooledBufferProvider::cntThreadCaches()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    reclaimAbandoned();
+    return caches_.size();
+  }
+  
+  size_t
+  PooledBufferProvider::cntSlabs()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    size_t cnt{0};
+    for (auto& cls : classes_)
+      cnt += cls->cntSlabs();
+    return cnt;
+  }
+  
+  size_t
+  PooledBufferProvider::allocatedBytes()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    size_t bytes{0};
+    for (auto& cls : classes_)
+      bytes += cls->capacity() * cls->frameSize;
+    return bytes;
+  }
+  
+  
+  
+}} // namespace steam::engine
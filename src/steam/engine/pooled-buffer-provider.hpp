@@ -0,0 +1,128 @@
+/*
+  POOLED-BUFFER-PROVIDER.hpp  -  BufferProvider recycling frames from size-class pools
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+/** @file pooled-buffer-provider.hpp
+ ** BufferProvider implementation for the render engine, based on pooled frame storage.
+ ** Render jobs lock and release working buffers at a high rate, yet the set of distinct
+ ** buffer sizes is small and known when the render nodes are prepared. Thus buffers are
+ ** organised into _size classes:_ each buffer size is rounded up to a multiple of the
+ ** #pool::FRAME_ALIGNMENT (a cache line, which also satisfies SIMD load/store), and all
+ ** buffer types of the same rounded size share a pool of frames. Frames are allocated in
+ ** larger _slabs,_ which are never returned to the heap while the provider exists;
+ ** released frames are kept in a free list and handed out again.
+ **
+ ** The required capacity is established when [announcing](\ref BufferProvider::announce)
+ ** the buffers for a type; the demand of all announcements for a size class adds up, and
+ ** any frames missing to cover this total are allocated right away. Once the
+ ** announced capacity is in place, locking and releasing buffers does not touch the heap.
+ ** When a size class is exhausted nevertheless, it is extended by a further slab, which
+ ** is recorded in the diagnostics.
+ **
+ ** Each thread using the provider retains a small cache (»magazine«) of free frames for
+ ** each size class. Locking and releasing is served from this cache, and only when the
+ ** cache runs empty or full, a batch of frames is exchanged with the central free list,
+ ** under a lock. The number of cached frames is limited by size, to avoid hoarding
+ ** large frames in threads not rendering anymore. Since frames parked in these caches
+ ** are not available to other threads, the capacity established for an announcement
+ ** also covers the maximum number of frames held by the caches of all attached threads.
+ ** When a thread terminates, its cache is abandoned and the frames return into the pool.
+ **
+ ** @note metadata management is performed by the BufferProvider frontend; its table
+ **       is likewise sized when announcing buffers and allows concurrent locking.
+ ** @see BufferProviderProtocol_test
+ ** @see PooledBufferProvider_test
+ */
+
+#ifndef STEAM_ENGINE_POOLED_BUFFER_PROVIDER_H
+#define STEAM_ENGINE_POOLED_BUFFER_PROVIDER_H
+
+
+#include "lib/error.hpp"
+#include "lib/hash-value.h"
+#include "steam/engine/buffer-provider.hpp"
+
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+
+namespace steam {
+namespace engine {
+  
+  using lib::HashVal;
+  
+  namespace pool {
+    
+    const size_t FRAME_ALIGNMENT = 64;         ///< alignment and granularity of frames (cache line / AVX-512)
+    const uint   MAX_SIZE_CLASSES = 32;        ///< limit for the number of distinct rounded buffer sizes
+    const uint   MAGAZINE_SIZE = 32;           ///< maximum number of frames cached per thread and size class
+    const size_t MAGAZINE_BYTES = 4*1024*1024; ///< limit for the storage cached per thread and size class
+    const size_t MIN_GROWTH = 4;               ///< minimum number of frames to add when exhausted
+    
+    class SizeClass;
+    class LocalCache;
+  }
+  
+  
+  /**
+   * BufferProvider for the render engine, handing out frames
+   * from pools organised by size class, with thread-local caches.
+   * Storage is retained until the provider is discarded as a whole.
+   */
+  class PooledBufferProvider
+    : public BufferProvider
+    {
+      const uint64_t serial_;
+      
+      std::mutex lock_;
+      std::vector<std::unique_ptr<pool::SizeClass>> classes_;
+      std::unordered_map<HashVal, pool::SizeClass*> typeClass_;
+      std::vector<std::shared_ptr<pool::LocalCache>> caches_;
+      
+    public:
+      PooledBufferProvider();
+     ~PooledBufferProvider();
+      
+      /* === BufferProvider interface === */
+      
+      virtual uint prepareBuffers (uint count, HashVal typeID)    override;
+      virtual BuffHandle provideLockedBuffer  (HashVal typeID)    override;
+      virtual void mark_emitted (HashVal, LocalTag const&)        override;
+      virtual void detachBuffer (HashVal, LocalTag const&, Buff&) override;
+      
+      
+      /* === diagnostics === */
+      
+      size_t cntSizeClasses();
+      size_t capacity (size_t bufferSize);     ///< number of frames allocated for this buffer size
+      size_t cntFree  (size_t bufferSize);     ///< frames currently not in use (including thread caches)
+      size_t cntThreadCaches();                ///< number of threads attached (after reclaiming terminated ones)
+      size_t cntSlabs();                       ///< number of heap allocations performed for frame storage
+      size_t allocatedBytes();
+      
+    private:
+      pool::SizeClass& classFor (HashVal typeID);
+      pool::SizeClass& lookupClass (HashVal typeID);
+      pool::SizeClass* findClass (size_t bufferSize);
+      pool::LocalCache& localCache();
+      pool::LocalCache& attachCurrentThread();
+      void reclaimAbandoned();
+      void refill (pool::SizeClass&, pool::LocalCache&);
+      void flush (pool::SizeClass&, pool::LocalCache&, uint keep);
+    };
+  
+  
+  
+}} // namespace steam::engine
+#endif /*STEAM_ENGINE_POOLED_BUFFER_PROVIDER_H*/
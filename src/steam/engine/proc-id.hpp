@@ -96,17 +96,20 @@ namespace engine {
     {
       bool manifold :1;
       bool isProxy  :1;
+      bool cached   :1;   ///< results to be retained in the FrameCache, also when not exit port
       
       ProcAttrib()
         : manifold{true}
         , isProxy{false}
+        , cached{false}
         { }
       
       friend bool
       operator== (ProcAttrib const& l, ProcAttrib const& r)
       {
         return l.manifold == r.manifold
-           and l.isProxy  == r.isProxy;
+           and l.isProxy  == r.isProxy
+           and l.cached   == r.cached;
       }
     };
   
@@ -152,6 +155,7 @@ namespace engine {
       
       bool hasManifoldPatt()     const { return attrib_.manifold; }
       bool hasProxyPatt()        const { return attrib_.isProxy; }
+      bool isCached()            const { return attrib_.cached; }
       
       friend bool
       operator== (ProcID const& l, ProcID const& r)
@@ -181,6 +181,43 @@ namespace engine {
   
   Port::~Port() { }  ///< @remark VTables for the Port-Turnout hierarchy emitted from \ref proc-node.cpp
   
+  /**
+   * Hash-key to identify the results produced by this port.
+   * Combines the [hash of the ProcID](\ref hash_value(ProcID const&)) with the
+   * state of the parameter binding and the processing hashes of all predecessor
+   * ports, since the same processing operation yields different results when
+   * fed from different sources or invoked with other parameters.
+   * @remark calculated on first use and memoised; this is a benign race,
+   *         since the result is deterministic.
+   */
+  HashVal
+  Port::procHash()
+  {
+    HashVal hash = procHash_.load (std::memory_order_relaxed);
+    if (not hash)
+      {
+        hash = hash_value (procID);
+        if (paramState_)
+          hash_combine (hash, paramState_);
+        for (Port& lead : watch(*this).srcPorts())
+          hash_combine (hash, lead.procHash());
+        procHash_.store (hash, std::memory_order_relaxed);
+      }
+    return hash;
+  }
+  
+  /** @remark drawn from a global counter; used only for parameters which can not
+   *          be identified at build time, since a Port bound thus never shares
+   *          cached results with a Port built in another Builder run */
+  HashVal
+  freshParamState()
+  {
+    static std::atomic<HashVal> cnt{0};
+    HashVal state{0};
+    hash_combine (state, ++cnt);
+    return state;
+  }
+  
   
   /**
    * @remark this is the only public access point to ProcID entries,
@@ -396,7 +433,18 @@ namespace engine {
   HashVal
   ProcNodeDiagnostic::getPortHash (uint portIdx)
   {
-    UNIMPLEMENTED ("calculate an unique, stable and reproducible hash-key to identify the Turnout");
+    return watchPort(portIdx).getProcHash();
+  }
+  
+  /** @return bytes of buffer memory configured for in-place processing in all ports
+   *  @see PortDiagnostic::getInPlaceBytes() */
+  size_t
+  ProcNodeDiagnostic::getInPlaceBytes()
+  {
+    size_t saved{0};
+    for (Port& port : ports())
+      saved += watch(port).getInPlaceBytes();
+    return saved;
   }
   
   
@@ -433,7 +481,7 @@ namespace engine {
   {
     if (p_.procID.hasManifoldPatt())
       {
-        auto [leads,types] = _RecastMediaWeaving::accessInternal (p_);
+        auto [leads,types,resultSlot,inPlace] = _RecastMediaWeaving::accessInternal (p_);
         return leads;
       }
     else
@@ -446,6 +494,52 @@ namespace engine {
       return EMPTY_PRECURSORS;
   }
   
+  Port*
+  PortDiagnostic::delegatePort()
+  {
+    if (not p_.procID.hasProxyPatt())
+      return nullptr;
+    return & std::get<0>(_RecastParamWeaving::accessInternal (p_));
+  }
+  
+  /**
+   * @return descriptor for the kind of buffer delivered as result by this port,
+   *         if it can be determined by looking into the weaving pattern;
+   *         for a Param Agent, this is the result type of the delegate.
+   */
+  optional<BuffDescr>
+  PortDiagnostic::resultType()
+  {
+    if (p_.procID.hasManifoldPatt())
+      {
+        auto [leads,types,resultSlot,inPlace] = _RecastMediaWeaving::accessInternal (p_);
+        if (resultSlot < types.size())
+          return types[resultSlot];
+      }
+    else
+    if (Port* delegate = delegatePort())
+      return watch(*delegate).resultType();
+    return nullopt;
+  }
+  
+  /** @return total size of the output buffers configured to reuse an input buffer.
+   *  @remark this is the _potential_ saving, as determined by the Builder; on invocation,
+   *          an input buffer is actually reused only when of the kind expected for output.
+   */
+  size_t
+  PortDiagnostic::getInPlaceBytes()
+  {
+    size_t saved{0};
+    if (p_.procID.hasManifoldPatt())
+      {
+        auto [leads,types,resultSlot,inPlace] = _RecastMediaWeaving::accessInternal (p_);
+        for (uint i=0; i < types.size() and i < 64; ++i)
+          if (inPlace & (uint64_t(1) << i))
+            saved += types[i].determineBufferSize();
+      }
+    return saved;
+  }
+  
   /**
    * @return the symbolic string representing this processing port,
    *         as [provided by Node-identification](\ref ProcID::genProcSpec())
@@ -465,7 +559,7 @@ namespace engine {
   HashVal
   PortDiagnostic::getProcHash()  ///< @return as [calculated by Node-identification](\ref ProcID)
   {
-    UNIMPLEMENTED ("calculate an unique, stable and reproducible hash-key to identify the Turnout");
+    return p_.procHash();
   }
   
   
@@ -106,6 +106,7 @@
 
 #include <string>
 #include <optional>
+#include <atomic>
 
 
 
@@ -145,6 +146,17 @@ namespace engine {
       
       ProcID& procID;
       
+      HashVal procHash();  ///< hash-key for the processing chain up to this port (memoised)
+      
+      /** @internal fold the state of the parameter binding into the #procHash;
+       *            to be set by the Builder, prior to any invocation */
+      void bindParamState (HashVal state) { paramState_ = state; }
+      
+    private:
+      std::atomic<HashVal> procHash_{0};
+      HashVal paramState_{0};
+    public:
+      
       ///    Port has reference semantics: all instances are distinct
       friend bool operator== (Port const& pl, Port const& pr){ return    & pl == & pr;}
       friend bool operator!= (Port const& pl, Port const& pr){ return not (pl == pr); }
@@ -152,6 +164,9 @@ namespace engine {
   
   using PortRef = std::reference_wrapper<Port>;
   
+  /** @return a distinct parameter state, to opt out from sharing results with any other Port */
+  HashVal freshParamState();
+  
   /**
    * Interface: Description of the input and output ports,
    * processing function and predecessor nodes for a given ProcNode.
@@ -259,6 +274,22 @@ namespace engine {
           return getPort(portIdx).weave (turnoutSystem, output);
         }
       
+      /** render and pull output, consulting a cache for the result of this port and of leads opting in */
+      BuffHandle
+      pull (uint portIdx, BuffHandle output, Time nomTime, ProcessKey procKey, FrameCache& cache)
+        {
+          TurnoutSystem turnoutSystem{nomTime, procKey};
+          turnoutSystem.attachFrameCache (cache);
+          return getPort(portIdx).weave (turnoutSystem, output);
+        }
+      
+      /** render and pull output, using a TurnoutSystem configured by the caller */
+      BuffHandle
+      pull (uint portIdx, BuffHandle output, TurnoutSystem& turnoutSystem)
+        {
+          return getPort(portIdx).weave (turnoutSystem, output);
+        }
+      
       /// „backdoor“ to watch internals from tests
       friend class ProcNodeDiagnostic;
     };
@@ -296,6 +327,7 @@ namespace engine {
       
       string getPortSpec  (uint portIdx);  ///< generate a descriptive diagnostic Spec for the designated Turnout
       HashVal getPortHash (uint portIdx);  ///< calculate an unique, stable and reproducible hash-key to identify the Turnout
+      size_t getInPlaceBytes();            ///< buffer memory configured for in-place processing, summed over all ports
       
       ProcNodeDiagnostic watchLead(uint leadIdx);
       PortDiagnostic     watchPort(uint portIdx);
@@ -320,6 +352,9 @@ namespace engine {
         { }
       
       lib::Several<PortRef> const& srcPorts();
+      Port* delegatePort();   ///< the port invoked within the scope of a Param Agent, or `nullptr`
+      optional<BuffDescr> resultType(); ///< kind of buffer delivered as result, if determinable
+      size_t getInPlaceBytes(); ///< size of output buffers configured to reuse an input buffer (in-place)
       
       bool isSrc()  { return srcPorts().empty(); }
       
@@ -50,6 +50,10 @@ namespace engine {
   using lib::time::Time;
   using ProcessKey = uint64_t;
   
+  class Port;
+  class FrameCache;
+  class LeadFork;
+  
 
   /**
    * Communication hub to coordinate and activate the »Render Node Network« performance.
@@ -68,12 +72,24 @@ namespace engine {
       
     private:
       FrontBlock invoParam_;
+      FrameCache* frameCache_{nullptr};
+      Port const* exitPort_{nullptr};
+      LeadFork*   leadFork_{nullptr};
       
     public:
       TurnoutSystem (Time absoluteNominalTime, ProcessKey procKey =0)
         : invoParam_{FrontBlock::build (absoluteNominalTime,procKey)}
         { }
       
+      /** derived context to render another frame, sharing the services attached to \a anchor
+       * @note extension blocks attached to the anchor are _not_ visible in the derived context */
+      TurnoutSystem (TurnoutSystem& anchor, Time otherNominalTime)
+        : invoParam_{FrontBlock::build (otherNominalTime, anchor.getProcKey())}
+        , frameCache_{anchor.frameCache_}
+        , exitPort_{anchor.exitPort_}
+        , leadFork_{anchor.leadFork_}
+        { }
+      
       Time
       getNomTime()
         {
@@ -86,6 +102,45 @@ namespace engine {
           return invoParam_.get<SLOT_KEY>();
         }
       
+      /** @return the cache to consult for results, or `nullptr` */
+      FrameCache*
+      getFrameCache()
+        {
+          return frameCache_;
+        }
+      
+      void
+      attachFrameCache (FrameCache& cache)
+        {
+          frameCache_ = &cache;
+        }
+      
+      /** @return `true` if the given port delivers the result of this invocation
+       * @remark the first port to ask is taken as exit port, since the recursive
+       *         pull into the lead ports can only start from there; a derived
+       *         context refers to the exit port of its anchor.
+       */
+      bool
+      isExitPort (Port const& port)
+        {
+          if (not exitPort_)
+            exitPort_ = &port;
+          return exitPort_ == &port;
+        }
+      
+      /** @return service to pull leads concurrently, or `nullptr` */
+      LeadFork*
+      getLeadFork()
+        {
+          return leadFork_;
+        }
+      
+      void
+      attachLeadFork (LeadFork& leadFork)
+        {
+          leadFork_ = &leadFork;
+        }
+      
       /**
        * get parameter from extension block,
        * as configured by the provided getter functor
@@ -29,6 +29,9 @@
  ** - `shed()` allocate output buffers and spread out all connections
  ** - `weft()` pass invocation to the processing operation
  ** - `fix()`  detach from input, mark and commit results and pas output
+ ** When a \ref FrameCache is attached to the TurnoutSystem, it is consulted before
+ ** mounting the Feed; on a cache hit, the result is delivered without recursing into
+ ** the predecessors, otherwise the result of the calculation is copied into the cache.
  ** As arranged in the Turnout template, the necessary interconnections are prepared
  ** and this standard sequence of operations is issued, while delegating the actual
  ** implementation of these steps into a **Weaving Pattern**, integrated as mix-in
@@ -57,6 +60,7 @@
 #include "steam/common.hpp"
 #include "steam/engine/proc-node.hpp"
 #include "steam/engine/turnout-system.hpp"
+#include "steam/engine/frame-cache.hpp"
 
 #include <utility>
 
@@ -134,11 +138,20 @@ namespace engine {
       BuffHandle
       weave (TurnoutSystem& turnoutSys, OptionalBuff outBuff =std::nullopt)  override
         {
+          FrameCache* cache = turnoutSys.getFrameCache();
+          if (cache)
+            if (auto cached = cache->recall (*this, turnoutSys, outBuff))
+              return *cached;
+          
           Feed feed = PAT::mount (turnoutSys);
           PAT::pull (feed, turnoutSys);
           PAT::shed (feed, turnoutSys, outBuff);
           PAT::weft (feed, turnoutSys);
-          return PAT::fix (feed, turnoutSys);
+          BuffHandle result = PAT::fix (feed, turnoutSys);
+          
+          if (cache)
+            cache->remember (*this, turnoutSys, result);
+          return result;
         }
     };
   
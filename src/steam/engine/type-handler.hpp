@@ -36,6 +36,7 @@
 #include "lib/error.hpp"
 #include "lib/hash-value.h"
 
+#include <type_traits>
 #include <utility>
 #include <functional>
 #include <boost/functional/hash.hpp>
@@ -108,6 +109,7 @@ namespace engine {
       DoInBuffer createAttached;
       DoInBuffer destroyAttached;
       HashVal identity;
+      bool plainData{false};   ///< object can be copied bytewise (trivially copyable)
       
       /** Marker for the default case: raw buffer without type handling */
       static const TypeHandler RAW;
@@ -145,8 +147,10 @@ namespace engine {
       static TypeHandler
       create (ARGS&& ...args)
         {
-          return TypeHandler ( bind (buildIntoBuffer<X,ARGS&...>, _1, forward<ARGS> (args)...)
-                             , destroyInBuffer<X>);
+          TypeHandler handler ( bind (buildIntoBuffer<X,ARGS&...>, _1, forward<ARGS> (args)...)
+                              , destroyInBuffer<X>);
+          handler.plainData = std::is_trivially_copyable<X>();
+          return handler;
         }
       
       bool
@@ -84,6 +84,9 @@
  **   the calculated media data
  ** - only one of these output buffers is used as actual result, while the other buffers
  **   are just discarded (but may possibly be fed to the frame cache).
+ ** - optionally, for a processing function able to work _in-place,_ an output slot may
+ **   reuse the (dead) input buffer with the same slot index; this is decided by a simple
+ **   liveness analysis when building the port, based on the result type of the lead port.
  ** 
  ** Each [Processing Node](\ref ProcNode) represents one specific processing functionality on a
  ** logical level; yet such a node may be able to generate several „flavours“ of this processing,
@@ -140,12 +143,15 @@
 #include "steam/engine/media-weaving-pattern.hpp"
 #include "lib/meta/tuple-closure.hpp"
 #include "lib/meta/tuple-helper.hpp"
+#include "lib/meta/duck-detector.hpp"
+#include "lib/hash-combine.hpp"
 //#include "lib/test/test-helper.hpp" ////////////////////////////OOO TODO added for test
 #include "lib/format-string.hpp"
 #include "lib/iter-zip.hpp"
 #include "lib/util.hpp"
 
 #include <functional>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 #include <string>
@@ -159,6 +165,7 @@ namespace engine {
   using std::forward;
   using lib::Depend;
   using lib::izip;
+  using lib::time::Duration;
   using util::_Fmt;
   using util::max;
   
@@ -170,6 +177,63 @@ namespace engine {
   template<uint siz>
   using SizMark = std::integral_constant<uint,siz>;
   
+  /** Detect a param-functor able to identify the parameters it supplies */
+  template<class PFX>
+  class _exposes_ParamState
+    {
+      using Yes_t = lib::meta::Yes_t;
+      using No_t  = lib::meta::No_t;
+      
+      META_DETECT_FUNCTION (HashVal, paramState, (void) const);
+      
+    public:
+      static constexpr bool value = HasFunSig_paramState<PFX>::value;
+    };
+  
+  /** @return hash to identify the parameters supplied by a param-functor:
+   *          derived from its content when exposed as `paramState()`,
+   *          otherwise from the identity of the functor type.
+   * @warning captured state not exposed as `paramState()` is not discerned;
+   *          a binding of such a functor must provide the state explicitly,
+   *          or opt out from sharing results by a freshParamState()
+   */
+  template<class PFX>
+  inline HashVal
+  paramStateOf (PFX const& paramFun)
+  {
+    if constexpr (_exposes_ParamState<PFX>::value)
+      return paramFun.paramState();
+    else
+      return std::hash<StrView>{} (typeid(PFX).name());
+  }
+  
+  /** @internal hash a fixed parameter value, as far as it can be identified */
+  template<typename PAR>
+  inline HashVal
+  paramValueHash (PAR const& val)
+  {
+    if constexpr (std::is_convertible_v<PAR, StrView>)
+      return std::hash<StrView>{} (StrView{val});
+    else
+    if constexpr (std::is_arithmetic_v<PAR> or std::is_enum_v<PAR>)
+      return std::hash<PAR>{} (val);
+    else
+    if constexpr (std::is_trivially_copyable_v<PAR>)
+      return std::hash<StrView>{} (StrView{reinterpret_cast<const char*> (&val), sizeof(PAR)});
+    else
+      return freshParamState();  // can not be identified: never share results
+  }
+  
+  /** @return hash to identify the parameters supplied as fixed value(s) */
+  template<typename...PARS>
+  inline HashVal
+  paramValueState (PARS const& ...vals)
+  {
+    HashVal state{0};
+    (lib::hash::combine (state, paramValueHash (vals)), ...);
+    return state;
+  }
+  
   
   
   /**
@@ -246,11 +310,15 @@ namespace engine {
   struct WeavingBuilder
     : util::MoveOnly
     {
-      using WeavingPattern = MediaWeavingPattern<PROT>;
-      using TurnoutWeaving = Turnout<WeavingPattern>;
-      static constexpr SizMark<sizeof(TurnoutWeaving)> sizMark{};
       static constexpr uint FAN_I = PROT::FAN_I;
       static constexpr uint FAN_O = PROT::FAN_O;
+      static constexpr bool BATCHED = is_BatchPrototype<PROT>();
+      using WeavingPattern = std::conditional_t<BATCHED, BatchWeavingPattern<PROT>
+                                                       , MediaWeavingPattern<PROT>>;
+      using TurnoutWeaving = Turnout<WeavingPattern>;
+      using TurnoutForking = std::conditional_t<(FAN_I > 1 and not BATCHED), Turnout<ParallelWeavingPattern<PROT>>
+                                                                         , TurnoutWeaving>;
+      static constexpr SizMark<max (sizeof(TurnoutWeaving), sizeof(TurnoutForking))> sizMark{};
       
       using TypeMarker = std::function<BuffDescr(BufferProvider&)>;
       using ProviderRef = std::reference_wrapper<BufferProvider>;
@@ -261,6 +329,9 @@ namespace engine {
       std::vector<ProviderRef>  providers;
       
       uint resultSlot{0};
+      bool inPlace{false};
+      bool cached{false};
+      HashVal paramState{0};
       
       Depend<EngineCtx> ctx;
       
@@ -284,6 +355,9 @@ namespace engine {
         , buffTypes {move (prevBuilder.buffTypes)}
         , providers {move (prevBuilder.providers)}
         , resultSlot{move (prevBuilder.resultSlot)}
+        , inPlace   {move (prevBuilder.inPlace)}
+        , cached    {move (prevBuilder.cached)}
+        , paramState{move (prevBuilder.paramState)}
         , nodeSymb_ {move (prevBuilder.nodeSymb_)}
         , portSpec_ {move (prevBuilder.portSpec_)}
         , prototype_{move (adaptedPrototype)}
@@ -303,15 +377,27 @@ namespace engine {
       template<class PFX>
       auto
       adaptParam (PFX paramFunctor)
+        {
+          HashVal state = paramStateOf (paramFunctor);
+          return adaptParam (move (paramFunctor), state);
+        }
+      
+      /** @param addedState hash to identify the parameters supplied by the functor */
+      template<class PFX>
+      auto
+      adaptParam (PFX paramFunctor, HashVal addedState)
         {
           static_assert (PROT::template isSuitableParamFun<PFX>()
                         ,"suitable as param-functor for given processing-functor");
           //
           using AdaptedWeavingBuilder = Adapted<PFX>;
           //
-          return AdaptedWeavingBuilder{move(*this)
-                                      ,prototype_.moveAdaptedParam (move (paramFunctor))
-                                      };
+          HashVal state = boundParamState (addedState);
+          AdaptedWeavingBuilder adapted{move(*this)
+                                       ,prototype_.moveAdaptedParam (move (paramFunctor))
+                                       };
+          adapted.paramState = state;
+          return adapted;
         }
       
       
@@ -327,15 +413,35 @@ namespace engine {
       template<class DEC>
       auto
       adaptProcFunParam (DEC decorator)
+        {
+          HashVal state = paramStateOf (decorator);
+          return adaptProcFunParam (move (decorator), state);
+        }
+      
+      template<class DEC>
+      auto
+      adaptProcFunParam (DEC decorator, HashVal addedState)
         {
           static_assert (PROT::template isSuitableParamAdaptor<DEC>()
                         ,"suitable to adapt the processing-functor's param argument");
           //
           using AdaptedWeavingBuilder = Decorated<DEC>;
           //
-          return AdaptedWeavingBuilder{move(*this)
-                                      ,prototype_.moveTransformedParam (move (decorator))
-                                      };
+          HashVal state = boundParamState (addedState);
+          AdaptedWeavingBuilder adapted{move(*this)
+                                       ,prototype_.moveTransformedParam (move (decorator))
+                                       };
+          adapted.paramState = state;
+          return adapted;
+        }
+      
+      /** @internal parameter state after binding yet another parameter source */
+      HashVal
+      boundParamState (HashVal addedState)
+        {
+          HashVal state{paramState};
+          lib::hash::combine (state, addedState);
+          return state;
         }
       
       WeavingBuilder&&
@@ -375,6 +481,28 @@ namespace engine {
           return move(*this);
         }
       
+      WeavingBuilder&&
+      allowInPlace()
+        {
+          this->inPlace = true;
+          return move(*this);
+        }
+      
+      WeavingBuilder&&
+      cacheResults()
+        {
+          this->cached = true;
+          return move(*this);
+        }
+      
+      WeavingBuilder&&
+      batchFrameStep (Duration frameDuration)
+        {
+          static_assert (BATCHED, "frame step only relevant for a batch processing functor");
+          prototype_.setFrameStep (frameDuration);
+          return move(*this);
+        }
+      
       
       auto
       build()
@@ -393,6 +521,13 @@ namespace engine {
           
           ENSURE (leadPorts.size() == FAN_I);
           ENSURE (outTypes.size()  == FAN_O);
+          if constexpr (BATCHED)
+            if (not prototype_.hasFrameStep())
+              throw err::Logic{"Builder: a batch processing function renders consecutive frames "
+                               "and thus requires the duration of a frame to be defined."};
+          InPlaceSlots inPlaceSlots{inPlace and not BATCHED? determineInPlaceSlots (outTypes) : 0};
+          ProcAttrib attrib;
+          attrib.cached = cached or BATCHED;   // following frames of a batch are passed by the FrameCache
           
           using PortDataBuilder = DataBuilder<POL, Port>;
           // provide a free-standing functor to build a suitable Port impl (≙Turnout)
@@ -400,22 +535,59 @@ namespace engine {
                  ,types = move(outTypes.build())
                  ,prototype = move(prototype_)
                  ,resultIdx = resultSlot
-                 ,&procID = ProcID::describe (nodeSymb_,portSpec_)
+                 ,inPlaceSlots
+                 ,paramState = paramState
+                 ,&procID = ProcID::describe (nodeSymb_,portSpec_,attrib)
                  ]
                  (PortDataBuilder& portData) mutable -> void
                    {
+                     auto bindParamState = [&]{ portData[portData.size()-1].bindParamState (paramState); };
+                     if constexpr (FAN_I > 1 and not BATCHED)
+                       if (uint64_t forkMask = fork::selectLeads (leads))
+                         {   // leads expensive enough to be pulled concurrently
+                           portData.template emplace<TurnoutForking> (procID
+                                                                     ,forkMask
+                                                                     ,move(leads)
+                                                                     ,move(types)
+                                                                     ,resultIdx
+                                                                     ,inPlaceSlots
+                                                                     ,move(prototype)
+                                                                     );
+                           bindParamState();
+                           return;
+                         }
                      portData.template emplace<TurnoutWeaving> (procID
                                                                ,move(leads)
                                                                ,move(types)
                                                                ,resultIdx
+                                                               ,inPlaceSlots
                                                                ,move(prototype)
                                                                );
+                     bindParamState();
                    };
         }
       
       
       
     private: /* ====== WeavingBuilder implementation details ====== */
+      /**
+       * @internal liveness analysis for in-place processing.
+       * Each input buffer is consumed by the processing step and is thus dead afterwards;
+       * output slot `i` can reuse input slot `i`, when the lead port connected there is known
+       * to deliver a buffer of the kind expected for this output.
+       * @return bitmask of output slots to reuse the input buffer
+       */
+      template<class DAB>
+      uint64_t
+      determineInPlaceSlots (DAB& outTypes)
+        {
+          uint64_t mask{0};
+          for (uint i=0; i < leadPorts.size() and i < outTypes.size() and i < 64; ++i)
+            if (watch(leadPorts[i].get()).resultType() == outTypes[i])
+              mask |= uint64_t(1) << i;
+          return mask;
+        }
+      
       void
       maybeFillDefaultProviders (size_t maxSlots)
         {
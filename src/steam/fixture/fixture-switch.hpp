@@ -0,0 +1,138 @@
+/*
+  FIXTURE-SWITCH.hpp  -  publish a new Segmentation while rendering continues
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file fixture-switch.hpp
+ ** Switch-over to a new version of the Segmentation, produced by a Builder run.
+ ** Job-planning for ongoing playback needs to look up the Segmentation for each
+ ** chunk of frames, while the Builder may complete a new version at any time.
+ ** Locking the Segmentation for each lookup would put the planning threads into
+ ** contention with each other; instead, the current version is published through
+ ** an lib::EpochPublication, so that read access is _wait-free_ and a new version
+ ** can be switched in atomically. The previous version is retired, but can not be
+ ** discarded as a whole once no planning thread reads it anymore, since jobs planned
+ ** from its JobTickets may still be scheduled. Thus each Segment is marked with the
+ ** deadline of the latest job planned from it (see Segment::retainUntil), and the
+ ** retired Segmentation releases its Segments individually when their deadline
+ ** has passed; this is checked on each switch, i.e. whenever the Builder commits
+ ** a new version, and can be triggered additionally by maintenance. When a FrameCache is attached, frames cached for the time range
+ ** of any Segment changed by the new version are invalidated on the switch.
+ ** @see FixtureSwitch_test
+ ** @see Fixture
+ ** @see PlanningBatch::plan
+ */
+
+
+#ifndef STEAM_FIXTURE_FIXTURE_SWITCH_H
+#define STEAM_FIXTURE_FIXTURE_SWITCH_H
+
+
+#include "steam/common.hpp"
+#include "steam/fixture/segmentation.hpp"
+#include "steam/engine/frame-cache.hpp"
+#include "vault/real-clock.hpp"
+#include "lib/epoch-publication.hpp"
+#include "lib/time/timevalue.hpp"
+#include "lib/nocopy.hpp"
+
+#include <memory>
+
+
+namespace steam {
+namespace fixture {
+  
+  using lib::time::Time;
+  using vault::RealClock;
+  using std::unique_ptr;
+  
+  
+  /**
+   * Holder for the current Segmentation of a Timeline, allowing to switch
+   * to a new version without blocking concurrent job-planning.
+   * @remark all retired versions are retained until #reclaim finds all their
+   *         Segments to be expired; this happens on each #publish, and can
+   *         be invoked additionally from a periodic maintenance job.
+   */
+  class FixtureSwitch
+    : util::NonCopyable
+    {
+      lib::EpochPublication<Segmentation> current_;
+      engine::FrameCache* frameCache_{nullptr};
+      
+    public:
+      explicit
+      FixtureSwitch (unique_ptr<Segmentation> initial)
+        : current_{move (initial)}
+        { }
+      
+      using Access = lib::EpochPublication<Segmentation>::Access;
+      
+      /** @return RAII handle for wait-free read access to the current Segmentation */
+      Access
+      access()  const
+        {
+          return current_.access();
+        }
+      
+      /** cached frames shall be invalidated for changed Segments on each switch */
+      void
+      attachFrameCache (engine::FrameCache& cache)
+        {
+          frameCache_ = &cache;
+        }
+      
+      /** switch to the new Segmentation; subsequent job-planning will use it,
+       *  and release Segments of superseded versions expired at the given time.
+       * @remark invalidation happens after the switch, so that frames cached
+       *         meanwhile from the superseded version are discarded as well;
+       *         frames remembered later by jobs still running from the old
+       *         version are keyed by the processing hash of the old ports.
+       */
+      void
+      publish (unique_ptr<Segmentation> newVersion, Time now =RealClock::now())
+        {
+          REQUIRE (newVersion);
+          Segmentation const& next{*newVersion};
+          {
+            Access previous{current_.access()};
+            current_.publish (move (newVersion));
+            if (frameCache_ and previous)
+              for (TimeSpan const& changed : next.changedAgainst (*previous))
+                frameCache_->invalidate (changed);
+          }
+          reclaim (now);
+        }
+      
+      /** release Segments of superseded versions, which are neither accessed
+       *  for job-planning nor retained by jobs pending at the given time.
+       * @return number of superseded versions still retained */
+      size_t
+      reclaim (Time now)
+        {
+          return current_.reclaim ([&](Segmentation& retired)
+                                      {
+                                        return retired.releaseExpired (now);
+                                      });
+        }
+      
+      size_t
+      cntRetired()
+        {
+          return current_.cntRetired();
+        }
+    };
+  
+  
+  
+}} // namespace steam::fixture
+#endif /*STEAM_FIXTURE_FIXTURE_SWITCH_H*/
@@ -25,11 +25,15 @@
  ** segments are obliterated as a whole, when being replaced by a new version as result
  ** of a more recent builder run. Ongoing render processes are also tracked per segment,
  ** which allows the individual calculation steps just to assume the data is "there".
+ ** The switch-over to a new Segmentation is intended to be handled by the FixtureSwitch,
+ ** which offers wait-free read access for job-planning and retains each superseded Segment
+ ** until the deadline of the last job planned from it.
  ** 
  ** @ingroup fixture
  ** 
  ** @todo WIP implementation of session core from 2010
  ** @todo as of 2016, this effort is considered stalled but basically valid
+ ** @todo 2026 FixtureSwitch not yet wired into the Fixture and the DispatchTable
  */
 
 
@@ -34,6 +34,11 @@
 #include "steam/mobject/model-port.hpp"
 #include "steam/fixture/model-port-registry.hpp"
 
+#include <memory>
+
+using std::make_unique;
+
+
 namespace steam {
 namespace fixture {
     
@@ -50,7 +55,20 @@ namespace fixture {
     
     /** storage for the link to the global
         Registry instance currently in charge  */
-    lib::OptionalRef<ModelPortRegistry> ModelPortRegistry::theGlobalRegistry;
+    std::atomic<ModelPortRegistry*> ModelPortRegistry::theGlobalRegistry{nullptr};
+    
+    namespace {
+      /** readers accessing through the global link; switching the link
+       *  awaits these readers, so the previous registry can be destroyed */
+      lib::EpochDomain globalReaders;
+    }
+    
+    
+    /** create a registry initially without any published model ports */
+    ModelPortRegistry::ModelPortRegistry()
+      : currentReg_{make_unique<MPTable>()}
+      , transaction_{}
+      { }
     
     
     
@@ -59,8 +77,11 @@ namespace fixture {
     ModelPortRegistry::shutdown ()
     {
       INFO (builder, "disabling ModelPort registry....");
-      LockRegistry global_lock;
-      theGlobalRegistry.clear(); 
+      {
+        LockRegistry global_lock;
+        theGlobalRegistry.store (nullptr);
+      }
+      globalReaders.synchronise();  // await readers without holding the lock
     }
     
     
@@ -69,29 +90,36 @@ namespace fixture {
      *  within the Builder subsystem lifecycle methods, or for
      *  temporarily exchanging the registry for unit tests
      * @return the registry instance previously in use or \c NULL
+     * @note blocks until ongoing lookups through the global link are complete;
+     *       thereafter the previous registry is no longer accessed this way.
      */
     ModelPortRegistry*
     ModelPortRegistry::setActiveInstance (ModelPortRegistry& newRegistry)
     {
-      LockRegistry global_lock;
-      ModelPortRegistry *previous = theGlobalRegistry.isValid()?
-                                      &( theGlobalRegistry()) : 0;
+      ModelPortRegistry *previous{nullptr};
+      {
+        LockRegistry global_lock;
+        previous = theGlobalRegistry.exchange (&newRegistry);
+      }
+      globalReaders.synchronise();
       INFO_IF (!previous, builder, "activating new ModelPort registry.");
       WARN_IF ( previous, builder, "switching ModelPort registry instance.");
-      theGlobalRegistry.link_to (newRegistry);
       return previous;
     }
     
     
     /** access the globally valid registry instance.
      *  @throw error::State if this global registry is
-     *         already closed or not yet initialised. */
+     *         already closed or not yet initialised.
+     *  @warning the registry may be switched or shut down concurrently; the
+     *         returned reference can only be used safely while the caller
+     *         ensures the registry remains active (as the builder does). */
     ModelPortRegistry&
     ModelPortRegistry::globalInstance()
     {
-      LockRegistry global_lock;
-      if (theGlobalRegistry.isValid())
-        return theGlobalRegistry();
+      ModelPortRegistry* registry = theGlobalRegistry.load();
+      if (registry)
+        return *registry;
       
       throw error::State ("global model port registry is not accessible"
                          , LUMIERA_ERROR_BUILDER_LIFECYCLE); 
@@ -120,45 +148,68 @@ namespace fixture {
     bool
     ModelPortRegistry::isRegistered (ID<Pipe> key)  const
     {
+      auto current = currentReg_.access();
       return bool(key)
-          && util::contains (currentReg_, key); 
+          && util::contains (*current, key); 
     }
     
     
-    /** basic access operation: access the descriptor
-     *  of a currently valid model port.
-     * @note no locking (but #accessDescriptor does lock!) 
-     * @throw error::Logic if accessing a non registered port
-     * @throw error::State if accessing an invalid / disconnected port
-     */
+    /** @internal find the descriptor within the given snapshot of published model ports */
     MPDescriptor
-    ModelPortRegistry::get (ID<Pipe> key)  const
+    ModelPortRegistry::lookup (MPTable const& current, ID<Pipe> key)
     {
       if (!key)
         throw error::State ("This model port is disconnected or NIL"
                            , LUMIERA_ERROR_UNCONNECTED_MODEL_PORT);
-      if (!isRegistered (key))
+      
+      MPTable::const_iterator pos = current.find (key);
+      if (pos == current.end())
         throw error::Logic ("Model port was never registered, or got unregistered meanwhile."
                            ,LUMIERA_ERROR_INVALID_MODEL_PORT);
-      
-      MPTable::const_iterator pos = currentReg_.find (key);
-      ASSERT (pos != currentReg_.end());
       ASSERT (pos->second.isValid());
       return pos->second;
     }
     
     
+    /** basic access operation: fetch a copy of the descriptor
+     *  of a currently valid model port.
+     * @note no locking; the copy is taken while the published version
+     *       is still pinned, since a concurrent #commit may discard it.
+     * @throw error::Logic if accessing a non registered port
+     * @throw error::State if accessing an invalid / disconnected port
+     */
+    ModelPortRegistry::ModelPortDescriptor
+    ModelPortRegistry::get (ID<Pipe> key)  const
+    {
+      auto current = currentReg_.access();
+      return lookup (*current, key);
+    }
+    
+    
     /** access \em the globally valid model port for the given pipe.
-     *  This (static) function locks and accesses the global model port registry
-     *  to fetch the descriptor record. Typically invoked by client code
-     *  through the ModelPort frontend
+     *  This (static) function accesses the global model port registry
+     *  to fetch a copy of the descriptor record, without any locking.
+     *  Typically invoked by client code through the ModelPort frontend
+     * @remark a concurrent #shutdown or #setActiveInstance awaits this lookup,
+     *         so that the registry can not be destroyed while accessed here.
      * @throw error::State when registry is down or the model port is disconnected
      * @throw error::Logic when the given key wasn't registered for a model port */
-    MPDescriptor
+    ModelPortRegistry::ModelPortDescriptor
     ModelPortRegistry::accessDescriptor (ID<Pipe> key)
     {
-      LockRegistry global_lock;
-      return theGlobalRegistry().get(key);
+      lib::EpochDomain::Guard guard{globalReaders};
+      auto current = globalInstance().currentReg_.access();
+      return lookup (*current, key);
+    }
+    
+    
+    /** @return true if the global registry has published a model port for the given pipe
+     *  @remark protected against concurrent #shutdown, like #accessDescriptor */
+    bool
+    ModelPortRegistry::isPublished (ID<Pipe> key)
+    {
+      lib::EpochDomain::Guard guard{globalReaders};
+      return globalInstance().isRegistered (key);
     }
     
     
@@ -204,15 +255,17 @@ namespace fixture {
      *  pending transaction to become the globally valid model ports
      * @note automatically starts a new transaction, initialised
      *       with the now published mappings.
+     * @remark the previously published mappings are discarded as soon as
+     *       no concurrent reader accesses them anymore; this is checked
+     *       whenever committing.
      */
     void
     ModelPortRegistry::commit()
     {
       LockRegistry global_lock;
-      MPTable newTransaction(transaction_);
       TRACE (builder, "committing new ModelPort list....");
-      swap (currentReg_, transaction_);
-      swap (transaction_, newTransaction);
+      currentReg_.publish (make_unique<MPTable> (transaction_));
+      currentReg_.reclaim();
     }
     
     
@@ -224,8 +277,7 @@ namespace fixture {
     {
       LockRegistry global_lock;
       TRACE (builder, "discarding changes to ModelPort list (rollback)....");
-      MPTable newTransaction(currentReg_);
-      swap (transaction_, newTransaction);
+      transaction_ = *currentReg_.access();
     }
     
     
@@ -253,7 +305,7 @@ namespace mobject {
   bool
   ModelPort::exists (ID<asset::Pipe> key)
   {
-    return fixture::ModelPortRegistry::globalInstance().isRegistered (key);
+    return fixture::ModelPortRegistry::isPublished (key);
   }
   
   
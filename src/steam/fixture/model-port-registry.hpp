@@ -25,11 +25,15 @@
  ** for setting up such a registry, while all other parts of the system just access the current
  ** model ports through the mobject::ModelPort frontend.
  ** 
- ** @note the locking is rather coarse grained; basically we're using just one
- **       single global lock for all ModelPortRegistry instances and all access/mutations,
- **       as well as for accessing the globally valid Registry through the ModelPort frontend.
- **       Assumed that usually there is just one Registry maintained by the builder, this is
- **       likely to be sufficient.
+ ** @note the currently active model ports are published as an immutable snapshot through
+ **       a lib::EpochPublication; read access through the ModelPort frontend thus is wait-free,
+ **       which is relevant since job-planning resolves model ports concurrently. Mutations
+ **       and the transactional switch are still protected by one single global lock for all
+ **       ModelPortRegistry instances; assumed that usually there is just one Registry
+ **       maintained by the builder, this is likely to be sufficient.
+ ** @note switching or shutting down the global registry blocks until ongoing lookups through
+ **       the ModelPort frontend are complete; the previous registry instance may then be
+ **       destroyed. References obtained from #globalInstance are not covered by this.
  ** 
  ** @see ModelPort
  ** @see OutputDesignation
@@ -41,11 +45,12 @@
 #define STEAM_FIXTURE_MODEL_PORT_REGISTRY_H
 
 #include "lib/error.hpp"
-#include "lib/optional-ref.hpp"
+#include "lib/epoch-publication.hpp"
 #include "steam/asset/pipe.hpp"
 #include "steam/asset/struct.hpp"
 #include "steam/mobject/model-port.hpp"
 
+#include <atomic>
 #include <map>
 
 namespace steam {
@@ -79,6 +84,7 @@ namespace fixture {
       /** @internal record to describe a model port */
       class ModelPortDescriptor;
       
+      ModelPortRegistry();
       
       static void shutdown ();
       
@@ -88,9 +94,11 @@ namespace fixture {
       static ModelPortRegistry&
       globalInstance();
       
-      static ModelPortDescriptor const&
+      static ModelPortDescriptor
       accessDescriptor (PID); 
       
+      static bool isPublished (PID);
+      
       
       ModelPortDescriptor const&
       definePort (PID pipe, StID element_exposing_this_port);
@@ -98,7 +106,7 @@ namespace fixture {
       bool contains (PID)     const;
       bool isRegistered (PID) const;
       
-      ModelPortDescriptor const&
+      ModelPortDescriptor
       get (PID)  const;
       
       
@@ -120,12 +128,14 @@ namespace fixture {
       
       
     private:
-      static lib::OptionalRef<ModelPortRegistry> theGlobalRegistry;
+      static std::atomic<ModelPortRegistry*> theGlobalRegistry;
       
       typedef std::map<PID, ModelPortDescriptor> MPTable;
       
-      MPTable currentReg_;
+      lib::EpochPublication<MPTable> currentReg_;
       MPTable transaction_;
+      
+      static ModelPortDescriptor const& lookup (MPTable const&, PID);
     };
   
   
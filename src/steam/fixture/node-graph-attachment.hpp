@@ -78,6 +78,17 @@ namespace fixture {
         {
           return util::isnil (exitNodes_);
         }
+      
+      /** @return `true` if both attach the same ExitNode for each ModelPort */
+      friend bool
+      operator== (NodeGraphAttachment const& a1, NodeGraphAttachment const& a2)
+      {
+        return a1.exitNodes_ == a2.exitNodes_;
+      }
+      
+      friend bool
+      operator!= (NodeGraphAttachment const& a1, NodeGraphAttachment const& a2)
+      { return not (a1 == a2); }
     };
   
   
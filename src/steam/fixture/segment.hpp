@@ -33,6 +33,7 @@
 #include "lib/util.hpp"
 
 #include <utility>
+#include <atomic>
 #include <deque>
 #include <tuple>
 
@@ -42,6 +43,7 @@ namespace fixture {
   
   using mobject::ExplicitPlacement;
   using lib::time::TimeSpan;
+  using lib::time::TimeValue;
   using lib::time::Time;
   using util::unConst;
   using std::move;
@@ -71,6 +73,16 @@ namespace fixture {
       TicketAlloc ticketAlloc_;
       PortTable   portTable_;
       
+      /** deadline of the latest job planned from this segment */
+      struct Retention
+        : std::atomic<gavl_time_t>
+        {
+          Retention()                        : atomic{_raw(Time::ANYTIME)} { }
+          Retention (Retention const& r)     : atomic{r.load()}            { }
+          Retention& operator= (Retention const& r) { store (r.load()); return *this; }
+        };
+      mutable Retention retention_;
+      
       ///////////////////////////////////////////////////////////////////////////////////////////////////////TICKET #725 : placeholder code
       /** relevant MObjects comprising this segment. */
       std::deque<ExplicitPlacement> elements;
@@ -133,6 +145,29 @@ namespace fixture {
           return exitNode.empty();
         }
       
+      /**
+       * Mark this Segment as used by a job with the given deadline.
+       * When the Fixture is switched, a Segment of the superseded Segmentation
+       * must be retained while any job planned from its JobTickets can still run.
+       * @remark safe to call concurrently from several planning threads
+       */
+      void
+      retainUntil (Time deadline)  const
+        {
+          gavl_time_t limit = _raw(deadline);
+          gavl_time_t current = retention_.load();
+          while (current < limit
+                 and not retention_.compare_exchange_weak (current, limit))
+            { }
+        }
+      
+      /** @return true if some job planned from this Segment might still run at the given time */
+      bool
+      isRetainedAt (Time now)  const
+        {
+          return now <= TimeValue{retention_.load()};
+        }
+      
       
     private:
       void
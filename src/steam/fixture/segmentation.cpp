@@ -23,6 +23,9 @@
 #include "lib/time/timevalue.hpp"
 #include "lib/split-splice.hpp"
 
+#include <algorithm>
+#include <iterator>
+
 using lib::time::Time;
 using lib::time::TimeSpan;
 
@@ -62,13 +65,24 @@ namespace fixture {
    *     creating a second (copied) part of the encompassing old Segment.
    *   - in case the JobTicket is omitted, the new Segment will be marked as _passive_
    *     and any job created from such a Segment will then be a »NOP-job«
+   * @note the index is used to start the splicing algorithm right at the Segment
+   *     covering the split point; all Segments before are left untouched and
+   *     only the index entries of the altered range need to be rewritten.
    * @see SplitSplice_test
    */
   Segment const&
   Segmentation::splitSplice (OptTime start, OptTime after, engine::ExitNodes&& modelLink)
   {
     ASSERT (!start or !after or start != after);
-    using Iter = typename list<Segment>::iterator;
+    
+    // locate the Segment covering the nominal split point (i.e. where the scan would stop)
+    Time sep = start? *start
+                    : after? *after
+                           : Time::NEVER;
+    size_t idx = size_t(std::lower_bound (index_.begin(), index_.end(), sep
+                                         ,[](IndexEntry const& entry, TimeValue t){ return entry.after < t; })
+                        - index_.begin());
+    ASSERT (idx < index_.size());
     
     auto getStart =  [](Iter elm)                                   -> Time { return elm->start(); };
     auto getAfter =  [](Iter elm)                                   -> Time { return elm->after(); };
@@ -85,14 +99,95 @@ namespace fixture {
                                   , cloneSeg
                                   , discard
                                   , Time::NEVER
-                                  , segments_.begin(),segments_.end()
+                                  , index_[idx].seg, segments_.end()
                                   , start,after
                                   };
     splicer.determineRelations();
     auto [s,n,e] = splicer.performSplitSplice();
+    reindex (idx, e);
     return *n;
   }
   
   
+  /**
+   * Release the storage of all Segments not retained by a pending job anymore.
+   * Only relevant for a Segmentation superseded by a [Fixture switch](\ref FixtureSwitch),
+   * since the JobTickets of the remaining Segments may still be used by scheduled jobs.
+   * @param now current wall-clock time, compared to the latest job deadline of each Segment
+   * @return `true` when all Segments are released and the Segmentation can be discarded
+   * @warning the Segmentation is no longer usable for lookup afterwards
+   */
+  bool
+  Segmentation::releaseExpired (Time now)
+  {
+    segments_.remove_if ([&](Segment const& seg){ return not seg.isRetainedAt (now); });
+    index_.clear();
+    ++generation_;
+    return segments_.empty();
+  }
+  
+  
+  /**
+   * Compare to the preceding version of the Segmentation, as replaced by a Builder run.
+   * A Segment counts as unchanged if the previous version holds a Segment with the same
+   * time range, attached to the same ExitNodes; any other part of the timeline may render
+   * differently now, and thus cached results for this time range must be discarded.
+   * @return the changed time ranges in ascending order; adjacent ranges are joined
+   */
+  std::vector<TimeSpan>
+  Segmentation::changedAgainst (Segmentation const& previous)  const
+  {
+    std::vector<TimeSpan> changes;
+    for (Segment const& seg : segments_)
+      {
+        Segment const& prev = previous[seg.start()];
+        if (prev.start() == seg.start()
+            and prev.after() == seg.after()
+            and prev.exitNode == seg.exitNode)
+          continue;
+        TimeVar start = seg.start();
+        if (not changes.empty() and changes.back().end() == start)
+          {
+            start = changes.back().start();
+            changes.pop_back();
+          }
+        changes.emplace_back (start, seg.after());
+      }
+    return changes;
+  }
+  
+  
+  /**
+   * @internal rewrite the index entries for all Segments from index position  idx
+   * up to (excluding) the given Segment  end, which was not affected by the change.
+   * @remark the Segment preceding position  idx is likewise unaffected and serves as
+   *         anchor to find the first changed Segment; existing index entries are reused,
+   *         so that the index is shifted only when the number of Segments changes.
+   */
+  void
+  Segmentation::reindex (size_t idx, Iter end)
+  {
+    size_t idxEnd = end == segments_.end()? index_.size()
+                                          : size_t(std::lower_bound (index_.begin(), index_.end(), end->after()
+                                                                    ,[](IndexEntry const& entry, TimeValue t){ return entry.after < t; })
+                                                   - index_.begin());
+    ASSERT (idxEnd == index_.size() or index_[idxEnd].seg == end);
+    Iter pos = idx == 0? segments_.begin()
+                       : std::next (index_[idx-1].seg);
+    
+    size_t cntOld = idxEnd - idx;
+    size_t cntNew = size_t(std::distance (pos, end));
+    if (cntNew > cntOld)
+      index_.insert (index_.begin()+idxEnd, cntNew-cntOld, IndexEntry{Time::NEVER, end});
+    else
+      index_.erase (index_.begin()+idx+cntNew, index_.begin()+idxEnd);
+    
+    for (size_t i=idx ; pos != end; ++pos, ++i)
+      index_[i] = IndexEntry{pos->after(), pos};
+    ++generation_;
+    ENSURE (index_.size() == segments_.size());
+  }
+  
+  
   
 }} // namespace steam::fixture
@@ -26,6 +26,14 @@
  ** index and access datastructure to get at any point of the render node network.
  ** Moreover, the segments are used as foundation for render node memory management
  ** 
+ ** The segments themselves are stored in a linked list, so that references to a Segment
+ ** (and to the JobTickets it owns) remain stable while the Segmentation is reworked. Lookup
+ ** by time however relies on a sorted contiguous index of the segment end points, allowing
+ ** for binary search; the index is kept consistent by #Segmentation::splitSplice, which
+ ** also uses it to locate the split point. For playback, which typically proceeds
+ ** monotonically through the timeline, a Segmentation::Cursor remembers the current
+ ** position and thus needs only to step ahead occasionally.
+ ** 
  ** @todo 5/2023 now actually started with the implementation for the »Playback Vertical Slice«
  ** 
  ** @see Fixture
@@ -44,8 +52,10 @@
 #include "lib/nocopy.hpp"
 
 #include <list>
+#include <vector>
 #include <optional>
 #include <functional>
+#include <algorithm>
 
 
 namespace steam {
@@ -55,6 +65,7 @@ namespace fixture {
   
   using std::list;
   using lib::time::TimeValue;
+  using lib::time::TimeVar;
   using util::_Fmt;
   
   using OptTime = std::optional<lib::time::Time>;
@@ -75,32 +86,52 @@ namespace fixture {
   class Segmentation
     : util::NonCopyable
     {
+      using Iter = list<Segment>::iterator;
+      
+      /** entry in the time index: end point of a Segment */
+      struct IndexEntry
+        {
+          TimeVar after;
+          Iter    seg;
+        };
+      
       /** segments of the engine in ordered sequence. */
       list<Segment> segments_;
       
+      /** index of all segments, sorted by (strictly ascending) end point */
+      std::vector<IndexEntry> index_;
+      
+      /** incremented on each change, to invalidate any Cursor */
+      size_t generation_{0};
+      
     protected:
       Segmentation()                ///< there is always a single cover-all Segment initially
         : segments_{1}
+        , index_{IndexEntry{segments_.front().after(), segments_.begin()}}
       { }
       
     public:
       virtual ~Segmentation();      ///< this is an interface
       
+      class Cursor;
+      
       size_t
       size()  const
         {
           return segments_.size();
         }
       
+      /** @return the Segment covering the given time point
+       * @remark binary search in the index: O(log n) */
       Segment const&
       operator[] (TimeValue time)  const
         {
-          for (auto& seg : segments_)
-            if (seg.after() > time)
-              return seg;
-          throw error::State (_Fmt{"Fixture datastructure corrupted: Time %s not covered"} % time);
+          return *index_[locate (time)].seg;
         }
       
+      /** @return a Cursor for repeated lookup of ascending time points */
+      Cursor cursor()  const;
+      
       auto
       eachSeg()  const              ///< @return iterator to enumerate each segment in ascending time order
         {
@@ -112,6 +143,28 @@ namespace fixture {
       Segment const&
       splitSplice (OptTime start, OptTime after, engine::ExitNodes&& modelLink  =ExitNodes{});
       
+      /** @internal discard Segments not needed anymore by any planned job,
+       *  after this Segmentation was superseded by a new version of the Fixture */
+      bool releaseExpired (Time now);
+      
+      /** @return time ranges rendered differently than by the given previous version */
+      std::vector<TimeSpan> changedAgainst (Segmentation const& previous)  const;
+      
+      
+    private:
+      /** @return index position of the Segment covering the given time
+       *  @throw error::State when beyond the end of the Segmentation */
+      size_t
+      locate (TimeValue time)  const
+        {
+          auto pos = std::upper_bound (index_.begin(), index_.end(), time
+                                      ,[](TimeValue t, IndexEntry const& entry){ return t < entry.after; });
+          if (pos == index_.end())
+            throw error::State (_Fmt{"Fixture datastructure corrupted: Time %s not covered"} % time);
+          return size_t(pos - index_.begin());
+        }
+      
+      void reindex (size_t idx, Iter end);
       
     protected:
       /** @internal rewrite the NodeGraphAttachment in each Segment */
@@ -125,5 +178,70 @@ namespace fixture {
   
   
   
+  /**
+   * Lookup helper for a sequence of mostly ascending time points, as in playback.
+   * The Cursor remembers the position of the current Segment; as long as the
+   * queried time remains within this Segment or moves ahead to one of the next
+   * Segments, the lookup is resolved by stepping ahead, which is amortised O(1)
+   * per frame. Any other query falls back to binary search in the index.
+   * @note the Cursor detects modifications by Segmentation::splitSplice and
+   *       relocates itself then; yet it must not outlive the Segmentation.
+   */
+  class Segmentation::Cursor
+    {
+      Segmentation const* segs_;
+      size_t pos_;
+      size_t generation_;
+      size_t cntSearch_{0};
+      
+      static const size_t MAX_STEPS = 8;   ///< scan ahead at most this far before searching
+      
+    public:
+      explicit
+      Cursor (Segmentation const& segmentation)
+        : segs_{&segmentation}
+        , pos_{0}
+        , generation_{segmentation.generation_}
+        { }
+      
+      /** @return the Segment covering the given time point */
+      Segment const&
+      operator[] (TimeValue time)
+        {
+          auto& index = segs_->index_;
+          if (generation_ != segs_->generation_
+              or time < index[pos_].seg->start())
+            return relocate (time);
+          for (size_t step=0; index[pos_].after <= time; ++step)
+            if (step == MAX_STEPS or pos_+1 == index.size())
+              return relocate (time);
+            else
+              ++pos_;
+          return *index[pos_].seg;
+        }
+      
+      /** number of lookups resolved by searching the complete index */
+      size_t cntSearch()  const { return cntSearch_; }
+      
+    private:
+      Segment const&
+      relocate (TimeValue time)
+        {
+          ++cntSearch_;
+          generation_ = segs_->generation_;
+          pos_ = segs_->locate (time);
+          return *segs_->index_[pos_].seg;
+        }
+    };
+  
+  
+  inline Segmentation::Cursor
+  Segmentation::cursor()  const
+  {
+    return Cursor{*this};
+  }
+  
+  
+  
 }} // namespace steam::fixture
 #endif /*STEAM_FIXTURE_SEGMENTATION_H*/
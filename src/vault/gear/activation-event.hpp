@@ -0,0 +1,112 @@
+/*
+  ACTIVATION-EVENT.hpp  -  data record to represent a scheduled Activity
+
+   Copyright (C)
+     2023,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file activation-event.hpp
+ ** Entry record passed through the queues of the Scheduler.
+ ** Extracted from scheduler-invocation.hpp to be shared by the central
+ ** priority queue and the [local run queues](\ref local-run-queue.hpp).
+ ** Besides the timing window, the event can carry a hint regarding the
+ ** [NUMA node](\ref work-topology.hpp) best suited to perform the work.
+ ** @see SchedulerInvocation
+ */
+
+
+#ifndef SRC_VAULT_GEAR_ACTIVATION_EVENT_H_
+#define SRC_VAULT_GEAR_ACTIVATION_EVENT_H_
+
+
+#include "vault/common.hpp"
+#include "vault/gear/activity.hpp"
+#include "vault/gear/work-topology.hpp"
+#include "lib/time/timevalue.hpp"
+
+
+namespace vault{
+namespace gear {
+  
+  using lib::time::Time;
+  
+  
+  /**
+   * @internal data record passed through the queues,
+   *           representing an event to be scheduled
+   */
+  struct ActivationEvent
+    {
+      Activity* activity;
+      int64_t   starting;
+      int64_t   deadline;
+      
+      uint32_t  manifestation :32;
+      bool      isCompulsory  :1;
+      bool      isSpeculative :1;     ///< only to be dispatched with idle capacity
+      uint8_t   numaNode;             ///< preferred NUMA node, e.g. where inputs were produced
+      
+      ActivationEvent()
+        : activity{nullptr}
+        , starting{_raw(Time::ANYTIME)}
+        , deadline{_raw(Time::NEVER)}
+        , manifestation{0}
+        , isCompulsory{false}
+        , isSpeculative{false}
+        , numaNode{work::NO_NODE}
+        { }
+      
+      ActivationEvent(Activity& act, Time when
+                                   , Time dead =Time::NEVER
+                                   , ManifestationID manID =ManifestationID()
+                                   , bool compulsory =false)
+        : activity{&act}
+        , starting{_raw(act.constrainedStart(when))}
+        , deadline{_raw(act.constrainedDeath(dead))}
+        , manifestation{manID}
+        , isCompulsory{compulsory}
+        , isSpeculative{false}
+        , numaNode{work::NO_NODE}
+        { }
+       // default copy operations acceptable
+      
+      /** @internal ordering function for time based scheduling
+       *  @note reversed order as required by std::priority_queue
+       *        to get the earliest element at top of the queue
+       *  @remark entries with the same start time are ordered by
+       *        earliest deadline first, and then compulsory first
+       */
+      bool
+      operator< (ActivationEvent const& o)  const
+        {
+          return starting != o.starting? starting > o.starting
+               : deadline != o.deadline? deadline > o.deadline
+               :                         o.isCompulsory and not isCompulsory;
+        }
+      
+      operator bool()      const { return bool{activity}; }
+      operator Activity*() const { return activity; }
+      
+      Time startTime()     const { return Time{TimeValue{starting}};}
+      Time deathTime()     const { return Time{TimeValue{deadline}};}
+      
+      void
+      refineTo (Activity* chain, Time when, Time dead)
+        {
+          activity = chain;
+          starting = _raw(activity->constrainedStart (when.isRegular()? when:startTime()));
+          deadline = _raw(activity->constrainedDeath (dead.isRegular()? dead:deathTime()));
+        }
+    };
+  
+  
+  
+}} // namespace vault::gear
+#endif /*SRC_VAULT_GEAR_ACTIVATION_EVENT_H_*/
@@ -27,6 +27,7 @@
 #include "vault/gear/scheduler.hpp"//////////////////////////////////////////////////////////////TODO extract -> scheduler.cpp
 
 #include <string>
+#include <atomic>
 #include <boost/functional/hash.hpp> ////////////////////////////////////////////////////////////TODO should be in a scheduler translation-unit / extract scheduler-API
 
 using std::string;
@@ -47,8 +48,16 @@ namespace gear {
       return boost::hash_value (uint32_t{id});
     }
   
-  Symbol WorkTiming::WORKSTART{"WorkStart"};
-  Symbol WorkTiming::WORKSTOP {"WorkStop"};
+  ManifestationID
+  ManifestationID::allocate()
+    {
+      const uint32_t FIRST_ALLOCATED = 1u << 31;
+      static std::atomic<uint32_t> nextID{FIRST_ALLOCATED};
+      uint32_t id = nextID.fetch_add (1, std::memory_order_relaxed);
+      if (id < FIRST_ALLOCATED)
+        throw error::Fatal{"ManifestationID space exhausted"};
+      return ManifestationID{id};
+    }
   
   ///////////////////////////////////////////////////////////////////////////////////////////////TODO extract scheduler-API
   
@@ -69,6 +69,7 @@
 #include "vault/gear/job.h"
 #include "lib/time/timevalue.hpp"
 
+#include <atomic>
 #include <string>
 #include <utility>
 
@@ -86,6 +87,16 @@ namespace gear {
   
   namespace activity {
     
+    /** @internal key to correlate WORKSTART and WORKSTOP of a job in the EngineObserver;
+     *  a sequence number is used, since storage of the Activities is recycled by the BlockFlow */
+    inline size_t
+    nextWorkKey()
+    {
+      static std::atomic<size_t> seqNr{0};
+      return 1 + seqNr.fetch_add (1, std::memory_order_relaxed);
+    }
+    
+    
     /**
      * A Term of the »Activity Language«, describing the steps necessary
      * to perform the calculation of a single frame or similar tasks.
@@ -276,6 +287,9 @@ namespace gear {
             Activity& start = alloc_.create (Activity::WORKSTART);
             Activity& stop  = alloc_.create (Activity::WORKSTOP);
             /////////////////////////////////////////////////////////////////////////////////////////////////TICKET #1283 define the "quality" parameter to distinguish observable execution times
+            size_t workKey = nextWorkKey();                  // correlation key to pair both in the EngineObserver
+            start.data_.timing.quality = workKey;
+            stop.data_.timing.quality  = workKey;
             
             insert (gate_? gate_: post_,  &start);
             insert (findTail (start.next), &stop);
@@ -80,6 +80,9 @@ namespace gear {
    * An opaque, copyable and comparable value object.
    * @remark to be maintained by the PlayProcess and used
    *         by the Scheduler to discard superseded planning.
+   * @note distinct IDs for independent streams should be obtained from #allocate();
+   *       these are drawn from the upper half of the value range, while lower values
+   *       remain available for fixed assignment (e.g. in tests).
    */
   class ManifestationID
     {
@@ -91,6 +94,9 @@ namespace gear {
         { }
       // standard copy operations acceptable
       
+      /** @return a new ID, distinct from any other allocated ID (threadsafe) */
+      static ManifestationID allocate();
+      
       explicit operator uint32_t()  const { return id_;}
       explicit operator bool()      const { return id_ != 0; }
       
@@ -0,0 +1,96 @@
+/*
+  ASYNC-JOB.hpp  -  render job to initiate an asynchronous operation
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file async-job.hpp
+ ** Integration of asynchronous IO operations into the Scheduler.
+ ** A job of kind `LOAD_JOB` is expected just to _initiate_ an IO operation and to return
+ ** immediately, without blocking the worker thread until the data is available. For this
+ ** kind of job, the Scheduler wires a [severed Activity chain](\ref activity::Term::LOAD_JOB),
+ ** and the remainder of this chain, i.e. the `WORKSTOP` and any `NOTIFY` towards dependent
+ ** jobs, is activated only when the IO operation signals completion. To allow for this
+ ** hand-over, the JobClosure must additionally implement the AsyncJob interface: when
+ ** the job is posted, an IoCompletion token is attached for each invocation, which is
+ ** to be invoked by the IO subsystem from whatever thread observes the completion.
+ ** The remainder of the chain is then posted into the Scheduler, to be dispatched
+ ** by the next available worker.
+ ** @note the completion must be invoked exactly once; if it is invoked only after
+ **       the deadline of the job, the dependent jobs are not triggered anymore.
+ ** @see ScheduleSpec::post()
+ ** @see SchedulerAsyncIO_test
+ ** @see vault::io::AsyncIO
+ */
+
+
+#ifndef SRC_VAULT_GEAR_ASYNC_JOB_H_
+#define SRC_VAULT_GEAR_ASYNC_JOB_H_
+
+
+#include "vault/common.hpp"
+#include "vault/gear/job.h"
+#include "vault/gear/activity.hpp"
+#include "lib/time/timevalue.hpp"
+
+
+namespace vault{
+namespace gear {
+  
+  using lib::time::Time;
+  using lib::time::TimeVar;
+  
+  class Scheduler;
+  
+  
+  /**
+   * Token to re-enter the Scheduler after completion of an asynchronous operation.
+   * Can be copied and invoked from any thread, but must be invoked only once.
+   */
+  class IoCompletion
+    {
+      Scheduler* scheduler_{nullptr};
+      Activity*  callback_{nullptr};
+      TimeVar    deadline_{Time::NEVER};
+      ManifestationID manID_{};
+      
+    public:
+      IoCompletion()  = default;
+      IoCompletion (Scheduler& scheduler, Activity& callback, Time deadline, ManifestationID manID)
+        : scheduler_{&scheduler}
+        , callback_{&callback}
+        , deadline_{deadline}
+        , manID_{manID}
+        { }
+      
+      explicit operator bool()  const { return callback_; }
+      
+      /** post the remainder of the Activity chain into the Scheduler */
+      void operator()()  const;
+    };
+  
+  
+  /**
+   * Interface to be implemented additionally by any JobClosure
+   * for jobs of kind `LOAD_JOB`, to receive the completion token.
+   */
+  class AsyncJob
+    {
+    public:
+      virtual ~AsyncJob();   ///< this is an interface
+      
+      /** receive the completion for an individual invocation of this job */
+      virtual void attachCompletion (InvocationInstanceID, IoCompletion)  =0;
+    };
+  
+  
+}} // namespace vault::gear
+#endif /*SRC_VAULT_GEAR_ASYNC_JOB_H_*/
@@ -59,13 +59,30 @@
  ** The increasing of capacity on overflow and the exponential targeting of an optimal
  ** fill factor counteract each other, typically converging after some »duty cycles«. 
  ** 
+ ** # Thread-local allocation windows
+ ** 
+ ** Each Epoch keeps track of claimed slots in its EpochGate, which thus acts as a shared
+ ** bump counter. When several threads plan jobs for different calculation streams, they
+ ** will typically allocate into the same Epoch, contending on this single cache line.
+ ** Optionally (config `ALLOC_WINDOW` > 1) each thread claims a small _window_ of
+ ** consecutive slots from the Epoch with a single atomic operation, and then allocates
+ ** from this window locally. A thread retains a few windows, one per Epoch used recently.
+ ** All windows are invalidated whenever Epochs are discarded, since the storage can then
+ ** be re-used for a new Epoch. Slots claimed into a window count as filled for the Epoch,
+ ** even while not yet handed out; FlowDiagnostic reports the fill of windows per thread.
+ ** @note only the claiming of slots from an already established Epoch is thread-safe;
+ **       extending the Epoch grid, overflow regulation and clean-up still require
+ **       exclusive access, as ensured by the Scheduler's »Grooming-Token«.
+ ** 
  ** @remark 7/2023 this implementation explicates the intended memory management pattern,
  **         yet a lot more measurements and observations with real-world load patterns
  **         seem indicated. The _characteristic parameters_ in blockFlow::DefaultConfig
- **         expose the most effective tuning points. In its current form, the underlying
+ **         expose the most effective tuning points. By default, the underlying
  **         ExtendFamily allocates the Extents directly from the default heap allocator,
- **         which does not seem to be of relevance performance-wise, since the pool of
- **         Extents, once allocated, is re-used cyclically.
+ **         since the pool of Extents, once allocated, is re-used cyclically. For the
+ **         Render Engine however, the [allocation policy](\ref Strategy::extentPolicy())
+ **         demands to carve the Extents from a reserved address range, backed by huge
+ **         pages and pre-faulted, to avoid page faults and TLB misses on start-up.
  ** @see BlockFlow_test
  ** @see SchedulerUsage_test
  ** @see extent-family.hpp underlying allocation scheme
@@ -86,7 +103,13 @@
 #include "lib/nocopy.hpp"
 #include "lib/util.hpp"
 
+#include <thread>
 #include <utility>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <array>
+#include <mutex>
 
 
 namespace vault{
@@ -134,6 +157,10 @@ namespace gear {
         const size_t ACTIVITIES_PER_FRAME = 10; ///< how many Activity records are typically used to implement a single frame
         const size_t REFERENCE_FPS  =  25;      ///< frame rate to use as reference point to relate DUTY_CYCLE and default counts
         const size_t OVERLOAD_LIMIT =  60;      ///< load factor over normal use where to assume saturation and limit throughput
+        
+        /* === memory allocation === */
+        const mem::ExtentPolicy EXTENT_POLICY{};///< allocate each Extent from the heap
+        const static size_t ALLOC_WINDOW = 1;   ///< slots claimed at once into a thread-local window (1 = no windows)
       };
     
     /**
@@ -143,7 +170,13 @@ namespace gear {
       : DefaultConfig
       {
         const static size_t EPOCH_SIZ = 500;
+        const static size_t ALLOC_WINDOW = 8;
         const size_t INITIAL_STREAMS = 5;
+        
+        const mem::ExtentPolicy EXTENT_POLICY{true                                // reserve contiguous address range
+                                             ,mem::ExtentPolicy::TRANSPARENT_HUGE
+                                             ,true                                // pre-fault new Extents
+                                             ,1_GiB};
       };
     
     /**
@@ -184,6 +217,18 @@ namespace gear {
             return util::max(2*_raw(config().DUTY_CYCLE) / _raw(initialEpochStep()), 2u);
           }
         
+        size_t
+        entranceCapacity()  const      ///< capacity of the Scheduler entrance to absorb the Activities of initial Epochs
+          {
+            return config().EPOCH_SIZ * initialEpochCnt();
+          }
+        
+        mem::ExtentPolicy
+        extentPolicy()  const          ///< how to allocate the storage Extents
+          {
+            return config().EXTENT_POLICY;
+          }
+        
         size_t
         averageEpochs()  const
           {
@@ -211,6 +256,68 @@ namespace gear {
     
     
     
+    const uint LOCAL_WINDOWS = 4;  ///< number of Epochs a thread can allocate from locally at the same time
+    
+    /** @internal unique token to tag the current state of the Epoch grid */
+    inline uint64_t
+    nextGeneration()
+    {
+      static std::atomic<uint64_t> generation{0};
+      return 1 + generation.fetch_add (1, std::memory_order_relaxed);
+    }
+    
+    /**
+     * Run of consecutive slots claimed by one thread from a single Epoch.
+     * Allocation proceeds downwards, like in the Epoch itself.
+     */
+    struct AllocWindow
+      {
+        Activity const* gate{nullptr};        ///< identifies the Epoch the slots were claimed from
+        uint64_t  generation{0};              ///< state of the Epoch grid when claimed
+        Activity* pos{nullptr};               ///< next slot to hand out
+        Activity* lim{nullptr};               ///< first slot beyond the window
+        
+        size_t remaining() const { return pos - lim; }
+      };
+    
+    /**
+     * Allocation windows of a single thread, registered with the BlockFlow.
+     * @remark the statistics are written by the owning thread only.
+     */
+    struct alignas(64) ThreadWindows
+      {
+        std::array<AllocWindow, LOCAL_WINDOWS> window;
+        uint victim{0};
+        uint recent{0};                       ///< window used most recently
+        std::thread::id owner{std::this_thread::get_id()};
+        
+        std::atomic<size_t> claimed{0};       ///< slots claimed from Epochs into windows
+        std::atomic<size_t> used{0};          ///< slots actually handed out by allocations
+        
+        static void
+        inc (std::atomic<size_t>& cnt, size_t amount =1)
+          {
+            cnt.store (cnt.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+          }
+        
+        double
+        fill()  const
+          {
+            size_t cntClaimed = claimed.load (std::memory_order_relaxed);
+            return cntClaimed? double(used.load (std::memory_order_relaxed)) / cntClaimed : 0.0;
+          }
+      };
+    
+    /** thread-local attachment to the windows used for a specific BlockFlow
+     * @remark the ThreadWindows are owned by the BlockFlow */
+    struct WindowHandle
+      {
+        uint64_t serial;
+        ThreadWindows* local;
+      };
+    
+    
+    
     
     /**
      * Allocation Extent holding _scheduler Activities_ to be performed altogether
@@ -274,13 +381,13 @@ namespace gear {
             filledSlots()  const
               {
                 const Activity* firstAllocPoint{this + (Epoch::SIZ()-1)};
-                return firstAllocPoint - next;
+                return firstAllocPoint - nextFree();
               }
             
             bool
             hasFreeSlot()  const
               { // see C++ § 5.9 : comparison of pointers within same array
-                return next > this;
+                return nextFree() > this;
               }
             
             Activity*
@@ -289,6 +396,35 @@ namespace gear {
                 REQUIRE (hasFreeSlot());
                 return next--;
               }
+            
+            /** claim a run of consecutive slots, safe against concurrent claims
+             * @param top  _output_ the first (highest) slot of the run
+             * @return number of slots claimed, downwards from `top`
+             */
+            size_t
+            claimRun (size_t cnt, Activity*& top)
+              {
+                Activity const* self = this;
+                Activity* curr = nextFree();
+                Activity* rest;
+                size_t claim;
+                do {
+                    claim = util::min (cnt, size_t(curr - self));
+                    if (0 == claim) return 0;
+                    rest = curr - claim;
+                  }
+                while (not __atomic_compare_exchange_n (&next, &curr, rest, true
+                                                       ,__ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+                top = curr;
+                return claim;
+              }
+            
+          private:
+            Activity*
+            nextFree()  const
+              {
+                return __atomic_load_n (&next, __ATOMIC_RELAXED);
+              }
           };
         
         
@@ -357,6 +493,18 @@ namespace gear {
       Allocator alloc_;
       TimeVar epochStep_;
       
+      constexpr static size_t ALLOC_WINDOW = CONF::ALLOC_WINDOW;
+      using ThreadWindows = blockFlow::ThreadWindows;
+      using AllocWindow   = blockFlow::AllocWindow;
+      
+      const uint64_t serial_{blockFlow::nextGeneration()};
+      std::atomic<uint64_t> generation_{blockFlow::nextGeneration()};
+      
+      std::mutex windowLock_;
+      std::vector<std::shared_ptr<ThreadWindows>> threadWindows_;
+      
+      static thread_local blockFlow::WindowHandle localWindows_;
+      
       
       /** @internal use a raw storage Extent as Epoch (unchecked cast) */
       static Epoch&
@@ -420,7 +568,7 @@ namespace gear {
       
     public:
       BlockFlow()
-        : alloc_{Strategy::initialEpochCnt()}
+        : alloc_{Strategy::initialEpochCnt(), Strategy::extentPolicy()}
         , epochStep_{Strategy::initialEpochStep()}
         { }
       
@@ -482,8 +630,9 @@ namespace gear {
           void*
           claimSlot() ///< EX_SANE
             {
+              void* slot;
               while (not (epoch_ and
-                          epoch_->gate().hasFreeSlot()))
+                          (slot = flow_->claimFrom (*epoch_))))
                   // Epoch overflow...
                 {//  shift to following Epoch; possibly allocate
                   if (not epoch_)
@@ -499,7 +648,7 @@ namespace gear {
                       ++epoch_;
                     }
                 }
-              return epoch_->gate().claimNextSlot();
+              return slot;
             }
         };
       
@@ -589,6 +738,8 @@ namespace gear {
             }
           // ask to discard the enumerated Extents
           alloc_.dropOld (toDiscard);
+          if (toDiscard)  // storage may be re-used => invalidate all allocation windows
+            generation_.store (blockFlow::nextGeneration(), std::memory_order_release);
         }
       
       
@@ -659,6 +810,91 @@ namespace gear {
       
       
     private:
+      /** @internal claim storage for a single Activity from the given Epoch,
+       *   preferably from a thread-local window, else claiming a new window.
+       * @return `nullptr` if the Epoch is exhausted
+       * @remark when replacing an existing window, its remaining slots are lost.
+       */
+      Activity*
+      claimFrom (Epoch& epoch)
+        {
+          if constexpr (ALLOC_WINDOW <= 1)
+            return epoch.gate().hasFreeSlot()? epoch.gate().claimNextSlot()
+                                             : nullptr;
+          else
+            {
+              ThreadWindows& local = localWindows();
+              AllocWindow* window = findWindow (local, epoch);
+              if (not window)
+                {
+                  Activity* top;
+                  size_t cnt = epoch.gate().claimRun (ALLOC_WINDOW, top);
+                  if (not cnt)
+                    return nullptr;
+                  local.recent = local.victim;
+                  window = & local.window[local.victim];
+                  local.victim = (local.victim+1) % blockFlow::LOCAL_WINDOWS;
+                  *window = AllocWindow{&epoch.gate()
+                                       ,generation_.load (std::memory_order_acquire)
+                                       ,top, top-cnt};
+                  ThreadWindows::inc (local.claimed, cnt);
+                }
+              ThreadWindows::inc (local.used);
+              return window->pos--;
+            }
+        }
+      
+      /** @internal locate a valid local window with free slots for this Epoch */
+      AllocWindow*
+      findWindow (ThreadWindows& local, Epoch& epoch)
+        {
+          uint64_t currGen = generation_.load (std::memory_order_acquire);
+          auto usable = [&](AllocWindow& window)
+                          {
+                            return window.gate == &epoch.gate()
+                               and window.generation == currGen
+                               and window.remaining();
+                          };
+          if (usable (local.window[local.recent]))
+            return & local.window[local.recent];
+          for (uint i=0; i < blockFlow::LOCAL_WINDOWS; ++i)
+            if (usable (local.window[i]))
+              {
+                local.recent = i;
+                return & local.window[i];
+              }
+          return nullptr;
+        }
+      
+      /** @internal windows of the current thread, attached on first use */
+      ThreadWindows&
+      localWindows()
+        {
+          if (localWindows_.serial != serial_)
+            attachCurrentThread();
+          return *localWindows_.local;
+        }
+      
+      void
+      attachCurrentThread()
+        {
+          std::lock_guard<std::mutex> guard{windowLock_};
+          auto self = std::this_thread::get_id();
+          std::shared_ptr<ThreadWindows> local;
+          for (auto& entry : threadWindows_)
+            if (entry->owner == self)
+              local = entry;
+          if (not local)
+            {
+              local = std::make_shared<ThreadWindows>();
+              threadWindows_.push_back (local);
+            }
+          for (AllocWindow& window : local->window)
+            window = AllocWindow{};
+          localWindows_.local = local.get();
+          localWindows_.serial = serial_;
+        }
+      
       Epoch&
       firstEpoch()
         {
@@ -711,6 +947,9 @@ namespace gear {
       friend class FlowDiagnostic<CONF>;
     };
   
+  template<class CONF>
+  thread_local blockFlow::WindowHandle BlockFlow<CONF>::localWindows_;
+  
   
   
   
@@ -736,6 +975,7 @@ namespace gear {
       Time   last()      { return flow_.lastEpoch().deadline(); }
       size_t cntEpochs() { return watch(flow_.alloc_).active(); }
       size_t poolSize()  { return watch(flow_.alloc_).size();   }
+      size_t reserved()  { return watch(flow_.alloc_).reserved();}
       
       /** find out in which Epoch the given Activity was placed */
       TimeValue
@@ -758,15 +998,55 @@ namespace gear {
           return util::join(deadlines, "|");
         }
       
-      /** count all currently active allocated elements */
+      /** count all currently active allocated elements
+       * @note slots claimed into allocation windows, but not yet
+       *       handed out, are not counted (requires quiescent state)
+       */
       size_t
       cntElm()
         {
           size_t cnt{0};
           for (auto& epoch : flow_.allEpochs())
             cnt += epoch.gate().filledSlots();
+          auto currGen = flow_.generation_.load();
+          for (auto& local : flow_.threadWindows_)
+            for (auto& window : local->window)
+              if (window.generation == currGen)
+                cnt -= window.remaining();
           return cnt;
         }
+      
+      /** number of threads which used allocation windows */
+      size_t
+      cntThreads()
+        {
+          std::lock_guard<std::mutex> guard{flow_.windowLock_};
+          return flow_.threadWindows_.size();
+        }
+      
+      /** fraction of slots claimed into allocation windows, which
+       *  were actually used for allocations, for each thread */
+      std::vector<double>
+      threadFill()
+        {
+          std::lock_guard<std::mutex> guard{flow_.windowLock_};
+          std::vector<double> fill;
+          for (auto& local : flow_.threadWindows_)
+            fill.push_back (local->fill());
+          return fill;
+        }
+      
+      /** slots handed out by allocations from windows of the current thread */
+      size_t
+      localUsed()
+        {
+          std::lock_guard<std::mutex> guard{flow_.windowLock_};
+          auto self = std::this_thread::get_id();
+          for (auto& local : flow_.threadWindows_)
+            if (local->owner == self)
+              return local->used.load();
+          return 0;
+        }
     };
   
   template<class CONF>
@@ -0,0 +1,228 @@
+/*
+  CALENDAR-QUEUE.hpp  -  time prioritisation of activation events in calendar buckets
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file calendar-queue.hpp
+ ** Alternative backend for the time prioritisation in Layer-1 of the Scheduler.
+ ** A _calendar queue_ (R. Brown, 1988) distributes entries into an array of »day«
+ ** buckets, each covering a fixed time span; a bucket holds all entries falling into
+ ** its day in any »year«, i.e. in any full cycle through the bucket array. Since the
+ ** bucket width is adapted to the typical distance between entries near the head,
+ ** each bucket holds only few entries, and thus insertion and removal of the head
+ ** work in (amortised) constant time. The Scheduler is fed with large numbers of
+ ** frame jobs, planned up to several seconds ahead; with a binary heap, every
+ ** operation would pay `O(log n)` with cache misses scattered over the heap array.
+ **
+ ** # Implementation
+ ** - the bucket width is a power of two µ-ticks, allowing to compute the day by shift
+ ** - the bucket count is a power of two, and is doubled or halved when the number
+ **   of entries changes significantly; on such a rebuild, the bucket width is
+ **   recalibrated from the separation of the most urgent entries
+ ** - each bucket is kept sorted, with the most urgent entry at the end
+ ** - the position of the current head is always known, so that `top()` is `O(1)`;
+ **   after removing the head, the next one is located by scanning forward through
+ **   the current year, which usually stops at the same or the adjacent bucket.
+ ** - entries inserted _before_ the current head just move the head position back.
+ ** @see SchedulerInvocation::useCalendarQueue()
+ ** @see SchedulerInvocation_test::verify_calendarQueue()
+ ** @see SchedulerStress_test::investigate_calendarQueue()
+ */
+
+
+#ifndef SRC_VAULT_GEAR_CALENDAR_QUEUE_H_
+#define SRC_VAULT_GEAR_CALENDAR_QUEUE_H_
+
+
+#include "vault/common.hpp"
+#include "vault/gear/activation-event.hpp"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace vault{
+namespace gear {
+  
+  namespace {// Internal defaults
+    const size_t CALENDAR_MIN_BUCKETS = 64;
+    const uint   CALENDAR_INIT_SHIFT  = 10;   ///< initial bucket width 2^10 µs ≈ 1ms
+    const uint   CALENDAR_MIN_SHIFT   = 4;
+    const uint   CALENDAR_MAX_SHIFT   = 30;
+    const size_t CALENDAR_SAMPLE_SIZE = 32;   ///< number of head entries used to calibrate the bucket width
+  }
+  
+  
+  /**
+   * Priority queue of ActivationEvent, organised as calendar.
+   * Provides the same interface as `std::priority_queue`, i.e. the
+   * entry with the earliest start time is found at the `top()`
+   * @note ordering by `ActivationEvent::operator<`
+   * @warning not threadsafe
+   */
+  class CalendarQueue
+    {
+      using Bucket = std::vector<ActivationEvent>;   ///< ascending order: most urgent entry at the back
+      
+      std::vector<Bucket> buckets_;
+      size_t size_{0};
+      size_t cur_{0};                                ///< bucket holding the current head
+      uint   shift_{CALENDAR_INIT_SHIFT};
+      
+      int64_t day (int64_t start) const { return start >> shift_; }
+      size_t slot (int64_t start) const { return size_t(day(start)) & (buckets_.size() - 1); }
+      
+      
+      void
+      place (ActivationEvent const& event)
+        {
+          Bucket& bucket = buckets_[slot (event.starting)];
+          bucket.insert (std::upper_bound (bucket.begin(), bucket.end(), event), event);
+        }
+      
+      /** @internal after removing the head at `headDay`, find the next head
+       *            within the current year, or else by searching all buckets */
+      void
+      locateHead (int64_t headDay)
+        {
+          size_t n = buckets_.size();
+          for (size_t i=0; i < n; ++i)
+            {
+              size_t j = (cur_+i) & (n-1);
+              if (not buckets_[j].empty()
+                  and day (buckets_[j].back().starting) <= headDay + int64_t(i))
+                {
+                  cur_ = j;
+                  return;
+                }
+            }
+          searchHead();
+        }
+      
+      void
+      searchHead()
+        {
+          bool found{false};
+          for (size_t j=0; j < buckets_.size(); ++j)
+            if (not buckets_[j].empty()
+                and (not found or buckets_[cur_].back() < buckets_[j].back()))
+              {
+                cur_ = j;
+                found = true;
+              }
+        }
+      
+      /** @internal rebuild with different bucket count, recalibrating the bucket width */
+      void
+      resize (size_t bucketCnt)
+        {
+          Bucket all;
+          all.reserve (size_);
+          for (Bucket& bucket : buckets_)
+            all.insert (all.end(), bucket.begin(), bucket.end());
+          
+          size_t sample = std::min (all.size(), CALENDAR_SAMPLE_SIZE);
+          if (1 < sample)
+            {
+              auto byStart = [](ActivationEvent const& a, ActivationEvent const& b)
+                                {
+                                  return a.starting < b.starting;
+                                };
+              std::partial_sort (all.begin(), all.begin()+sample, all.end(), byStart);
+              uint64_t separation = (uint64_t(all[sample-1].starting) - uint64_t(all[0].starting)) / (sample-1);
+              if (separation)
+                {                                    // bucket width ≈ 3 times the average separation
+                  uint shift = CALENDAR_MIN_SHIFT;
+                  while (shift < CALENDAR_MAX_SHIFT and (uint64_t(1) << shift) / 3 < separation)
+                    ++shift;
+                  shift_ = shift;
+                }
+            }
+          
+          buckets_.clear();
+          buckets_.resize (bucketCnt);
+          for (ActivationEvent const& event : all)
+            place (event);
+          searchHead();
+        }
+      
+      
+    public:
+      CalendarQueue()
+        : buckets_(CALENDAR_MIN_BUCKETS)
+        { }
+      
+      bool   empty() const { return 0 == size_; }
+      size_t size()  const { return size_; }
+      
+      ActivationEvent const&
+      top()  const
+        {
+          REQUIRE (size_);
+          return buckets_[cur_].back();
+        }
+      
+      void
+      push (ActivationEvent const& event)
+        {
+          if (size_ >= 2*buckets_.size())
+            resize (2*buckets_.size());
+          bool isNewHead = not size_ or top() < event;
+          place (event);
+          if (isNewHead)
+            cur_ = slot (event.starting);
+          ++size_;
+        }
+      
+      void
+      pop()
+        {
+          REQUIRE (size_);
+          int64_t headDay = day (top().starting);
+          buckets_[cur_].pop_back();
+          --size_;
+          if (not size_)
+            return;
+          if (size_ < buckets_.size()/4 and buckets_.size() > CALENDAR_MIN_BUCKETS)
+            resize (buckets_.size()/2);
+          else
+            locateHead (headDay);
+        }
+      
+      void
+      clear()
+        {
+          buckets_.clear();
+          buckets_.resize (CALENDAR_MIN_BUCKETS);
+          size_ = 0;
+          cur_ = 0;
+          shift_ = CALENDAR_INIT_SHIFT;
+        }
+      
+      /** @return current bucket width (as µ-ticks) */
+      int64_t
+      bucketWidth()  const
+        {
+          return int64_t(1) << shift_;
+        }
+      
+      size_t
+      bucketCnt()  const
+        {
+          return buckets_.size();
+        }
+    };
+  
+  
+  
+}} // namespace vault::gear
+#endif /*SRC_VAULT_GEAR_CALENDAR_QUEUE_H_*/
@@ -0,0 +1,253 @@
+/*
+  EngineObserver  -  collection and maintenance of engine performance indicators
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file engine-observer.cpp
+ ** Implementation of the asynchronous event pipeline of the EngineObserver:
+ ** attachment of ring buffers to threads, the drainer thread and aggregation.
+ */
+
+
+#include "vault/gear/engine-observer.hpp"
+#include "lib/util.hpp"
+
+#include <algorithm>
+
+
+namespace vault{
+namespace gear {
+  
+  using std::lock_guard;
+  using std::unique_lock;
+  using observer::EventRing;
+  
+  namespace { // internal details
+    
+    std::atomic<uint64_t> observerSerial{0};
+    
+    bool
+    isRegular (int64_t rawTime)
+    {
+      return Time{TimeValue{rawTime}}.isRegular();
+    }
+  }
+  
+  thread_local observer::RingHandle EngineObserver::localRing_;
+  
+  Symbol WorkTiming::WORKSTART{"WorkStart"};
+  Symbol WorkTiming::WORKSTOP {"WorkStop"};
+  
+  
+  
+  EngineObserver::EngineObserver()
+    : serial_{1 + observerSerial.fetch_add (1, std::memory_order_relaxed)}
+    { }
+  
+  EngineObserver::~EngineObserver()
+    {
+      try {
+          halt_ = true;
+          wakeup_.notify_all();
+          if (drainer_)
+            drainer_->join();
+        }
+      ERROR_LOG_AND_IGNORE (vault, "shutdown of EngineObserver")
+    }
+  
+  
+  /**
+   * Attach the current thread to a new ring buffer;
+   * the drainer thread is launched with the first attachment.
+   * @remark a thread previously attached to another observer
+   *         abandons its former buffer.
+   */
+  void
+  EngineObserver::attachCurrentThread()
+  {
+    auto ring = std::make_shared<EventRing>();
+    lock_guard<std::mutex> guard{lock_};
+    rings_.push_back (ring);
+    if (not drainer_)
+      drainer_.reset (new lib::ThreadJoinable<>{"EngineObserver", [this]{ drainLoop(); }});
+    if (localRing_.ring)
+      localRing_.ring->abandon();
+    localRing_.ring = move (ring);
+    localRing_.serial = serial_;
+  }
+  
+  
+  void
+  EngineObserver::drainLoop()
+  {
+    while (not halt_)
+      {
+        {
+          unique_lock<std::mutex> guard{lock_};
+          wakeup_.wait_for (guard, observer::DRAIN_CYCLE, [this]{ return bool(halt_); });
+        }
+        drainAll();
+        publish();
+      }
+  }
+  
+  
+  /** @internal drain all buffers and discard those abandoned
+   * @return number of events drained */
+  size_t
+  EngineObserver::drainAll()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    size_t cnt{0};
+    for (auto& ring : rings_)
+      {
+        bool abandoned = ring->isAbandoned();
+        cnt += ring->drain ([this](EngineEvent const& event, size_t qualifier)
+                              {
+                                aggregate (event, qualifier);
+                              });
+        aggregate_.dropped += ring->takeDropped();
+        if (abandoned)
+          ring.reset();
+      }
+    rings_.erase (std::remove (rings_.begin(), rings_.end(), nullptr), rings_.end());
+    aggregate_.events += cnt;
+    discardPending();
+    return cnt;
+  }
+  
+  
+  /** @internal integrate a single event into the statistics;
+   *  a `WORKSTOP` is paired with the `WORKSTART` of same qualifier,
+   *  which may arrive later, when emitted through another buffer. */
+  void
+  EngineObserver::aggregate (EngineEvent const& event, size_t qualifier)
+  {
+    if (event.message == WorkTiming::WORKSTART)
+      {
+        auto data = WorkTiming::decode (event);
+        latest_ = std::max (latest_, data.now);
+        auto& stat = aggregate_.perManifestation[ManifestationID{data.manID}];
+        if (isRegular (data.ref))
+          stat.queueLatency.add (data.now - data.ref);
+        auto stop = pendingStop_.find (qualifier);
+        if (stop != pendingStop_.end() and stop->second.now >= data.now)
+          {
+            recordWork (stop->second, data.now);
+            pendingStop_.erase (stop);
+          }
+        else
+          pendingStart_[qualifier] = data.now;
+      }
+    else
+    if (event.message == WorkTiming::WORKSTOP)
+      {
+        auto data = WorkTiming::decode (event);
+        latest_ = std::max (latest_, data.now);
+        if (isRegular (data.ref) and data.now > data.ref)
+          ++aggregate_.perManifestation[ManifestationID{data.manID}].missed;
+        auto start = pendingStart_.find (qualifier);
+        if (start != pendingStart_.end() and start->second <= data.now)
+          {
+            recordWork (data, start->second);
+            pendingStart_.erase (start);
+          }
+        else
+          {
+            if (util::contains (pendingStop_, qualifier))
+              ++aggregate_.unmatched;         // superseded stop was never paired
+            pendingStop_[qualifier] = data;
+          }
+      }
+  }
+  
+  void
+  EngineObserver::recordWork (WorkTiming::Data const& stop, int64_t startedAt)
+  {
+    auto& stat = aggregate_.perManifestation[ManifestationID{stop.manID}];
+    stat.workTime.add (stop.now - startedAt);
+  }
+  
+  /** @internal forget unpaired events beyond the PENDING_HORIZON;
+   *  a stop discarded thereby is counted as unmatched */
+  void
+  EngineObserver::discardPending()
+  {
+    int64_t limit = latest_ - observer::PENDING_HORIZON;
+    for (auto it = pendingStart_.begin(); it != pendingStart_.end(); )
+      if (it->second < limit)
+        it = pendingStart_.erase (it);
+      else
+        ++it;
+    for (auto it = pendingStop_.begin(); it != pendingStop_.end(); )
+      if (it->second.now < limit)
+        {
+          ++aggregate_.unmatched;
+          it = pendingStop_.erase (it);
+        }
+      else
+        ++it;
+  }
+  
+  
+  /** @internal notify subscribers, if new events were aggregated */
+  void
+  EngineObserver::publish()
+  {
+    Snapshot current;
+    std::vector<Subscriber> subscribers;
+    {
+      lock_guard<std::mutex> guard{lock_};
+      if (subscribers_.empty() or published_ == aggregate_.events + aggregate_.dropped)
+        return;
+      published_ = aggregate_.events + aggregate_.dropped;
+      current = aggregate_;
+      subscribers = subscribers_;
+    }
+    for (auto& subscriber : subscribers)
+      subscriber (current);
+  }
+  
+  
+  void
+  EngineObserver::subscribe (Subscriber subscriber)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    subscribers_.emplace_back (move (subscriber));
+  }
+  
+  
+  void
+  EngineObserver::flush()
+  {
+    drainAll();
+  }
+  
+  
+  observer::Snapshot
+  EngineObserver::snapshot()
+  {
+    drainAll();
+    lock_guard<std::mutex> guard{lock_};
+    return aggregate_;
+  }
+  
+  
+  size_t
+  EngineObserver::ringCnt()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return rings_.size();
+  }
+  
+  
+}} // namespace vault::gear
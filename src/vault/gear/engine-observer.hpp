@@ -18,12 +18,35 @@
  ** synchronous notification calls. The information transmitted must be offloaded
  ** quickly for asynchronous processing to generate the actual observable values.
  ** 
+ ** # Event pipeline
+ ** Notifications are emitted from the render workers on the hot path, and thus
+ ** must neither block nor serialise the workers. Each thread emitting events is
+ ** attached to a dedicated _single producer single consumer_ ring buffer of fixed
+ ** capacity; emitting an event amounts to copying a small EngineEvent record into
+ ** this buffer. If the buffer is full, the event is dropped (and counted). A
+ ** background _drainer_ thread empties all buffers periodically and aggregates
+ ** the observations [per Manifestation](\ref ManifestationID) into histograms
+ ** of queue latency and work time, and counts missed deadlines. Subscribers are
+ ** notified from the drainer thread with a snapshot of the aggregated values.
+ ** 
+ ** Each event is buffered together with the _qualifier_ given on dispatch; the
+ ** `WORKSTART` and `WORKSTOP` of the same job carry the same qualifier, which is
+ ** used as key to pair them up — irrespective of the thread emitting the event,
+ ** since the `WORKSTOP` of an asynchronous IO job is posted from the completion.
+ ** A `WORKSTOP` without matching `WORKSTART` (e.g. when the latter was dropped)
+ ** is only counted as _unmatched;_ unpaired events are retained for a limited
+ ** time span, to allow for the counterpart to arrive through another buffer.
+ ** 
+ ** Buffers are attached to threads on first use and remain attached until the
+ ** thread terminates; abandoned buffers are discarded after the final drain.
+ ** 
  ** @see scheduler.hpp
  ** @see job-planning.hpp
  ** @see Activity::Verb::WORKSTART
+ ** @see EngineObserver_test
  ** 
  ** @todo WIP-WIP-WIP 10/2023 »Playback Vertical Slice« created as a stub
- ** @todo design and implement the EngineObserver as publisher-subscriber... ////////////////////////////////TICKET #1347 : design EngineObserver
+ ** @todo further event types for higher level capacity management  //////////////////////////////////TICKET #1347 : design EngineObserver
  ** 
  */
 
@@ -38,11 +61,19 @@
 #include "vault/gear/scheduler-invocation.hpp"
 #include "lib/symbol.hpp"
 #include  "lib/nocopy.hpp"
+#include "lib/thread.hpp"
 //#include "lib/util.hpp"
 
 //#include <string>
+#include <unordered_map>
+#include <condition_variable>
+#include <functional>
 #include <utility>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <array>
+#include <mutex>
 
 
 namespace vault{
@@ -95,6 +126,16 @@ namespace gear {
         , storage_{0}
         { }
       
+      /** @internal reinterpret the payload stored by a derived class */
+      template<class DAT>
+      DAT
+      payload()  const
+        {
+          Payload<DAT> buff;
+          buff.raw = storage_;
+          return buff.data;
+        }
+      
       // default copy and assignment acceptable
       
       Symbol message;
@@ -104,26 +145,282 @@ namespace gear {
     };
   
   
+  /** work-timing event for performance observation */
+  class WorkTiming
+    : public EngineEvent
+    {
+    public:
+      struct Data
+        {
+          int64_t now;          ///< time of observation
+          int64_t ref;          ///< scheduled start time (WORKSTART) or deadline (WORKSTOP)
+          uint32_t manID;
+        };
+      
+    private:
+      using Payload = EngineEvent::Payload<Data>;
+      using EngineEvent::EngineEvent;
+      
+    public:
+      static Symbol WORKSTART;
+      static Symbol WORKSTOP;
+      
+      static WorkTiming
+      start (Time now, Time scheduled =Time::ANYTIME, ManifestationID manID =ManifestationID())
+        {
+          return WorkTiming{WORKSTART, Payload{Data{_raw(now), _raw(scheduled), uint32_t(manID)}}};
+        }
+      
+      static WorkTiming
+      stop (Time now, Time deadline =Time::NEVER, ManifestationID manID =ManifestationID())
+        {
+          return WorkTiming{WORKSTOP, Payload{Data{_raw(now), _raw(deadline), uint32_t(manID)}}};
+        }
+      
+      /** @return timing data carried by a WORKSTART or WORKSTOP event */
+      static Data
+      decode (EngineEvent const& event)
+        {
+          return event.payload<Data>();
+        }
+    };
+  
+  
+  
+  namespace observer {
+    
+    const size_t RING_CAPACITY = 1024;         ///< events buffered per thread between drain cycles
+    const uint   HISTOGRAM_BINS = 24;          ///< logarithmic bins of 2^i µs, up to ~8s
+    const auto   DRAIN_CYCLE = std::chrono::milliseconds(10);
+    const int64_t PENDING_HORIZON = 10'000'000;  ///< µs after which an unpaired start or stop is discarded
+    
+    
+    /**
+     * Bounded lock-free ring buffer for a single producer and a single consumer.
+     * The producer keeps a cached copy of the consumer position, so that in the
+     * common case a push touches only the producer's own cache line.
+     */
+    class EventRing
+      : util::NonCopyable
+      {
+        struct Entry
+          {
+            size_t qualifier;
+            EngineEvent event;
+          };
+        std::array<Entry, RING_CAPACITY> buff_;
+        
+        alignas(64)
+        std::atomic<size_t> tail_{0};          ///< next position to write (producer)
+        size_t cachedHead_{0};
+        std::atomic<size_t> dropped_{0};
+        std::atomic<bool>  abandoned_{false};
+        
+        alignas(64)
+        std::atomic<size_t> head_{0};          ///< next position to read (consumer)
+        
+      public:
+        bool
+        push (size_t qualifier, EngineEvent const& event)
+          {
+            size_t pos = tail_.load (std::memory_order_relaxed);
+            if (pos - cachedHead_ >= RING_CAPACITY)
+              {
+                cachedHead_ = head_.load (std::memory_order_acquire);
+                if (pos - cachedHead_ >= RING_CAPACITY)
+                  {
+                    dropped_.fetch_add (1, std::memory_order_relaxed);
+                    return false;
+                  }
+              }
+            buff_[pos % RING_CAPACITY] = Entry{qualifier, event};
+            tail_.store (pos+1, std::memory_order_release);
+            return true;
+          }
+        
+        template<class FUN>
+        size_t
+        drain (FUN&& consume)
+          {
+            size_t pos = head_.load (std::memory_order_relaxed);
+            size_t end = tail_.load (std::memory_order_acquire);
+            for (size_t i=pos; i < end; ++i)
+              consume (buff_[i % RING_CAPACITY].event, buff_[i % RING_CAPACITY].qualifier);
+            head_.store (end, std::memory_order_release);
+            return end - pos;
+          }
+        
+        size_t
+        takeDropped()
+          {
+            return dropped_.exchange (0, std::memory_order_relaxed);
+          }
+        
+        /** mark as detached from the producer thread (on thread exit) */
+        void abandon()           { abandoned_.store (true, std::memory_order_release); }
+        bool isAbandoned() const { return abandoned_.load (std::memory_order_acquire); }
+      };
+    
+    
+    /** thread-local attachment of the current thread to a ring buffer */
+    struct RingHandle
+      {
+        uint64_t serial{0};
+        std::shared_ptr<EventRing> ring;
+       
+       ~RingHandle() { if (ring) ring->abandon(); }
+      };
+    
+    
+    /** distribution of observed durations in logarithmic bins */
+    struct Histogram
+      {
+        std::array<size_t, HISTOGRAM_BINS> bins{};
+        size_t  cnt{0};
+        int64_t sum{0};
+        int64_t max{0};
+        
+        /** bin 0 holds values below 1µs, bin i holds [2^(i-1) ... 2^i) µs */
+        static uint
+        binOf (int64_t micros)
+          {
+            uint bin{0};
+            while (micros > 0 and bin+1 < HISTOGRAM_BINS)
+              {
+                micros >>= 1;
+                ++bin;
+              }
+            return bin;
+          }
+        
+        void
+        add (int64_t micros)
+          {
+            ++bins[binOf (micros)];
+            ++cnt;
+            sum += micros;
+            max = cnt==1? micros : std::max (max, micros);
+          }
+        
+        double
+        average()  const
+          {
+            return cnt? double(sum) / cnt : 0.0;
+          }
+        
+        /** @return upper bound (µs) of the bin holding the given quantile */
+        int64_t
+        percentile (double fraction)  const
+          {
+            size_t limit = fraction * cnt;
+            size_t seen{0};
+            for (uint bin=0; bin < HISTOGRAM_BINS; ++bin)
+              if ((seen += bins[bin]) > limit or seen == cnt)
+                return int64_t(1) << bin;
+            return int64_t(1) << HISTOGRAM_BINS;
+          }
+      };
+    
+    
+    /** aggregated observations for one Manifestation */
+    struct Statistics
+      {
+        Histogram queueLatency;                ///< delay of actual start after scheduled start
+        Histogram workTime;                    ///< duration between WORKSTART and WORKSTOP with same qualifier
+        size_t missed{0};                      ///< jobs ending after their deadline
+      };
+    
+    /** aggregated state as published to subscribers */
+    struct Snapshot
+      {
+        std::unordered_map<ManifestationID, Statistics> perManifestation;
+        size_t events{0};
+        size_t dropped{0};
+        size_t unmatched{0};                   ///< WORKSTOP events without corresponding WORKSTART
+        
+        Statistics const&
+        operator[] (ManifestationID manID)  const
+          {
+            static const Statistics NIL;
+            auto it = perManifestation.find (manID);
+            return it != perManifestation.end()? it->second : NIL;
+          }
+      };
+  }//(End)namespace observer
+  
+  
   
   /**
    * Collector and aggregator for performance data.
-   * @todo WIP-WIP 10/2023 - stub as placeholder for later development   ////////////////////////////////////TICKET #1347 : design EngineObserver
+   * Events are [dispatched](\ref #dispatchEvent) from any thread without blocking,
+   * and aggregated asynchronously by a background thread, which is started on
+   * first use and notifies subscribers with [snapshots](\ref observer::Snapshot).
    * @see Scheduler
+   * @see EngineObserver_test
    */
   class EngineObserver
     : util::NonCopyable
     {
+      using Ring = observer::EventRing;
       
     public:
-      explicit
-      EngineObserver()
-        { }
+      using Snapshot = observer::Snapshot;
+      using Subscriber = std::function<void(Snapshot const&)>;
+      
+    private:
+      const uint64_t serial_;
+      
+      std::mutex lock_;
+      std::vector<std::shared_ptr<Ring>> rings_;
+      std::vector<Subscriber> subscribers_;
+      Snapshot aggregate_;
+      size_t published_{0};
       
+      std::unordered_map<size_t, int64_t> pendingStart_;            ///< start times by qualifier
+      std::unordered_map<size_t, WorkTiming::Data> pendingStop_;    ///< stops not yet paired
+      int64_t latest_{0};                                           ///< most recent event time seen
+      
+      std::condition_variable wakeup_;
+      std::atomic<bool> halt_{false};
+      std::unique_ptr<lib::ThreadJoinable<>> drainer_;
+      
+      static thread_local observer::RingHandle localRing_;
+      
+    public:
+      EngineObserver();
+     ~EngineObserver();
+      
+      /** emit an event into the pipeline; never blocks
+       * @param qualifier key to correlate related events (start/stop of a job) */
       void
-      dispatchEvent (size_t /*address*/, EngineEvent /*event*/)
+      dispatchEvent (size_t qualifier, EngineEvent event)
         {
-          /* TICKET #1347 actually move this event into a dispatcher queue */
+          if (localRing_.serial != serial_)
+            attachCurrentThread();
+          localRing_.ring->push (qualifier, event);
         }
+      
+      /** register a callback to receive aggregated snapshots
+       * @note invoked from the drainer thread */
+      void subscribe (Subscriber);
+      
+      /** drain all pending events synchronously */
+      void flush();
+      
+      /** @return the current aggregate, after draining pending events */
+      Snapshot snapshot();
+      
+      /** @internal number of ring buffers currently attached */
+      size_t ringCnt();
+      
+    private:
+      void attachCurrentThread();
+      void drainLoop();
+      size_t drainAll();
+      void publish();
+      void aggregate (EngineEvent const&, size_t);
+      void recordWork (WorkTiming::Data const&, int64_t);
+      void discardPending();
     };
   
   
@@ -0,0 +1,152 @@
+/*
+  HANDOFF-SLOTS.hpp  -  pass due Activities to other workers without Grooming-Token
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file handoff-slots.hpp
+ ** Batched dispatch extension for Layer-1 of the Scheduler.
+ ** In regular operation, each worker acquires the »Grooming-Token« to dequeue exactly
+ ** one Activity chain and drops the token when switching into work mode. For very short
+ ** jobs (audio blocks, parameter agents), the traffic on the token then dominates. In
+ ** _batched dispatch mode,_ a worker holding the token dequeues several due entries at
+ ** once; besides the one entry it dispatches itself, further _detachable_ entries are
+ ** placed into a small array of hand-off slots, from where any worker, including the
+ ** current one on its next round, can pick them up without touching the token.
+ ** The size of the batch is adapted to the current load.
+ ** @note like the [local run queues](\ref local-run-queue.hpp), entries in these slots
+ **       are checked against their deadline only when picked up.
+ ** @see LoadController::dispatchBatchSize()
+ ** @see SchedulerCommutator::handOffDueWork()
+ ** @see SchedulerInvocation_test::verify_handoffSlots()
+ */
+
+
+#ifndef SRC_VAULT_GEAR_HANDOFF_SLOTS_H_
+#define SRC_VAULT_GEAR_HANDOFF_SLOTS_H_
+
+
+#include "vault/common.hpp"
+#include "vault/gear/activation-event.hpp"
+#include "vault/gear/local-run-queue.hpp"
+#include "lib/nocopy.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+
+namespace vault{
+namespace gear {
+  
+  namespace {// Internal defaults
+    const size_t HANDOFF_SLOTS = 8;     ///< maximum number of due entries handed off per batch
+  }
+  
+  
+  /**
+   * Fixed array of slots to pass single ActivationEvents to other threads.
+   * Only the thread holding the Grooming-Token may [fill](\ref #offer) slots,
+   * while any thread may [take](\ref #take) an entry concurrently; the state
+   * of each slot is switched by atomic operations.
+   */
+  class HandoffSlots
+    : util::NonCopyable
+    {
+      enum State : int {FREE, FILLED, TAKING};
+      
+      struct alignas(64) Slot
+        {
+          std::atomic<int> state{FREE};
+          std::atomic<int64_t> start{NO_HEAD};
+          ActivationEvent event;
+        };
+      
+      Slot slots_[HANDOFF_SLOTS];
+      std::atomic<size_t> filled_{0};
+      
+    public:
+      /** place the event into a free slot
+       * @return `false` if all slots are occupied
+       * @warning only to be used by the thread holding the Grooming-Token
+       */
+      bool
+      offer (ActivationEvent const& event)
+        {
+          for (Slot& slot : slots_)
+            if (FREE == slot.state.load (std::memory_order_acquire))
+              {
+                slot.event = event;
+                slot.start.store (event.starting, std::memory_order_relaxed);
+                filled_.fetch_add (1, std::memory_order_relaxed);
+                slot.state.store (FILLED, std::memory_order_release);
+                return true;
+              }
+          return false;
+        }
+      
+      /** retrieve some entry handed off, if available
+       * @return _»empty marker«_ if no entry could be claimed
+       */
+      ActivationEvent
+      take()
+        {
+          if (empty())
+            return ActivationEvent();
+          for (Slot& slot : slots_)
+            {
+              int expect{FILLED};
+              if (slot.state.compare_exchange_strong (expect, TAKING, std::memory_order_acquire))
+                {
+                  ActivationEvent event = slot.event;
+                  slot.start.store (NO_HEAD, std::memory_order_relaxed);
+                  filled_.fetch_sub (1, std::memory_order_relaxed);
+                  slot.state.store (FREE, std::memory_order_release);
+                  return event;
+                }
+            }
+          return ActivationEvent();
+        }
+      
+      void
+      clear()
+        {
+          while (take())
+            { /* discard */ }
+        }
+      
+      bool
+      empty()  const
+        {
+          return 0 == filled_.load (std::memory_order_acquire);
+        }
+      
+      size_t
+      size()  const
+        {
+          return filled_.load (std::memory_order_acquire);
+        }
+      
+      /** @return earliest start time of entries currently handed off */
+      int64_t
+      headStart()  const
+        {
+          int64_t head{NO_HEAD};
+          if (not empty())
+            for (Slot const& slot : slots_)
+              head = std::min (head, slot.start.load (std::memory_order_relaxed));
+          return head;
+        }
+    };
+  
+  
+  
+}} // namespace vault::gear
+#endif /*SRC_VAULT_GEAR_HANDOFF_SLOTS_H_*/
@@ -0,0 +1,190 @@
+/*
+  INSTRUCT-QUEUE.hpp  -  bounded lock-free entrance queue for the Scheduler
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file instruct-queue.hpp
+ ** Entrance queue to pass new work into Layer-1 of the Scheduler.
+ ** Any thread may post new Activities into the Scheduler, while only the thread
+ ** holding the »Grooming-Token« may consume them into the priority queue. This
+ ** calls for a _multiple producer, single consumer_ queue, which must not block.
+ ** The implementation is a ring buffer with fixed capacity, allocated upfront,
+ ** so that no memory allocation happens on the hot path.
+ **
+ ** # Implementation
+ ** Based on the well known design of a bounded queue with sequence numbers
+ ** (D. Vyukov): each cell carries a sequence number, which indicates whether
+ ** the cell is ready to be written for a given round, or ready to be consumed.
+ ** Producers claim a position by CAS on the tail counter; after writing the
+ ** payload, the cell is published by setting its sequence number. A producer
+ ** can claim a batch of consecutive cells with a single CAS; the consumer
+ ** drains all published cells in bulk, up to the first cell not yet published.
+ ** @see SchedulerInvocation::instruct()
+ ** @see InstructQueue_test
+ */
+
+
+#ifndef SRC_VAULT_GEAR_INSTRUCT_QUEUE_H_
+#define SRC_VAULT_GEAR_INSTRUCT_QUEUE_H_
+
+
+#include "vault/common.hpp"
+#include "lib/nocopy.hpp"
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <limits>
+
+
+namespace vault{
+namespace gear {
+  
+  using std::atomic;
+  using std::memory_order_relaxed;
+  using std::memory_order_acquire;
+  using std::memory_order_release;
+  
+  
+  /**
+   * Bounded lock-free MPSC queue.
+   * Capacity is rounded up to the next power of two.
+   * @tparam T element type, must be default constructible and assignable
+   * @warning only a single thread at any time may invoke #drain()
+   */
+  template<typename T>
+  class InstructQueue
+    : util::NonCopyable
+    {
+      struct Cell
+        {
+          atomic<size_t> seq;
+          T data;
+        };
+      
+      std::unique_ptr<Cell[]> cells_;
+      const size_t mask_;
+      
+      alignas(64) atomic<size_t> tail_{0};   ///< next position to claim by producers
+      alignas(64) atomic<size_t> head_{0};   ///< next position to consume
+      
+      static size_t
+      roundUp (size_t capacity)
+        {
+          size_t cap{2};
+          while (cap < capacity)
+            cap <<= 1;
+          return cap;
+        }
+      
+    public:
+      explicit
+      InstructQueue (size_t capacity)
+        : cells_{new Cell[roundUp (capacity)]}
+        , mask_{roundUp (capacity) - 1}
+        {
+          for (size_t i=0; i <= mask_; ++i)
+            cells_[i].seq.store (i, memory_order_relaxed);
+        }
+      
+      size_t capacity()  const { return mask_ + 1; }
+      
+      /** @return `false` if (possibly) some elements are pending */
+      bool
+      empty()  const
+        {
+          return tail_.load (memory_order_acquire) == head_.load (memory_order_acquire);
+        }
+      
+      bool
+      push (T const& elm)
+        {
+          return push (&elm, 1);
+        }
+      
+      /**
+       * Enqueue a batch of elements, claiming all necessary cells at once.
+       * @return `false` if the queue has not enough free capacity;
+       *         in this case, no element was enqueued.
+       */
+      bool
+      push (T const* elms, size_t cnt)
+        {
+          if (not cnt) return true;
+          REQUIRE (cnt <= capacity());
+          size_t pos = tail_.load (memory_order_relaxed);
+          while (true)
+            {                      // cells are freed in order; if the last cell is free, all are free
+              Cell& last = cells_[(pos+cnt-1) & mask_];
+              size_t seq = last.seq.load (memory_order_acquire);
+              intptr_t diff = intptr_t(seq) - intptr_t(pos+cnt-1);
+              if (0 == diff)
+                {
+                  if (tail_.compare_exchange_weak (pos, pos+cnt, memory_order_relaxed))
+                    break;
+                }
+              else
+              if (diff < 0)
+                return false;    // queue full
+              else
+                pos = tail_.load (memory_order_relaxed);
+            }
+          for (size_t i=0; i < cnt; ++i)
+            {
+              Cell& cell = cells_[(pos+i) & mask_];
+              cell.data = elms[i];
+              cell.seq.store (pos+i+1, memory_order_release);
+            }
+          return true;
+        }
+      
+      /**
+       * Consume all elements published thus far.
+       * @param consume functor to accept each element (by reference)
+       * @param limit maximum number of elements to consume
+       * @return number of elements consumed
+       */
+      template<class FUN>
+      size_t
+      drain (FUN&& consume, size_t limit =std::numeric_limits<size_t>::max())
+        {
+          size_t pos = head_.load (memory_order_relaxed);
+          size_t cnt{0};
+          for ( ; cnt < limit; ++cnt, ++pos)
+            {
+              Cell& cell = cells_[pos & mask_];
+              if (cell.seq.load (memory_order_acquire) != pos+1)
+                break;           // not yet published
+              consume (cell.data);
+              cell.seq.store (pos + mask_+1, memory_order_release);
+            }
+          head_.store (pos, memory_order_release);
+          return cnt;
+        }
+      
+      bool
+      pop (T& target)
+        {
+          return 1 == drain ([&](T& elm){ target = elm; }, 1);
+        }
+      
+      void
+      clear()
+        {
+          drain ([](T&){ /*obliterate*/ });
+        }
+    };
+  
+  
+  
+}} // namespace vault::gear
+#endif /*SRC_VAULT_GEAR_INSTRUCT_QUEUE_H_*/
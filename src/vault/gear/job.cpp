@@ -26,6 +26,7 @@
 
 #include "vault/gear/job.h"
 #include "vault/gear/nop-job-functor.hpp"
+#include "vault/gear/async-job.hpp"
 #include "lib/util.hpp"
 
 #include <boost/functional/hash.hpp>
@@ -61,6 +62,8 @@ namespace gear {
   JobFunctor::~JobFunctor() { }
   JobClosure::~JobClosure() { } ///< @deprecated 4/23 refactoring to retract C-structs from the Scheduler interface
   
+  AsyncJob::~AsyncJob() { }
+  
   NopJobFunctor::NopJobFunctor() { }
   
   
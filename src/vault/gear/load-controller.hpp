@@ -63,6 +63,18 @@
  ** - a sampling of the lag, i.e. the average distance to the next task;
  **   this observation is sampled whenever a worker asks for more work.
  ** 
+ ** The load indicator also determines the batch size when the Scheduler
+ ** dequeues several due entries per Grooming-Token acquisition, and whether
+ ** regular entries lacking the necessary slack are [shed](\ref #shedMargin).
+ ** 
+ ** # Speculative work
+ ** Work marked as _speculative_ (e.g. pre-rendering frames around a paused playhead)
+ ** may use only capacity deemed [idle](\ref LoadController::isIdle), i.e. workers
+ ** which would otherwise be sent to sleep, since no regular work is expected within
+ ** the current work horizon. Moreover, only a [share](\ref #allowsSpeculation) of the
+ ** possible concurrency can be engaged with speculative work at any time; the remaining
+ ** workers are kept ready to pick up real-time work without delay.
+ ** 
  ** @see scheduler.hpp
  ** @see SchedulerLoadControl_test
  ** @see SchedulerService_test::verify_LoadFactor()
@@ -129,6 +141,8 @@ namespace gear {
     Duration STANDARD_LAG {_uTicks(200us)}; ///< Experience shows that on average scheduling happens with 200µs delay
     
     const double LAG_SAMPLE_DAMPING = 2;    ///< smoothing factor for exponential moving average of lag;
+    const size_t DISPATCH_BATCH_MAX = 8;    ///< upper limit for due entries dequeued per Grooming-Token acquisition
+    const size_t SPECULATION_SHARE  = 2;    ///< at most 1/N of the possible concurrency engaged with speculative work
   }
   
   
@@ -148,7 +162,7 @@ namespace gear {
       struct Wiring
         {
           function<size_t()> maxCapacity      {[]{ return 1; }};
-          function<size_t()> currWorkForceSize{[]{ return 0; }};
+          function<size_t()> currWorkForceSize{[]{ return 0; }};   ///< @note invoked concurrently by workers
           function<void(uint)> stepUpWorkForce{[](uint){/*NOP*/}};
           ///////TODO add here functors to access performance indicators
         };
@@ -169,6 +183,7 @@ namespace gear {
       
       
       atomic_int64_t sampledLag_{0};
+      atomic_int64_t speculating_{0};
       
       /**
        * @internal evaluate the situation encountered when a worker calls for work.
@@ -191,6 +206,18 @@ namespace gear {
           while (not sampledLag_.compare_exchange_weak (average, newAverage, memory_order_relaxed));
         }
       
+      /** @internal fuse the fraction of engaged concurrency with the given lag sample */
+      double
+      combinedLoad (double lag)  const
+        {
+          lag -= _raw(STANDARD_LAG);
+          lag /= _raw(WORK_HORIZON);
+          lag *= 10;
+          double lagFactor = lag<0? 1/(1-lag): 1+lag;
+          double loadFactor = wiring_.currWorkForceSize() / double(wiring_.maxCapacity());
+          return loadFactor * lagFactor;
+        }
+      
     public:
       /**
        * @return guess of current scheduler pressure
@@ -224,19 +251,79 @@ namespace gear {
        *         which can be retrieved with low overhead
        *         - the used fraction of possible concurrency
        *         - [sampling of distance to next task](\ref averageLag)
+       * @note invoked by workers on the hot path without Grooming-Token; thus
+       *       all state values must be retrieved from atomic variables.
        */
       double
       effectiveLoad()  const
         {
-          double lag = averageLag();
-          lag -= _raw(STANDARD_LAG);
-          lag /= _raw(WORK_HORIZON);
-          lag *= 10;
-          double lagFactor = lag<0? 1/(1-lag): 1+lag;
-          double loadFactor = wiring_.currWorkForceSize() / double(wiring_.maxCapacity());
-          return loadFactor * lagFactor;
+          return combinedLoad (averageLag());
+        }
+      
+      /**
+       * @return number of due entries to dequeue per acquisition of the
+       *         Grooming-Token, when the Scheduler uses batched dispatch.
+       * @remark under low load, the token is rarely contended and each worker
+       *         retrieves just one entry. When the schedule is lagging behind
+       *         with the work force fully engaged, more work is due than can
+       *         be picked up one by one; the batch then grows with the load,
+       *         but is never larger than the number of active workers.
+       */
+      size_t
+      dispatchBatchSize()  const
+        {
+          double load = effectiveLoad();
+          if (load < 1.0)
+            return 1;
+          size_t workers = util::max (wiring_.currWorkForceSize(), 1u);
+          return util::min (util::min (size_t(2*load), workers), DISPATCH_BATCH_MAX);
+        }
+      
+      /**
+       * @return safety margin to discard regular entries early when overloaded;
+       *         an entry is shed if its remaining slack, i.e. the time left until
+       *         its deadline after subtracting this margin, is negative.
+       * @remark no shedding below full load. In overload, the average lag beyond
+       *         the typical lag indicates how much dispatch falls behind schedule.
+       *         Entries unable to cope with this delay are likely to miss their
+       *         deadline anyway, and discarding them frees capacity for entries
+       *         still viable. Compulsory entries are never shed.
+       * @note invoked by workers without Grooming-Token; the lag is sampled
+       *       once, so that load and margin are derived from the same value.
+       */
+      Offset
+      shedMargin()  const
+        {
+          int64_t lag = averageLag();
+          if (combinedLoad (lag) <= 1.0)
+            return Offset::ZERO;
+          int64_t excessLag = lag - _raw(STANDARD_LAG);
+          return Offset{TimeValue{std::max<int64_t> (excessLag, 0)}};
+        }
+      
+      /**
+       * @return `true` if another worker may engage with speculative work.
+       * @remark limited to a share of the possible concurrency (at least one worker),
+       *         so that real-time work can always be picked up by the other workers.
+       */
+      bool
+      allowsSpeculation()  const
+        {
+          size_t limit = util::max (wiring_.maxCapacity() / SPECULATION_SHARE, size_t(1));
+          return speculating_.load (memory_order_relaxed) < int64_t(limit);
         }
       
+      /** number of workers currently engaged with speculative work */
+      size_t
+      cntSpeculating()  const
+        {
+          return speculating_.load (memory_order_relaxed);
+        }
+      
+      class Speculation;
+      /** mark the current worker as engaged with speculative work while in scope */
+      Speculation engageSpeculation();
+      
       /** periodic call to build integrated state indicators */
       void
       updateState (Time)
@@ -305,6 +392,14 @@ namespace gear {
                     ,IDLEWAIT   ///< time to go to sleep
                     };
       
+      /** capacity not required for regular work within the work horizon */
+      static bool
+      isIdle (Capacity capacity)
+        {
+          return capacity == WORKTIME
+              or capacity == IDLEWAIT;
+        }
+      
       /** classification of time horizon for scheduling */
       static Capacity
       classifyTimeHorizon (Offset off)
@@ -388,6 +483,32 @@ namespace gear {
     };
   
   
+  /** scope guard to account for a worker engaged with speculative work */
+  class LoadController::Speculation
+    : util::NonCopyable
+    {
+      atomic_int64_t& cnt_;
+      
+    public:
+      Speculation (atomic_int64_t& cnt)
+        : cnt_{cnt}
+        {
+          cnt_.fetch_add (1, memory_order_relaxed);
+        }
+      
+     ~Speculation()
+        {
+          cnt_.fetch_sub (1, memory_order_relaxed);
+        }
+    };
+  
+  inline LoadController::Speculation
+  LoadController::engageSpeculation()
+  {
+    return Speculation{speculating_};
+  }
+  
+  
   
 }}// namespace vault::gear
 #endif /*SRC_VAULT_GEAR_LOAD_CONTROLLER_H_*/
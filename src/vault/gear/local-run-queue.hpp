@@ -0,0 +1,340 @@
+/*
+  LOCAL-RUN-QUEUE.hpp  -  per-worker queues of Activities already due for dispatch
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file local-run-queue.hpp
+ ** Work-stealing extension for Layer-1 of the Scheduler.
+ ** In the standard mode of operation, every worker pulling for work has to acquire
+ ** the »Grooming-Token« just to retrieve the next entry from the central priority queue.
+ ** With many cores and short jobs, most workers are thus kicked back into contention wait.
+ ** As an optional scheduling mode, some entries _already due_ can be moved out of the central
+ ** queue into a set of small per-worker _local run queues,_ from where workers can pick them
+ ** up without touching the Grooming-Token. A worker finding its own queue empty will attempt
+ ** to _steal_ from its neighbours. The central queue and the Grooming-Token remain in charge
+ ** of any planning work, entries in the future and all internal state transitions.
+ **
+ ** # Detachable work
+ ** Dispatching an Activity chain requires »management mode« up to the `WORKSTART`. However,
+ ** for a regular calculation job with an _open_ `GATE` (all prerequisites are fulfilled)
+ ** or without any gate at all, the preparatory part of the chain does not alter any state
+ ** shared with other Activities: the Gate was opened under the Grooming-Token and can not
+ ** be affected by further notifications (which only decrement a latch still holding);
+ ** follow-up notifications are passed through the lock-free entrance queue. The decision
+ ** which entries are _detachable_ is taken by Layer-2, while holding the Grooming-Token.
+ ** 
+ ** # NUMA nodes
+ ** When workers are [pinned](\ref work::Config::PIN_WORKERS) to cores, the local queues
+ ** can be grouped per NUMA node. An event tagged with a node hint is preferably placed
+ ** into a queue of that node, and a worker first looks into its own queue, then into the
+ ** other queues of its node; stealing across nodes happens only when all queues of its
+ ** own node ran dry. This way, chains of dependent jobs tend to stay on the node where
+ ** their input data was produced.
+ ** @note such entries are outside the reach of the regular queue maintenance; they are
+ **       only checked against their deadline when picked up. Since local queues are
+ **       small and hold only due entries, this gap remains confined to few µs.
+ ** @see SchedulerInvocation::distributeLocal()
+ ** @see SchedulerCommutator::findWork()
+ ** @see SchedulerInvocation_test::verify_localRunQueues()
+ ** @see SchedulerStress_test::investigate_localRunQueues()
+ */
+
+
+#ifndef SRC_VAULT_GEAR_LOCAL_RUN_QUEUE_H_
+#define SRC_VAULT_GEAR_LOCAL_RUN_QUEUE_H_
+
+
+#include "vault/common.hpp"
+#include "vault/gear/activation-event.hpp"
+#include "vault/gear/work-topology.hpp"
+#include "lib/time/timevalue.hpp"
+#include "lib/nocopy.hpp"
+#include "lib/util.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <limits>
+
+
+namespace vault{
+namespace gear {
+  
+  using lib::time::Time;
+  
+  namespace {// Internal defaults
+    const size_t LOCAL_QUEUE_CAPACITY = 16;     ///< maximum number of due entries held per worker
+    const int64_t NO_HEAD = std::numeric_limits<int64_t>::max();
+  }
+  
+  
+  /**
+   * Small bounded queue of due ActivationEvents, ordered by start time.
+   * Protected by a spin lock, since each critical section is just a
+   * handful of instructions; the earliest start time is mirrored into
+   * an atomic to allow for cheap checks without locking.
+   * @remark aligned to a cache line to prevent false sharing
+   *         between the queues of neighbouring workers.
+   */
+  class alignas(64) LocalRunQueue
+    : util::NonCopyable
+    {
+      std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+      std::atomic<int64_t> head_{NO_HEAD};
+      
+      ActivationEvent entries_[LOCAL_QUEUE_CAPACITY];
+      size_t cnt_{0};                     ///< @note sorted descending: earliest entry at the end
+      
+      
+      bool tryLock() { return not lock_.test_and_set (std::memory_order_acquire); }
+      void unlock()  { lock_.clear (std::memory_order_release); }
+      
+      void
+      lock()
+        {
+          while (not tryLock())
+            std::this_thread::yield();
+        }
+      
+      void
+      publishHead()
+        {
+          head_.store (cnt_? entries_[cnt_-1].starting : NO_HEAD
+                      ,std::memory_order_release);
+        }
+      
+      ActivationEvent
+      takeHead()
+        {
+          if (not cnt_)
+            return ActivationEvent();
+          ActivationEvent head = entries_[--cnt_];
+          publishHead();
+          return head;
+        }
+      
+    public:
+      /** @return `false` if the queue is full and the event was _not_ accepted */
+      bool
+      push (ActivationEvent event)
+        {
+          lock();
+          bool accepted = cnt_ < LOCAL_QUEUE_CAPACITY;
+          if (accepted)
+            {
+              size_t pos = cnt_++;
+              for ( ; pos > 0 and entries_[pos-1].starting < event.starting; --pos)
+                entries_[pos] = entries_[pos-1];
+              entries_[pos] = event;
+              publishHead();
+            }
+          unlock();
+          return accepted;
+        }
+      
+      /** retrieve the earliest entry, waiting for a competing thief */
+      ActivationEvent
+      pop()
+        {
+          if (empty()) return ActivationEvent();
+          lock();
+          ActivationEvent head = takeHead();
+          unlock();
+          return head;
+        }
+      
+      /** retrieve the earliest entry, but yield if another thread is active */
+      ActivationEvent
+      steal()
+        {
+          if (empty() or not tryLock())
+            return ActivationEvent();
+          ActivationEvent head = takeHead();
+          unlock();
+          return head;
+        }
+      
+      void
+      clear()
+        {
+          lock();
+          cnt_ = 0;
+          publishHead();
+          unlock();
+        }
+      
+      bool
+      empty()  const
+        {
+          return NO_HEAD == head_.load (std::memory_order_acquire);
+        }
+      
+      int64_t
+      headStart()  const
+        {
+          return head_.load (std::memory_order_acquire);
+        }
+    };
+  
+  
+  
+  /**
+   * Set of per-worker run queues with work stealing.
+   * Remains inactive until [configured](\ref #configure) with a number of slots;
+   * each thread is associated with one slot, based on a number drawn
+   * on first usage. When more threads are in use than slots are available,
+   * some slots will be shared, which is harmless but increases contention.
+   * Optionally the slots can be grouped into consecutive ranges per NUMA node;
+   * a thread then uses a slot within the group of the node it is pinned to.
+   */
+  class LocalRunQueues
+    : util::NonCopyable
+    {
+      std::unique_ptr<LocalRunQueue[]> queues_;
+      size_t slots_{0};
+      size_t nodes_{1};
+      size_t perNode_{0};
+      size_t distribute_{0};              ///< @note only touched while holding the Grooming-Token
+      
+      size_t
+      nodeOf (uint node)  const
+        {
+          return node < nodes_? node : 0;
+        }
+      
+      bool
+      distributeWithin (ActivationEvent const& event, size_t base, size_t cnt)
+        {
+          for (size_t i=0; i < cnt; ++i)
+            {
+              size_t slot = base + distribute_++ % cnt;
+              if (queues_[slot].push (event))
+                return true;
+            }
+          return false;
+        }
+      
+      /** @internal number drawn by each thread on first call */
+      static size_t
+      threadNumber()
+        {
+          static std::atomic<size_t> threadCnt{0};
+          thread_local size_t myNumber = threadCnt.fetch_add (1, std::memory_order_relaxed);
+          return myNumber;
+        }
+      
+    public:
+      /** @param nodes number of NUMA node groups to divide the slots into
+       *  @warning must not be called while workers are active */
+      void
+      configure (size_t slots, size_t nodes =1)
+        {
+          nodes = util::limited (size_t(1), nodes, util::max (slots, size_t(1)));
+          queues_.reset (slots? new LocalRunQueue[slots] : nullptr);
+          slots_ = slots;
+          nodes_ = nodes;
+          perNode_ = slots / nodes;
+          distribute_ = 0;
+        }
+      
+      explicit operator bool()  const { return 0 < slots_; }
+      size_t   size()           const { return slots_; }
+      size_t   nodeCnt()        const { return nodes_; }
+      
+      /** @return index of the local queue owned by the current thread;
+       *  workers use their worker number (resp. their rank within the node group),
+       *  while any other thread draws a number on first use */
+      size_t
+      mySlot()  const
+        {
+          REQUIRE (slots_);
+          auto& place = work::currentPlacement();
+          bool isWorker = place.worker != work::NO_WORKER;
+          if (1 == nodes_)
+            return (isWorker? place.worker : threadNumber()) % slots_;
+          return nodeOf(place.node) * perNode_ + (isWorker? place.rank : threadNumber()) % perNode_;
+        }
+      
+      /**
+       * Place a due event into the local queue of some worker.
+       * Distribution is round-robin, skipping any queues already full;
+       * events with a NUMA hint are preferably placed into the group of this node.
+       * @return `false` if no local queue was able to accept the event
+       */
+      bool
+      distribute (ActivationEvent event)
+        {
+          if (1 < nodes_ and event.numaNode < nodes_
+              and distributeWithin (event, event.numaNode * perNode_, perNode_))
+            return true;
+          return distributeWithin (event, 0, slots_);
+        }
+      
+      /**
+       * Pick up work from the local run queue of the current thread,
+       * or else attempt to steal from the neighbours' queues;
+       * queues of other NUMA nodes are only considered
+       * when all queues of the own node are empty.
+       * @return _»empty marker«_ if no work was found
+       */
+      ActivationEvent
+      pullLocal()
+        {
+          if (not slots_) return ActivationEvent();
+          size_t own = mySlot();
+          ActivationEvent found = queues_[own].pop();
+          if (1 == nodes_)
+            for (size_t i=1; not found and i < slots_; ++i)
+              found = queues_[(own+i) % slots_].steal();
+          else
+            {
+              size_t base = own - own % perNode_;
+              for (size_t i=1; not found and i < perNode_; ++i)
+                found = queues_[base + (own-base+i) % perNode_].steal();
+              for (size_t i=1; not found and i < slots_; ++i)
+                {
+                  size_t slot = (own+i) % slots_;
+                  if (slot - base >= perNode_)            // only slots of other nodes
+                    found = queues_[slot].steal();
+                }
+            }
+          return found;
+        }
+      
+      /** @return earliest start time found in any local queue (as µ-tick) */
+      int64_t
+      headStart()  const
+        {
+          int64_t head{NO_HEAD};
+          for (size_t i=0; i < slots_; ++i)
+            head = std::min (head, queues_[i].headStart());
+          return head;
+        }
+      
+      bool
+      empty()  const
+        {
+          return NO_HEAD == headStart();
+        }
+      
+      void
+      discard()
+        {
+          for (size_t i=0; i < slots_; ++i)
+            queues_[i].clear();
+        }
+    };
+  
+  
+  
+}} // namespace vault::gear
+#endif /*SRC_VAULT_GEAR_LOCAL_RUN_QUEUE_H_*/
@@ -49,6 +49,10 @@
  ** - use the [Activity Language environment](\ref ActivityLang) to _perform_
  **   the retrieved chain within some worker thread; this is called _dispatch_
  ** The main entrance point into this implementation is the #postChain function.
+ ** Workers classified as idle capacity may pick up _speculative work,_ which is kept
+ ** aside in Layer-1 and only dispatched while no regular work is due; since such a worker
+ ** then re-evaluates the situation after each speculative job, real-time work preempts
+ ** speculation at job granularity.
  ** @see SchedulerCommutator::acquireGroomingToken()
  ** @see SchedulerCommutator::findWork()
  ** @see SchedulerCommutator::postChain()
@@ -66,6 +70,7 @@
 #include "vault/gear/activity.hpp"
 #include "vault/gear/scheduler-invocation.hpp"
 #include "vault/gear/load-controller.hpp"
+#include "vault/gear/work-force.hpp"
 #include "vault/gear/activity-lang.hpp"
 #include "lib/time/timevalue.hpp"
 #include "lib/format-string.hpp"
@@ -111,11 +116,38 @@ namespace gear {
     {
       using ThreadID = std::thread::id;
       atomic<ThreadID> groomingToken_{};
+      work::ParkingLot* parking_{nullptr};
+      bool batchDispatch_{false};
+      bool shedOverload_{false};
       
       
     public:
       SchedulerCommutator()  = default;
       
+      /** use the given ParkingLot for targeted sleep,
+       *  allowing workers to be woken up by new work */
+      void
+      attachParking (work::ParkingLot& parking)
+        {
+          parking_ = &parking;
+        }
+      
+      /** dequeue several due entries per Grooming-Token acquisition,
+       *  with the batch size adapted by the LoadController */
+      void
+      useBatchDispatch (bool yes =true)
+        {
+          batchDispatch_ = yes;
+        }
+      
+      /** in overload, discard regular entries lacking slack early,
+       *  using the margin indicated by the LoadController */
+      void
+      useOverloadShedding (bool yes =true)
+        {
+          shedOverload_ = yes;
+        }
+      
       /**
        * acquire the right to perform internal state transitions.
        * @return `true` if this attempt succeeded
@@ -185,6 +217,7 @@ namespace gear {
         {
           ENSURE (holdsGroomingToken (thisThread()));
           layer1.feedPrioritisation();
+          layer1.advanceTo (now);
           while (layer1.isOutdated (now) and not layer1.isOutOfTime(now))
             layer1.pullHead();
           return not layer1.isOutOfTime(now);
@@ -194,25 +227,141 @@ namespace gear {
        * Look into the queues and possibly retrieve work due by now.
        * @note transparently discards any outdated entries,
        *       but blocks if a compulsory entry becomes outdated.
+       * @param batch number of due entries to dequeue while holding the token;
+       *       besides the entry returned, further detachable entries are
+       *       placed into the hand-off slots, unless using local run queues.
+       * @param shedMargin in overload, regular entries which can not be started
+       *       within their deadline, allowing for this margin, are discarded.
+       * @remark when Layer-1 is configured with local run queues, work can be
+       *       picked up from there without acquiring the Grooming-Token; a thread
+       *       holding the token will in turn distribute further due entries.
+       *       The same holds for entries passed through the hand-off slots.
        */
       ActivationEvent
-      findWork (SchedulerInvocation& layer1, Time now)
+      findWork (SchedulerInvocation& layer1, Time now
+               ,size_t batch =1, Offset shedMargin =Offset::ZERO)
         {
+          if (not holdsGroomingToken (thisThread()))
+            {
+              if (layer1.hasLocalWork())
+                if (ActivationEvent localWork = layer1.pullLocal (now))
+                  return localWork;
+              if (layer1.hasHandoffWork())
+                if (ActivationEvent handed = layer1.pullHandoff (now))
+                  return handed;
+            }
           if (holdsGroomingToken (thisThread())
               or acquireGoomingToken())
             {
               layer1.feedPrioritisation();
-              while (layer1.isOutdated (now) and not layer1.isOutOfTime(now))
+              layer1.advanceTo (now);
+              while ((layer1.isOutdated (now) or layer1.lacksSlack (now, shedMargin))
+                     and not layer1.isOutOfTime(now))
                 layer1.pullHead();
               if (not maintainQueueHead (layer1,now))
                 ALERT (engine, "MISSED compulsory job -- should raise Scheduler-Emergency");   //////////////TICKET #1362 : not clear where Scheduler-Emergency is to be handled and how it can be triggered. See Scheduler::triggerEmergency()
               else
               if (layer1.isDue (now))
-                return layer1.pullHead();
+                {
+                  ActivationEvent head = layer1.pullHead();
+                  if (layer1.hasLocalQueues())
+                    distributeDueWork (layer1, now);
+                  else
+                  if (1 < batch)
+                    handOffDueWork (layer1, now, batch-1);
+                  return head;
+                }
             }
           return ActivationEvent();
         }
       
+      /**
+       * Retrieve speculative work to employ idle capacity.
+       * @return _»empty marker«_ if there is no speculative work viable by now,
+       *       or if some regular work became due, which takes precedence.
+       * @note may leave the current thread holding the Grooming-Token
+       */
+      ActivationEvent
+      findIdleWork (SchedulerInvocation& layer1, Time now)
+        {
+          if (layer1.hasSpeculativeWork()
+              and (holdsGroomingToken (thisThread())
+                   or acquireGoomingToken()))
+            {
+              layer1.feedPrioritisation();
+              if (not layer1.isDue (now))
+                return layer1.pullSpeculative (now);
+            }
+          return ActivationEvent();
+        }
+      
+      /**
+       * Move further entries due by now into the local run queues,
+       * as long as these can be dispatched without Grooming-Token.
+       * @remark at most one entry per local queue in each round,
+       *         to keep the time spent in »grooming mode« short.
+       */
+      void
+      distributeDueWork (SchedulerInvocation& layer1, Time now)
+        {
+          ENSURE (holdsGroomingToken (thisThread()));
+          for (size_t cnt=0; cnt < layer1.localQueueSlots(); ++cnt)
+            if (not (maintainQueueHead (layer1,now)
+                     and layer1.isDue (now)
+                     and isDetachable (layer1.peekHead(), now)
+                     and layer1.distributeLocal()))
+              break;
+        }
+      
+      /**
+       * Pass up to `cnt` further entries due by now into the hand-off slots,
+       * as long as these can be dispatched without Grooming-Token,
+       * and wake up parked workers to pick them up.
+       * @return number of entries handed off
+       */
+      size_t
+      handOffDueWork (SchedulerInvocation& layer1, Time now, size_t cnt)
+        {
+          ENSURE (holdsGroomingToken (thisThread()));
+          size_t handed{0};
+          while (handed < cnt
+                 and maintainQueueHead (layer1,now)
+                 and layer1.isDue (now)
+                 and isDetachable (layer1.peekHead(), now)
+                 and layer1.handOff())
+            ++handed;
+          if (handed and parking_)
+            parking_->wakeUp (handed);
+          return handed;
+        }
+      
+      /**
+       * Determine if dispatching the given chain requires »grooming mode«.
+       * This is _not_ the case for a regular job chain (POST ⟶ WORKSTART)
+       * or when an intermediary `GATE` is already open (all prerequisites
+       * fulfilled); the Gate can then not be altered by further notifications.
+       * Compulsory entries are always left to the central queue, in order
+       * to retain the emergency detection.
+       * @warning can only be decided while holding the Grooming-Token
+       */
+      static bool
+      isDetachable (ActivationEvent const& event, Time now)
+        {
+          if (not event or event.isCompulsory)
+            return false;
+          Activity* chain = event.activity;
+          if (not chain->is (Activity::POST))
+            return false;
+          Activity* next = chain->next;
+          if (next and next->is (Activity::GATE))
+            {
+              if (not next->data_.condition.isFree (now))
+                return false;
+              next = next->next;
+            }
+          return next and next->is (Activity::WORKSTART);
+        }
+      
       
       
       /***********************************************************//**
@@ -225,9 +374,11 @@ namespace gear {
        *       - activity::PASS continue processing in regular operation
        *       - activity::WAIT nothing to do now, check back later
        *       - activity::HALT serious problem, cease processing
-       * @note Never attempts to acquire the GroomingToken itself,
+       * @note Normally does not attempt to acquire the GroomingToken,
        *       but if current thread holds the token, the task can
-       *       be placed directly into the scheduler queue.
+       *       be placed directly into the scheduler queue. Only when
+       *       the (bounded) entrance queue is full, the current thread
+       *       contends for the token to drain the entrance itself.
        */
       activity::Proc
       postChain (ActivationEvent event, SchedulerInvocation& layer1)
@@ -235,7 +386,38 @@ namespace gear {
           if (holdsGroomingToken (thisThread()))
             layer1.feedPrioritisation (move (event));
           else
-            layer1.instruct (move (event));
+          if (not layer1.tryInstruct (event))
+            {
+              while (not acquireGoomingToken())
+                std::this_thread::sleep_for (GROOMING_WAIT_CYCLE);
+              layer1.feedPrioritisation();
+              layer1.feedPrioritisation (move (event));
+              dropGroomingToken();
+            }
+          return activity::PASS;
+        }
+      
+      /**
+       * Place a batch of events into the schedule at once: the entrance capacity
+       * is claimed by a single atomic operation; only when the entrance can not
+       * accommodate the batch, the Grooming-Token is acquired once for all events.
+       */
+      activity::Proc
+      postChains (ActivationEvent const* events, size_t cnt, SchedulerInvocation& layer1)
+        {
+          if (holdsGroomingToken (thisThread()))
+            for (size_t i=0; i<cnt; ++i)
+              layer1.feedPrioritisation (events[i]);
+          else
+          if (not layer1.tryInstruct (events, cnt))
+            {
+              while (not acquireGoomingToken())
+                std::this_thread::sleep_for (GROOMING_WAIT_CYCLE);
+              layer1.feedPrioritisation();
+              for (size_t i=0; i<cnt; ++i)
+                layer1.feedPrioritisation (events[i]);
+              dropGroomingToken();
+            }
           return activity::PASS;
         }
 
@@ -301,6 +483,7 @@ namespace gear {
    * @remarks this function is invoked from within the worker thread(s) and will
    *   - decide if and how the capacity of this worker shall be used right now
    *   - possibly go into a short targeted wait state to redirect capacity at a better time point
+   *   - or employ idle capacity for speculative work, while no regular work is due
    *   - and most notably commence with dispatch of render Activities, to calculate media data.
    * @return an instruction for the work::Worker how to proceed next:
    *   - activity::PASS causes the worker to poll again immediately
@@ -323,18 +506,33 @@ namespace gear {
                                         ,CLOCK getSchedTime
                                         )
   {
+    auto employCapacity = [&](Time now, Time head, LoadController::Capacity capacity)
+                            {
+                              if (LoadController::isIdle (capacity)
+                                  and loadController.allowsSpeculation())
+                                if (ActivationEvent idleWork = findIdleWork (layer1, now))
+                                  {
+                                    auto speculation = loadController.engageSpeculation();
+                                    activity::Proc res = executeActivity (idleWork);
+                                    return activity::PASS == res? activity::SKIP  // re-assess capacity
+                                                                : res;            // before further work
+                                  }
+                              return scatteredDelay(now, head, loadController, capacity);
+                            };
     try {
         auto res = WorkerInstruction{}
                       .performStep([&]{
                                         maybeFeed(layer1);
                                         Time now = getSchedTime();
                                         Time head = layer1.headTime();
-                                        return scatteredDelay(now, head, loadController,
+                                        return employCapacity(now, head,
                                                   loadController.markIncomingCapacity (head,now));
                                       })
                       .performStep([&]{
                                         Time now = getSchedTime();
-                                        auto toDispatch = findWork (layer1,now);
+                                        size_t batch = batchDispatch_? loadController.dispatchBatchSize() : 1;
+                                        Offset margin = shedOverload_? loadController.shedMargin() : Offset::ZERO;
+                                        auto toDispatch = findWork (layer1,now, batch, margin);
                                         if (not toDispatch) return activity::KICK; // contention
                                         return executeActivity (toDispatch);
                                       })
@@ -342,7 +540,7 @@ namespace gear {
                                         maybeFeed(layer1);
                                         Time now = getSchedTime();
                                         Time head = layer1.headTime();
-                                        return scatteredDelay(now, head, loadController,
+                                        return employCapacity(now, head,
                                                   loadController.markOutgoingCapacity (head,now));
                                       });
         
@@ -383,7 +581,11 @@ namespace gear {
             ensureDroppedGroomingToken();
             // relocate this thread(capacity) to a time where its more useful
             Offset targetedDelay = loadController.scatteredDelayTime (now, capacity);
-            std::this_thread::sleep_for (std::chrono::microseconds (_raw(targetedDelay)));
+            auto delay = std::chrono::microseconds (_raw(targetedDelay));
+            if (parking_)
+              parking_->park (delay);
+            else
+              std::this_thread::sleep_for (delay);
           };
     auto doTendNextHead = [&]
           {
@@ -21,17 +21,82 @@
 
 #include "lib/error.h"
 #include "vault/gear/scheduler-frontend.hpp"
+#include "vault/gear/scheduler.hpp"
+
+#include <vector>
+
 
 namespace vault{
 namespace gear {
   
-  
   /** storage for the (singleton) scheduler access frontend */
   lib::Depend<SchedulerFrontend> SchedulerFrontend::instance;
   
   
   
   
+  void
+  SchedulerFrontend::connect (Scheduler& scheduler, ManifestationID manID)
+  {
+    scheduler_ = &scheduler;
+    manID_ = manID;
+  }
+  
+  void
+  SchedulerFrontend::disconnect()
+  {
+    scheduler_ = nullptr;
+  }
+  
+  
+  /**
+   * @internal post all jobs of the transaction into the Scheduler.
+   * A ScheduleSpec is built for each entry, to start at the planned start time;
+   * entries without a planned start may be started right away. Prerequisites are
+   * linked by NOTIFY to their dependent jobs, which thus need not be posted explicitly,
+   * since they will be triggered when the last prerequisite is completed. All other
+   * jobs are handed over with a single batch entrance operation into the Scheduler.
+   * Jobs to be performed in background are scheduled as _speculative work._
+   * @throw error::State when not connected to a Scheduler
+   */
+  void
+  SchedulerFrontend::commit (JobTransaction& tx)
+  {
+    if (not scheduler_)
+      throw error::State ("No Scheduler connected to accept the job transaction");
+    
+    Time now = RealClock::now();
+    std::vector<ScheduleSpec> specs;
+    std::vector<bool> isDependent(tx.size(), false);
+    specs.reserve (tx.size());
+    for (size_t i=0; i < tx.size(); ++i)
+      {
+        auto& entry = tx[i];
+        auto spec = scheduler_->defineSchedule(entry.job)
+                               .manifestation(manID_)
+                               .startTime(entry.start == Time::ANYTIME? now : Time{entry.start});
+        if (JobTransaction::TIMEBOUND == entry.mode)
+          spec = spec.deadline(entry.deadline);
+        else
+          spec = spec.lifeWindow(FREEWHEELING_WINDOW)
+                     .speculative(JobTransaction::BACKGROUND == entry.mode);
+        specs.emplace_back (move (spec));
+      }
+    for (auto [pre,dep] : tx.links())
+      {
+        specs[pre].linkToSuccessor (specs[dep]);
+        isDependent[dep] = true;
+      }
+    std::vector<ScheduleSpec> entrance;
+    entrance.reserve (specs.size());
+    for (size_t i=0; i < specs.size(); ++i)
+      if (not isDependent[i])
+        entrance.emplace_back (move (specs[i]));
+    scheduler_->postBatch (entrance);
+  }               // dependent jobs will be triggered by NOTIFY
+  
+  
+  
   /**
    * Switch the complete engine into diagnostics mode.
    * This activates additional logging and reporting facilities,
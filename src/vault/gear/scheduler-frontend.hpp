@@ -30,12 +30,20 @@
 #include "lib/depend.hpp"
 #include "lib/time/timevalue.hpp"
 #include "vault/gear/job.h"
+#include "vault/gear/activity.hpp"
+
+#include <utility>
+#include <vector>
+#include <chrono>
 
 
 namespace vault{
 namespace gear {
   
   using lib::time::Time;
+  using lib::time::TimeVar;
+  
+  class Scheduler;
   
   
   /**
@@ -64,6 +72,9 @@ namespace gear {
        */
       static lib::Depend<SchedulerFrontend> instance;
       
+      /** time window to allow for jobs without specific deadline, starting at commit */
+      static constexpr std::chrono::seconds FREEWHEELING_WINDOW{10};
+      
       
       /**
        * Definition context for jobs to be scheduled.
@@ -71,11 +82,28 @@ namespace gear {
        * and to attach a transaction for prerequisite jobs.
        * When done, the #commit operation can be used
        * to activate all jobs defined this far.
+       * @remark job definitions are collected into a flat array, which can be
+       *         pre-sized with #reserve; dependencies are recorded as links
+       *         between entries, and established when committing.
        */
       class JobTransaction
         {
-          SchedulerFrontend* sched_;
+        public:
+          enum Mode { TIMEBOUND, BACKGROUND, FREEWHEELING };
+          
+          struct Entry
+            {
+              Job  job;
+              TimeVar start;      ///< planned start, or Time::ANYTIME to start at commit
+              TimeVar deadline;
+              Mode mode;
+            };
+          using Link = std::pair<size_t,size_t>;   ///< (prerequisite, dependent)
           
+        private:
+          SchedulerFrontend* sched_;
+          std::vector<Entry> entries_;
+          std::vector<Link>  links_;
           
           JobTransaction (SchedulerFrontend* s)
             : sched_(s)
@@ -92,11 +120,14 @@ namespace gear {
            *  and all dependent transactions will be scheduled
            * @note transaction should not be used beyond this point;
            *       contents and data structures are cleared right away;
+           * @throw error::State when no Scheduler is connected
            */
           void
           commit()
             {
-              UNIMPLEMENTED ("feed all the attached jobs and transactions to the scheduler");
+              sched_->commit (*this);
+              entries_.clear();
+              links_.clear();
             }
           
           /** define a render job
@@ -104,7 +135,15 @@ namespace gear {
           JobTransaction&
           addJob (Time deadline, Job const& job)
             {
-              UNIMPLEMENTED ("a mock implementation for adding a single job; change this later to talk to the real scheduler");
+              return addJob (Time::ANYTIME, deadline, job);
+            }
+          
+          /** define a render job for time-bound calculation,
+           *  not to be started before the planned start time */
+          JobTransaction&
+          addJob (Time start, Time deadline, Job const& job)
+            {
+              entries_.push_back (Entry{job, start, deadline, TIMEBOUND});
               return *this;
             }
           
@@ -112,7 +151,7 @@ namespace gear {
           JobTransaction&
           addBackground (Job const& job)
             {
-              UNIMPLEMENTED ("a mock implementation for adding a single background job; change this later to talk to the real scheduler");
+              entries_.push_back (Entry{job, Time::ANYTIME, Time::NEVER, BACKGROUND});
               return *this;
             }
           
@@ -123,22 +162,42 @@ namespace gear {
           JobTransaction&
           addFreewheeling (Job const& job)
             {
-              UNIMPLEMENTED ("a mock implementation for adding a single job for immediate calculation; change this later to talk to the real scheduler");
+              entries_.push_back (Entry{job, Time::ANYTIME, Time::NEVER, FREEWHEELING});
+              return *this;
+            }
+          
+          /** mark the job defined last as prerequisite
+           *  of a job defined earlier within this transaction
+           * @param dependentEntry index number of the dependent job
+           */
+          JobTransaction&
+          prerequisiteOf (size_t dependentEntry)
+            {
+              REQUIRE (not entries_.empty() and dependentEntry < entries_.size()-1);
+              links_.emplace_back (entries_.size()-1, dependentEntry);
               return *this;
             }
           
           /**
-           * define a set of prerequisites of the current JobTransaction.
+           * define a set of prerequisites of the job defined last in this transaction.
            * @param prerequisites a set of job definitions, which need to be executed
-           *        successfully before any job of the current JobTransaction may be
-           *        invoked.
+           *        successfully before this job may be invoked; those without a
+           *        dependent within the prerequisite transaction are linked to this job.
            * @note prerequisites may be nested recursively, a prerequisite transaction
            *        might rely on further prerequisites
            */
           JobTransaction&
           attach (JobTransaction const& prerequisites)
             {
-              UNIMPLEMENTED ("a mock implementation for adding a tree of prerequisite jobs; change this later to talk to the real scheduler");
+              REQUIRE (not entries_.empty(), "prerequisites require a dependent job");
+              size_t offset = entries_.size();
+              size_t dependent = offset-1;
+              entries_.insert (entries_.end(), prerequisites.entries_.begin(), prerequisites.entries_.end());
+              for (auto [pre,dep] : prerequisites.links_)
+                links_.emplace_back (pre+offset, dep+offset);
+              for (size_t pre=0; pre < prerequisites.size(); ++pre)
+                if (not prerequisites.hasDependent (pre))
+                  links_.emplace_back (pre+offset, dependent);
               return *this;
             }
           
@@ -148,6 +207,28 @@ namespace gear {
               return JobTransaction(sched_);
             }
           
+          /** pre-allocate storage for the given number of job definitions */
+          JobTransaction&
+          reserve (size_t cntJobs)
+            {
+              entries_.reserve (cntJobs);
+              links_.reserve (cntJobs);
+              return *this;
+            }
+          
+          size_t size()  const { return entries_.size(); }
+          Entry const& operator[] (size_t i)  const { return entries_[i]; }
+          std::vector<Link> const& links()  const { return links_; }
+          
+        private:
+          bool
+          hasDependent (size_t entry)  const
+            {
+              for (auto& link : links_)
+                if (link.first == entry)
+                  return true;
+              return false;
+            }
         };
       
       
@@ -158,6 +239,10 @@ namespace gear {
         }
       
       
+      /** hand over committed transactions to the given Scheduler instance */
+      void connect (Scheduler&, ManifestationID =ManifestationID());
+      void disconnect();
+      
       ///// TODO: find out about further public operations
        
       
@@ -168,7 +253,10 @@ namespace gear {
       friend class SchedulerDiagnostics;
       
     private:
+      Scheduler* scheduler_{nullptr};
+      ManifestationID manID_{};
       
+      void commit (JobTransaction&);
     };
 
 }} // namespace vault::gear
@@ -19,11 +19,19 @@
  ** on Activity records maintained elsewhere, in the \ref BlockFlow allocation scheme.
  ** Layer-2 adds the ability to _perform_ these _Render Activities,_ constituting a
  ** low-level execution language. Since the services of the Scheduler are used in
- ** a multi-threaded context, new entries will be passed in through an lock-free
- ** _Instruction Queue._ The actual time based prioritisation is achieved by the
- ** use of a _Priority Queue_ — which however must be concurrency protected.
- ** The Layer-2 thus assures that _mutating operations_ are performed
- ** exclusively from a special »grooming mode« (management mode).
+ ** a multi-threaded context, new entries will be passed in through a lock-free
+ ** _Instruction Queue_ with fixed capacity (\ref InstructQueue). The actual time
+ ** based prioritisation is achieved by the use of a _Priority Queue_ — which however
+ ** must be concurrency protected. The Layer-2 thus assures that _mutating operations_
+ ** are performed exclusively from a special »grooming mode« (management mode).
+ ** As alternative to the binary heap, a [calendar queue](\ref CalendarQueue)
+ ** can be selected as prioritisation backend, to achieve constant-time insertion
+ ** and removal even with a schedule holding several thousand entries.
+ ** Optionally, entries already due can be relocated into a set of
+ ** [local run queues](\ref LocalRunQueues), which are concurrency safe
+ ** and allow workers to pick up work without entering grooming mode.
+ ** Similarly, with batched dispatch, a few due entries can be passed
+ ** through [hand-off slots](\ref HandoffSlots) to other workers.
  ** @par Data maintained in Queue Entries
  **   - the [Activity itself](\ref SchedulerInvocation::ActOrder::activity)
  **     is allocated externally an only referred by pointer; however, this
@@ -37,9 +45,14 @@
  **     which allows to filter out complete _families_ of already planned entries
  **   - as a safety measure, an entry can be marked as
  **     [compulsory](\ref SchedulerInvocation::ActOrder::isCompulsory).
- **     In regular operation, this has no effect, but an *emergency state*
- **     is triggered in the SchedulerService, should such an entry
- **     [miss it's deadline](\ref SchedulerInvocation::isOutOfTime())
+ **     Such entries are kept in a separate _priority lane,_ which is checked
+ **     first: once due, a compulsory entry is served before any regular entry.
+ **     An *emergency state* is triggered in the SchedulerService, should such
+ **     an entry [miss it's deadline](\ref SchedulerInvocation::isOutOfTime())
+ **   - entries with the same start time are served _earliest deadline first_
+ **   - entries marked as [speculative](\ref SchedulerInvocation::pullSpeculative())
+ **     are kept aside in a separate queue and do not count for the head time;
+ **     Layer-2 picks them up only with idle capacity, when no regular work is due.
  ** @see SchedulerCommutator::findWork()
  ** @see SchedulerCommutator::postChain()
  ** @see SchedulerInvocation_test
@@ -55,11 +68,16 @@
 #include "vault/common.hpp"
 #include "lib/nocopy.hpp"
 #include "vault/gear/activity.hpp"
+#include "vault/gear/activation-event.hpp"
+#include "vault/gear/instruct-queue.hpp"
+#include "vault/gear/calendar-queue.hpp"
+#include "vault/gear/local-run-queue.hpp"
+#include "vault/gear/handoff-slots.hpp"
 #include "lib/time/timevalue.hpp"
 #include "lib/util.hpp"
 
 #include <queue>
-#include <boost/lockfree/queue.hpp>
+#include <atomic>
 #include <unordered_set>
 #include <utility>
 
@@ -67,80 +85,23 @@ namespace vault{
 namespace gear {
   
   using lib::time::Time;
+  using lib::time::Offset;
   using std::move;
   
   namespace error = lumiera::error;
   
   namespace {// Internal defaults
-    const size_t INITIAL_CAPACITY = 128;
+    const size_t ENTRANCE_CAPACITY = 1024;    ///< default capacity of the entrance queue
   }
   
-  /**
-   * @internal data record passed through the queues,
-   *           representing an event to be scheduled
-   */
-  struct ActivationEvent
-    {
-      Activity* activity;
-      int64_t   starting;
-      int64_t   deadline;
-      
-      uint32_t  manifestation :32;
-      bool      isCompulsory  :1;
-      
-      ActivationEvent()
-        : activity{nullptr}
-        , starting{_raw(Time::ANYTIME)}
-        , deadline{_raw(Time::NEVER)}
-        , manifestation{0}
-        , isCompulsory{false}
-        { }
-
-      ActivationEvent(Activity& act, Time when
-                                   , Time dead =Time::NEVER
-                                   , ManifestationID manID =ManifestationID()
-                                   , bool compulsory =false)
-        : activity{&act}
-        , starting{_raw(act.constrainedStart(when))}
-        , deadline{_raw(act.constrainedDeath(dead))}
-        , manifestation{manID}
-        , isCompulsory{compulsory}
-        { }
-       // default copy operations acceptable
-      
-      /** @internal ordering function for time based scheduling
-       *  @note reversed order as required by std::priority_queue
-       *        to get the earliest element at top of the queue
-       */
-      bool
-      operator< (ActivationEvent const& o)  const
-        {
-          return starting > o.starting;
-        }
-      
-      operator bool()      const { return bool{activity}; }
-      operator Activity*() const { return activity; }
-      
-      Time startTime()     const { return Time{TimeValue{starting}};}
-      Time deathTime()     const { return Time{TimeValue{deadline}};}
-      
-      void
-      refineTo (Activity* chain, Time when, Time dead)
-        {
-          activity = chain;
-          starting = _raw(activity->constrainedStart (when.isRegular()? when:startTime()));
-          deadline = _raw(activity->constrainedDeath (dead.isRegular()? dead:deathTime()));
-        }
-    };
-  
-  
-  
-  
   /***************************************************//**
    * Scheduler Layer-1 : time based dispatch.
    * Manages pointers to _Render Activity records._
    * - new entries passed in through the #instruct_ queue
-   * - time based prioritisation in the #priority_ queue
+   * - time based prioritisation in the #priority_ queue,
+   *   using either a binary heap or a CalendarQueue
+   * - optionally some due entries can be moved to #local_ run queues
+   * - speculative entries wait in the #speculative_ queue for idle capacity
    * @warning not threadsafe; requires Layer-2 to coordinate.
    * @see Scheduler
    * @see SchedulerInvocation_test
@@ -148,19 +109,148 @@ namespace gear {
   class SchedulerInvocation
     : util::NonCopyable
     {
-      using InstructQueue = boost::lockfree::queue<ActivationEvent>;
-      using PriorityQueue = std::priority_queue<ActivationEvent>;
+      using Entrance      = InstructQueue<ActivationEvent>;
       using ActivationSet = std::unordered_set<ManifestationID>;
       
-      InstructQueue instruct_;
+      /** time prioritisation backend: binary heap or calendar queue,
+       *  complemented by a priority lane for compulsory entries.
+       * @note the earliest start time is mirrored into an atomic after each
+       *       mutation, since workers without Grooming-Token need to know
+       *       the head time, while the storage may be reallocated meanwhile.
+       */
+      class PriorityQueue
+        {
+          std::priority_queue<ActivationEvent> heap_;
+          CalendarQueue calendar_;
+          std::priority_queue<ActivationEvent> lane_;
+          bool useCalendar_{false};
+          bool useLane_{true};
+          int64_t level_{_raw(Time::ANYTIME)};     ///< current time as last observed by Layer-2
+          std::atomic<int64_t> head_{NO_HEAD};     ///< mirror of the earliest start time
+          
+          bool
+          mainEmpty()  const
+            {
+              return useCalendar_? calendar_.empty() : heap_.empty();
+            }
+          
+          ActivationEvent const&
+          mainTop()  const
+            {
+              return useCalendar_? calendar_.top() : heap_.top();
+            }
+          
+          /** compulsory entries take precedence once due */
+          bool
+          laneFirst()  const
+            {
+              if (lane_.empty()) return false;
+              if (mainEmpty())   return true;
+              return lane_.top().starting <= level_
+                  or not (lane_.top() < mainTop());
+            }
+          
+          /** @internal update the head time mirror
+           * @warning must hold the Grooming-Token */
+          void
+          publishHead()
+            {
+              int64_t head = mainEmpty()? NO_HEAD : mainTop().starting;
+              if (not lane_.empty())
+                head = std::min (head, lane_.top().starting);
+              head_.store (head, std::memory_order_release);
+            }
+          
+        public:
+          void
+          selectCalendar (bool yes)
+            {
+              REQUIRE (empty(), "switch prioritisation backend with pending schedule");
+              useCalendar_ = yes;
+            }
+          
+          void
+          selectLane (bool yes)
+            {
+              REQUIRE (empty(), "switch priority lane with pending schedule");
+              useLane_ = yes;
+            }
+          
+          void advance (int64_t level) { level_ = level; }
+          
+          bool isCalendar() const { return useCalendar_; }
+          bool hasLane()    const { return useLane_; }
+          bool empty()      const { return mainEmpty() and lane_.empty(); }
+          
+          ActivationEvent const&
+          top()  const
+            {
+              return laneFirst()? lane_.top() : mainTop();
+            }
+          
+          void
+          push (ActivationEvent const& event)
+            {
+              if (useLane_ and event.isCompulsory)
+                lane_.push (event);
+              else
+              if (useCalendar_)
+                calendar_.push (event);
+              else
+                heap_.push (event);
+              publishHead();
+            }
+          
+          void
+          pop()
+            {
+              if (laneFirst())
+                lane_.pop();
+              else
+              if (useCalendar_)
+                calendar_.pop();
+              else
+                heap_.pop();
+              publishHead();
+            }
+          
+          void
+          clear()
+            {
+              heap_ = std::priority_queue<ActivationEvent>();
+              lane_ = std::priority_queue<ActivationEvent>();
+              calendar_.clear();
+              publishHead();
+            }
+          
+          /** @return earliest start time in any lane
+           * @remark can be used concurrently _without_ Grooming-Token */
+          int64_t
+          headStart()  const
+            {
+              return head_.load (std::memory_order_acquire);
+            }
+        };
+      
+      Entrance instruct_;
       PriorityQueue priority_;
+      LocalRunQueues local_;
+      HandoffSlots handoff_;
+      std::priority_queue<ActivationEvent> speculative_;
+      std::atomic<int64_t> specHead_{NO_HEAD};     ///< mirror of the earliest speculative start
       
       ActivationSet allowed_;
       
     public:
-      SchedulerInvocation()
-        : instruct_{INITIAL_CAPACITY}
+      /** @param entranceCapacity number of new entries
+       *         the entrance can hold before being drained */
+      explicit
+      SchedulerInvocation (size_t entranceCapacity =ENTRANCE_CAPACITY)
+        : instruct_{entranceCapacity}
         , priority_{}
+        , local_{}
+        , handoff_{}
+        , speculative_{}
         , allowed_{}
         { }
       
@@ -169,33 +259,142 @@ namespace gear {
       void
       discardSchedule()
         {
-          instruct_.consume_all([](auto&){/*obliterate*/});
-          priority_ = PriorityQueue();
+          instruct_.clear();
+          priority_.clear();
+          local_.discard();
+          handoff_.clear();
+          speculative_ = std::priority_queue<ActivationEvent>();
+          publishSpeculation();
+        }
+      
+      
+      /**
+       * Select the CalendarQueue as backend for time prioritisation,
+       * instead of the default binary heap.
+       * @warning can only be switched while the schedule is empty
+       */
+      void
+      useCalendarQueue (bool yes =true)
+        {
+          priority_.selectCalendar (yes);
+        }
+      
+      bool
+      isCalendarQueue()  const
+        {
+          return priority_.isCalendar();
+        }
+      
+      /**
+       * Keep compulsory entries in a separate priority lane (default).
+       * Once due, such entries are served before any regular entry.
+       * @warning can only be switched while the schedule is empty
+       */
+      void
+      useCompulsoryLane (bool yes =true)
+        {
+          priority_.selectLane (yes);
+        }
+      
+      bool
+      hasCompulsoryLane()  const
+        {
+          return priority_.hasLane();
+        }
+      
+      /**
+       * Inform about current time, to decide if entries in the priority lane
+       * are due and thus take precedence. Layer-2 invokes this function when
+       * starting to maintain the queue head in »grooming mode«.
+       */
+      void
+      advanceTo (Time now)
+        {
+          priority_.advance (waterLevel (now));
+        }
+      
+      
+      /**
+       * Switch to work-stealing mode, with a set of local run queues
+       * @param slots number of local queues, typically one per worker
+       * @param nodes number of NUMA node groups to divide these queues into
+       * @warning must not be changed while workers are active
+       */
+      void
+      useLocalQueues (size_t slots, size_t nodes =1)
+        {
+          local_.configure (slots, nodes);
+        }
+      
+      size_t
+      localQueueSlots()  const
+        {
+          return local_.size();
+        }
+      
+      bool
+      hasLocalQueues()  const
+        {
+          return bool(local_);
         }
       
       
       /**
        * Accept an ActivationEvent with an Activity for time-bound execution
+       * @throw error::Fatal when the entrance capacity is exhausted
        */
       void
       instruct (ActivationEvent actEvent)
         {
-          bool success = instruct_.push (move (actEvent));
-          if (not success)
-            throw error::Fatal{"Scheduler entrance: memory allocation failed"};
+          if (not tryInstruct (actEvent))
+            throw error::Fatal{"Scheduler entrance: queue overflow"};
+        }
+      
+      /** @return `false` if the entrance is full and must be drained first */
+      bool
+      tryInstruct (ActivationEvent const& actEvent)
+        {
+          return instruct_.push (actEvent);
+        }
+      
+      /**
+       * Accept a batch of ActivationEvents at once,
+       * reserving entrance capacity with a single atomic operation.
+       */
+      void
+      instruct (ActivationEvent const* actEvents, size_t cnt)
+        {
+          if (not tryInstruct (actEvents, cnt))
+            throw error::Fatal{"Scheduler entrance: queue overflow"};
+        }
+      
+      /** @return `false` if the entrance can not accept the complete batch */
+      bool
+      tryInstruct (ActivationEvent const* actEvents, size_t cnt)
+        {
+          return cnt <= instruct_.capacity()
+             and instruct_.push (actEvents, cnt);
+        }
+      
+      size_t
+      entranceCapacity()  const
+        {
+          return instruct_.capacity();
         }
       
       
       /**
        * Pick up all new events from the entrance queue
        * and enqueue them to be retrieved ordered by start time.
+       * @return number of events moved into prioritisation
        */
-      void
+      size_t
       feedPrioritisation()
         {
-          ActivationEvent actEvent;
-          while (instruct_.pop (actEvent))
-            priority_.push (move (actEvent));
+          return instruct_.drain ([this](ActivationEvent& actEvent)
+                                    {
+                                      enqueue (actEvent);
+                                    });
         }
       
       
@@ -207,7 +406,7 @@ namespace gear {
       void
       feedPrioritisation (ActivationEvent actEvent)
         {
-          priority_.push (move (actEvent));
+          enqueue (actEvent);
         }
       
       
@@ -237,6 +436,68 @@ namespace gear {
           return head;
         }
       
+      /**
+       * Move the entry at the head of the priority queue into some local run queue,
+       * from where it can be retrieved by any worker without the Grooming-Token.
+       * @return `false` if not possible, because all local queues are full
+       * @remark Layer-2 has to decide if the head entry is suitable for local dispatch.
+       */
+      bool
+      distributeLocal()
+        {
+          REQUIRE (hasLocalQueues() and not priority_.empty());
+          bool accepted = local_.distribute (priority_.top());
+          if (accepted)
+            priority_.pop();
+          return accepted;
+        }
+      
+      /**
+       * Retrieve a due entry from the local run queue of the current thread,
+       * or steal one from another local queue; entries missing their deadline
+       * are silently discarded. Can be used concurrently _without_ Grooming-Token.
+       * @return _»empty marker«_ if no local work is available right now
+       */
+      ActivationEvent
+      pullLocal (Time now)
+        {
+          ActivationEvent local = local_.pullLocal();
+          while (local and waterLevel(now) > local.deadline)
+            local = local_.pullLocal();
+          return local;
+        }
+      
+      /**
+       * Move the head entry (which must be due) into a hand-off slot,
+       * to be picked up by some worker without the Grooming-Token.
+       * @return `false` if all slots are occupied, leaving the entry in place
+       * @warning must hold the Grooming-Token
+       */
+      bool
+      handOff()
+        {
+          REQUIRE (not priority_.empty());
+          bool accepted = handoff_.offer (priority_.top());
+          if (accepted)
+            priority_.pop();
+          return accepted;
+        }
+      
+      /**
+       * Pick up an entry handed off from a batched dispatch; entries
+       * missing their deadline are silently discarded. Can be used
+       * concurrently _without_ Grooming-Token.
+       * @return _»empty marker«_ if no such work is available right now
+       */
+      ActivationEvent
+      pullHandoff (Time now)
+        {
+          ActivationEvent handed = handoff_.take();
+          while (handed and waterLevel(now) > handed.deadline)
+            handed = handoff_.take();
+          return handed;
+        }
+      
       /**
        * Enable entries marked with a specific ManifestationID to be processed.
        * By default, entries are marked with the default ManifestationID, which
@@ -252,10 +513,56 @@ namespace gear {
             allowed_.insert (manID);
         }
       
+      /**
+       * Disable processing of entries with the given ManifestationID.
+       * Regular entries are discarded when reaching the queue head; waiting
+       * speculative entries are discarded immediately, since they may linger
+       * in the queue for extended time, while idle capacity is scarce.
+       */
       void
       drop (ManifestationID manID)
         {
           allowed_.erase (manID);
+          if (speculative_.empty() or not manID) return;
+          std::priority_queue<ActivationEvent> retained;
+          for ( ; not speculative_.empty(); speculative_.pop())
+            if (speculative_.top().manifestation != manID)
+              retained.push (speculative_.top());
+          speculative_.swap (retained);
+          publishSpeculation();
+        }
+      
+      
+      /**
+       * Retrieve the most urgent speculative entry, if it can be started by now;
+       * entries missing their deadline or belonging to a manifestation not
+       * activated (anymore) are silently discarded.
+       * @return _»empty marker«_ if no speculative work is viable right now
+       * @remark Layer-2 must decide if capacity is idle and no regular work is due.
+       * @warning must hold the Grooming-Token
+       */
+      ActivationEvent
+      pullSpeculative (Time now)
+        {
+          discardOutdatedSpeculation (now);
+          if (speculative_.empty()
+              or speculative_.top().starting > waterLevel(now))
+            return ActivationEvent();
+          ActivationEvent spec = speculative_.top();
+          speculative_.pop();
+          publishSpeculation();
+          return spec;
+        }
+      
+      /** remove speculative entries at the head which can not be dispatched anymore */
+      void
+      discardOutdatedSpeculation (Time now)
+        {
+          while (not speculative_.empty()
+                 and (waterLevel(now) > speculative_.top().deadline
+                      or not isActivated (speculative_.top().manifestation)))
+            speculative_.pop();
+          publishSpeculation();
         }
       
       
@@ -295,6 +602,19 @@ namespace gear {
                   and not isActivated (priority_.top().manifestation));
         }
       
+      /**
+       * determine if a regular Activity at scheduler head can not be started
+       * within its deadline, when allowing for the given safety margin.
+       * @remark used by Layer-2 to shed entries early in overload situations
+       */
+      bool
+      lacksSlack (Time now, Offset margin)  const
+        {
+          return not priority_.empty()
+             and not priority_.top().isCompulsory
+             and waterLevel(now) + _raw(margin) > priority_.top().deadline;
+        }
+      
       /** detect a compulsory Activity at scheduler head with missed deadline */
       bool
       isOutOfTime (Time now)  const
@@ -311,22 +631,83 @@ namespace gear {
           return not instruct_.empty();
         }
       
+      bool
+      hasLocalWork()  const
+        {
+          return not local_.empty();
+        }
+      
+      bool
+      hasHandoffWork()  const
+        {
+          return not handoff_.empty();
+        }
+      
+      /** @remark can be used without Grooming-Token (reads the mirror) */
+      bool
+      hasSpeculativeWork()  const
+        {
+          return NO_HEAD != specHead_.load (std::memory_order_acquire);
+        }
+      
       bool
       empty()  const
         {
           return instruct_.empty()
-             and priority_.empty();
+             and NO_HEAD == priority_.headStart()
+             and local_.empty()
+             and handoff_.empty()
+             and not hasSpeculativeWork();
         }
       
-      /** @return the earliest time of prioritised work */
+      /** @return the earliest time of prioritised work, including work
+       *          already moved to local run queues or hand-off slots
+       *  @note speculative work is not considered, since it can always
+       *        be postponed and is dispatched only with idle capacity;
+       *        see #speculativeHead
+       *  @remark can be used concurrently _without_ Grooming-Token,
+       *        since only atomic mirrors of the head times are read */
       Time
       headTime()  const
         {
-          return priority_.empty()? Time::NEVER
-                                  : Time{TimeValue{priority_.top().starting}};
+          int64_t head = std::min (local_.headStart(), handoff_.headStart());
+          head = std::min (head, priority_.headStart());
+          return NO_HEAD == head? Time::NEVER
+                                : Time{TimeValue{head}};
         }                              //Note: 64-bit waterLevel corresponds to µ-Ticks
       
+      /** @return the earliest start time of speculative work waiting for idle capacity
+       *  @remark can be used concurrently _without_ Grooming-Token */
+      Time
+      speculativeHead()  const
+        {
+          int64_t head = specHead_.load (std::memory_order_acquire);
+          return NO_HEAD == head? Time::NEVER
+                                : Time{TimeValue{head}};
+        }
+      
     private:
+      void
+      enqueue (ActivationEvent const& actEvent)
+        {
+          if (actEvent.isSpeculative)
+            {
+              speculative_.push (actEvent);
+              publishSpeculation();
+            }
+          else
+            priority_.push (actEvent);
+        }
+      
+      /** @internal update the speculative head mirror
+       * @warning must hold the Grooming-Token */
+      void
+      publishSpeculation()
+        {
+          specHead_.store (speculative_.empty()? NO_HEAD : speculative_.top().starting
+                          ,std::memory_order_release);
+        }
+      
       static int64_t
       waterLevel (Time time)
         {
@@ -78,6 +78,35 @@
  **       As a safety net, the grooming-token will automatically be dropped after
  **       catching an exception, or when a thread is sent to sleep.
  ** 
+ ** Workers sent into sleep are parked within the WorkForce; whenever new work is posted
+ ** that becomes due within the current work horizon, one parked worker is woken up, and
+ ** an idle worker never sleeps longer than the distance to the next scheduled Activity.
+ ** 
+ ** With many cores and short jobs, contention on the grooming-token can dominate.
+ ** As an optional mode (\ref work::Config::LOCAL_RUN_QUEUES), the token holder
+ ** moves further due work into [per-worker run queues](\ref local-run-queue.hpp),
+ ** from where other workers can pick it up or steal it without the token.
+ ** When moreover workers are [pinned](\ref work::Config::PIN_WORKERS) to cores, these
+ ** local queues are grouped per NUMA node, and follow-up work posted from a worker
+ ** is tagged with this worker's node, so that chains of jobs tend to stay local.
+ ** Likewise optional (\ref work::Config::CALENDAR_QUEUE) is the use of a
+ ** [calendar queue](\ref calendar-queue.hpp) for time prioritisation in Layer-1.
+ ** In [batched dispatch](\ref work::Config::BATCH_DISPATCH) mode, the token holder
+ ** dequeues several due entries at once and passes some through
+ ** [hand-off slots](\ref handoff-slots.hpp) to other workers.
+ ** Compulsory jobs are served through a priority lane in Layer-1; in overload, regular
+ ** jobs lacking slack can optionally be [shed](\ref work::Config::SHED_OVERLOAD) early.
+ ** 
+ ** Jobs can be scheduled as [speculative](\ref ScheduleSpec::speculative), e.g. to pre-render
+ ** frames around a paused playhead. Such work is performed only by idle capacity, as classified
+ ** by the LoadController, and never while regular work is due. When the speculation becomes
+ ** pointless (e.g. when the playhead jumps), the corresponding ManifestationID can be
+ ** [dropped](\ref Scheduler::dropManifestation), discarding all waiting entries at once.
+ ** 
+ ** Jobs of kind `LOAD_JOB` perform [asynchronous IO](\ref async-job.hpp): the worker only
+ ** initiates the operation and returns, while the remainder of the job's Activity chain
+ ** is posted back into the Scheduler by the IoCompletion, once the data is available.
+ ** 
  ** @see SchedulerService_test Component integration test
  ** @see SchedulerStress_test
  ** @see SchedulerUsage_test
@@ -104,11 +133,13 @@
 #include "vault/gear/scheduler-invocation.hpp"
 #include "vault/gear/load-controller.hpp"
 #include "vault/gear/engine-observer.hpp"
+#include "vault/gear/async-job.hpp"
 #include "vault/real-clock.hpp"
 #include  "lib/nocopy.hpp"
 
 #include <optional>
 #include <utility>
+#include <vector>
 
 
 namespace vault{
@@ -143,6 +174,7 @@ namespace gear {
       TimeVar death_{Time::NEVER};
       ManifestationID manID_{};
       bool isCompulsory_{false};
+      bool isSpeculative_{false};
       
       Scheduler* theScheduler_;
       std::optional<activity::Term> term_;
@@ -175,6 +207,13 @@ namespace gear {
           return move(*this);
         }
       
+      ScheduleSpec
+      deadline (Time fixedDeadline)
+        {
+          death_ = fixedDeadline;
+          return move(*this);
+        }
+      
       ScheduleSpec
       manifestation (ManifestationID manID)
         {
@@ -189,6 +228,16 @@ namespace gear {
           return move(*this);
         }
       
+      /** perform this job only with idle capacity, when no regular work is due.
+       * @note typically combined with a distinct ManifestationID, to allow
+       *       for dropping all speculative work at once when it becomes obsolete */
+      ScheduleSpec
+      speculative (bool indeed =true)
+        {
+          isSpeculative_ = indeed;
+          return move(*this);
+        }
+      
       
       /** build Activity chain and hand-over to the Scheduler. */
       ScheduleSpec post();
@@ -197,6 +246,9 @@ namespace gear {
       ScheduleSpec linkToPredecessor(ScheduleSpec&, bool unlimitedTime =false);
     private:
       void maybeBuildTerm();
+      ActivationEvent activation();
+      
+      friend class Scheduler;
     };
   
   
@@ -219,6 +271,7 @@ namespace gear {
           Scheduler& scheduler;
           activity::Proc doWork() { return scheduler.doWork();           }
           void finalHook (bool _) { scheduler.handleWorkerTermination(_);}
+          microseconds idleWaitLimit() { return scheduler.headDistance(); }
         };
       
       
@@ -234,13 +287,24 @@ namespace gear {
     public:
       Scheduler (BlockFlowAlloc& activityAllocator
                 ,EngineObserver& engineObserver)
-        : layer1_{}
+        : layer1_{activityAllocator.entranceCapacity()}
         , layer2_{}
         , workForce_{Setup{IDLE_WAIT, DISMISS_CYCLES, *this}}
         , activityLang_{activityAllocator}
         , loadControl_{connectMonitoring()}
         , engineObserver_{engineObserver}
-        { }
+        {
+          layer2_.attachParking (workForce_.parking());
+          if (work::Config::LOCAL_RUN_QUEUES)
+            layer1_.useLocalQueues (work::Config::COMPUTATION_CAPACITY
+                                   ,work::Config::PIN_WORKERS? work::Topology::system().nodeCnt() : 1);
+          if (work::Config::CALENDAR_QUEUE)
+            layer1_.useCalendarQueue();
+          if (work::Config::BATCH_DISPATCH)
+            layer2_.useBatchDispatch();
+          if (work::Config::SHED_OVERLOAD)
+            layer2_.useOverloadShedding();
+        }
       
       
       bool
@@ -346,6 +410,32 @@ namespace gear {
         }
       
       
+      /**
+       * Enable processing of work marked with the given ManifestationID,
+       * without seeding a planning job (e.g. for speculative work).
+       */
+      void
+      enableManifestation (ManifestationID manID)
+        {
+          auto guard = layer2_.requireGroomingTokenHere();
+          layer1_.activate (manID);
+        }
+      
+      /**
+       * Discard all further work marked with the given ManifestationID.
+       * Speculative work waiting for idle capacity is removed immediately,
+       * while regular entries are discarded when reaching the queue head.
+       * @remark jobs already in progress are not affected.
+       */
+      void
+      dropManifestation (ManifestationID manID)
+        {
+          auto guard = layer2_.requireGroomingTokenHere();
+          layer1_.feedPrioritisation();
+          layer1_.drop (manID);
+        }
+      
+      
       /**
        * Render Job builder: start definition of a schedule
        * to invoke the given Job. Use the functions on the returned builder
@@ -359,6 +449,14 @@ namespace gear {
           return ScheduleSpec{*this, job};
         }
       
+      /**
+       * Issue several schedules defined beforehand with a single entrance operation,
+       * instead of contending for the entrance (or Grooming-Token) with each one.
+       * @note schedules linked as successor of some other schedule must not be
+       *       included, since they will be triggered by their predecessor.
+       */
+      void postBatch (std::vector<ScheduleSpec>&);
+      
       
       
       /**
@@ -370,10 +468,13 @@ namespace gear {
       
     private:
       void postChain (ActivationEvent);
+      void continueAfterIO (Activity&, Time deadline, ManifestationID);
       void sanityCheck (ActivationEvent const&);
       void handleDutyCycle (Time now, bool =false);
       void handleWorkerTermination (bool isFailure);
       void maybeScaleWorkForce (Time startHorizon);
+      void wakeForWork (Time start);
+      microseconds headDistance();
       
       void triggerEmergency();
       
@@ -384,7 +485,7 @@ namespace gear {
         {
           LoadController::Wiring setup;
           setup.maxCapacity = []{ return work::Config::COMPUTATION_CAPACITY; };
-          setup.currWorkForceSize = [this]{ return workForce_.size(); };
+          setup.currWorkForceSize = [this]{ return workForce_.cntLive(); };
           setup.stepUpWorkForce   = [this](uint steps){ workForce_.incScale(steps); };
           return setup;
         }
@@ -402,6 +503,7 @@ namespace gear {
       
       /** the Job builder is allowed to allocate and dispatch */
       friend class ScheduleSpec;
+      friend class IoCompletion;
       
       /** open private backdoor for tests */
       friend class test::SchedulerService_test;
@@ -412,21 +514,6 @@ namespace gear {
   
   
   
-  /** work-timing event for performance observation */
-  class WorkTiming
-    : public EngineEvent
-    {
-      using Payload = EngineEvent::Payload<Time>;
-      using EngineEvent::EngineEvent;
-      
-      static Symbol WORKSTART;
-      static Symbol WORKSTOP;
-      
-    public:
-      static WorkTiming start (Time now) { return WorkTiming{WORKSTART, Payload{now}}; }
-      static WorkTiming stop  (Time now) { return WorkTiming{WORKSTOP,  Payload{now}}; }
-    };
-  
   /**
    * @remark when due, the scheduled Activities are performed within the
    *  [Activity-Language execution environment](\ref ActivityLang::dispatchChain());
@@ -465,28 +552,37 @@ namespace gear {
           REQUIRE (chain);
           ActivationEvent chainEvent = ctx.rootEvent;
           chainEvent.refineTo (chain, when, dead);
+          uint node = work::currentNode();
+          if (node != work::NO_NODE)
+            chainEvent.numaNode = node;         // follow-up work prefers the node which produced its input
           scheduler_.sanityCheck (chainEvent);
-          return scheduler_.layer2_.postChain (chainEvent, scheduler_.layer1_);
+          activity::Proc res = scheduler_.layer2_.postChain (chainEvent, scheduler_.layer1_);
+          scheduler_.wakeForWork (chainEvent.startTime());
+          return res;
         }
       
       /**
        * λ-work : transition Managment-Mode -> Work-Mode
        * - drop the Grooming-Token (allow concurrent execution from now on)
        * - signal start time of actual processing
-       * @warning current thread is expected to hold the Grooming-Token
+       * @note current thread is expected to hold the Grooming-Token, unless
+       *       the chain was picked up from a [local run queue](\ref local-run-queue.hpp)
        */
       void
       work (Time now, size_t qualifier)
         {
-          scheduler_.layer2_.dropGroomingToken();
-          scheduler_.engineObserver_.dispatchEvent(qualifier, WorkTiming::start(now));
+          if (scheduler_.layer2_.holdsGroomingToken (thisThread()))
+            scheduler_.layer2_.dropGroomingToken();
+          scheduler_.engineObserver_.dispatchEvent(qualifier, WorkTiming::start(now, rootEvent.startTime()
+                                                                                  , rootEvent.manifestation));
         }
       
       /** λ-done : signal end time of actual processing */
       void
       done (Time now, size_t qualifier)
         {
-          scheduler_.engineObserver_.dispatchEvent(qualifier, WorkTiming::stop(now));
+          scheduler_.engineObserver_.dispatchEvent(qualifier, WorkTiming::stop(now, rootEvent.deathTime()
+                                                                                 , rootEvent.manifestation));
         }
       
       /** λ-tick : scheduler management duty cycle */
@@ -545,28 +641,52 @@ namespace gear {
    */
   inline ScheduleSpec
   ScheduleSpec::post()
+  {
+    theScheduler_->postChain (activation());
+    return move(*this);
+  }
+  
+  /** @internal set up the event to enter the schedule, by retrieving the Activity-chain */
+  inline ActivationEvent
+  ScheduleSpec::activation()
   {  // execute term-builder on-demand...
     maybeBuildTerm();
+    REQUIRE (not (isCompulsory_ and isSpeculative_), "speculative work can not be compulsory");
     
-     // set up new schedule by retrieving the Activity-chain...
-    theScheduler_->postChain ({term_->post(), start_
-                                            , death_
-                                            , manID_
-                                            , isCompulsory_});
-    return move(*this);
+    ActivationEvent event{term_->post(), start_
+                                       , death_
+                                       , manID_
+                                       , isCompulsory_};
+    event.isSpeculative = isSpeculative_;
+    return event;
   }
   
   /**
    * @internal if not done yet, then construct the Activity-Language term
    *   describing the schedule according to the parameters set thus far.
+   * @note for a `LOAD_JOB`, the completion token is attached to the job closure
+   *   at this point, which implies the manifestation must be defined beforehand.
    */
   inline void
   ScheduleSpec::maybeBuildTerm()
   {
     if (term_) return;
-    term_ = move(
-      theScheduler_->activityLang_
-          .buildCalculationJob (job_, start_,death_));
+    if (LOAD_JOB == job_.getKind())
+      {
+        auto* asyncJob = dynamic_cast<AsyncJob*> (static_cast<JobClosure*> (job_.jobClosure));
+        if (not asyncJob)
+          throw error::Logic ("LOAD_JOB without AsyncJob interface; unable to signal IO completion");
+        term_ = move(
+          theScheduler_->activityLang_
+              .buildAsyncLoadJob (job_, start_,death_));
+        // hand over the re-entrance point for completion of the IO operation
+        asyncJob->attachCompletion (job_.parameter.invoKey
+                                   ,IoCompletion{*theScheduler_, term_->callback(), death_, manID_});
+      }
+    else
+      term_ = move(
+        theScheduler_->activityLang_
+            .buildCalculationJob (job_, start_,death_));
   }
   
   inline ScheduleSpec
@@ -589,6 +709,25 @@ namespace gear {
   
   
   
+  /**
+   * Re-entrance after completion of an asynchronous operation:
+   * post the remainder of the Activity chain (`WORKSTOP` and `NOTIFY`)
+   * for immediate dispatch. Can be invoked from any thread.
+   */
+  inline void
+  Scheduler::continueAfterIO (Activity& callback, Time deadline, ManifestationID manID)
+  {
+    postChain (ActivationEvent{callback, getSchedTime(), deadline, manID});
+  }
+  
+  inline void
+  IoCompletion::operator()()  const
+  {
+    REQUIRE (scheduler_ and callback_, "IoCompletion not connected to the Scheduler");
+    scheduler_->continueAfterIO (*callback_, deadline_, manID_);
+  }
+  
+  
   inline void
   Scheduler::sanityCheck (ActivationEvent const& event)
     {
@@ -622,6 +761,30 @@ namespace gear {
     sanityCheck (actEvent);
     maybeScaleWorkForce (actEvent.startTime());
     layer2_.postChain (actEvent, layer1_);
+    wakeForWork (actEvent.startTime());
+  }
+  
+  /**
+   * Batch entrance: retrieve the Activity-chains of all given schedules
+   * and enqueue them with a single operation on the entrance queue.
+   */
+  inline void
+  Scheduler::postBatch (std::vector<ScheduleSpec>& specs)
+  {
+    if (specs.empty()) return;
+    std::vector<ActivationEvent> events;
+    events.reserve (specs.size());
+    TimeVar earliest{Time::NEVER};
+    for (ScheduleSpec& spec : specs)
+      {
+        events.emplace_back (spec.activation());
+        sanityCheck (events.back());
+        if (events.back().startTime() < earliest)
+          earliest = events.back().startTime();
+      }
+    maybeScaleWorkForce (earliest);
+    layer2_.postChains (events.data(), events.size(), layer1_);
+    wakeForWork (earliest);
   }
   
   
@@ -655,6 +818,9 @@ namespace gear {
         return;//   leave everything as-is
       }
     
+    // speculative entries beyond deadline can not be retained
+    layer1_.discardOutdatedSpeculation (now);
+    
     // clean-up of obsolete Activities
     activityLang_.discardBefore (now);
     
@@ -700,6 +866,41 @@ namespace gear {
       loadControl_.ensureCapacity (startHorizon);
   }
   
+  /**
+   * Hook invoked whenever a new entry was added to the schedule.
+   * Since each entry can be handled by one worker, at most one
+   * parked worker will be woken, and only if the new entry — or
+   * speculative work, while idle capacity may engage with it —
+   * becomes due within the current work horizon.
+   * @remark cheap when no worker is parked
+   */
+  inline void
+  Scheduler::wakeForWork (Time start)
+  {
+    if (not workForce_.parking().parkedCnt())
+      return;
+    Time now = getSchedTime();
+    if (Offset{now, start} < WORK_HORIZON
+        or (loadControl_.allowsSpeculation()
+            and Offset{now, layer1_.speculativeHead()} < WORK_HORIZON))
+      workForce_.wakeUp();
+  }
+  
+  /**
+   * Limit for the idle wait of a worker: distance to the next head time,
+   * including speculative work while idle capacity may engage with it;
+   * an idle worker will thus be up in time for the next scheduled Activity,
+   * even if nobody thinks to wake it up.
+   */
+  inline microseconds
+  Scheduler::headDistance()
+  {
+    Time head = loadControl_.allowsSpeculation()? util::min (layer1_.headTime(), layer1_.speculativeHead())
+                                                : layer1_.headTime();
+    Offset toHead{getSchedTime(), head};
+    return microseconds{util::max (_raw(toHead), gavl_time_t(0))};
+  }
+  
   /**
    * Trip the emergency brake and unwind processing while retaining all state.
    * @todo as of 4/2024 it is not clear what Scheduler-Emergency actually entails;
@@ -22,6 +22,12 @@
 #include "vault/gear/work-force.hpp"
 #include "lib/util.hpp"
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#include <ctime>
+
 
 namespace vault{
 namespace gear {
@@ -44,6 +50,45 @@ namespace gear {
    */
   size_t work::Config::COMPUTATION_CAPACITY = Config::getDefaultComputationCapacity();
   
+  /**
+   * Scheduling mode with per-worker local run queues and work stealing.
+   * When enabled, due work can be picked up without contending for the
+   * Grooming-Token; takes effect on construction of the Scheduler.
+   * @see local-run-queue.hpp
+   */
+  bool work::Config::LOCAL_RUN_QUEUES = false;
+  
+  /**
+   * Use a calendar queue instead of a binary heap for time prioritisation.
+   * Takes effect on construction of the Scheduler.
+   * @see calendar-queue.hpp
+   */
+  bool work::Config::CALENDAR_QUEUE = false;
+  
+  /**
+   * Pin each worker thread to a specific core, interleaved over NUMA nodes.
+   * Combined with LOCAL_RUN_QUEUES, the local queues are grouped per node.
+   * @see work-topology.hpp
+   */
+  bool work::Config::PIN_WORKERS = false;
+  
+  /**
+   * Dequeue several due entries per acquisition of the Grooming-Token,
+   * handing off further entries to other workers; the batch size is
+   * adapted to the current load. Takes effect on construction of the Scheduler.
+   * @see handoff-slots.hpp
+   */
+  bool work::Config::BATCH_DISPATCH = false;
+  
+  /**
+   * In overload, discard regular (non-compulsory) jobs early, when they can not
+   * be expected to complete within their deadline. Since a discarded job will not
+   * trigger its dependent jobs, this is only adequate for jobs whose result may
+   * be lost. Takes effect on construction of the Scheduler.
+   * @see LoadController::shedMargin()
+   */
+  bool work::Config::SHED_OVERLOAD = false;
+  
   /**
    * default value for full computing capacity is to use all (virtual) cores.
    */
@@ -85,6 +130,39 @@ namespace gear {
     uint factor = 1u << (stepping-1);
     return (CONTEND_WAIT + 10us*randFact) * factor;
   }
+  
+  
+  /**
+   * Announce the current thread as parked, then wait on the futex, as long as
+   * the epoch remains unchanged. A concurrent wake-up incrementing the epoch
+   * after the announcement is thus either seen by the futex syscall, or will
+   * actually wake this thread. Spurious wake-ups are harmless, since any
+   * worker just returns to pull for work and may be parked again.
+   */
+  bool
+  work::ParkingLot::park (microseconds maxWait)
+  {
+    if (maxWait <= 0us)
+      return false;
+    parked_.fetch_add (1, std::memory_order_seq_cst);
+    uint32_t epoch = epoch_.load (std::memory_order_seq_cst);
+    struct timespec timeout;
+    timeout.tv_sec  = maxWait.count() / 1000000;
+    timeout.tv_nsec = (maxWait.count() % 1000000) * 1000;
+    syscall (SYS_futex, reinterpret_cast<uint32_t*> (&epoch_)
+            ,FUTEX_WAIT_PRIVATE, epoch, &timeout, nullptr, 0);
+    parked_.fetch_sub (1, std::memory_order_relaxed);
+    return epoch != epoch_.load (std::memory_order_relaxed);
+  }
+  
+  size_t
+  work::ParkingLot::wakeParked (uint cnt)
+  {
+    epoch_.fetch_add (1, std::memory_order_seq_cst);
+    long woken = syscall (SYS_futex, reinterpret_cast<uint32_t*> (&epoch_)
+                         ,FUTEX_WAKE_PRIVATE, util::min (cnt, uint(INT_MAX)), nullptr, nullptr, 0);
+    return woken > 0? size_t(woken) : 0;
+  }
 
 
 }} // namespace vault::gear
@@ -28,6 +28,14 @@
  ** the worker's behaviour, either by prompting to pull further work, by sending a worker
  ** into a sleep cycle, perform contention mitigation, or even asking the worker to terminate.
  ** 
+ ** Workers sent to sleep are _parked_ in a [ParkingLot](\ref work::ParkingLot), implemented
+ ** on top of the Linux futex mechanism. The sleep is bounded, but can be interrupted when
+ ** new work becomes due; the idle sleep is moreover limited by a hook in the configuration,
+ ** allowing to wake up in time for the next scheduled activity.
+ ** 
+ ** Optionally, workers can be [pinned](\ref work::Config::PIN_WORKERS) to individual cores,
+ ** interleaved over the NUMA nodes of the machine, as discovered by work::Topology.
+ ** 
  ** @warning concurrency and synchronisation in the Scheduler (which maintains and operates
  **          WorkForce) is based on the assumption that _all maintenance and organisational
  **          work is done chunk-wise by a single worker._ Other render activities may proceed
@@ -46,9 +54,11 @@
 
 #include "vault/common.hpp"
 #include "vault/gear/activity.hpp"
+#include "vault/gear/work-topology.hpp"
 #include "lib/meta/function.hpp"
 #include "lib/thread.hpp"
 #include "lib/nocopy.hpp"
+#include "lib/util-foreach.hpp"
 #include "lib/util.hpp"
 
 #include <utility>
@@ -104,11 +114,19 @@ namespace gear {
     struct Config
       {
         static size_t COMPUTATION_CAPACITY;
+        static bool   LOCAL_RUN_QUEUES;
+        static bool   CALENDAR_QUEUE;
+        static bool   PIN_WORKERS;
+        static bool   BATCH_DISPATCH;
+        static bool   SHED_OVERLOAD;
         
         const milliseconds IDLE_WAIT = 20ms;      ///< wait period when a worker _falls idle_
         const size_t DISMISS_CYCLES  = 100;       ///< number of idle cycles after which the worker terminates
         
         static size_t getDefaultComputationCapacity();
+        
+        /** hook to limit the idle wait, e.g. by the next scheduled activity */
+        microseconds idleWaitLimit() { return microseconds::max(); }
       };
     
     
@@ -117,6 +135,43 @@ namespace gear {
     microseconds steppedRandDelay(size_t,size_t);
     
     
+    /**
+     * Place where idle workers can wait to be woken up when new work arrives.
+     * Based on a futex over an epoch counter, which is incremented to signal
+     * a wake-up; parking is always bounded by a timeout, since notification
+     * happens without any lock and may thus occasionally be missed.
+     * The (frequently used) wake-up operation is cheap as long
+     * as no thread is actually parked.
+     */
+    class ParkingLot
+      : util::NonCopyable
+      {
+        atomic<uint32_t> epoch_{0};
+        atomic<uint>     parked_{0};
+        
+        size_t wakeParked (uint);
+        
+      public:
+        /** send the current thread to sleep, until woken or after timeout
+         * @return `true` if woken up by notification */
+        bool park (microseconds maxWait);
+        
+        /** wake up to the given number of parked threads
+         * @return number of threads actually woken */
+        size_t
+        wakeUp (uint cnt =1)
+          {
+            return parked_.load (std::memory_order_seq_cst)? wakeParked (cnt) : 0;
+          }
+        
+        uint
+        parkedCnt()  const
+          {
+            return parked_.load (std::memory_order_relaxed);
+          }
+      };
+    
+    
     using Launch = lib::Thread::Launch;
     
     /*************************************//**
@@ -129,8 +184,11 @@ namespace gear {
       , util::NonCopyable
       {
       public:
-        Worker (CONF config)
+        Worker (CONF config, ParkingLot& parking, atomic<uint>& live, Placement placement =Placement())
           : CONF{move (config)}
+          , parking_{parking}
+          , live_{live}
+          , placement_{placement}
           , thread_{Launch{&Worker::pullWork, this}
                           .threadID("Worker")
                           .decorateCounter()}
@@ -142,8 +200,14 @@ namespace gear {
         /** this Worker starts out active, but may terminate */
         bool isDead() const { return not thread_; }
         
+        /** number of this worker, unique among the live workers of the pool */
+        uint number() const { return placement_.worker; }
+        
         
       private:
+        ParkingLot& parking_;
+        atomic<uint>& live_;
+        Placement placement_;
         lib::Thread thread_;
         
         void
@@ -155,6 +219,7 @@ namespace gear {
             bool regularExit{false};
             try /* ================ pull work ===================== */
               {
+                pinCurrentThread (placement_);      // remember placement, possibly pin to core
                 while (true)
                   {
                     activity::Proc res = CONF::doWork();
@@ -168,7 +233,7 @@ namespace gear {
                     if (res == activity::WAIT)
                       res = idleWait();
                     else
-                      idleCycles_ = 0;
+                      idleTime_ = 0us;
                     if (res != activity::PASS)
                       break;
                   }
@@ -176,6 +241,7 @@ namespace gear {
               }
             ERROR_LOG_AND_IGNORE (threadpool, "defunct worker thread")
             
+            live_.fetch_sub (1, std::memory_order_relaxed);
             try /* ================ thread-exit hook ============== */
               {
                 CONF::finalHook (not regularExit);
@@ -183,19 +249,26 @@ namespace gear {
             ERROR_LOG_AND_IGNORE (threadpool, "failure in thread-exit hook")
           }// Thread will terminate....
         
+        /** park for `IDLE_WAIT`, unless limited by the next due activity.
+         *  The time actually parked is summed up, so that a worker repeatedly
+         *  woken early for near-due work is not dismissed prematurely; the limit
+         *  corresponds to `DISMISS_CYCLES` invocations with full idle periods. */
         activity::Proc
         idleWait()
           {
-            ++idleCycles_;
-            if (idleCycles_ < CONF::DISMISS_CYCLES)
+            if (idleTime_ < (CONF::DISMISS_CYCLES-1) * CONF::IDLE_WAIT)
               {
-                sleep_for (CONF::IDLE_WAIT);
+                microseconds idleWait = util::min (microseconds{CONF::IDLE_WAIT}
+                                                  ,CONF::idleWaitLimit());
+                auto parkedAt = std::chrono::steady_clock::now();
+                parking_.park (idleWait);
+                idleTime_ += std::chrono::duration_cast<microseconds> (std::chrono::steady_clock::now() - parkedAt);
                 return activity::PASS;
               }
             else  // idle beyond threshold => terminate worker
               return activity::HALT;
           }
-        size_t idleCycles_{0};
+        microseconds idleTime_{0};
         
         
         activity::Proc
@@ -243,12 +316,15 @@ namespace gear {
       using Pool = std::list<work::Worker<CONF>>;
       
       CONF setup_;
+      work::ParkingLot parking_;
+      atomic<uint> live_{0};
       Pool workers_;
       
       
     public:
       WorkForce (CONF config)
         : setup_{move (config)}
+        , parking_{}
         , workers_{}
         { }
       
@@ -272,17 +348,17 @@ namespace gear {
         {
           size_t scale{setup_.COMPUTATION_CAPACITY};
           scale = size_t(util::limited (0.0, degree*scale, scale*MAX_OVERPROVISIONING));
-          for (uint i = workers_.size(); i < scale; ++i)
-            workers_.emplace_back (setup_);
+          for (size_t i = size(); i < scale; ++i)
+            spawnWorker();
         }
       
       void
       incScale(uint step =+1)
         {
-          uint i = workers_.size();
-          uint target = util::min (i+step, setup_.COMPUTATION_CAPACITY);
+          size_t i = size();
+          size_t target = util::min (i+step, setup_.COMPUTATION_CAPACITY);
           for ( ; i < target; ++i)
-            workers_.emplace_back (setup_);
+            spawnWorker();
         }
       
       void
@@ -291,7 +367,24 @@ namespace gear {
           for (auto& w : workers_)
             w.emergency.store (true, std::memory_order_relaxed);
           while (0 < size())
-            sleep_for (setup_.IDLE_WAIT);
+            {
+              parking_.wakeUp (workers_.size());
+              sleep_for (setup_.IDLE_WAIT);
+            }
+        }
+      
+      /** wake up parked workers to pick up newly due work
+       * @return number of workers actually woken */
+      size_t
+      wakeUp (uint cnt =1)
+        {
+          return parking_.wakeUp (cnt);
+        }
+      
+      work::ParkingLot&
+      parking()
+        {
+          return parking_;
         }
       
       size_t
@@ -300,6 +393,52 @@ namespace gear {
           unConst(workers_).remove_if([](auto& w){ return w.isDead(); });
           return workers_.size();
         }
+      
+      /** @return number of workers not yet terminated
+       * @remark in contrast to #size, this is just an atomic read and
+       *         can thus be used concurrently from any thread, notably
+       *         by workers in the hot path of the Scheduler. Workers count
+       *         as terminated when they leave the work loop. */
+      size_t
+      cntLive()  const
+        {
+          return live_.load (std::memory_order_relaxed);
+        }
+      
+    private:
+      /** @return core and NUMA node for the i-th worker, if pinning is enabled */
+      work::Placement
+      placement (size_t i)  const
+        {
+          return setup_.PIN_WORKERS? work::Topology::system().placement(i)
+                                   : work::Placement{-1, work::NO_NODE, uint(i), uint(i)};
+        }
+      
+      void
+      spawnWorker()
+        {
+          live_.fetch_add (1, std::memory_order_relaxed);
+          try {
+              workers_.emplace_back (setup_, parking_, live_, placement (freeNumber()));
+            }
+          catch(...)
+            {
+              live_.fetch_sub (1, std::memory_order_relaxed);
+              throw;
+            }
+        }
+      
+      /** @return lowest worker number not used by any live worker
+       *  @remark numbers of terminated workers are reused, so that
+       *          live workers never share a core or a local run queue */
+      uint
+      freeNumber()  const
+        {
+          uint nr{0};
+          while (util::has_any (workers_, [nr](auto& w){ return not w.isDead() and w.number() == nr; }))
+            ++nr;
+          return nr;
+        }
     };
   
   
@@ -0,0 +1,189 @@
+/*
+  WorkTopology  -  processor and memory topology for placement of render workers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file work-topology.cpp
+ ** Implementation of topology discovery from sysfs and thread pinning (Linux).
+ */
+
+
+#include "vault/gear/work-topology.hpp"
+#include "lib/util.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+
+namespace vault{
+namespace gear {
+namespace work {
+  
+  namespace { // internal details
+    
+    const uint MAX_NODES = 64;   ///< upper limit for probing NUMA node directories
+    
+    thread_local Placement currentPlacement_;
+    
+    /** @return the cores this process is allowed to use */
+    vector<int>
+    allowedCores()
+    {
+      vector<int> cores;
+      cpu_set_t mask;
+      CPU_ZERO (&mask);
+      if (0 == sched_getaffinity (0, sizeof(mask), &mask))
+        for (int cpu=0; cpu < CPU_SETSIZE; ++cpu)
+          if (CPU_ISSET (cpu, &mask))
+            cores.push_back (cpu);
+      if (cores.empty())
+        for (int cpu=0; cpu < int(std::thread::hardware_concurrency()); ++cpu)
+          cores.push_back (cpu);
+      if (cores.empty())
+        cores.push_back (0);
+      return cores;
+    }
+  } // internal details
+  
+  
+  
+  Topology::Topology (vector<vector<int>> coresPerNode)
+    : nodes_{}
+    {
+      for (auto& cores : coresPerNode)
+        if (not cores.empty())
+          nodes_.emplace_back (std::move (cores));
+      if (nodes_.empty())
+        nodes_.emplace_back (allowedCores());
+    }
+  
+  
+  Topology const&
+  Topology::system()
+  {
+    static Topology systemTopology{discover()};
+    return systemTopology;
+  }
+  
+  
+  /**
+   * Read the CPU list of each NUMA node from sysfs (`nodeN/cpulist`),
+   * retaining only those cores the current process is allowed to use.
+   * Falls back to a single node if no NUMA information is available.
+   */
+  Topology
+  Topology::discover (string sysfsNodeDir)
+  {
+    vector<int> allowed = allowedCores();
+    vector<vector<int>> nodes;
+    for (uint n=0; n < MAX_NODES; ++n)
+      {
+        std::ifstream cpulist{sysfsNodeDir+"/node"+std::to_string(n)+"/cpulist"};
+        if (not cpulist) continue;
+        string spec;
+        std::getline (cpulist, spec);
+        vector<int> cores;
+        for (int cpu : parseCpuList (spec))
+          if (util::contains (allowed, cpu))
+            cores.push_back (cpu);
+        nodes.emplace_back (move (cores));
+      }
+    if (nodes.empty())
+      nodes.emplace_back (move (allowed));
+    return Topology{move (nodes)};
+  }
+  
+  
+  /** parse the kernel's cpu list format, e.g. `0-3,8-11,16` */
+  vector<int>
+  Topology::parseCpuList (string const& spec)
+  {
+    vector<int> cpus;
+    std::istringstream in{spec};
+    string range;
+    while (std::getline (in, range, ','))
+      {
+        int first{-1}, last{-1};
+        char sep{0};
+        std::istringstream rangeIn{range};
+        if (not (rangeIn >> first))
+          continue;
+        last = (rangeIn >> sep >> last) and sep == '-'? last : first;
+        for (int cpu=first; cpu <= last; ++cpu)
+          cpus.push_back (cpu);
+      }
+    return cpus;
+  }
+  
+  
+  size_t
+  Topology::cpuCnt()  const
+  {
+    size_t cnt{0};
+    for (auto& cores : nodes_)
+      cnt += cores.size();
+    return cnt;
+  }
+  
+  
+  /**
+   * Determine core and node for the given worker. Workers are interleaved
+   * over the NUMA nodes, and within each node distributed over the cores,
+   * wrapping around when there are more workers than cores.
+   * @remark distinct live workers get distinct cores only if they use distinct
+   *         worker numbers; thus the WorkForce reuses the number of a terminated worker.
+   */
+  Placement
+  Topology::placement (size_t workerNr)  const
+  {
+    uint node = workerNr % nodeCnt();
+    uint rank = workerNr / nodeCnt();
+    auto& cores = nodes_[node];
+    return Placement{cores[rank % cores.size()], node, uint(workerNr), rank};
+  }
+  
+  
+  
+  bool
+  pinCurrentThread (Placement place)
+  {
+    currentPlacement_ = place;
+    if (not place)
+      return false;
+    cpu_set_t mask;
+    CPU_ZERO (&mask);
+    CPU_SET (place.cpu, &mask);
+    if (0 == pthread_setaffinity_np (pthread_self(), sizeof(mask), &mask))
+      return true;
+    WARN (threadpool, "unable to pin worker thread to core %d", place.cpu);
+    return false;
+  }
+  
+  
+  uint
+  currentNode()
+  {
+    return currentPlacement_.node;
+  }
+  
+  
+  Placement const&
+  currentPlacement()
+  {
+    return currentPlacement_;
+  }
+  
+  
+}}} // namespace vault::gear::work
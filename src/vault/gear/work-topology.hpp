@@ -0,0 +1,116 @@
+/*
+  WORK-TOPOLOGY.hpp  -  processor and memory topology for placement of render workers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file work-topology.hpp
+ ** Discovery of the processor topology, to pin render workers to specific cores.
+ ** On machines with several sockets, memory is attached to a specific _NUMA node;_
+ ** access from cores of another node is considerably slower. Since render jobs
+ ** operate on frame buffers produced by preceding jobs, it is beneficial to keep
+ ** a chain of dependent jobs on the same node. For this purpose, workers can
+ ** be pinned to individual cores, and are grouped per NUMA node. Each worker
+ ** thread knows the node it is pinned to, which allows to tag work posted
+ ** from this thread with a NUMA hint (\ref ActivationEvent::numaNode).
+ **
+ ** The topology is discovered on Linux from `/sys/devices/system/node`, limited
+ ** to the cores accessible by the current process. If this information is not
+ ** available, a single node with all cores is assumed.
+ ** @see WorkForce
+ ** @see LocalRunQueues
+ ** @see WorkForce_test::verify_topology()
+ */
+
+
+#ifndef SRC_VAULT_GEAR_WORK_TOPOLOGY_H_
+#define SRC_VAULT_GEAR_WORK_TOPOLOGY_H_
+
+
+#include "vault/common.hpp"
+
+#include <string>
+#include <vector>
+#include <limits>
+
+
+namespace vault{
+namespace gear {
+namespace work {
+  
+  using std::string;
+  using std::vector;
+  
+  /** marker for »no NUMA node«, fits into the hint within ActivationEvent */
+  const uint NO_NODE = std::numeric_limits<uint8_t>::max();
+  
+  /** marker for a thread not started as worker */
+  const uint NO_WORKER = std::numeric_limits<uint>::max();
+  
+  
+  /** assignment of a worker to a specific core */
+  struct Placement
+    {
+      int  cpu{-1};
+      uint node{NO_NODE};
+      uint worker{NO_WORKER};   ///< number of the worker, unique among the live workers of the pool
+      uint rank{NO_WORKER};     ///< number of the worker within the group of its NUMA node
+      
+      explicit operator bool()  const { return 0 <= cpu; }
+    };
+  
+  
+  /**
+   * Layout of available cores, grouped by NUMA node.
+   * Provides a placement scheme for a sequence of workers, interleaved
+   * over the nodes, so that the workers of each node form a group.
+   */
+  class Topology
+    {
+      vector<vector<int>> nodes_;
+      
+    public:
+      explicit
+      Topology (vector<vector<int>> coresPerNode);
+      
+      /** topology of this machine, discovered once on first use */
+      static Topology const& system();
+      
+      static Topology discover (string sysfsNodeDir ="/sys/devices/system/node");
+      static vector<int> parseCpuList (string const& spec);
+      
+      uint   nodeCnt()  const { return nodes_.size(); }
+      size_t cpuCnt()   const;
+      
+      vector<int> const&
+      cores (uint node)  const
+        {
+          REQUIRE (node < nodeCnt());
+          return nodes_[node];
+        }
+      
+      Placement placement (size_t workerNr)  const;
+    };
+  
+  
+  /** pin the current thread to a core, and remember its NUMA node and worker number
+   * @return `false` if pinning failed (the placement is remembered anyway) */
+  bool pinCurrentThread (Placement);
+  
+  /** @return NUMA node the current thread is pinned to, else NO_NODE */
+  uint currentNode();
+  
+  /** @return placement of the current worker thread, as given to #pinCurrentThread */
+  Placement const& currentPlacement();
+  
+  
+}}} // namespace vault::gear::work
+#endif /*SRC_VAULT_GEAR_WORK_TOPOLOGY_H_*/
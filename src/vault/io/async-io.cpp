@@ -0,0 +1,466 @@
+/*
+  AsyncIO  -  perform read operations without blocking the calling thread
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file async-io.cpp
+ ** Implementation of asynchronous IO by `io_uring` and an IO thread pool.
+ ** The ring is driven directly through the Linux system calls, without relying
+ ** on `liburing`: the submission and completion queues are mapped into the process,
+ ** and requests are placed into the submission queue under a lock, while a single
+ ** reaper thread blocks in `io_uring_enter()` awaiting completions. The address of the
+ ** heap allocated request record is used as `user_data`; a `NOP` with zero `user_data`
+ ** is submitted at shutdown to wake the reaper thread.
+ ** @remark the number of requests in flight is limited by the size of the submission
+ **         queue, which ensures the completion queue (twice as large) can never overflow.
+ */
+
+
+#include "vault/io/async-io.hpp"
+#include "lib/format-string.hpp"
+#include "lib/util.hpp"
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+  #include <linux/io_uring.h>
+  #include <sys/syscall.h>
+  #define VAULT_IO_URING 1
+#endif
+
+
+using std::unique_lock;
+using std::string;
+using std::lock_guard;
+using util::_Fmt;
+
+
+namespace vault{
+namespace io {
+  
+  namespace {
+    /** record of a single operation pending in the ring */
+    struct PendingOp
+      {
+        Completion done;
+      };
+  }
+
+
+#ifdef VAULT_IO_URING
+  /**
+   * @internal submission and completion queue of an `io_uring`,
+   * together with the reaper thread to dispatch the completions.
+   */
+  class AsyncIO::Ring
+    : util::NonCopyable
+    {
+      AsyncIO& service_;
+      int fd_{-1};
+      
+      void*  sqMap_{MAP_FAILED};
+      size_t sqSize_{0};
+      void*  cqMap_{MAP_FAILED};
+      size_t cqSize_{0};
+      io_uring_sqe* sqes_{static_cast<io_uring_sqe*> (MAP_FAILED)};
+      size_t sqesSize_{0};
+      
+      uint* sqHead_;
+      uint* sqTail_;
+      uint* sqMask_;
+      uint* sqArray_;
+      uint  sqEntries_;
+      uint* cqHead_;
+      uint* cqTail_;
+      uint* cqMask_;
+      io_uring_cqe* cqes_;
+      
+      std::mutex submitLock_;
+      uint inFlight_{0};
+      std::unique_ptr<lib::ThreadJoinable<>> reaper_;
+      
+      template<typename X>
+      static X*
+      field (void* base, uint offset)
+        {
+          return reinterpret_cast<X*> (static_cast<char*> (base) + offset);
+        }
+      
+      static uint
+      loadAcquire (uint* loc)
+        {
+          return __atomic_load_n (loc, __ATOMIC_ACQUIRE);
+        }
+      
+      static void
+      storeRelease (uint* loc, uint val)
+        {
+          __atomic_store_n (loc, val, __ATOMIC_RELEASE);
+        }
+      
+      int
+      enter (uint toSubmit, uint minComplete, uint flags)
+        {
+          return int(::syscall (__NR_io_uring_enter, fd_, toSubmit, minComplete, flags, nullptr, 0));
+        }
+      
+    public:
+      Ring (AsyncIO& service, uint depth)
+        : service_{service}
+        {
+          io_uring_params params;
+          std::memset (&params, 0, sizeof(params));
+          fd_ = int(::syscall (__NR_io_uring_setup, depth, &params));
+          if (fd_ < 0)
+            throw error::External{_Fmt{"io_uring not available: %s"} % string{std::strerror(errno)}};
+          
+          sqSize_ = params.sq_off.array + params.sq_entries * sizeof(uint);
+          cqSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+          bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+          if (singleMap)
+            sqSize_ = cqSize_ = std::max (sqSize_, cqSize_);
+          
+          sqMap_ = ::mmap (nullptr, sqSize_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+          if (sqMap_ == MAP_FAILED)
+            failSetup();
+          if (singleMap)
+            cqMap_ = sqMap_;
+          else
+            {
+              cqMap_ = ::mmap (nullptr, cqSize_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+              if (cqMap_ == MAP_FAILED)
+                failSetup();
+            }
+          sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+          sqes_ = static_cast<io_uring_sqe*> (::mmap (nullptr, sqesSize_, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd_, IORING_OFF_SQES));
+          if (sqes_ == MAP_FAILED)
+            failSetup();
+          
+          sqHead_  = field<uint> (sqMap_, params.sq_off.head);
+          sqTail_  = field<uint> (sqMap_, params.sq_off.tail);
+          sqMask_  = field<uint> (sqMap_, params.sq_off.ring_mask);
+          sqArray_ = field<uint> (sqMap_, params.sq_off.array);
+          sqEntries_ = params.sq_entries;
+          cqHead_  = field<uint> (cqMap_, params.cq_off.head);
+          cqTail_  = field<uint> (cqMap_, params.cq_off.tail);
+          cqMask_  = field<uint> (cqMap_, params.cq_off.ring_mask);
+          cqes_    = field<io_uring_cqe> (cqMap_, params.cq_off.cqes);
+          
+          reaper_.reset (new lib::ThreadJoinable<>{"IO completion", [this]{ reapCompletions(); }});
+        }
+     
+     ~Ring()
+        {
+          if (reaper_)
+            {
+              while (not submit (IORING_OP_NOP, -1, 0, 0, nullptr, 0, 0))
+                std::this_thread::yield();
+              reaper_->join();
+            }
+          unmapAll();
+        }
+      
+      
+      /** place a request into the submission queue and hand it over to the kernel
+       * @param opFlags flags specific to the operation (e.g. the advice for `MADVISE`)
+       * @return `false` when the ring is currently exhausted, or when \a bytes
+       *         exceeds the 32bit length field of a submission entry
+       */
+      bool
+      submit (uint8_t opcode, int fd, size_t offset, size_t bytes, char* buffer, uint32_t opFlags, uint64_t userData)
+        {
+          if (bytes > std::numeric_limits<uint32_t>::max())
+            return false;
+          lock_guard<std::mutex> guard{submitLock_};
+          if (inFlight_ >= sqEntries_)
+            return false;
+          uint tail = *sqTail_;
+          uint idx  = tail & *sqMask_;
+          io_uring_sqe& sqe = sqes_[idx];
+          std::memset (&sqe, 0, sizeof(sqe));
+          sqe.opcode = opcode;
+          sqe.fd = fd;
+          sqe.off = offset;
+          sqe.addr = reinterpret_cast<uint64_t> (buffer);
+          sqe.len = uint(bytes);
+          sqe.rw_flags = opFlags;
+          sqe.user_data = userData;
+          sqArray_[idx] = idx;
+          storeRelease (sqTail_, tail+1);
+          
+          int res;
+          do res = enter (1, 0, 0);
+          while (res < 0 and errno == EINTR);
+          if (res < 1)
+            {// kernel did not consume the entry: withdraw it
+              storeRelease (sqTail_, tail);
+              return false;
+            }
+          ++inFlight_;
+          return true;
+        }
+      
+    private:
+      void
+      reapCompletions()
+        {
+          bool halt = false;
+          while (not halt)
+            {
+              int res = enter (0, 1, IORING_ENTER_GETEVENTS);
+              if (res < 0 and errno != EINTR)
+                WARN (vault, "io_uring wait failed: %s", std::strerror(errno));
+              
+              uint head = *cqHead_;
+              uint tail = loadAcquire (cqTail_);
+              for ( ; head != tail; ++head)
+                {
+                  io_uring_cqe& cqe = cqes_[head & *cqMask_];
+                  uint64_t userData = cqe.user_data;
+                  ssize_t result = cqe.res;
+                  storeRelease (cqHead_, head+1);
+                  {
+                    lock_guard<std::mutex> guard{submitLock_};
+                    --inFlight_;
+                  }
+                  if (not userData)
+                    halt = true;
+                  else
+                    {
+                      std::unique_ptr<PendingOp> req{reinterpret_cast<PendingOp*> (userData)};
+                      service_.complete (req->done, result);
+                    }
+                }
+            }
+        }
+      
+      void
+      failSetup()
+        {
+          int err = errno;
+          unmapAll();
+          throw error::External{_Fmt{"io_uring setup failed: %s"} % string{std::strerror(err)}};
+        }
+      
+      void
+      unmapAll()
+        {
+          if (sqes_ != MAP_FAILED)
+            ::munmap (sqes_, sqesSize_);
+          if (cqMap_ != MAP_FAILED and cqMap_ != sqMap_)
+            ::munmap (cqMap_, cqSize_);
+          if (sqMap_ != MAP_FAILED)
+            ::munmap (sqMap_, sqSize_);
+          if (fd_ >= 0)
+            ::close (fd_);
+          sqes_ = static_cast<io_uring_sqe*> (MAP_FAILED);
+          cqMap_ = sqMap_ = MAP_FAILED;
+          fd_ = -1;
+        }
+    };
+
+#else /* no io_uring on this platform */
+  
+  class AsyncIO::Ring
+    {
+    public:
+      Ring (AsyncIO&, uint)
+        {
+          throw error::External{"io_uring not supported on this platform"};
+        }
+    };
+#endif
+  
+  
+  
+  
+  AsyncIO::AsyncIO (AsyncIOPolicy const& policy)
+    {
+      REQUIRE (policy.poolThreads > 0, "need at least one IO thread");
+      if (policy.useRing)
+        try {
+            ring_.reset (new Ring{*this, policy.queueDepth});
+          }
+        catch (lumiera::Error& failure)
+          {
+            lumiera_error();  // clear error flag
+            INFO (vault, "asynchronous IO falls back to thread pool: %s", failure.what());
+          }
+      for (uint i=0; i < policy.poolThreads; ++i)
+        pool_.emplace_back (new lib::ThreadJoinable<>{"IO pool", [this]{ serveTasks(); }});
+    }
+  
+  
+  /** @note blocks until all pending operations are completed */
+  AsyncIO::~AsyncIO()
+    {
+      {
+        unique_lock<std::mutex> guard{lock_};
+        drained_.wait (guard, [this]{ return 0 == pending_; });
+        halt_ = true;
+      }
+      wakeUp_.notify_all();
+      ring_.reset();
+      for (auto& thread : pool_)
+        thread->join();
+    }
+  
+  
+  /**
+   * Read a range of data from a file, invoking the completion callback afterwards.
+   * @param fd an open file descriptor, which must stay open until completion
+   * @param buffer storage to receive \a bytes, must remain valid until completion
+   * @param done callback to receive the number of bytes read, or the negated `errno`.
+   * @remark submitted through `io_uring` if possible, otherwise performed by `pread()`
+   *         on the IO pool. Thus the callback may be invoked from either thread.
+   *         Requests beyond 4GiB are always performed on the pool, and may
+   *         be answered by a short read, as usual for `pread()`.
+   */
+  void
+  AsyncIO::read (int fd, size_t offset, size_t bytes, char* buffer, Completion done)
+  {
+    REQUIRE (done);
+    ++pending_;
+#ifdef VAULT_IO_URING
+    if (ring_)
+      {
+        auto req = std::make_unique<PendingOp> (PendingOp{done});
+        if (ring_->submit (IORING_OP_READ, fd, offset, bytes, buffer, 0, reinterpret_cast<uint64_t> (req.get())))
+          {
+            req.release();      // ownership passed to the ring
+            ++cntRing_;
+            return;
+          }
+      }
+#endif
+    dispatch ([this, fd, offset, bytes, buffer, done]{
+                   ssize_t res = ::pread (fd, buffer, bytes, off_t(offset));
+                   complete (done, res < 0? -errno : res);
+                 });
+  }
+  
+  
+  /**
+   * Apply `madvise()` to a range of mapped memory, invoking the completion callback afterwards.
+   * Notably with `MADV_POPULATE_READ`, the kernel reads in all pages of a mapped file range,
+   * which can then be accessed without blocking on IO after completion is signalled.
+   * @param addr start of the range, must be page aligned
+   * @param done callback to receive zero on success, or the negated `errno`.
+   * @remark submitted through `io_uring` (`IORING_OP_MADVISE`) if possible, otherwise
+   *         performed on the IO pool; notably for ranges beyond 4GiB, which do not
+   *         fit into a submission entry. A kernel rejecting the advice signals `-EINVAL`.
+   */
+  void
+  AsyncIO::advise (const char* addr, size_t bytes, int advice, Completion done)
+  {
+    REQUIRE (done);
+    ++pending_;
+    char* range = const_cast<char*> (addr);
+#ifdef VAULT_IO_URING
+    if (ring_)
+      {
+        auto req = std::make_unique<PendingOp> (PendingOp{done});
+        if (ring_->submit (IORING_OP_MADVISE, -1, 0, bytes, range, uint32_t(advice), reinterpret_cast<uint64_t> (req.get())))
+          {
+            req.release();      // ownership passed to the ring
+            ++cntRing_;
+            return;
+          }
+      }
+#endif
+    dispatch ([this, range, bytes, advice, done]{
+                   int res = ::madvise (range, bytes, advice);
+                   complete (done, res < 0? -errno : 0);
+                 });
+  }
+  
+  
+  /**
+   * Perform an arbitrary blocking operation on the IO pool.
+   * @param op operation to perform, returning a byte count or negative `errno`
+   * @param done callback to receive the result of the operation.
+   */
+  void
+  AsyncIO::perform (Operation op, Completion done)
+  {
+    REQUIRE (op and done);
+    ++pending_;
+    dispatch ([this, op=move(op), done=move(done)]
+                {
+                  ssize_t res;
+                  try { res = op(); }
+                  catch (std::exception& problem)
+                    {
+                      WARN (vault, "IO operation failed: %s", problem.what());
+                      lumiera_error();
+                      res = -EIO;
+                    }
+                  complete (done, res);
+                });
+  }
+  
+  
+  void
+  AsyncIO::dispatch (std::function<void()> task)
+  {
+    ++cntPool_;
+    {
+      lock_guard<std::mutex> guard{lock_};
+      tasks_.emplace_back (move (task));
+    }
+    wakeUp_.notify_one();
+  }
+  
+  
+  void
+  AsyncIO::serveTasks()
+  {
+    while (true)
+      {
+        std::function<void()> task;
+        {
+          unique_lock<std::mutex> guard{lock_};
+          wakeUp_.wait (guard, [this]{ return halt_ or not tasks_.empty(); });
+          if (tasks_.empty())
+            return;
+          task = move (tasks_.front());
+          tasks_.pop_front();
+        }
+        task();
+      }
+  }
+  
+  
+  void
+  AsyncIO::complete (Completion const& done, ssize_t result)
+  {
+    try { done (result); }
+    catch (std::exception& problem)
+      {
+        WARN (vault, "IO completion failed: %s", problem.what());
+        lumiera_error();  // clear error flag
+      }
+    {
+      lock_guard<std::mutex> guard{lock_};
+      --pending_;
+    }
+    drained_.notify_all();
+  }
+  
+  
+}} // namespace vault::io
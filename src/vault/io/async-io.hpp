@@ -0,0 +1,124 @@
+/*
+  ASYNC-IO.hpp  -  perform read operations without blocking the calling thread
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file async-io.hpp
+ ** Service to perform IO operations asynchronously, signalling completion by callback.
+ ** Render workers must never block on disk access, since this would withdraw computation
+ ** capacity from the Scheduler for the duration of the IO. Rather, a [LOAD_JOB](\ref async-job.hpp)
+ ** only submits the operation and returns, while the completion callback posts the dependent
+ ** activities back into the Scheduler. Two mechanisms are provided to perform the actual IO:
+ ** - on Linux, read requests are submitted through an `io_uring` queue shared with the kernel;
+ **   a single dedicated thread waits on the completion queue and invokes the callbacks.
+ **   Likewise, `madvise()` can be submitted, so that the kernel populates a [mapped file
+ **   range](\ref MappedRange) (`MADV_POPULATE_READ`), while the caller proceeds.
+ ** - as fall-back, a small pool of IO threads performs blocking reads (`pread`). This pool
+ **   also takes on requests when the ring is not available (older kernel, seccomp restrictions)
+ **   or when the submission queue is exhausted, and it can be used to run arbitrary blocking
+ **   operations, like populating a [mapped file range](\ref MappedRange::populate).
+ ** Callbacks are invoked from the completion thread or the IO pool and should return quickly.
+ ** @warning the target buffer of a read must remain valid until completion is signalled.
+ ** @see MediaRead
+ ** @see AsyncIO_test
+ */
+
+
+#ifndef SRC_VAULT_IO_ASYNC_IO_H_
+#define SRC_VAULT_IO_ASYNC_IO_H_
+
+
+#include "vault/common.hpp"
+#include "lib/thread.hpp"
+#include "lib/nocopy.hpp"
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+
+namespace vault{
+namespace io {
+  
+  namespace error = lumiera::error;
+  
+  /** callback to signal completion: bytes read, or negative `errno` */
+  using Completion = std::function<void(ssize_t)>;
+  
+  /** a blocking operation to be performed on the IO pool */
+  using Operation = std::function<ssize_t()>;
+  
+  
+  /**
+   * Parametrisation of the asynchronous IO service.
+   */
+  struct AsyncIOPolicy
+    {
+      uint queueDepth{128};          ///< number of submission slots in the io_uring
+      uint poolThreads{2};           ///< number of threads to perform blocking operations
+      bool useRing{true};            ///< submit reads through io_uring, if available
+    };
+  
+  
+  /**
+   * Asynchronous IO service, based on `io_uring` with a thread pool as fall-back.
+   * All operations can be invoked concurrently and return immediately.
+   * The destructor waits for all pending operations to complete.
+   */
+  class AsyncIO
+    : util::NonCopyable
+    {
+      class Ring;
+      std::unique_ptr<Ring> ring_;
+      
+      std::mutex lock_;
+      std::condition_variable wakeUp_;
+      std::condition_variable drained_;
+      std::deque<std::function<void()>> tasks_;
+      bool halt_{false};
+      std::atomic_size_t pending_{0};
+      std::atomic_size_t cntRing_{0};
+      std::atomic_size_t cntPool_{0};
+      
+      std::vector<std::unique_ptr<lib::ThreadJoinable<>>> pool_;
+      
+    public:
+      explicit
+      AsyncIO (AsyncIOPolicy const& policy =AsyncIOPolicy{});
+     ~AsyncIO();
+      
+      void read (int fd, size_t offset, size_t bytes, char* buffer, Completion);
+      void advise (const char* addr, size_t bytes, int advice, Completion);
+      void perform (Operation, Completion);
+      
+      bool usesRing()  const { return bool(ring_); }
+      
+      /* === diagnostics === */
+      size_t cntPending()  const { return pending_; }
+      size_t cntRing()     const { return cntRing_; }  ///< operations submitted through io_uring
+      size_t cntPool()     const { return cntPool_; }  ///< operations performed by the IO pool
+      
+    private:
+      void dispatch (std::function<void()>);
+      void serveTasks();
+      void complete (Completion const&, ssize_t);
+    };
+  
+  
+}} // namespace vault::io
+#endif /*SRC_VAULT_IO_ASYNC_IO_H_*/
@@ -0,0 +1,378 @@
+/*
+  MappingCache  -  memory mapped access to media files with bounded resource usage
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file mapping-cache.cpp
+ ** Implementation of file access based on `mmap` and kernel read-ahead advice (Linux).
+ */
+
+
+#include "vault/io/mapping-cache.hpp"
+#include "lib/format-string.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+
+using util::_Fmt;
+using std::lock_guard;
+
+
+namespace vault{
+namespace io {
+  
+  namespace { // internal details
+    
+    size_t
+    pageSize()
+    {
+      static const size_t PAGE_SIZ = sysconf (_SC_PAGESIZE);
+      return PAGE_SIZ;
+    }
+    
+    size_t
+    roundUp (size_t bytes, size_t unit)
+    {
+      return (bytes + unit-1) / unit * unit;
+    }
+    
+    string
+    sysError()
+    {
+      return std::strerror (errno);
+    }
+  }
+  
+  
+  
+  MappingCache::MappingCache (MappingPolicy const& policy)
+    : policy_{policy}
+    {
+      policy_.chunkSize = roundUp (std::max (policy.chunkSize, pageSize()), pageSize());
+      policy_.maxOpenFiles = std::max (policy.maxOpenFiles, 1u);
+    }
+  
+  /** @warning all MappedRange handles must be released beforehand */
+  MappingCache::~MappingCache()
+    {
+      lock_guard<std::mutex> guard{lock_};
+      WARN_IF (dedicated_, mmap, "discarding MappingCache while still in use");
+      for (Window& win : windows_)
+        {
+          WARN_IF (win.pins, mmap, "discarding MappingCache while still in use");
+          munmap (win.base, win.size);
+        }
+      for (FileEntry& file : files_)
+        closeFile (file);
+    }
+  
+  
+  /**
+   * Register a file for read access.
+   * @return ID to refer to this file; a file already known is not registered again.
+   * @throw error::External if the file can not be opened for reading.
+   */
+  FileID
+  MappingCache::open (string const& path)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    for (FileID id=0; id < files_.size(); ++id)
+      if (files_[id].path == path)
+        return id;
+    FileID id = files_.size();
+    files_.push_back (FileEntry{path});
+    try {
+        int fd = ensureOpen (id);
+        struct stat info;
+        if (0 != fstat (fd, &info))
+          throw error::External{_Fmt{"unable to access file %s: %s"} % path % sysError()};
+        files_[id].size = info.st_size;
+      }
+    catch(...)
+      {
+        closeFile (files_[id]);
+        files_.pop_back();
+        throw;
+      }
+    return id;
+  }
+  
+  
+  size_t
+  MappingCache::fileSize (FileID id)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return entry(id).size;
+  }
+  
+  
+  /**
+   * Grant access to a range of file content.
+   * @param dir direction of playback, to guide read-ahead when mapping new windows
+   * @return handle to the mapped data, which is pinned until the handle is released
+   * @throw error::Invalid when the range is not within the file;
+   *        error::External when the file can not be mapped.
+   */
+  MappedRange
+  MappingCache::access (FileID id, size_t offset, size_t bytes, Direction dir)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    FileEntry& file = entry (id);
+    if (0 == bytes or file.size < offset + bytes)
+      throw error::Invalid{_Fmt{"range [%d..%d[ not within file %s of size %d"}
+                               % offset % (offset+bytes) % file.path % file.size};
+    
+    size_t chunk = offset / policy_.chunkSize;
+    Window& win = (chunk == (offset+bytes-1) / policy_.chunkSize)? mapChunk (id, chunk, dir)
+                                                                 : mapDedicated (id, offset, bytes, dir);
+    ++win.pins;
+    trimMappings();
+    return MappedRange{*this, win, offset, bytes};
+  }
+  
+  
+  /** @internal invoked when a MappedRange is released */
+  void
+  MappingCache::unpin (Window& win)
+  {
+    lock_guard<std::mutex> guard{lock_};
+    REQUIRE (win.pins);
+    if (--win.pins)
+      return;
+    if (mapping::NOT_KEYED == win.chunk)
+      {
+        munmap (win.base, win.size);
+        --dedicated_;
+        delete &win;
+      }
+    else
+      trimMappings();
+  }
+  
+  
+  MappingCache::FileEntry&
+  MappingCache::entry (FileID id)
+  {
+    if (id >= files_.size())
+      throw error::Invalid{_Fmt{"unknown file-ID %d"} % id, LERR_(INDEX_BOUNDS)};
+    return files_[id];
+  }
+  
+  
+  /** @internal ensure a file descriptor is available, possibly closing the least recently used file */
+  int
+  MappingCache::ensureOpen (FileID id)
+  {
+    FileEntry& file = files_[id];
+    if (0 <= file.fd)
+      {
+        openFiles_.splice (openFiles_.begin(), openFiles_, file.lruPos);
+        return file.fd;
+      }
+    if (openFiles_.size() >= policy_.maxOpenFiles)
+      closeFile (files_[openFiles_.back()]);
+    file.fd = ::open (file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file.fd < 0)
+      throw error::External{_Fmt{"unable to open file %s for reading: %s"} % file.path % sysError()};
+    TRACE (filehandlecache_dbg, "open %s (fd=%d)", file.path.c_str(), file.fd);
+    file.lruPos = openFiles_.insert (openFiles_.begin(), id);
+    return file.fd;
+  }
+  
+  void
+  MappingCache::closeFile (FileEntry& file)
+  {
+    if (file.fd < 0) return;
+    TRACE (filehandlecache_dbg, "close %s (fd=%d)", file.path.c_str(), file.fd);
+    ::close (file.fd);
+    file.fd = -1;
+    openFiles_.erase (file.lruPos);
+  }
+  
+  
+  /** @internal retrieve or establish the window to map the given chunk of the file */
+  MappingCache::Window&
+  MappingCache::mapChunk (FileID id, size_t chunk, Direction dir)
+  {
+    auto pos = index_.find (ChunkKey{id, chunk});
+    if (pos != index_.end())
+      {
+        ++hits_;
+        windows_.splice (windows_.begin(), windows_, pos->second);
+        Window& win = *pos->second;
+        if (win.advice != dir)
+          advise (win, dir);
+        return win;
+      }
+    ++misses_;
+    size_t start = chunk * policy_.chunkSize;
+    size_t size = std::min (policy_.chunkSize, entry(id).size - start);
+    windows_.push_front (mapRange (id, start, size, dir));
+    windows_.front().chunk = chunk;
+    index_.emplace (ChunkKey{id, chunk}, windows_.begin());
+    readAhead (id, chunk, dir);
+    return windows_.front();
+  }
+  
+  
+  /** @internal establish a mapping used only for a single range crossing chunk boundaries */
+  MappingCache::Window&
+  MappingCache::mapDedicated (FileID id, size_t offset, size_t bytes, Direction dir)
+  {
+    Window* win = new Window{mapRange (id, offset, bytes, dir)};
+    ++dedicated_;
+    return *win;
+  }
+  
+  
+  /** @internal map a page aligned range of the file, to cover the given bytes */
+  MappingCache::Window
+  MappingCache::mapRange (FileID id, size_t offset, size_t bytes, Direction dir)
+  {
+    int fd = ensureOpen (id);
+    size_t start = offset / pageSize() * pageSize();
+    size_t size = offset+bytes - start;
+    void* addr = mmap (nullptr, size, PROT_READ, MAP_SHARED, fd, start);
+    if (addr == MAP_FAILED)
+      {
+        WARN (mmap, "unable to map %zu bytes of file %s", size, files_[id].path.c_str());
+        throw error::External{_Fmt{"unable to map file %s: %s"} % files_[id].path % sysError()};
+      }
+    TRACE (mmapings_dbg, "map %zu bytes at offset %zu of %s", size, start, files_[id].path.c_str());
+    Window win{id, mapping::NOT_KEYED, static_cast<char*> (addr), size, start};
+    advise (win, dir);
+    return win;
+  }
+  
+  
+  /** @internal adjust the kernel's read-ahead for the mapped window */
+  void
+  MappingCache::advise (Window& win, Direction dir)
+  {
+    win.advice = dir;
+    int advice = FORWARD == dir? MADV_SEQUENTIAL : MADV_RANDOM;
+    madvise (win.base, win.size, advice);
+  }
+  
+  
+  /** @internal announce the chunk following in playback direction, to be read into page cache */
+  void
+  MappingCache::readAhead (FileID id, size_t chunk, Direction dir)
+  {
+#ifdef POSIX_FADV_WILLNEED
+    FileEntry& file = files_[id];
+    if (RANDOM == dir or (BACKWARD == dir and 0 == chunk))
+      return;
+    size_t next = FORWARD == dir? chunk+1 : chunk-1;
+    size_t start = next * policy_.chunkSize;
+    if (start >= file.size or file.fd < 0)
+      return;
+    if (0 == posix_fadvise (file.fd, start, std::min (policy_.chunkSize, file.size - start), POSIX_FADV_WILLNEED))
+      ++advised_;
+#endif
+  }
+  
+  
+  /** @internal unmap least recently used windows beyond the limit, unless pinned */
+  void
+  MappingCache::trimMappings()
+  {
+    auto pos = windows_.end();
+    while (windows_.size() > policy_.maxMappings and pos != windows_.begin())
+      {
+        --pos;
+        if (pos->pins) continue;
+        TRACE (mmapcache_dbg, "unmap chunk %zu of file %u", pos->chunk, pos->file);
+        munmap (pos->base, pos->size);
+        index_.erase (ChunkKey{pos->file, pos->chunk});
+        pos = windows_.erase (pos);
+      }
+  }
+  
+  
+  
+  /**
+   * Ensure the data of this range is present in memory, reading it from the file
+   * as required. This call blocks for IO, and subsequent access is free of page faults,
+   * unless the kernel decides to evict the pages from page cache in the meantime.
+   */
+  void
+  MappedRange::populate()  const
+  {
+    if (not data_) return;
+    size_t page = pageSize();
+    const char* firstPage = data_ - size_t(data_ - window_->base) % page;
+#ifdef MADV_POPULATE_READ
+    if (0 == madvise (const_cast<char*> (firstPage), size_t(data_+size_ - firstPage), MADV_POPULATE_READ))
+      return;
+#endif
+    madvise (const_cast<char*> (firstPage), size_t(data_+size_ - firstPage), MADV_WILLNEED);
+    volatile const char* p = firstPage;
+    for (size_t off = 0; off < size_t(data_+size_ - firstPage); off += page)
+      (void) p[off];
+  }
+  
+  
+  
+  /* === diagnostics === */
+  
+  size_t
+  MappingCache::cntFiles()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return files_.size();
+  }
+  
+  size_t
+  MappingCache::cntOpenFiles()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return openFiles_.size();
+  }
+  
+  /** number of mappings currently established, including dedicated mappings in use */
+  size_t
+  MappingCache::cntMappings()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return windows_.size() + dedicated_;
+  }
+  
+  size_t
+  MappingCache::cntHits()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return hits_;
+  }
+  
+  size_t
+  MappingCache::cntMisses()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return misses_;
+  }
+  
+  /** number of chunks announced for read-ahead */
+  size_t
+  MappingCache::cntAdvised()
+  {
+    lock_guard<std::mutex> guard{lock_};
+    return advised_;
+  }
+  
+  
+}} // namespace vault::io
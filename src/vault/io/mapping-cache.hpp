@@ -0,0 +1,267 @@
+/*
+  MAPPING-CACHE.hpp  -  memory mapped access to media files with bounded resource usage
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file mapping-cache.hpp
+ ** Access to the content of media files by mapping them into memory.
+ ** Source media is read through `mmap`, in _windows_ of a large fixed size (»chunks«),
+ ** so that consecutive frames are served from the same mapping, while the kernel's page
+ ** cache does the actual buffering. Since a long timeline may refer to hundreds of media
+ ** files, the resources held are bounded:
+ ** - only a limited number of file descriptors is kept open; the least recently used
+ **   file is closed when another file needs to be opened. A mapping remains valid
+ **   after closing the file, and the file is re-opened transparently when required.
+ ** - unused windows are kept mapped up to a limit, and then unmapped in LRU order.
+ **   Windows currently accessed are _pinned_ and never unmapped; the limit is thus
+ **   a soft limit, which can be exceeded temporarily by pinned windows.
+ ** Access is granted through a MappedRange, which pins the underlying window while in use.
+ ** A range crossing the boundary between two chunks is served by a dedicated mapping,
+ ** which is unmapped when released.
+ **
+ ** # Read-ahead
+ ** Each access indicates the direction of playback. When a new window is mapped, the kernel
+ ** is advised accordingly: for forward playback the window is marked for sequential access
+ ** and the following chunk is announced with `posix_fadvise(WILLNEED)`; since kernel read-ahead
+ ** only works forward, for backward playback the window is marked for random access and the
+ ** _preceding_ chunk is announced instead. Random access disables read-ahead altogether.
+ ** @note all operations on the cache are protected by a single lock; however the
+ **       page faults, i.e. the actual IO, happen outside, when accessing the data.
+ ** @see MediaRead to prefetch data by a job scheduled ahead of the render job
+ ** @see MappingCache_test
+ */
+
+
+#ifndef SRC_VAULT_IO_MAPPING_CACHE_H_
+#define SRC_VAULT_IO_MAPPING_CACHE_H_
+
+
+#include "vault/common.hpp"
+#include "lib/meta/util.hpp"
+#include "lib/nocopy.hpp"
+
+#include <unordered_map>
+#include <cstddef>
+#include <utility>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <list>
+
+
+namespace vault{
+namespace io {
+  
+  namespace error = lumiera::error;
+  using std::string;
+  
+  /** direction of playback, to guide read-ahead */
+  enum Direction { FORWARD
+                 , BACKWARD
+                 , RANDOM
+                 };
+  
+  /** registration number of a file known to the MappingCache */
+  using FileID = uint;
+  
+  
+  /**
+   * Parametrisation of resource usage for mapped file access.
+   */
+  struct MappingPolicy
+    {
+      size_t chunkSize{32_MiB};      ///< size of mapped windows (rounded to page size)
+      uint   maxOpenFiles{64};       ///< number of file descriptors kept open
+      uint   maxMappings{128};       ///< number of windows kept mapped, while not in use
+    };
+  
+  
+  class MappingCache;
+  
+  namespace mapping {
+    
+    /** @internal a mapped part of a file */
+    struct Window
+      {
+        FileID    file;
+        size_t    chunk;             ///< chunk number, or `NOT_KEYED` for a dedicated mapping
+        char*     base;
+        size_t    size;
+        size_t    start;             ///< file offset of the mapping
+        uint      pins{0};
+        Direction advice;
+      };
+    
+    const size_t NOT_KEYED = size_t(-1);
+  }
+  
+  
+  /**
+   * Access to a range of file content, mapped into memory.
+   * The underlying mapping is pinned as long as this handle exists.
+   * @note the data is mapped read-only; touching a page not yet
+   *       in the page cache blocks the current thread for IO.
+   */
+  class MappedRange
+    : util::MoveOnly
+    {
+      MappingCache*     cache_{nullptr};
+      mapping::Window*  window_{nullptr};
+      const char*       data_{nullptr};
+      size_t            size_{0};
+      
+      MappedRange (MappingCache& cache, mapping::Window& win, size_t offset, size_t bytes)
+        : cache_{&cache}
+        , window_{&win}
+        , data_{win.base + (offset - win.start)}
+        , size_{bytes}
+        { }
+      
+      friend class MappingCache;
+    public:
+      MappedRange()  = default;
+     ~MappedRange()  { release(); }
+      
+      MappedRange (MappedRange&& rr)
+        : cache_{rr.cache_}
+        , window_{rr.window_}
+        , data_{rr.data_}
+        , size_{rr.size_}
+        {
+          rr.window_ = nullptr;
+          rr.cache_ = nullptr;
+          rr.data_ = nullptr;
+          rr.size_ = 0;
+        }
+      
+      MappedRange&
+      operator= (MappedRange&& rr)
+        {
+          if (this != &rr)
+            {
+              release();
+              std::swap (cache_, rr.cache_);
+              std::swap (window_,rr.window_);
+              std::swap (data_,  rr.data_);
+              std::swap (size_,  rr.size_);
+            }
+          return *this;
+        }
+      
+      explicit operator bool()  const { return data_; }
+      
+      const char* data()  const { return data_; }
+      size_t      size()  const { return size_; }
+      
+      void populate()  const;
+      void release();
+    };
+  
+  
+  /**
+   * Bounded cache of open files and memory mapped windows into these files.
+   * Files are registered once and then referred by FileID; the actual file
+   * descriptors and mappings are managed by the cache. Thread safe.
+   */
+  class MappingCache
+    : util::NonCopyable
+    {
+      using Window = mapping::Window;
+      using Windows = std::list<Window>;
+      using FileLRU = std::list<FileID>;
+      
+      struct FileEntry
+        {
+          string  path;
+          int     fd{-1};
+          size_t  size{0};
+          FileLRU::iterator lruPos{};
+        };
+      
+      struct ChunkKey
+        {
+          FileID file;
+          size_t chunk;
+          
+          bool operator== (ChunkKey const& o)  const { return file == o.file and chunk == o.chunk; }
+        };
+      
+      struct KeyHash
+        {
+          size_t operator() (ChunkKey const& k)  const { return k.chunk * 0x9E3779B97F4A7C15 ^ k.file; }
+        };
+      
+      MappingPolicy policy_;
+      std::mutex    lock_;
+      
+      std::vector<FileEntry> files_;
+      FileLRU   openFiles_;          ///< open files, most recently used first
+      Windows   windows_;            ///< keyed windows, most recently used first
+      std::unordered_map<ChunkKey, Windows::iterator, KeyHash> index_;
+      uint      dedicated_{0};
+      
+      size_t    hits_{0};
+      size_t    misses_{0};
+      size_t    advised_{0};
+      
+    public:
+      explicit
+      MappingCache (MappingPolicy const& policy =MappingPolicy{});
+     ~MappingCache();
+      
+      FileID open (string const& path);
+      size_t fileSize (FileID);
+      
+      MappedRange access (FileID, size_t offset, size_t bytes, Direction =FORWARD);
+      
+      /** chunk size actually used, rounded to whole pages */
+      size_t chunkSize()  const { return policy_.chunkSize; }
+      
+      /* === diagnostics === */
+      size_t cntFiles();
+      size_t cntOpenFiles();
+      size_t cntMappings();
+      size_t cntHits();
+      size_t cntMisses();
+      size_t cntAdvised();
+      
+    private:
+      friend class MappedRange;
+      void unpin (Window&);
+      
+      FileEntry& entry (FileID);
+      int   ensureOpen (FileID);
+      void  closeFile (FileEntry&);
+      Window& mapChunk (FileID, size_t chunk, Direction);
+      Window& mapDedicated (FileID, size_t offset, size_t bytes, Direction);
+      Window  mapRange (FileID, size_t offset, size_t bytes, Direction);
+      void  advise (Window&, Direction);
+      void  readAhead (FileID, size_t chunk, Direction);
+      void  trimMappings();
+    };
+  
+  
+  
+  inline void
+  MappedRange::release()
+  {
+    if (cache_ and window_)
+      cache_->unpin (*window_);
+    cache_ = nullptr;
+    window_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+  }
+  
+  
+}} // namespace vault::io
+#endif /*SRC_VAULT_IO_MAPPING_CACHE_H_*/
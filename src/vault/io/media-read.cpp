@@ -0,0 +1,409 @@
+/*
+  MediaRead  -  prerequisite job to load media data ahead of rendering
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file media-read.cpp
+ ** Implementation of the IO job to populate a mapped range of media data.
+ ** When offloaded to AsyncIO, the IO job only maps the range and then submits
+ ** `madvise(MADV_POPULATE_READ)` through the `io_uring`, so that the kernel reads in
+ ** the pages without occupying any thread of the application. Where this advice is not
+ ** available or rejected by the kernel, the range is populated on the IO pool instead.
+ */
+
+
+#include "vault/io/media-read.hpp"
+#include "vault/io/async-io.hpp"
+#include "vault/gear/nop-job-functor.hpp"
+#include "vault/gear/async-job.hpp"
+#include "vault/gear/scheduler.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdint>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+
+
+namespace vault{
+namespace io {
+  
+  using gear::Job;
+  using gear::JobParameter;
+  
+  
+  /**
+   * @internal shared state of a MediaRead, performing the work of the IO job.
+   * The range is mapped only once, and then populated either by the IO job or on demand;
+   * populating concurrently from both sides is harmless. Releasing the request while
+   * some loading is still in flight only marks the mapping to be unpinned, which is
+   * then done when the last pending load operation is complete. When invoked
+   * through the Scheduler, the IO job receives a completion token, which is invoked
+   * after loading to release the dependent render job.
+   */
+  class MediaRead::Request
+    : util::NonCopyable
+    {
+      MappingCache& cache_;
+      FileID    file_;
+      size_t    offset_;
+      size_t    bytes_;
+      Direction dir_;
+      
+      MappedRange range_;
+      std::once_flag    mapped_;
+      std::atomic_bool  loaded_{false};
+      std::mutex        guard_;
+      uint pendingLoads_{0};
+      bool released_{false};
+      InvocationInstanceID jobKey_{};
+      AsyncIO* asyncIO_{nullptr};
+      gear::IoCompletion completion_;
+      
+      void
+      signalCompletion()
+        {
+          if (completion_)
+            completion_();
+        }
+      
+    public:
+      Request (MappingCache& cache, FileID file, size_t offset, size_t bytes, Direction dir)
+        : cache_{cache}
+        , file_{file}
+        , offset_{offset}
+        , bytes_{bytes}
+        , dir_{dir}
+        { }
+      
+     ~Request();
+      
+      /** @return key to find this request from the IO job */
+      InvocationInstanceID enrol (std::shared_ptr<Request> const& self);
+      
+      /** perform the loading on the given IO service */
+      void
+      offloadTo (AsyncIO& io)
+        {
+          asyncIO_ = &io;
+        }
+      
+      void
+      map()
+        {
+          std::call_once (mapped_, [this]{ range_ = cache_.access (file_, offset_, bytes_, dir_); });
+        }
+      
+      void
+      load()
+        {
+          if (isLoaded() or not beginLoad())
+            return;
+          try {
+              map();
+              range_.populate();
+              loaded_.store (true, std::memory_order_release);
+            }
+          catch(...)
+            {
+              endLoad();
+              throw;
+            }
+          endLoad();
+        }
+      
+      bool
+      isLoaded()  const
+        {
+          return loaded_.load (std::memory_order_acquire);
+        }
+      
+      MappedRange const&
+      data()
+        {
+          load();
+          return range_;
+        }
+      
+      /** unpin the mapping, if established, without touching the data;
+       *  afterwards the range is never mapped anymore.
+       * @note while some loading is in flight, the mapping is only marked
+       *       and then unpinned on completion of the last pending load */
+      void
+      release()
+        {
+          std::lock_guard<std::mutex> lock{guard_};
+          released_ = true;
+          if (0 == pendingLoads_)
+            unpin();
+        }
+      
+      
+      /** perform the IO job: load right away, or hand over the loading to AsyncIO
+       * @param self the shared ownership, to keep this request alive while loading */
+      void
+      invoke (std::shared_ptr<Request> self)
+        {
+          try {
+              if (asyncIO_)
+                return populateAsync (std::move (self));
+              load();
+            }
+          catch(...)
+            {
+              signalCompletion();             // render job falls back to synchronous load
+              throw;
+            }
+          signalCompletion();
+        }
+      
+      void
+      attachCompletion (gear::IoCompletion completion)
+        {
+          completion_ = completion;
+        }
+      
+    private:
+      /** mark a load operation in flight, which keeps the mapping pinned
+       * @return `false` when already released, thus nothing to load */
+      bool
+      beginLoad()
+        {
+          std::lock_guard<std::mutex> lock{guard_};
+          if (released_)
+            return false;
+          ++pendingLoads_;
+          return true;
+        }
+      
+      /** load operation complete; perform a release deferred meanwhile */
+      void
+      endLoad()
+        {
+          std::lock_guard<std::mutex> lock{guard_};
+          REQUIRE (pendingLoads_);
+          if (0 == --pendingLoads_ and released_)
+            unpin();
+        }
+      
+      void
+      unpin()
+        {
+          std::call_once (mapped_, []{ /* not mapped yet: skip mapping */ });
+          range_.release();
+        }
+      
+      /** let the kernel read in all pages of the mapped range through AsyncIO;
+       *  if the kernel rejects, the range is populated on the IO pool instead. */
+      void
+      populateAsync (std::shared_ptr<Request> self)
+        {
+#ifdef MADV_POPULATE_READ
+          if (not beginLoad())
+            return signalCompletion();        // already released: nothing to load
+          try {
+              map();
+              uintptr_t page = uintptr_t(::sysconf (_SC_PAGESIZE));
+              uintptr_t start = uintptr_t(range_.data()) / page * page;
+              size_t bytes = uintptr_t(range_.data()) + range_.size() - start;
+              asyncIO_->advise (reinterpret_cast<const char*> (start), bytes, MADV_POPULATE_READ
+                               ,[self](ssize_t res)
+                                  {
+                                    if (res >= 0)
+                                      self->loaded_.store (true, std::memory_order_release);
+                                    self->endLoad();  // mapping stays pinned up to here
+                                    if (res < 0)
+                                      return self->populateOnPool (self);
+                                    self->signalCompletion();
+                                  });
+            }
+          catch(...)
+            {
+              endLoad();
+              throw;
+            }
+#else
+          populateOnPool (std::move (self));
+#endif
+        }
+      
+      void
+      populateOnPool (std::shared_ptr<Request> self)
+        {
+          asyncIO_->perform ([self]{ self->load(); return ssize_t(self->bytes_); }
+                            ,[self](ssize_t){ self->signalCompletion(); });
+        }
+    };
+  
+  
+  
+  /**
+   * @internal closure of all IO jobs to load media data, shared by all MediaRead requests.
+   * Each job is identified by a key in the InvocationInstanceID, to find the actual request.
+   * The IO job refers to the request only _weakly:_ since a job not invoked before its
+   * deadline is silently discarded by the Scheduler, the request must not depend on the
+   * invocation for clean-up. Rather it lives as long as some MediaRead handle, or some
+   * load operation in flight refers to it; an IO job invoked after the request is gone
+   * does nothing, since no render job is waiting for this data anymore.
+   */
+  class MediaRead::LoadJob
+    : public gear::NopJobFunctor
+    , public gear::AsyncJob
+    {
+      std::mutex mtx_;
+      std::unordered_map<uint64_t, std::weak_ptr<Request>> requests_;
+      uint64_t lastKey_{0};
+      
+      std::shared_ptr<Request>
+      lookup (InvocationInstanceID key)
+        {
+          std::lock_guard<std::mutex> lock{mtx_};
+          auto pos = requests_.find (key.code.w1);
+          return pos == requests_.end()? nullptr
+                                       : pos->second.lock();
+        }
+      
+    public:
+      static LoadJob&
+      instance()
+        {
+          static LoadJob theLoadJob;
+          return theLoadJob;
+        }
+      
+      InvocationInstanceID
+      enrol (std::shared_ptr<Request> const& request)
+        {
+          InvocationInstanceID key;
+          std::lock_guard<std::mutex> lock{mtx_};
+          key.code.w1 = ++lastKey_;
+          requests_.emplace (key.code.w1, request);
+          return key;
+        }
+      
+      void
+      forget (InvocationInstanceID key)
+        {
+          std::lock_guard<std::mutex> lock{mtx_};
+          requests_.erase (key.code.w1);
+        }
+      
+      
+      /* === JobFunctor Interface === */
+      
+      JobKind
+      getJobKind()  const override
+        {
+          return LOAD_JOB;
+        }
+      
+      void
+      invokeJobOperation (JobParameter param)  override
+        {
+          if (auto request = lookup (param.invoKey))
+            request->invoke (std::move (request));
+        }                // otherwise request already gone: nothing to load
+      
+      std::string
+      diagnostic()  const override
+        {
+          return "MediaRead::LoadJob";
+        }
+      
+      
+      /* === AsyncJob Interface === */
+      
+      void
+      attachCompletion (InvocationInstanceID key, gear::IoCompletion completion)  override
+        {
+          if (auto request = lookup (key))
+            request->attachCompletion (completion);
+        }
+    };
+  
+  
+  InvocationInstanceID
+  MediaRead::Request::enrol (std::shared_ptr<Request> const& self)
+  {
+    REQUIRE (self.get() == this);
+    if (not jobKey_.code.w1)
+      jobKey_ = LoadJob::instance().enrol (self);
+    return jobKey_;
+  }
+  
+  MediaRead::Request::~Request()
+  {
+    if (jobKey_.code.w1)
+      LoadJob::instance().forget (jobKey_);
+  }
+  
+  
+  
+  MediaRead::MediaRead (MappingCache& cache, FileID file, size_t offset, size_t bytes, Direction dir)
+    : req_{std::make_shared<Request> (cache, file, offset, bytes, dir)}
+    { }
+  
+  
+  /**
+   * Build the IO job to load the data, to be scheduled as prerequisite of the render job.
+   * @note the IO job does not keep the request alive; some MediaRead handle must be
+   *       retained (typically by the render job) for the data to be loaded.
+   * @warning the data is loaded directly within the IO job, thereby blocking the
+   *          worker thread; preferably the loading should be offloaded to AsyncIO.
+   */
+  Job
+  MediaRead::prefetchJob (Time nominalTime)
+  {
+    return Job{LoadJob::instance(), req_->enrol (req_), nominalTime};
+  }
+  
+  /**
+   * Build an IO job which only maps the range, hands over the loading to the AsyncIO
+   * service and returns immediately. The pages are read in by the kernel (`io_uring`),
+   * and the render job linked as successor is released by the Scheduler when loading
+   * is complete, without occupying a worker or IO thread in between.
+   */
+  Job
+  MediaRead::prefetchJob (AsyncIO& io, Time nominalTime)
+  {
+    req_->offloadTo (io);
+    return prefetchJob (nominalTime);
+  }
+  
+  
+  /**
+   * Access the data; if not yet loaded by the IO job, the data is loaded
+   * synchronously, thereby blocking the current thread for IO.
+   * @throw error::Invalid or error::External when the data can not be accessed.
+   */
+  MappedRange const&
+  MediaRead::data()
+  {
+    return req_->data();
+  }
+  
+  bool
+  MediaRead::isLoaded()  const
+  {
+    return req_->isLoaded();
+  }
+  
+  /** release the mapped data, which is no longer accessible for any copy of this handle */
+  void
+  MediaRead::release()
+  {
+    req_->release();
+  }
+  
+  
+}} // namespace vault::io
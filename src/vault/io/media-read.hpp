@@ -0,0 +1,84 @@
+/*
+  MEDIA-READ.hpp  -  prerequisite job to load media data ahead of rendering
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file media-read.hpp
+ ** Read access to source media, performed by a prerequisite job.
+ ** A render job reading source media from a [mapped file](\ref MappingCache) would block
+ ** on page faults, whenever the data is not yet in the kernel's page cache. To decouple
+ ** rendering from disk access, the data required by a render job is loaded beforehand by
+ ** a separate _IO job_ (JobKind `LOAD_JOB`), which is linked as prerequisite to the render
+ ** job by a NOTIFY → GATE dependency, using ScheduleSpec::linkToSuccessor(). Thus the render
+ ** job is only dispatched after the IO job has completed, while the Scheduler can dispatch
+ ** other work in the meantime. A MediaRead handle is shared by both jobs:
+ ** - MediaRead::prefetchJob() yields the IO job, which maps the range and populates the pages;
+ **   when given an AsyncIO service, this IO job merely maps the range and submits the loading
+ **   to the kernel through `io_uring` (`MADV_POPULATE_READ`) and returns; the render job is then
+ **   released by the [completion](\ref async-job.hpp). Without `io_uring`, or when the kernel
+ **   rejects this advice, the pages are populated by a blocking operation on the IO pool.
+ ** - the render job retrieves the data through MediaRead::data(); should the IO job not
+ **   have been performed (e.g. because its deadline was missed), the data is loaded
+ **   synchronously at that point as a fall-back.
+ ** @note the IO job refers to the request only weakly, since the Scheduler silently discards
+ **       a job not invoked before its deadline; the request is kept alive by the MediaRead
+ **       handles and by load operations in flight, and an orphaned IO job does nothing.
+ ** @see MappingCache
+ ** @see MediaRead_test
+ */
+
+
+#ifndef SRC_VAULT_IO_MEDIA_READ_H_
+#define SRC_VAULT_IO_MEDIA_READ_H_
+
+
+#include "vault/common.hpp"
+#include "vault/io/mapping-cache.hpp"
+#include "vault/gear/job.h"
+#include "lib/time/timevalue.hpp"
+
+#include <memory>
+
+
+namespace vault{
+namespace io {
+  
+  using lib::time::Time;
+  
+  
+  class AsyncIO;
+  
+  
+  /**
+   * Handle for reading a range of media data, which can be loaded
+   * by a prerequisite IO job. Copies refer to the same request.
+   */
+  class MediaRead
+    {
+      class Request;
+      class LoadJob;
+      std::shared_ptr<Request> req_;
+      
+    public:
+      MediaRead (MappingCache&, FileID, size_t offset, size_t bytes, Direction =FORWARD);
+      
+      gear::Job prefetchJob (Time nominalTime =Time::ANYTIME);
+      gear::Job prefetchJob (AsyncIO&, Time nominalTime =Time::ANYTIME);
+      
+      MappedRange const& data();
+      bool isLoaded()  const;
+      void release();
+    };
+  
+  
+}} // namespace vault::io
+#endif /*SRC_VAULT_IO_MEDIA_READ_H_*/
@@ -23,6 +23,11 @@
  ** and down to avoid holding larger amounts of unused memory, while the availability
  ** of a baseline amount of memory can be enforced.
  ** 
+ ** By default, each Extent is allocated individually from the heap. Alternatively,
+ ** an ExtentPolicy can demand to carve all extents from one contiguous virtual
+ ** [address range](\ref reserved-range.hpp) reserved upfront, optionally backed
+ ** by huge pages and pre-faulted on allocation.
+ ** 
  ** @see ExtentFamily_test
  ** @see gear::BlockFlow usage example
  */
@@ -33,6 +38,7 @@
 
 
 #include "vault/common.hpp"
+#include "vault/mem/reserved-range.hpp"
 #include "lib/uninitialised-storage.hpp"
 #include "lib/iter-adapter.hpp"
 #include "lib/nocopy.hpp"
@@ -87,20 +93,46 @@ namespace mem {
       
       
     private:
-      using _UniqueStoragePtr = std::unique_ptr<lib::UninitialisedStorage<T,siz>>;
+      using RawStorage = lib::UninitialisedStorage<T,siz>;
+      
+      /** discard heap allocated storage; storage carved from a
+       *  ReservedRange is released together with the range */
+      struct Release
+        {
+          bool fromHeap{true};
+          
+          void
+          operator() (RawStorage* storage)
+            {
+              if (fromHeap)
+                delete storage;
+            }
+        };
+      using _UniqueStoragePtr = std::unique_ptr<RawStorage, Release>;
       
       /** Entry in the Extents management datastructure */
       struct Storage
         : _UniqueStoragePtr
         {
           /**
-           * @note default ctor immediately allocates the full storage,
+           * @note ctor immediately allocates the full storage,
            *       but without any initialisation of memory content
            */
-          Storage()
-            : _UniqueStoragePtr{new lib::UninitialisedStorage<T,siz>}
+          Storage (ReservedRange* range)
+            : _UniqueStoragePtr{allocate (range)}
             { }
           
+          static _UniqueStoragePtr
+          allocate (ReservedRange* range)
+            {
+              void* raw = range? range->carve (sizeof(RawStorage), alignof(RawStorage))
+                               : nullptr;
+              if (raw)
+                return _UniqueStoragePtr{new(raw) RawStorage, Release{false}};
+              else
+                return _UniqueStoragePtr{new RawStorage, Release{true}};
+            }
+          
           /** access projected Extent storage type
            * @warning payload is uninitialised and dtors won't be invoked
            */
@@ -195,16 +227,20 @@ namespace mem {
       
       /* ==== Management Data ==== */
       
+      std::unique_ptr<ReservedRange> range_;
       Extents extents_;
       size_t start_,after_;
       
     public:
       explicit
-      ExtentFamily(size_t initialCnt =1)
-        : extents_{initialCnt}
+      ExtentFamily(size_t initialCnt =1, ExtentPolicy policy =ExtentPolicy{})
+        : range_{policy.reserveRange? new ReservedRange{policy} : nullptr}
+        , extents_{}
         , start_{0}        //  Extents allocated yet marked unused
         , after_{0}
-        { }
+        {
+          addExtents (initialCnt);
+        }
       
       void
       reserve (size_t expectedMaxExtents)
@@ -229,7 +265,7 @@ namespace mem {
                               + EXCESS_ALLOC;
               // add a strike of new extents at the end
               ___sanityCheckAllocSize (addSiz);
-              extents_.resize (oldSiz + addSiz);
+              addExtents (addSiz);
               if (isWrapped())
                 {// need the new elements in the middle, before the existing start_
                   auto p = extents_.begin();
@@ -282,6 +318,13 @@ namespace mem {
       
       
     private: /* ====== storage management implementation ====== */
+      void
+      addExtents (size_t cnt)
+        {
+          for (size_t i=0; i<cnt; ++i)
+            extents_.emplace_back (range_.get());
+        }
+      
       bool
       isWrapped()  const
         {
@@ -391,6 +434,10 @@ namespace mem {
       size_t last()   { return exFam_.after_; }
       size_t size()   { return exFam_.slotCnt(); }
       size_t active() { return exFam_.activeSlotCnt(); }
+      
+      /** @return number of bytes carved from a reserved address range */
+      size_t reserved() { return exFam_.range_? exFam_.range_->used() : 0; }
+      bool   hugePages(){ return exFam_.range_ and exFam_.range_->usesHugePages(); }
     };
   
   template<typename T, size_t siz>
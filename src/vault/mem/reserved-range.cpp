@@ -0,0 +1,131 @@
+/*
+  ReservedRange  -  contiguous virtual address range to carve storage extents
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+
+/** @file reserved-range.cpp
+ ** Implementation of address range reservation based on `mmap` (Linux).
+ */
+
+
+#include "vault/mem/reserved-range.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace vault{
+namespace mem {
+  
+  namespace { // internal details
+    
+    const size_t HUGE_PAGE_SIZ = 2_MiB;
+    
+    size_t
+    pageSize()
+    {
+      static const size_t PAGE_SIZ = sysconf (_SC_PAGESIZE);
+      return PAGE_SIZ;
+    }
+    
+    size_t
+    roundUp (size_t bytes, size_t unit)
+    {
+      return (bytes + unit-1) / unit * unit;
+    }
+    
+    char*
+    mapAnonymous (size_t bytes, int extraFlags)
+    {
+      void* addr = mmap (nullptr, bytes
+                        ,PROT_READ | PROT_WRITE
+                        ,MAP_PRIVATE | MAP_ANONYMOUS | extraFlags
+                        ,-1, 0);
+      return addr == MAP_FAILED? nullptr : static_cast<char*> (addr);
+    }
+  }
+  
+  
+  
+  /**
+   * Reserve the address range, falling back from explicit
+   * huge pages to transparent huge pages to standard pages.
+   * @note explicit huge pages are committed for the whole range
+   *       at once, since faulting on a page not backed by the
+   *       huge page pool would raise `SIGBUS`
+   * @note the range remains unmapped (and the ExtentFamily
+   *       uses the heap) if no mapping could be established.
+   */
+  ReservedRange::ReservedRange (ExtentPolicy const& policy)
+    : prefault_{policy.prefault}
+    {
+      size_ = roundUp (policy.reserve, HUGE_PAGE_SIZ);
+#ifdef MAP_HUGETLB
+      if (ExtentPolicy::EXPLICIT_HUGE == policy.pages)
+        {
+          base_ = mapAnonymous (size_, MAP_HUGETLB);      // fails unless the pool can provide the whole range
+          huge_ = bool(base_);
+        }
+#endif
+      if (not base_)
+        base_ = mapAnonymous (size_, MAP_NORESERVE);
+      if (not base_)
+        {
+          WARN (mmap, "unable to reserve %zu bytes of address space for memory extents", size_);
+          size_ = 0;
+          return;
+        }
+#ifdef MADV_HUGEPAGE
+      if (not huge_ and ExtentPolicy::DEFAULT_PAGES != policy.pages)
+        huge_ = 0 == madvise (base_, size_, MADV_HUGEPAGE);
+#endif
+    }
+  
+  ReservedRange::~ReservedRange()
+    {
+      if (base_)
+        munmap (base_, size_);
+    }
+  
+  
+  void*
+  ReservedRange::carve (size_t bytes, size_t alignment)
+  {
+    size_t start = roundUp (used_, alignment);
+    if (not base_ or start + bytes > size_)
+      return nullptr;
+    used_ = start + bytes;
+    if (prefault_)
+      populate (base_+start, bytes);
+    return base_+start;
+  }
+  
+  
+  /** @internal ensure the pages are mapped, by writing to each page;
+   *  for freshly mapped anonymous memory, this does not alter content */
+  void
+  ReservedRange::populate (char* start, size_t bytes)
+  {
+#ifdef MADV_POPULATE_WRITE
+    char* firstPage = base_ + (start-base_) / pageSize() * pageSize();
+    if (0 == madvise (firstPage, size_t(start+bytes - firstPage), MADV_POPULATE_WRITE))
+      return;
+#endif
+    size_t page = pageSize();
+    volatile char* p = start;
+    for (size_t off = 0; off < bytes; off += page)
+      p[off] = p[off];
+    p[bytes-1] = p[bytes-1];
+  }
+  
+  
+}} // namespace vault::mem
@@ -0,0 +1,113 @@
+/*
+  RESERVED-RANGE.hpp  -  contiguous virtual address range to carve storage extents
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+*/
+
+
+/** @file reserved-range.hpp
+ ** Allocation policy for memory extents, based on a reserved address range.
+ ** By default, the ExtentFamily allocates each Extent individually from the heap.
+ ** Since the Scheduler claims new extents at a high rate during the first seconds
+ ** of playback, the costs of page faults and TLB misses become noticeable. As an
+ ** alternative, one large contiguous range of virtual memory can be reserved
+ ** upfront, from which the extents are then carved sequentially, without ever
+ ** calling into the general heap allocator. Optionally
+ ** - the range can be backed by huge pages, either explicitly (`MAP_HUGETLB`),
+ **   which requires the administrator to provide a pool of huge pages, or by
+ **   advising the kernel to use _transparent huge pages_ (`MADV_HUGEPAGE`)
+ ** - memory can be pre-faulted whenever new extents are carved, so that the
+ **   page faults happen when allocating, rather than on first use in the
+ **   render workers.
+ ** The range is reserved without committing memory (`MAP_NORESERVE`), and is
+ ** released as a whole when the owning ExtentFamily is discarded. If the range
+ ** can not be mapped, or is exhausted, allocation falls back to the heap.
+ ** @see ExtentFamily
+ ** @see blockFlow::Strategy::extentPolicy()
+ ** @see ExtentFamily_test::reservedRange()
+ */
+
+
+#ifndef SRC_VAULT_MEM_RESERVED_RANGE_H_
+#define SRC_VAULT_MEM_RESERVED_RANGE_H_
+
+
+#include "vault/common.hpp"
+#include "lib/meta/util.hpp"
+#include "lib/nocopy.hpp"
+
+#include <cstddef>
+
+
+namespace vault{
+namespace mem {
+  
+  
+  /**
+   * Parametrisation how to allocate memory extents.
+   * Default is to allocate each Extent from the heap.
+   */
+  struct ExtentPolicy
+    {
+      enum Pages { DEFAULT_PAGES     ///< use the standard page size
+                 , TRANSPARENT_HUGE  ///< advise the kernel to use transparent huge pages
+                 , EXPLICIT_HUGE     ///< commit the whole range from the huge page pool, else fall back to transparent
+                 };
+      
+      bool   reserveRange{false};    ///< carve all extents from a contiguous virtual address range
+      Pages  pages{DEFAULT_PAGES};
+      bool   prefault{false};        ///< touch the memory of newly carved extents
+      size_t reserve{1_GiB};         ///< size of the virtual address range to reserve
+    };
+  
+  
+  /**
+   * Contiguous range of virtual memory, reserved upfront,
+   * from which storage is carved sequentially.
+   * Storage can not be returned individually; the
+   * whole range is unmapped on destruction.
+   */
+  class ReservedRange
+    : util::NonCopyable
+    {
+      char*  base_{nullptr};
+      size_t size_{0};
+      size_t used_{0};
+      bool   huge_{false};
+      bool   prefault_;
+      
+    public:
+      explicit
+      ReservedRange (ExtentPolicy const& policy);
+     ~ReservedRange();
+      
+      explicit operator bool()  const { return base_; }
+      
+      size_t size()           const { return size_; }
+      size_t used()           const { return used_; }
+      bool   usesHugePages()  const { return huge_; }
+      
+      bool
+      contains (const void* addr)  const
+        {
+          return base_ <= addr and addr < base_+size_;
+        }
+      
+      /** claim the next chunk of storage
+       * @return `nullptr` if the range is exhausted */
+      void* carve (size_t bytes, size_t alignment);
+      
+    private:
+      void populate (char* start, size_t bytes);
+    };
+  
+  
+}} // namespace vault::mem
+#endif /*SRC_VAULT_MEM_RESERVED_RANGE_H_*/
@@ -21,15 +21,20 @@
 #include "lib/test/test-helper.hpp"
 #include "steam/engine/buffer-metadata.hpp"
 #include "steam/engine/testframe.hpp"
+#include "lib/scoped-collection.hpp"
+#include "lib/thread.hpp"
 #include "lib/util.hpp"
 
 #include <memory>
+#include <vector>
 
 using std::strncpy;
 using std::unique_ptr;
 using lib::test::randStr;
 using util::isSameObject;
 using util::isnil;
+using lib::ThreadJoinable;
+using std::vector;
 
 
 namespace steam {
@@ -96,6 +101,10 @@ namespace test  {
           verifyBasicProperties();
           verifyStandardCase();
           verifyStateMachine();
+          verifyTableExtension();
+          verifyReservation();
+          verifyTombstoneReclaim();
+          verifyConcurrentLocking();
         }
       
       
@@ -399,6 +408,189 @@ namespace test  {
           CHECK (!meta_->isKnown(entry));
           CHECK ( meta_->isKnown(key));
         }
+      
+      
+      /** @test the metadata table is extended on demand or when reserving capacity;
+       *        existing entries remain at their storage location, and the storage
+       *        of released entries is reused when locking the same buffers again.
+       */
+      void
+      verifyTableExtension()
+        {
+          BufferMetadata meta{"verifyTableExtension"};
+          metadata::Key key = meta.key(SIZE_A);
+          size_t initialCapacity = meta.capacity();
+          CHECK (0 < initialCapacity);
+          
+          // reserving space covered by the current capacity allocates nothing
+          meta.reserve (initialCapacity/2);
+          CHECK (initialCapacity == meta.capacity());
+          
+          const uint CNT = 10 * initialCapacity;
+          vector<int> buffers(CNT);
+          auto entryID = [&](uint i){ return HashVal(metadata::Key::forEntry (key, mark_as_Buffer(buffers[i]))); };
+          
+          metadata::Entry& first = meta.markLocked (key, mark_as_Buffer(buffers[0]));
+          for (uint i=1; i<CNT; ++i)
+            meta.markLocked (key, mark_as_Buffer(buffers[i]));
+          CHECK (CNT < meta.capacity());
+          CHECK (isSameObject (first, meta.get (entryID(0))));
+          
+          for (uint i=0; i<CNT; ++i)
+            {
+              CHECK (meta.isLocked (entryID(i)));
+              meta.get(entryID(i)).mark(FREE);
+              meta.release (entryID(i));
+              CHECK (not meta.isKnown (entryID(i)));
+            }
+          size_t capacity = meta.capacity();
+          
+          // locking the same buffers again reuses the released storage
+          for (uint round=0; round<10; ++round)
+            {
+              for (uint i=0; i<CNT; ++i)
+                meta.markLocked (key, mark_as_Buffer(buffers[i]));
+              for (uint i=0; i<CNT; ++i)
+                {
+                  metadata::Entry& entry = meta.get (entryID(i));
+                  entry.mark(FREE);
+                  meta.release (entry);
+                }
+            }
+          CHECK (capacity == meta.capacity());
+          CHECK (meta.isKnown (key));
+          
+          // reserve space for further entries upfront
+          meta.reserve (3*capacity);
+          CHECK (3*capacity < meta.capacity());
+        }
+      
+      
+      /** @test reservations add up, and the reserved number of entries can be
+       *        stored without extending the table; tombstones of released
+       *        entries do not block buckets for the reservation.
+       */
+      void
+      verifyReservation()
+        {
+          BufferMetadata meta{"verifyReservation"};
+          metadata::Key key = meta.key(SIZE_B);
+          const uint CNT = meta.capacity() / 4;
+          
+          vector<int> buffers(5*CNT);
+          auto entryID = [&](uint i){ return HashVal(metadata::Key::forEntry (key, mark_as_Buffer(buffers[i]))); };
+          auto lockAll    = [&](uint from, uint to){ for (uint i=from; i<to; ++i) meta.markLocked (key, mark_as_Buffer(buffers[i])); };
+          auto releaseAll = [&](uint from, uint to){ for (uint i=from; i<to; ++i)
+                                                       {
+                                                         metadata::Entry& entry = meta.get (entryID(i));
+                                                         entry.mark(FREE);
+                                                         meta.release (entry);
+                                                       }};
+          // tombstones of released entries are cleared
+          lockAll (0, CNT);
+          releaseAll (0, CNT);
+          size_t initialCapacity = meta.capacity();
+          meta.reserve (CNT);
+          CHECK (initialCapacity == meta.capacity());
+          
+          // further announcements add up
+          meta.reserve (CNT);
+          meta.reserve (CNT);
+          meta.reserve (CNT);
+          size_t capacity = meta.capacity();
+          CHECK (initialCapacity < capacity);
+          
+          // fill up to the reserved count with other buffers
+          lockAll (CNT, 5*CNT);
+          CHECK (capacity == meta.capacity());              // no extension was necessary
+          releaseAll (CNT, 5*CNT);
+        }
+      
+      
+      /** @test under continuous churn with ever new buffer addresses, tombstones
+       *        are reclaimed and the table does not grow beyond a small multiple
+       *        of the entries actually in use.
+       */
+      void
+      verifyTombstoneReclaim()
+        {
+          BufferMetadata meta{"verifyTombstoneReclaim"};
+          metadata::Key key = meta.key(SIZE_A);
+          size_t initialCapacity = meta.capacity();
+          const uint INUSE = initialCapacity / 2;
+          const uint CNT = 50 * initialCapacity;
+          
+          vector<int> buffers(CNT);
+          auto entryID = [&](uint i){ return HashVal(metadata::Key::forEntry (key, mark_as_Buffer(buffers[i % CNT]))); };
+          for (uint i=0; i < 20*CNT; ++i)
+            {
+              meta.markLocked (key, mark_as_Buffer(buffers[i % CNT]));
+              if (i >= INUSE)
+                {
+                  metadata::Entry& entry = meta.get (entryID (i-INUSE));
+                  entry.mark(FREE);
+                  meta.release (entry);
+                }
+            }
+          CHECK (meta.capacity() <= 8*initialCapacity);
+          for (uint i=20*CNT-INUSE; i < 20*CNT; ++i)
+            {
+              meta.get(entryID(i)).mark(FREE);
+              meta.release (entryID(i));
+            }
+        }
+      
+      
+      /** @test several threads lock and release distinct buffers concurrently,
+       *        while also looking up the entries of other threads.
+       */
+      void
+      verifyConcurrentLocking()
+        {
+          const uint THREADS = 4;
+          const uint BUFFS   = 50;
+          const uint ROUNDS  = 500;
+          
+          BufferMetadata meta{"verifyConcurrentLocking"};
+          metadata::Key key = meta.key(SIZE_B);
+          meta.reserve (THREADS * BUFFS);
+          size_t capacity = meta.capacity();
+          
+          vector<int> buffers(THREADS * BUFFS);
+          auto entryID = [&](uint i){ return HashVal(metadata::Key::forEntry (key, mark_as_Buffer(buffers[i]))); };
+          
+          vector<size_t> seen(THREADS, 0);
+          auto lockRelease = [&](uint thread)
+                                {
+                                  for (uint round=0; round<ROUNDS; ++round)
+                                    {
+                                      for (uint b=0; b<BUFFS; ++b)
+                                        meta.markLocked (key, mark_as_Buffer(buffers[thread*BUFFS + b]));
+                                      for (uint i=0; i<THREADS*BUFFS; ++i)
+                                        if (meta.isKnown (entryID(i)))
+                                          ++seen[thread];
+                                      for (uint b=0; b<BUFFS; ++b)
+                                        {
+                                          metadata::Entry& entry = meta.get (entryID (thread*BUFFS + b));
+                                          entry.mark(FREE);
+                                          meta.release (entry);
+                                        }
+                                    }
+                                };
+          {
+            lib::ScopedCollection<ThreadJoinable<>> workers{THREADS};
+            for (uint t=0; t<THREADS; ++t)
+              workers.emplace ("BufferMetadata_test: worker", lockRelease, t);
+            for (auto& worker : workers)
+              worker.join();
+          }
+          
+          for (uint t=0; t<THREADS; ++t)
+            CHECK (ROUNDS*BUFFS <= seen[t]);                  // each thread saw at least its own buffers
+          for (uint i=0; i<THREADS*BUFFS; ++i)
+            CHECK (not meta.isKnown (entryID(i)));
+          CHECK (capacity == meta.capacity());              // no extension was necessary
+        }
     };
   
   
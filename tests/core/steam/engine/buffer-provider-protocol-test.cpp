@@ -23,6 +23,7 @@
 #include "lib/util-foreach.hpp"
 #include "steam/engine/testframe.hpp"
 #include "steam/engine/diagnostic-buffer-provider.hpp"
+#include "steam/engine/pooled-buffer-provider.hpp"
 #include "steam/engine/buffhandle-attach.hpp"
 #include "steam/engine/bufftable.hpp"
 
@@ -65,7 +66,8 @@ namespace test  {
    *       
    *       This test should help understanding the sequence of buffer management
    *       operations performed at various stages while passing an calculation job
-   *       through the render engine.
+   *       through the render engine. Moreover, the same protocol is verified
+   *       against the PooledBufferProvider used for actual rendering.
    */
   class BufferProviderProtocol_test : public Test
     {
@@ -74,8 +76,13 @@ namespace test  {
         {
           verifySimpleUsage();
           verifyStandardCase();
-          verifyObjectAttachment();
-          verifyObjectAttachmentFailure();
+          verifyObjectAttachment (DiagnosticBufferProvider::build());
+          verifyObjectAttachmentFailure (DiagnosticBufferProvider::build());
+          
+          PooledBufferProvider pooledProvider;
+          verifyPooledUsage (pooledProvider);
+          verifyObjectAttachment (pooledProvider);
+          verifyObjectAttachmentFailure (pooledProvider);
         }
       
       
@@ -108,6 +115,33 @@ namespace test  {
         }
       
       
+      /** @test the same usage cycle, performed with a provider for rendering,
+       *        after announcing the required number of buffers beforehand.
+       */
+      void
+      verifyPooledUsage (BufferProvider& provider)
+        {
+          BuffDescr type = provider.getDescriptor<TestFrame>();
+          CHECK (TEST_ELMS == provider.announce (TEST_ELMS, type));
+          
+          BuffHandle buff = provider.lockBuffer (type);
+          CHECK (buff.isValid());
+          CHECK (buff.isKindOf (type));
+          CHECK (not buff.isKindOf (provider.getDescriptor<uint>()));
+          CHECK (sizeof(TestFrame) <= buff.size());
+          TestFrame& content = buff.accessAs<TestFrame>();
+          CHECK (content.isSane());
+          content = testData(1);
+          CHECK (testData(1) == buff.accessAs<TestFrame>());
+          
+          buff.emit();
+          buff.release();
+          CHECK (!buff.isValid());
+          CHECK (content.isDead());
+          VERIFY_ERROR (LIFECYCLE, buff.accessAs<TestFrame>() );
+        }
+      
+      
       void
       verifyStandardCase()
         {
@@ -146,9 +180,8 @@ namespace test  {
       
       
       void
-      verifyObjectAttachment()
+      verifyObjectAttachment (BufferProvider& provider)
         {
-          BufferProvider& provider = DiagnosticBufferProvider::build();
           BuffDescr type_A = provider.getDescriptorFor(sizeof(TestFrame));
           BuffDescr type_B = provider.getDescriptorFor(sizeof(int));
           BuffDescr type_C = provider.getDescriptor<int>();
@@ -183,9 +216,8 @@ namespace test  {
       
       
       void
-      verifyObjectAttachmentFailure()
+      verifyObjectAttachmentFailure (BufferProvider& provider)
         {
-          BufferProvider& provider = DiagnosticBufferProvider::build();
           BuffDescr type_D = provider.getDescriptorFor(sizeof(Dummy));
           
           Dummy::checksum() = 0;
@@ -219,6 +251,7 @@ namespace test  {
           
           VERIFY_ERROR (LIFECYCLE, handle_DD.accessAs<Dummy>() );
           VERIFY_ERROR (LIFECYCLE, handle_DD.create<Dummy>() );
+          Dummy::activateCtorFailure (false);
         }
     };
   
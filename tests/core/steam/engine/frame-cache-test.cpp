@@ -0,0 +1,364 @@
+/*
+  FrameCache(Test)  -  verify caching of rendered frames with adaptive replacement
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file frame-cache-test.cpp
+ ** unit test \ref FrameCache_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "steam/engine/frame-cache.hpp"
+#include "steam/engine/node-builder.hpp"
+#include "steam/engine/diagnostic-buffer-provider.hpp"
+#include "steam/engine/testframe.hpp"
+#include "steam/fixture/segment.hpp"
+#include "lib/time/timevalue.hpp"
+#include "lib/util.hpp"
+
+#include <array>
+
+using lib::time::Time;
+using lib::time::FSecs;
+using lib::time::TimeSpan;
+using util::isSameAdr;
+using std::array;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  namespace { // Test fixture
+    
+    const size_t FRAME_SIZ = 1000;
+    const HashVal PROC = 0xBEEF;
+    
+    FrameKey
+    keyFor (uint frameNr, HashVal proc =PROC)
+    {
+      return FrameKey{proc, Time{FSecs(frameNr)}, 0};
+    }
+    
+    /** compute a »frame« filled with a marker value and store it into the cache */
+    void
+    render (FrameCache& cache, FrameKey key, char mark)
+    {
+      BuffHandle buff = cache.lockBuffer (cache.getDescriptorFor (FRAME_SIZ));
+      array<char,FRAME_SIZ>& data = buff.accessAs<array<char,FRAME_SIZ>>();
+      data.fill (mark);
+      cache.remember (key, buff);
+      buff.release();
+    }
+    
+    bool
+    holds (BuffHandle buff, char mark)
+    {
+      auto& data = buff.accessAs<array<char,FRAME_SIZ>>();
+      for (char c : data)
+        if (c != mark) return false;
+      return true;
+    }
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify the cache for rendered frames, which is consulted
+   *       by the Turnout prior to pulling input data.
+   *       - frames are looked up by processing hash, time and process key
+   *       - cached data is copied into the output buffer
+   *       - eviction follows the adaptive replacement policy (ARC)
+   *       - cached frames can be invalidated by time range
+   *       - a cache attached to a node invocation prevents recalculation
+   *       - identical processing with identical parameters shares results
+   *       - only the exit port and ports opting in are cached
+   *       - buffers holding an object are not cached
+   * @see frame-cache.hpp
+   * @see NodeBuilder_test
+   */
+  class FrameCache_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          simpleUsage();
+          verifyAdaptiveReplacement();
+          verifyInvalidation();
+          verifyNodeInvocation();
+          verifyTypeHandler();
+        }
+      
+      
+      /** @test remember a frame and retrieve a copy of the data */
+      void
+      simpleUsage()
+        {
+          FrameCache cache{10*FRAME_SIZ};
+          CHECK (not cache.recall (keyFor(1)));
+          CHECK (1 == cache.cntMisses());
+          
+          render (cache, keyFor(1), 'a');
+          CHECK (cache.contains (keyFor(1)));
+          CHECK (not cache.contains (keyFor(1, PROC+1)));
+          CHECK (1 == cache.cntFrames());
+          CHECK (FRAME_SIZ == cache.usedBytes());
+          
+          // retrieve into a buffer provided by the cache
+          auto found = cache.recall (keyFor(1));
+          CHECK (found);
+          CHECK (FRAME_SIZ == found->size());
+          CHECK (holds (*found, 'a'));
+          CHECK (1 == cache.cntHits());
+          
+          // the buffer is a copy and may be manipulated freely
+          found->accessAs<char>() = 'x';
+          found->release();
+          
+          // retrieve into a buffer from another provider
+          BufferProvider& provider = DiagnosticBufferProvider::build();
+          BuffHandle outBuff = provider.lockBuffer (provider.getDescriptorFor (FRAME_SIZ));
+          auto copy = cache.recall (keyFor(1), outBuff);
+          CHECK (copy);
+          CHECK (isSameAdr (*outBuff, **copy));
+          CHECK (holds (outBuff, 'a'));
+          CHECK (2 == cache.cntHits());
+          outBuff.release();
+          
+          // a frame requested repeatedly is moved to the frequency list
+          CHECK (0 == cache.cntRecent());
+          CHECK (1 == cache.cntFrequent());
+          
+          cache.clear();
+          CHECK (0 == cache.cntFrames());
+          CHECK (0 == cache.usedBytes());
+        }
+      
+      
+      /** @test within the budget, frames are evicted according to ARC
+       *        - frames requested repeatedly survive a scan of new frames
+       *        - the keys of evicted frames are retained as ghost entries
+       *        - recalculating a frame evicted recently adapts the target
+       *          size of the recency list and inserts into the frequency list
+       */
+      void
+      verifyAdaptiveReplacement()
+        {
+          FrameCache cache{4*FRAME_SIZ};
+          for (uint i=0; i<4; ++i)
+            render (cache, keyFor(i), 'a'+i);
+          CHECK (4 == cache.cntFrames());
+          CHECK (0 == cache.cntEvictions());
+          
+          CHECK (cache.recall (keyFor(0)));
+          CHECK (cache.recall (keyFor(1)));
+          CHECK (2 == cache.cntFrequent());
+          
+          // scan over a sequence of new frames
+          for (uint i=4; i<=20; ++i)
+            render (cache, keyFor(i), 'a'+i);
+          CHECK (4*FRAME_SIZ == cache.usedBytes());
+          CHECK (4 == cache.cntFrames());
+          CHECK (17 == cache.cntEvictions());
+          CHECK (cache.contains (keyFor(0)));
+          CHECK (cache.contains (keyFor(1)));
+          CHECK (cache.contains (keyFor(20)));
+          CHECK (cache.contains (keyFor(19)));
+          CHECK (not cache.contains (keyFor(18)));
+          CHECK (2 == cache.cntGhosts());
+          CHECK (0 == cache.adaptiveTarget());
+          
+          // a frame evicted recently is requested again
+          CHECK (not cache.recall (keyFor(18)));
+          render (cache, keyFor(18), 'X');
+          CHECK (FRAME_SIZ == cache.adaptiveTarget());
+          CHECK (3 == cache.cntFrequent());
+          CHECK (1 == cache.cntRecent());
+          CHECK (cache.contains (keyFor(18)));
+          CHECK (cache.contains (keyFor(20)));
+          CHECK (not cache.contains (keyFor(19)));
+          
+          auto found = cache.recall (keyFor(18));
+          CHECK (holds (*found, 'X'));
+          found->release();
+          
+          // frames exceeding the budget are not cached
+          FrameCache tiny{FRAME_SIZ/2};
+          render (tiny, keyFor(1), 'a');
+          CHECK (0 == tiny.cntFrames());
+        }
+      
+      
+      /** @test discard all frames within the time range of a changed segment */
+      void
+      verifyInvalidation()
+        {
+          FrameCache cache{10*FRAME_SIZ};
+          for (uint i=0; i<10; ++i)
+            render (cache, keyFor(i), 'a');
+          CHECK (10 == cache.cntFrames());
+          
+          CHECK (3 == cache.invalidate (TimeSpan{Time{FSecs(3)}, Time{FSecs(6)}}));
+          CHECK (7 == cache.cntFrames());
+          CHECK (    cache.contains (keyFor(2)));
+          CHECK (not cache.contains (keyFor(3)));
+          CHECK (not cache.contains (keyFor(5)));
+          CHECK (    cache.contains (keyFor(6)));
+          
+          fixture::Segment changed{TimeSpan{Time{FSecs(8)}, FSecs(10)}};
+          CHECK (2 == cache.invalidate (changed));
+          CHECK (5 == cache.cntFrames());
+          CHECK (not cache.contains (keyFor(9)));
+          CHECK (    cache.contains (keyFor(7)));
+        }
+      
+      
+      /** @test pull from a chain of render nodes with a cache attached:
+       *        results are retrieved from the cache without recursing
+       *        into the predecessor nodes, as long as the same frame
+       *        is requested repeatedly.
+       */
+      void
+      verifyNodeInvocation()
+        {
+          uint cntCalc{0};
+          auto sourceFun = [&](uint param, uint* out){ ++cntCalc; *out = param; };
+          auto filterFun = [&](uint* in, uint* out)  { ++cntCalc; *out = 2 * *in; };
+          auto frameNr   = [](TurnoutSystem& tus)    { return uint(_raw(tus.getNomTime()) / 1000); };
+          
+          ProcNode src{prepareNode("Src")
+                          .preparePort()
+                            .invoke ("gen()", sourceFun)
+                            .attachParamFun (frameNr)
+                            .completePort()
+                          .build()};
+          ProcNode filter{prepareNode("Filter")
+                          .preparePort()
+                            .invoke ("double()", filterFun)
+                            .connectLead(src)
+                            .completePort()
+                          .build()};
+          
+          // the processing hash covers the predecessor ports
+          HashVal srcHash = watch(src).getPortHash(0);
+          HashVal filterHash = watch(filter).getPortHash(0);
+          CHECK (srcHash);
+          CHECK (filterHash);
+          CHECK (srcHash != filterHash);
+          CHECK (srcHash == watch(filter).watchLead(0).getPortHash(0));
+          
+          // identical processing yields the same hash, discerned by parameter values
+          auto hashWithParam = [&](uint val)
+                                  {
+                                    ProcNode other{prepareNode("Src")
+                                                     .preparePort()
+                                                       .invoke ("gen()", sourceFun)
+                                                       .setParam (val)
+                                                       .completePort()
+                                                     .build()};
+                                    return watch(other).getPortHash(0);
+                                  };
+          CHECK (hashWithParam(5) == hashWithParam(5));
+          CHECK (hashWithParam(5) != hashWithParam(23));
+          CHECK (hashWithParam(5) != srcHash);
+          
+          FrameCache cache{100*sizeof(uint)};
+          BufferProvider& provider = DiagnosticBufferProvider::build();
+          auto invoke = [&](Time nomTime)
+                          {
+                            BuffHandle buff = provider.lockBufferFor<uint> (0);
+                            buff = filter.pull (0, buff, nomTime, ProcessKey{0}, cache);
+                            uint result = buff.accessAs<uint>();
+                            buff.release();
+                            return result;
+                          };
+          
+          Time t1{FSecs(1)}, t2{FSecs(2)};
+          CHECK (2000 == invoke (t1));
+          CHECK (2 == cntCalc);
+          CHECK (1 == cache.cntFrames());         // only the result of the exit port
+          CHECK (    cache.contains (FrameKey{filterHash, t1, 0}));
+          CHECK (not cache.contains (FrameKey{srcHash, t1, 0}));
+          
+          CHECK (2000 == invoke (t1));
+          CHECK (2 == cntCalc);                   // no recalculation
+          CHECK (1 == cache.cntHits());
+          
+          CHECK (4000 == invoke (t2));
+          CHECK (4 == cntCalc);
+          
+          // after invalidation the source is recalculated
+          cache.invalidate (TimeSpan{t1, FSecs(1)});
+          CHECK (2000 == invoke (t1));
+          CHECK (6 == cntCalc);
+          
+          // without cache, the frame is always calculated
+          BuffHandle buff = provider.lockBufferFor<uint> (0);
+          buff = filter.pull (0, buff, t1, ProcessKey{0});
+          CHECK (2000 == buff.accessAs<uint>());
+          buff.release();
+          CHECK (8 == cntCalc);
+          
+          // a port can opt in to be cached also when pulled as lead
+          ProcNode cachedSrc{prepareNode("Src")
+                                .preparePort()
+                                  .invoke ("gen()", sourceFun)
+                                  .attachParamFun (frameNr)
+                                  .cacheResults()
+                                  .completePort()
+                                .build()};
+          ProcNode cachedFilter{prepareNode("Filter")
+                                .preparePort()
+                                  .invoke ("double()", filterFun)
+                                  .connectLead(cachedSrc)
+                                  .completePort()
+                                .build()};
+          cache.clear();
+          buff = provider.lockBufferFor<uint> (0);
+          buff = cachedFilter.pull (0, buff, t1, ProcessKey{0}, cache);
+          CHECK (2000 == buff.accessAs<uint>());
+          buff.release();
+          CHECK (10 == cntCalc);
+          CHECK (2 == cache.cntFrames());         // both source and filter result
+          CHECK (cache.contains (FrameKey{watch(cachedSrc).getPortHash(0), t1, 0}));
+        }
+      
+      
+      /** @test buffers holding an object of non trivially copyable type
+       *        are not cached, since the data is copied as plain bytes. */
+      void
+      verifyTypeHandler()
+        {
+          FrameCache cache{100*sizeof(TestFrame)};
+          BufferProvider& provider = DiagnosticBufferProvider::build();
+          BuffHandle buff = provider.lockBuffer (provider.getDescriptor<TestFrame>());
+          CHECK (not buff.isPlainData());
+          cache.remember (keyFor(1), buff);
+          CHECK (not cache.contains (keyFor(1)));
+          CHECK (0 == cache.cntFrames());
+          buff.release();
+          
+          BuffHandle raw = provider.lockBufferFor<uint> (0);
+          CHECK (raw.isPlainData());                 // object of trivially copyable type
+          cache.remember (keyFor(2), raw);
+          CHECK (cache.contains (keyFor(2)));
+          raw.release();
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (FrameCache_test, "unit engine");
+  
+  
+  
+}}} // namespace steam::engine::test
@@ -0,0 +1,335 @@
+/*
+  JobPlanningBatch(Test)  -  plan a chunk of frames with batched JobTicket resolution
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file job-planning-batch-test.cpp
+ ** unit test \ref JobPlanningBatch_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "steam/engine/planning-batch.hpp"
+#include "steam/engine/mock-dispatcher.hpp"
+#include "vault/gear/scheduler.hpp"
+#include "lib/format-string.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/util.hpp"
+
+#include <thread>
+
+
+using test::Test;
+using lib::time::FrameRate;
+using lib::test::benchmarkTime;
+using util::isnil;
+using util::_Fmt;
+using std::this_thread::sleep_for;
+using std::chrono_literals::operator ""ms;
+
+
+namespace steam {
+namespace engine{
+namespace test  {
+  
+  using vault::gear::Scheduler;
+  using vault::gear::BlockFlowAlloc;
+  using vault::gear::EngineObserver;
+  using vault::RealClock;
+  using LERR_(STATE);
+  
+  namespace { // test fixture...
+    
+    /** Segmentation with three levels of prerequisites, and a second Segment from 250ms */
+    inline MockDispatcher
+    setupDispatcher()
+    {
+      return MockDispatcher{MakeRec()
+                              .attrib("mark", 11)
+                              .attrib("runtime", Duration{Time{10,0}})
+                              .scope(MakeRec()
+                                      .attrib("mark",22)
+                                      .attrib("runtime", Duration{Time{20,0}})
+                                      .scope(MakeRec()
+                                              .attrib("mark",33)
+                                              .attrib("runtime", Duration{Time{30,0}})
+                                            .genNode())
+                                    .genNode())
+                            .genNode()
+                           ,MakeRec()
+                              .attrib("start", Time{250,0})
+                              .attrib("mark", 44)
+                              .attrib("runtime", Duration{Time{70,0}})
+                              .scope(MakeRec()
+                                      .attrib("mark", 55)
+                                      .attrib("runtime", Duration{Time{60,0}})
+                                    .genNode()
+                                    ,MakeRec()
+                                      .attrib("mark", 66)
+                                      .attrib("runtime", Duration{Time{50,0}})
+                                    .genNode())
+                            .genNode()};
+    }
+    
+    const uint WAIT_LIMIT = 500;            ///< give up waiting after 5 sec
+    
+  } // (End) test fixture
+  
+  
+  
+  /****************************************************************************//**
+   * @test verify job-planning for a chunk of frames at once.
+   *       - the Segment is resolved once for each run of frames
+   *       - all JobPlanning records are stored contiguously, in the same order
+   *         as produced by the job-planning pipeline
+   *       - the resulting jobs are posted in one transaction to the Scheduler
+   *       - the per-frame planning cost is compared to the pipeline
+   * @see JobPlanningPipeline_test
+   * @see PlanningBatch
+   * @see SchedulerFrontend::JobTransaction
+   */
+  class JobPlanningBatch_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          seedRand();
+          planChunk();
+          feedTransaction();
+          postToScheduler();
+          benchmark_highFrameRate();
+        }
+      
+      
+      /** @test plan a chunk of frames spanning two Segments,
+       *        yielding the same jobs as the planning pipeline */
+      void
+      planChunk()
+        {
+          MockDispatcher dispatcher = setupDispatcher();
+          play::Timings timings (FrameRate::PAL, Time{0,1});
+          auto [port,sink] = dispatcher.getDummyConnection(0);
+          
+          PlanningBatch batch{dispatcher, timings, port};
+          CHECK (isnil (batch));
+          batch.plan (Time{200,0}, Time{300,0});
+          CHECK (3 == batch.cntFrames());
+          CHECK (2 == batch.cntRuns());                                             // Segmentation accessed only once for each Segment
+          CHECK (9 == batch.size());
+          
+          auto visualise = [&](JobPlanning& planning) -> string
+                              {
+                                Job job = planning.buildJob();
+                                TimeValue nominalTime{job.parameter.nominalTime};
+                                int32_t mark = job.parameter.invoKey.part.a;
+                                TimeValue deadline{planning.determineDeadline (timings)};
+                                return _Fmt{"J(%d|%s⧐%s)"}
+                                           % mark % nominalTime % deadline;
+                              };
+          string plans;
+          for (size_t i=0; i < batch.size(); ++i)
+            plans += (i? "-":"") + visualise (batch[i]);
+          CHECK (plans == "J(11|200ms⧐1s180ms)-J(22|200ms⧐1s150ms)-J(33|200ms⧐1s110ms)-"
+                          "J(11|240ms⧐1s220ms)-J(22|240ms⧐1s190ms)-J(33|240ms⧐1s150ms)-"
+                          "J(44|280ms⧐1s200ms)-J(66|280ms⧐1s140ms)-J(55|280ms⧐1s130ms)"_expect);
+          
+          CHECK (batch[0].isTopLevel());
+          CHECK (PlanningBatch::TOP_LEVEL == batch.dependentOf(0));
+          CHECK (0 == batch.dependentOf(1));                                        // 22 is prerequisite of 11
+          CHECK (1 == batch.dependentOf(2));                                        // 33 is prerequisite of 22
+          CHECK (PlanningBatch::TOP_LEVEL == batch.dependentOf(6));
+          CHECK (6 == batch.dependentOf(7));                                        // 66 and 55 are both
+          CHECK (6 == batch.dependentOf(8));                                        //        prerequisites of 44
+          
+          // compare with the job-planning pipeline
+          auto pipeline = dispatcher.forCalcStream (timings)
+                                    .timeRange(Time{200,0}, Time{300,0})
+                                    .pullFrom (port)
+                                    .expandPrerequisites()
+                                    .feedTo (sink);
+          for (size_t i=0; i < batch.size(); ++i, ++pipeline)
+            CHECK (visualise (*pipeline) == visualise (batch[i]));
+          CHECK (isnil (pipeline));
+          
+          // storage is reused for the next chunk
+          batch.plan (Time{300,0}, Time{400,0});
+          CHECK (2 == batch.cntFrames());
+          CHECK (1 == batch.cntRuns());
+          CHECK (6 == batch.size());
+          CHECK (visualise (batch[3]) == "J(44|360ms⧐1s280ms)"_expect);
+          
+          batch.plan (Time{300,0}, Time{300,0});
+          CHECK (isnil (batch));
+        }
+      
+      
+      /** @test the jobs of a chunk are entered into a single JobTransaction,
+       *        with prerequisites linked to their dependent job; likewise for
+       *        a transaction of prerequisites attached to a job */
+      void
+      feedTransaction()
+        {
+          MockDispatcher dispatcher = setupDispatcher();
+          play::Timings timings (FrameRate::PAL, Time{0,1});
+          auto [port,sink] = dispatcher.getDummyConnection(0);
+          
+          PlanningBatch batch{dispatcher, timings, port};
+          batch.plan (Time{200,0}, Time{300,0});
+          
+          JobTransaction tx = SchedulerFrontend::instance().startJobTransaction();
+          batch.feedTo (tx);
+          CHECK (9 == tx.size());
+          CHECK (6 == tx.links().size());                                           // each prerequisite linked to its dependent
+          CHECK (tx.links()[0] == JobTransaction::Link(1,0));
+          CHECK (tx.links()[5] == JobTransaction::Link(8,6));
+          CHECK (JobTransaction::TIMEBOUND == tx[0].mode);
+          CHECK (tx[0].deadline == batch[0].determineDeadline (timings));
+          CHECK (tx[0].start == tx[0].deadline - timings.getFrameDurationAt (Time{200,0}));   // not to start before the target buffer is allotted
+          CHECK (tx[8].deadline == Time(130,1));
+          CHECK (MockJobTicket::isAssociated (tx[4].job, batch[4].ticket()));
+          
+          // Segments were marked on lookup, to be retained until the time due for the chunk
+          fixture::Segment const& seg1 = dispatcher.segmentAt (Time{200,0});
+          fixture::Segment const& seg2 = dispatcher.segmentAt (Time{280,0});
+          FrameCnt last = timings.getBreakPointAfter (Time{300,0}) - 1;            // last frame of the chunk
+          Time due = timings.getTimeDue (last);
+          CHECK (seg1.isRetainedAt (tx[3].deadline));
+          CHECK (seg1.isRetainedAt (due));                                          // covers the deadline of any job in the chunk
+          CHECK (not seg1.isRetainedAt (due + TimeValue(1)));
+          CHECK (seg2.isRetainedAt (tx[6].deadline));
+          CHECK (not seg2.isRetainedAt (due + TimeValue(1)));
+          
+          // freewheeling calculation for final rendering
+          play::Timings freewheeling (FrameRate::PAL);
+          PlanningBatch batch2{dispatcher, freewheeling, port};
+          batch2.plan (Time{200,0}, Time{240,0})
+                .feedTo (tx);                                                       // append to the same transaction
+          CHECK (12 == tx.size());
+          CHECK (JobTransaction::FREEWHEELING == tx[9].mode);
+          CHECK (Time::ANYTIME == tx[9].start);                                     // to be started on commit
+          CHECK (seg1.isRetainedAt (RealClock::now() + TimeValue(10'000'000)));            // retained for the freewheeling window
+          CHECK (tx.links().back() == JobTransaction::Link(11,10));
+          
+          // a nested transaction of prerequisites belongs to the job defined last
+          JobTransaction nested = SchedulerFrontend::instance().startJobTransaction();
+          nested.addJob (Time{10,0}, tx[0].job)
+                .addJob (Time{20,0}, tx[1].job);
+          JobTransaction prereq = nested.startPrerequisiteTx();
+          prereq.addJob (Time{5,0}, tx[2].job)
+                .addJob (Time{5,0}, tx[3].job)
+                .prerequisiteOf (0);
+          nested.attach (prereq);
+          CHECK (4 == nested.size());
+          CHECK (2 == nested.links().size());
+          CHECK (nested.links()[0] == JobTransaction::Link(3,2));                  // link within the prerequisites
+          CHECK (nested.links()[1] == JobTransaction::Link(2,1));                  // root prerequisite only linked to its own dependent
+        }
+      
+      
+      /** @test commit a transaction with all jobs of a chunk into the Scheduler */
+      void
+      postToScheduler()
+        {
+          MockDispatcher dispatcher = setupDispatcher();
+          play::Timings timings (FrameRate::PAL);
+          auto [port,sink] = dispatcher.getDummyConnection(0);
+          
+          BlockFlowAlloc bFlow;
+          EngineObserver watch;
+          Scheduler scheduler{bFlow, watch};
+          SchedulerFrontend& frontend = SchedulerFrontend::instance();
+          frontend.connect (scheduler);
+          
+          PlanningBatch batch{dispatcher, timings, port};
+          batch.plan (Time{200,0}, Time{300,0});
+          JobTransaction tx = frontend.startJobTransaction();
+          batch.feedTo (tx);
+          std::vector<Job> jobs;
+          for (size_t i=0; i < tx.size(); ++i)
+            jobs.push_back (tx[i].job);
+          tx.commit();
+          CHECK (0 == tx.size());
+          
+          auto allInvoked = [&]{ return util::and_all (jobs, [](Job const& job){ return MockJob::was_invoked (job); }); };
+          for (uint i=0; i < WAIT_LIMIT and not allInvoked(); ++i)
+            sleep_for (10ms);
+          CHECK (allInvoked());
+          // prerequisites were performed prior to their dependent job
+          CHECK (MockJob::invocationTime (jobs[2]) <= MockJob::invocationTime (jobs[1]));
+          CHECK (MockJob::invocationTime (jobs[1]) <= MockJob::invocationTime (jobs[0]));
+          CHECK (MockJob::invocationTime (jobs[7]) <= MockJob::invocationTime (jobs[6]));
+          CHECK (MockJob::invocationTime (jobs[8]) <= MockJob::invocationTime (jobs[6]));
+          
+          frontend.disconnect();
+          JobTransaction tx2 = frontend.startJobTransaction();
+          VERIFY_ERROR (STATE, tx2.commit());
+        }
+      
+      
+      /** @test compare the per-frame cost of planning a chunk of audio blocks
+       *        with 1000 blocks per second, with the job-planning pipeline */
+      void
+      benchmark_highFrameRate()
+        {
+          const uint CHUNKS = 10;
+          const uint FRAMES = 1000;                                                  // 1sec per chunk
+          MockDispatcher dispatcher = setupDispatcher();
+          play::Timings timings (FrameRate{1000});
+          auto [port,sink] = dispatcher.getDummyConnection(0);
+          auto chunkStart = [](uint c){ return Time{0, int(c)}; };
+          
+          size_t checksum{0};
+          auto pipelined = [&]
+                            {
+                              for (uint c=0; c < CHUNKS; ++c)
+                                {
+                                  auto pipeline = dispatcher.forCalcStream (timings)
+                                                            .timeRange(chunkStart(c), chunkStart(c+1))
+                                                            .pullFrom (port)
+                                                            .expandPrerequisites()
+                                                            .feedTo (sink);
+                                  for ( ; pipeline; ++pipeline)
+                                    checksum += pipeline->isTopLevel();
+                                }
+                            };
+          PlanningBatch batch{dispatcher, timings, port};
+          auto batched = [&]
+                            {
+                              for (uint c=0; c < CHUNKS; ++c)
+                                {
+                                  batch.plan (chunkStart(c), chunkStart(c+1));
+                                  for (size_t i=0; i < batch.size(); ++i)
+                                    checksum += batch[i].isTopLevel();
+                                }
+                            };
+          
+          double timePipeline = benchmarkTime (pipelined, CHUNKS*FRAMES);
+          double timeBatch    = benchmarkTime (batched,   CHUNKS*FRAMES);
+          CHECK (checksum == 2 * CHUNKS*FRAMES);
+          CHECK (FRAMES == batch.cntFrames());
+          
+          cout << _Fmt{"job-planning %d frames per chunk, per frame: pipeline %5.3fµs  batch %5.3fµs"}
+                      % FRAMES % timePipeline % timeBatch
+               << endl;
+          CHECK (timeBatch < timePipeline);
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (JobPlanningBatch_test, "unit engine");
+  
+  
+  
+}}} // namespace steam::engine::test
@@ -0,0 +1,297 @@
+/*
+  LeadFork(Test)  -  verify pulling independent lead nodes concurrently
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file lead-fork-test.cpp
+ ** unit test \ref LeadFork_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "steam/engine/lead-fork.hpp"
+#include "steam/engine/node-builder.hpp"
+#include "steam/engine/diagnostic-buffer-provider.hpp"
+#include "vault/gear/scheduler.hpp"
+#include "lib/scoped-collection.hpp"
+#include "lib/thread.hpp"
+
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+
+using lib::time::Time;
+using lib::ThreadJoinable;
+using std::this_thread::get_id;
+using std::atomic;
+using std::vector;
+using std::deque;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  namespace { // Test fixture
+    
+    const uint CHAIN_LEN = fork::MIN_COST;
+    
+    std::thread::id mainThread;
+    atomic<uint> cntCalc{0};
+    atomic<uint> cntForeign{0};
+    atomic<bool> failure{false};
+    
+    void
+    markCalc()
+    {
+      ++cntCalc;
+      if (get_id() != mainThread)
+        ++cntForeign;
+    }
+    
+    /** a chain of processing steps: source, followed by increments
+     * @remark the source fails on parameter retrieval, if requested */
+    ProcNode&
+    buildChain (deque<ProcNode>& nodes, uint base, uint len)
+    {
+      auto sourceFun = [](uint param, uint* out){ markCalc(); *out = param; };
+      auto stepFun   = [](uint* in, uint* out)  { markCalc(); *out = *in + 1; };
+      auto paramFun  = [base](TurnoutSystem&)
+                          {
+                            if (failure) throw err::State{"processing failure"};
+                            return base;
+                          };
+      nodes.emplace_back (prepareNode("Src")
+                            .preparePort()
+                              .invoke ("src()", sourceFun)
+                              .attachParamFun (paramFun)
+                              .completePort()
+                            .build());
+      for (uint i=1; i<len; ++i)
+        {
+          ProcNode& lead = nodes.back();
+          nodes.emplace_back (prepareNode("Step")
+                                .preparePort()
+                                  .invoke ("inc()", stepFun)
+                                  .connectLead(lead)
+                                  .completePort()
+                                .build());
+        }
+      return nodes.back();
+    }
+    
+    /** a node summing up the results from two lead chains */
+    ProcNode&
+    buildJoin (deque<ProcNode>& nodes, uint len1, uint len2)
+    {
+      using SrcBuffs = std::array<uint*, 2>;
+      auto joinFun = [](SrcBuffs src, uint* out){ markCalc(); *out = *src[0] + *src[1]; };
+      ProcNode& lead1 = buildChain (nodes, 100, len1);
+      ProcNode& lead2 = buildChain (nodes, 200, len2);
+      nodes.emplace_back (prepareNode("Join")
+                            .preparePort()
+                              .invoke ("sum()", joinFun)
+                              .connectLead(lead1)
+                              .connectLead(lead2)
+                              .completePort()
+                            .build());
+      return nodes.back();
+    }
+    
+    uint
+    invoke (ProcNode& node, LeadFork& leadFork)
+    {
+      BufferProvider& provider = DiagnosticBufferProvider::build();
+      BuffHandle buff = provider.lockBufferFor<uint> (0);
+      TurnoutSystem turnoutSys{Time::ZERO};
+      turnoutSys.attachLeadFork (leadFork);
+      try {
+          buff = node.pull (0, buff, turnoutSys);
+        }
+      catch (...)
+        {
+          buff.release();
+          throw;
+        }
+      uint result = buff.accessAs<uint>();
+      buff.release();
+      return result;
+    }
+    
+    
+    /** perform each sub-task immediately in a separate thread */
+    struct ThreadFork
+      : LeadFork
+      {
+        void
+        dispatch (fork::Task task)  override
+          {
+            ThreadJoinable worker{"LeadFork_test: sub-task"
+                                 ,[task]() mutable { task.perform(); }};
+            worker.join();
+          }
+      };
+    
+    /** retain sub-tasks without performing them */
+    struct LazyFork
+      : LeadFork
+      {
+        vector<fork::Task> pending;
+        
+        void
+        dispatch (fork::Task task)  override
+          {
+            pending.emplace_back (task);
+          }
+      };
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify the concurrent pull of expensive lead nodes
+   *       through the ParallelWeavingPattern and a LeadFork.
+   *       - the builder selects leads based on estimated cost
+   *       - selected leads are pulled as sub-tasks by other workers
+   *       - sub-tasks not picked up are performed by the invoking worker
+   *       - failures are propagated after the join
+   *       - sub-tasks can be dispatched to the Scheduler
+   * @see lead-fork.hpp
+   * @see NodeBuilder_test
+   */
+  class LeadFork_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          mainThread = get_id();
+          verifyCostEstimation();
+          verifyForkJoin();
+          verifyLazyFork();
+          verifyFailure();
+          verifyScheduler();
+        }
+      
+      
+      /** @test only leads with sufficient estimated cost are spread out */
+      void
+      verifyCostEstimation()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& chain = buildChain (nodes, 0, CHAIN_LEN);
+          CHECK (CHAIN_LEN == fork::estimateCost (watch(chain).ports()[0]));
+          
+          ProcNode& cheap = buildJoin (nodes, 1, CHAIN_LEN-1);
+          CHECK (0 == fork::selectLeads (watch(cheap).watchPort(0).srcPorts()));
+          CHECK (1 + 1 + CHAIN_LEN-1 == fork::estimateCost (watch(cheap).ports()[0]));
+          
+          ProcNode& mixed = buildJoin (nodes, 1, CHAIN_LEN);
+          CHECK (0b10 == fork::selectLeads (watch(mixed).watchPort(0).srcPorts()));
+          
+          ProcNode& heavy = buildJoin (nodes, CHAIN_LEN+1, CHAIN_LEN);
+          CHECK (0b11 == fork::selectLeads (watch(heavy).watchPort(0).srcPorts()));
+        }
+      
+      
+      /** @test expensive leads are calculated in another thread */
+      void
+      verifyForkJoin()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& join = buildJoin (nodes, CHAIN_LEN, 1);
+          ThreadFork threadFork;
+          
+          cntCalc = cntForeign = 0;
+          uint res = invoke (join, threadFork);
+          CHECK (res == 100 + CHAIN_LEN-1 + 200);
+          CHECK (cntCalc == CHAIN_LEN + 1 + 1);
+          CHECK (cntForeign == CHAIN_LEN);
+          
+          // without LeadFork, all leads are pulled sequentially
+          cntCalc = cntForeign = 0;
+          BufferProvider& provider = DiagnosticBufferProvider::build();
+          BuffHandle buff = provider.lockBufferFor<uint> (0);
+          buff = join.pull (0, buff, Time::ZERO, 0);
+          CHECK (res == buff.accessAs<uint>());
+          buff.release();
+          CHECK (cntCalc == CHAIN_LEN + 1 + 1);
+          CHECK (cntForeign == 0);
+        }
+      
+      
+      /** @test sub-tasks not started by some other worker are
+       *        picked up by the invoking worker prior to the join;
+       *        any later attempt to perform them is ignored. */
+      void
+      verifyLazyFork()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& join = buildJoin (nodes, CHAIN_LEN, CHAIN_LEN);
+          LazyFork lazyFork;
+          
+          cntCalc = cntForeign = 0;
+          CHECK (100+200 + 2*(CHAIN_LEN-1) == invoke (join, lazyFork));
+          CHECK (cntCalc == 2*CHAIN_LEN + 1);
+          CHECK (cntForeign == 0);
+          
+          CHECK (2 == lazyFork.pending.size());
+          for (auto& task : lazyFork.pending)
+            CHECK (not task.perform());
+          CHECK (cntCalc == 2*CHAIN_LEN + 1);
+        }
+      
+      
+      /** @test an exception raised within a sub-task is propagated */
+      void
+      verifyFailure()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& join = buildJoin (nodes, CHAIN_LEN, CHAIN_LEN);
+          ThreadFork threadFork;
+          
+          failure = true;
+          VERIFY_FAIL ("processing failure", invoke (join, threadFork));
+          failure = false;
+          CHECK (100+200 + 2*(CHAIN_LEN-1) == invoke (join, threadFork));
+        }
+      
+      
+      /** @test dispatch sub-tasks as jobs to the Scheduler */
+      void
+      verifyScheduler()
+        {
+          using vault::gear::BlockFlowAlloc;
+          using vault::gear::EngineObserver;
+          using vault::gear::Scheduler;
+          
+          deque<ProcNode> nodes;
+          ProcNode& join = buildJoin (nodes, CHAIN_LEN, CHAIN_LEN);
+          
+          BlockFlowAlloc bFlow;
+          EngineObserver observer;
+          Scheduler scheduler{bFlow, observer};
+          ScheduledLeadFork scheduledFork{scheduler};
+          
+          for (uint i=0; i<10; ++i)
+            CHECK (100+200 + 2*(CHAIN_LEN-1) == invoke (join, scheduledFork));
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (LeadFork_test, "unit node");
+  
+  
+  
+}}} // namespace steam::engine::test
@@ -0,0 +1,172 @@
+/*
+  LookAhead(Test)  -  verify speculative pre-rendering of frames around the playhead
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file look-ahead-test.cpp
+ ** unit test \ref LookAhead_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "steam/engine/look-ahead.hpp"
+#include "steam/engine/frame-cache.hpp"
+#include "steam/engine/node-builder.hpp"
+#include "vault/gear/scheduler.hpp"
+#include "lib/time/timevalue.hpp"
+
+#include <atomic>
+#include <thread>
+
+using lib::time::FrameRate;
+using lib::time::TimeValue;
+using std::this_thread::sleep_for;
+using std::chrono_literals::operator ""ms;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  using vault::gear::BlockFlowAlloc;
+  using vault::gear::EngineObserver;
+  using vault::gear::Scheduler;
+  
+  namespace { // Test fixture
+    
+    const FrameRate FPS{25};
+    const uint RADIUS = 3;
+    const uint WAIT_LIMIT = 500;       ///< give up waiting for the jobs after 5 sec
+    
+    std::atomic_uint cntCalc{0};
+    
+    /** a frame holds its own frame number */
+    void
+    generate (FrameCnt frameNr, FrameCnt* out)
+    {
+      ++cntCalc;
+      *out = frameNr;
+    }
+    
+    FrameCnt
+    frameNr (TurnoutSystem& tus)
+    {
+      return _raw(tus.getNomTime()) * FPS.numerator() / (TimeValue::SCALE * FPS.denominator());
+    }
+    
+    /** wait until all jobs posted thus far are performed */
+    bool
+    awaitCompletion (LookAheadRender& lookAhead)
+    {
+      for (uint i=0; i < WAIT_LIMIT; ++i)
+        if (lookAhead.cntPosted() == lookAhead.cntRendered() + lookAhead.cntSkipped())
+          return true;
+        else
+          sleep_for (10ms);
+      return false;
+    }
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify speculative rendering of frames around the playhead
+   *       into the FrameCache, using idle capacity of the Scheduler.
+   *       - frames within the radius around the playhead are rendered
+   *       - a small move of the playhead only adds the missing frames
+   *       - frames already cached are not calculated again
+   *       - when jumping, a new manifestation is used for speculation
+   * @see look-ahead.hpp
+   * @see SchedulerInvocation_test::verify_speculativeWork()
+   */
+  class LookAhead_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          BlockFlowAlloc bFlow;
+          EngineObserver observer;
+          Scheduler scheduler{bFlow, observer};
+          
+          ProcNode src{prepareNode("Test:gen")
+                          .preparePort()
+                            .invoke ("gen()", generate)
+                            .attachParamFun (frameNr)
+                            .completePort()
+                          .build()};
+          Port& port = src.getPort(0);
+          FrameCache cache{1000*sizeof(FrameCnt)};
+          auto isCached = [&](FrameCnt frame)
+                            {
+                              return cache.contains (FrameKey{port.procHash(), Time{lib::time::Offset{frame, FPS}}, 0});
+                            };
+          
+          LookAheadRender lookAhead{scheduler, port, cache, FPS, RADIUS};
+          CHECK (0 == lookAhead.cntPosted());
+          ManifestationID manID = lookAhead.manifestation();
+          CHECK (manID);
+          
+          lookAhead.moveTo (10);
+          CHECK (2*RADIUS+1 == lookAhead.cntPosted());
+          CHECK (awaitCompletion (lookAhead));
+          CHECK (7 == lookAhead.cntRendered());
+          CHECK (7 == cntCalc);
+          for (FrameCnt f=7; f<=13; ++f)
+            CHECK (isCached(f));
+          CHECK (not isCached(6));
+          CHECK (not isCached(14));
+          
+          // slow scrubbing: only the missing frame is posted
+          lookAhead.moveTo (11);
+          CHECK (8 == lookAhead.cntPosted());
+          CHECK (manID == lookAhead.manifestation());
+          CHECK (awaitCompletion (lookAhead));
+          CHECK (isCached(14));
+          CHECK (8 == cntCalc);
+          
+          // moving back re-posts frame 7, which is found in cache
+          lookAhead.moveTo (10);
+          CHECK (9 == lookAhead.cntPosted());
+          CHECK (awaitCompletion (lookAhead));
+          CHECK (1 == lookAhead.cntSkipped());
+          CHECK (8 == cntCalc);
+          
+          // jumping obsoletes the speculation and switches the manifestation
+          // the new manifestation does not collide with the manifestation of another stream
+          ManifestationID otherStream = ManifestationID::allocate();
+          lookAhead.moveTo (100);
+          CHECK (manID != lookAhead.manifestation());
+          CHECK (otherStream != lookAhead.manifestation());
+          manID = lookAhead.manifestation();
+          CHECK (16 == lookAhead.cntPosted());
+          CHECK (awaitCompletion (lookAhead));
+          CHECK (15 == cntCalc);
+          for (FrameCnt f=97; f<=103; ++f)
+            CHECK (isCached(f));
+          
+          lookAhead.stop();
+          CHECK (manID != lookAhead.manifestation());
+          CHECK (otherStream != lookAhead.manifestation());
+          lookAhead.moveTo (101);                                            // after stopping, the frames
+          CHECK (awaitCompletion (lookAhead));                               // around the playhead are
+          CHECK (16 == cntCalc);                                             // taken from the cache
+          CHECK (isCached(104));
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (LookAhead_test, "unit engine");
+  
+  
+  
+}}} // namespace steam::engine::test
@@ -359,6 +359,14 @@ namespace test   {
           return seg.jobTicket(portIDX);
         }
       
+      TicketRun
+      getJobTicketRun (size_t portIDX, TimeValue nominalTime, Time retainUntil)  override
+        {
+          auto& seg = mockSeg_[nominalTime];
+          seg.retainUntil (retainUntil);
+          return TicketRun{seg.jobTicket(portIDX), seg.after()};
+        }
+      
       
     public:
       MockDispatcher()
@@ -400,6 +408,13 @@ namespace test   {
           return dummySetup_.getModelPort (index);
         }
       
+      /** Test support: the mock Segment covering the given time */
+      fixture::Segment const&
+      segmentAt (TimeValue nominalTime)
+        {
+          return mockSeg_[nominalTime];
+        }
+      
       /**
        * Test support: verify the given Job is consistent with this Dispatcher.
        */
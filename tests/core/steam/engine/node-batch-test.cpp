@@ -0,0 +1,357 @@
+/*
+  NodeBatch(Test)  -  verify rendering consecutive frames with a batch processing functor
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file node-batch-test.cpp
+ ** unit test \ref NodeBatch_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "steam/engine/node-builder.hpp"
+#include "steam/engine/frame-cache.hpp"
+#include "steam/engine/test-rand-ontology.hpp"
+#include "steam/engine/diagnostic-buffer-provider.hpp"
+#include "lib/time/timevalue.hpp"
+
+#include <cmath>
+#include <deque>
+
+using lib::test::showType;
+using lib::time::Time;
+using lib::time::TimeValue;
+using lib::time::Duration;
+using lib::time::FSecs;
+using std::deque;
+using std::fabs;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  using ont::FraNo;
+  using ont::Sampl;
+  using ont::SampleBlock;
+  using ont::SAMPLE_CNT;
+  
+  namespace { // Test fixture
+    
+    const uint BATCH = 4;
+    const Duration FRAME{FSecs(1)};
+    
+    uint cntBatch{0};
+    uint cntFrames{0};   ///< frames calculated by the generator and gain node
+    
+    /** parameter: frame number, derived from nominal time in seconds */
+    FraNo
+    frameNr (TurnoutSystem& tus)
+    {
+      return FraNo(_raw(tus.getNomTime()) / TimeValue::SCALE);
+    }
+    
+    /** »automation« of the gain parameter */
+    Sampl
+    autoGain (TurnoutSystem& tus)
+    {
+      return Sampl(1 + frameNr(tus)) / 8;
+    }
+    
+    /** crossfade by 1/8 for each frame */
+    tuple<Sampl,Sampl>
+    autoFade (TurnoutSystem& tus)
+    {
+      Sampl start = Sampl(frameNr(tus) % 8) / 8;
+      return {start, start + Sampl(1)/8};
+    }
+    
+    
+    SampleBlock
+    pullBlock (ProcNode& node, Time nomTime, FrameCache* cache =nullptr)
+    {
+      BufferProvider& provider = DiagnosticBufferProvider::build();
+      BuffHandle buff = provider.lockBufferFor<SampleBlock>();
+      TurnoutSystem turnoutSys{nomTime};
+      if (cache)
+        turnoutSys.attachFrameCache (*cache);
+      buff = node.pull (0, buff, turnoutSys);
+      SampleBlock result = buff.accessAs<SampleBlock>();
+      buff.release();
+      return result;
+    }
+    
+    Time
+    frame (FraNo n)
+    {
+      return Time{FSecs(n)};
+    }
+    
+    
+    /** build a generator and a gain node, both invoked for batches of frames */
+    ProcNode&
+    buildGainChain (deque<ProcNode>& nodes)
+    {
+      using FraNos = FrameBatch<FraNo, BATCH>;
+      using In   = FrameBatch<SampleBlock const*, BATCH>;
+      using Out  = FrameBatch<SampleBlock*, BATCH>;
+      auto genFun = [](FraNos frameNr, Out out)
+                        {
+                          cntFrames += out.cnt;
+                          for (uint k=0; k<out.cnt; ++k)
+                            ont::generateSamples (out[k], frameNr[k]);
+                        };
+      auto gen = testRand().setupSampleGenerator<BATCH>();
+      nodes.emplace_back (prepareNode(gen.nodeID())
+                            .preparePort()
+                              .invoke (gen.procID(), genFun)
+                              .attachParamFun (frameNr)
+                              .batchFrameStep (FRAME)
+                              .completePort()
+                            .build());
+      ProcNode& src = nodes.back();
+      
+      using Gain = FrameBatch<Sampl, BATCH>;
+      auto gainFun = [](Gain gain, In in, Out out)
+                        {
+                          ++cntBatch;
+                          cntFrames += out.cnt;
+                          for (uint k=0; k<out.cnt; ++k)
+                            ont::gainSamples (out[k], in[k], gain[k]);
+                        };
+      nodes.emplace_back (prepareNode("Test:gain")
+                            .preparePort()
+                              .invoke ("x4(Samples)(Samples)", gainFun)
+                              .attachParamFun (autoGain)
+                              .connectLead (src)
+                              .batchFrameStep (FRAME)
+                              .completePort()
+                            .build());
+      return nodes.back();
+    }
+    
+    SampleBlock
+    expectedGain (FraNo n)
+    {
+      SampleBlock block;
+      ont::generateSamples (&block, n);
+      ont::gainSamples (&block, &block, Sampl(1+n) / 8);
+      return block;
+    }
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify the invocation of a _batch processing functor,_ which
+   *       renders several consecutive frames with a single invocation.
+   *       - the reference kernels for sample processing
+   *       - results are the same as for processing single frames
+   *       - without FrameCache, only a single frame is rendered
+   *       - the results for the following frames are picked up from the FrameCache
+   *       - a batch ends before the first following frame found in the cache
+   *       - a batch functor with several inputs
+   *       - the builder requires the frame step
+   * @see feed-manifold.hpp
+   * @see media-weaving-pattern.hpp
+   * @see NodeLink_test
+   */
+  class NodeBatch_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          verify_kernels();
+          detect_batchFunctor();
+          render_batch();
+          render_withCache();
+          render_crossfade();
+          reject_missingFrameStep();
+        }
+      
+      
+      /** @test the portable reference kernels of the test ontology */
+      void
+      verify_kernels()
+        {
+          SampleBlock a, b, out;
+          ont::generateSamples (&a, 1);
+          ont::generateSamples (&b, 2);
+          ont::generateSamples (&out, 1);
+          CHECK (out == a);
+          CHECK (out != b);
+          for (uint i=0; i<SAMPLE_CNT; ++i)
+            {
+              CHECK (-1 <= a[i] and a[i] < 1);
+              CHECK (-1 <= b[i] and b[i] < 1);
+            }
+          
+          ont::gainSamples (&out, &a, 0.5);
+          for (uint i=0; i<SAMPLE_CNT; ++i)
+            CHECK (out[i] == a[i] / 2);
+          
+          ont::mixSamples (&out, &a, &b, 0.25);
+          for (uint i=0; i<SAMPLE_CNT; ++i)
+            CHECK (out[i] == Sampl(0.75)*a[i] + Sampl(0.25)*b[i]);
+          
+          ont::crossfadeSamples (&out, &a, &b, 0, 1);
+          CHECK (out.front() == a.front());
+          CHECK (fabs (out.back() - b.back()) <= fabs (b.back() - a.back()) / SAMPLE_CNT * 2);
+          
+          // processing in-place
+          out = a;
+          ont::gainSamples (&out, &out, 2);
+          for (uint i=0; i<SAMPLE_CNT; ++i)
+            CHECK (out[i] == 2*a[i]);
+        }
+      
+      
+      /** @test detect a processing functor with FrameBatch arguments */
+      void
+      detect_batchFunctor()
+        {
+          auto gen = testRand().setupSampleGenerator<BATCH>();
+          using GenFun = decltype(gen.makeFun());
+          using Proto = ProcPrototype<GenFun>::Type;
+          CHECK (is_BatchPrototype<Proto>());
+          CHECK (BATCH == Proto::BATCH);
+          CHECK (1 == Proto::FAN_O);
+          CHECK (0 == Proto::FAN_I);
+          CHECK (Proto::hasParam());
+          
+          using Feed = Proto::Feed;
+          CHECK (showType<Feed::Param>() == "ulong"_expect);
+          CHECK (showType<Feed::ArgO>()  == "array<float, 256ul> *"_expect);
+          
+          // a plain array of buffers designates several channels of a single frame
+          auto mix = testRand().setupCombinator();
+          CHECK (not is_BatchPrototype<ProcPrototype<decltype(mix.makeFun())>::Type>());
+        }
+      
+      
+      /** @test without FrameCache, the following frames of a batch could not be
+       *        picked up, and thus each invocation renders only a single frame,
+       *        yielding the same result as single frame processing;
+       *        notably no frame is rendered repeatedly. */
+      void
+      render_batch()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& gain = buildGainChain (nodes);
+          
+          cntBatch = 0;
+          cntFrames = 0;
+          for (FraNo n : {0,1,5,13})
+            CHECK (pullBlock (gain, frame(n)) == expectedGain(n));
+          CHECK (4 == cntBatch);
+          CHECK (2*4 == cntFrames);                     // each frame rendered once by generator and gain node
+          
+          cntFrames = 0;
+          for (FraNo n=0; n < 2*BATCH; ++n)
+            CHECK (pullBlock (gain, frame(n)) == expectedGain(n));
+          CHECK (2*2*BATCH == cntFrames);               // no work repeated for consecutive frames
+        }
+      
+      
+      /** @test with a FrameCache attached, the results for the following
+       *        frames of the batch are remembered and picked up from there
+       *        by the invocations for these frames; thus consecutive frame
+       *        jobs are effectively grouped into a single invocation. */
+      void
+      render_withCache()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& gain = buildGainChain (nodes);
+          FrameCache cache{100*sizeof(SampleBlock)};
+          
+          cntBatch = 0;
+          cntFrames = 0;
+          CHECK (pullBlock (gain, frame(0), &cache) == expectedGain(0));
+          CHECK (1 == cntBatch);
+          CHECK (2*BATCH == cntFrames);
+          CHECK (2*BATCH == cache.cntFrames());         // all frames of generator and gain node
+          CHECK (BATCH-1 == cache.cntHits());           // the gain node picked up further generator frames
+          
+          for (FraNo n=1; n < 2*BATCH; ++n)
+            CHECK (pullBlock (gain, frame(n), &cache) == expectedGain(n));
+          CHECK (2 == cntBatch);
+          CHECK (4*BATCH == cntFrames);
+          CHECK (4*BATCH == cache.cntFrames());
+          CHECK (4*(BATCH-1) == cache.cntHits());         // one batch invocation per node for each group of frames
+          
+          // a batch ends before the following frames already in cache
+          cache.clear();
+          cntFrames = 0;
+          CHECK (pullBlock (gain, frame(2), &cache) == expectedGain(2));
+          CHECK (2*BATCH == cntFrames);                 // frames 2...5 rendered by both nodes
+          CHECK (pullBlock (gain, frame(0), &cache) == expectedGain(0));
+          CHECK (2*BATCH + 2*2 == cntFrames);           // only frames 0 and 1 rendered additionally
+          for (FraNo n=1; n < 2+BATCH; ++n)
+            CHECK (pullBlock (gain, frame(n), &cache) == expectedGain(n));
+          CHECK (2*BATCH + 2*2 == cntFrames);           // all further frames picked up from cache
+        }
+      
+      
+      /** @test a batch processing functor combining two inputs */
+      void
+      render_crossfade()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& gain = buildGainChain (nodes);
+          ProcNode& src = nodes.front();
+          auto fade = testRand().setupCrossfade<BATCH>();
+          nodes.emplace_back (prepareNode(fade.nodeID())
+                                .preparePort()
+                                  .invoke (fade.procID(), fade.makeFun())
+                                  .attachParamFun (autoFade)
+                                  .connectLead (src)
+                                  .connectLead (gain)
+                                  .batchFrameStep (FRAME)
+                                  .completePort()
+                                .build());
+          ProcNode& crossfade = nodes.back();
+          
+          for (FraNo n : {0,1,7,8})
+            {
+              SampleBlock srcData, expected;
+              ont::generateSamples (&srcData, n);
+              SampleBlock gainData = expectedGain(n);
+              TurnoutSystem turnoutSys{frame(n)};
+              auto [from,to] = autoFade (turnoutSys);
+              ont::crossfadeSamples (&expected, &srcData, &gainData, from, to);
+              CHECK (pullBlock (crossfade, frame(n)) == expected);
+            }
+        }
+      
+      
+      /** @test a batch processing functor can not be used without frame step */
+      void
+      reject_missingFrameStep()
+        {
+          auto gen = testRand().setupSampleGenerator<BATCH>();
+          VERIFY_FAIL ("requires the duration of a frame"
+                      , prepareNode(gen.nodeID())
+                          .preparePort()
+                            .invoke (gen.procID(), gen.makeFun())
+                            .attachParamFun (frameNr)
+                            .completePort()
+                          .build());
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (NodeBatch_test, "unit node");
+  
+  
+  
+}}} // namespace steam::engine::test
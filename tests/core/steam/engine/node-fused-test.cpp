@@ -0,0 +1,358 @@
+/*
+  NodeFused(Test)  -  verify fusing a chain of element-wise operations into a single node
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file node-fused-test.cpp
+ ** unit test \ref NodeFused_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "steam/engine/node-builder.hpp"
+#include "steam/engine/fused-chain.hpp"
+#include "steam/engine/test-rand-ontology.hpp"
+#include "steam/engine/diagnostic-buffer-provider.hpp"
+#include "lib/format-string.hpp"
+#include "lib/time/timevalue.hpp"
+
+#include <iostream>
+#include <deque>
+
+using lib::test::showType;
+using lib::test::microBenchmark;
+using lib::time::Time;
+using lib::time::TimeValue;
+using lib::time::FSecs;
+using util::_Fmt;
+using std::deque;
+using std::cout;
+using std::endl;
+using std::tuple;
+using std::get;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  using ont::FraNo;
+  using ont::Sampl;
+  using ont::SampleBlock;
+  using ont::SAMPLE_CNT;
+  
+  namespace { // Test fixture
+    
+    const Sampl GAIN{1.5};
+    const Sampl DC{0.25};
+    
+    /** parameter: frame number, derived from nominal time in seconds */
+    FraNo
+    frameNr (TurnoutSystem& tus)
+    {
+      return FraNo(_raw(tus.getNomTime()) / TimeValue::SCALE);
+    }
+    
+    tuple<Sampl,Sampl>
+    gainAndOffset (TurnoutSystem&)
+    {
+      return {GAIN, DC};
+    }
+    
+    SampleBlock
+    pullBlock (ProcNode& node, Time nomTime)
+    {
+      BufferProvider& provider = DiagnosticBufferProvider::build();
+      BuffHandle buff = provider.lockBufferFor<SampleBlock>();
+      buff = node.pull (0, buff, nomTime, ProcessKey{});
+      SampleBlock result = buff.accessAs<SampleBlock>();
+      buff.release();
+      return result;
+    }
+    
+    /** reference result computed directly by the element operations */
+    SampleBlock
+    expectedResult (FraNo n)
+    {
+      SampleBlock block;
+      ont::generateSamples (&block, n);
+      for (Sampl& s : block)
+        s = ont::clip (ont::offset (DC, ont::amplify (GAIN, s)));
+      return block;
+    }
+    
+    /** build a source node generating random samples */
+    ProcNode&
+    buildSource (deque<ProcNode>& nodes)
+    {
+      nodes.emplace_back (prepareNode("Test:gen")
+                            .preparePort()
+                              .invoke ("gen(Samples)", [](FraNo n, SampleBlock* out){ ont::generateSamples (out, n); })
+                              .attachParamFun (frameNr)
+                              .completePort()
+                            .build());
+      return nodes.back();
+    }
+    
+    /** build the element operations as a chain of separate nodes */
+    ProcNode&
+    buildNodeChain (deque<ProcNode>& nodes)
+    {
+      ProcNode& src = buildSource (nodes);
+      nodes.emplace_back (prepareNode("Test:gain")
+                            .preparePort()
+                              .invoke ("gain(Samples)(Samples)"
+                                      ,[](Sampl gain, SampleBlock const* in, SampleBlock* out)
+                                          {
+                                            for (uint i=0; i<SAMPLE_CNT; ++i)
+                                              (*out)[i] = ont::amplify (gain, (*in)[i]);
+                                          })
+                              .setParam (GAIN)
+                              .connectLead (src)
+                              .completePort()
+                            .build());
+      ProcNode& gain = nodes.back();
+      nodes.emplace_back (prepareNode("Test:offset")
+                            .preparePort()
+                              .invoke ("offset(Samples)(Samples)"
+                                      ,[](Sampl dc, SampleBlock const* in, SampleBlock* out)
+                                          {
+                                            for (uint i=0; i<SAMPLE_CNT; ++i)
+                                              (*out)[i] = ont::offset (dc, (*in)[i]);
+                                          })
+                              .setParam (DC)
+                              .connectLead (gain)
+                              .completePort()
+                            .build());
+      ProcNode& offset = nodes.back();
+      nodes.emplace_back (prepareNode("Test:clip")
+                            .preparePort()
+                              .invoke ("clip(Samples)(Samples)"
+                                      ,[](SampleBlock const* in, SampleBlock* out)
+                                          {
+                                            for (uint i=0; i<SAMPLE_CNT; ++i)
+                                              (*out)[i] = ont::clip ((*in)[i]);
+                                          })
+                              .connectLead (offset)
+                              .completePort()
+                            .build());
+      return nodes.back();
+    }
+    
+    /** build the same element operations fused into a single node */
+    ProcNode&
+    buildFusedNode (deque<ProcNode>& nodes)
+    {
+      ProcNode& src = buildSource (nodes);
+      nodes.emplace_back (prepareNode("Test:fused")
+                            .preparePort()
+                              .invokeFused<SampleBlock> ("gain+offset+clip(Samples)(Samples)"
+                                                        , elmOp("gain",   ont::amplify)
+                                                        , elmOp("offset", ont::offset)
+                                                        , elmOp("clip",   ont::clip))
+                              .attachParamFun (gainAndOffset)
+                              .connectLead (src)
+                              .completePort()
+                            .build());
+      return nodes.back();
+    }
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify the composition of a linear chain of element-wise operations
+   *       into a single processing function, invoked by a single Render Node.
+   *       - the FusedChain applies all operations in a single pass
+   *       - the fused node yields the same result as a chain of nodes
+   *       - the constituents of the fused node are traceable in diagnostics
+   *       - the spec must name all constituents
+   *       - compare performance and memory traffic with the chain of nodes
+   * @see fused-chain.hpp
+   * @see NodeBatch_test
+   */
+  class NodeFused_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          compose_elementOps();
+          render_fusedNode();
+          reject_unnamedConstituents();
+          benchmark_bandwidth();
+        }
+      
+      
+      /** @test compose a chain of element operations and apply it to a buffer
+       *        - the parameters of all stages are combined into a tuple
+       *        - a single parameter is passed plain
+       *        - the chain can be applied in-place
+       */
+      void
+      compose_elementOps()
+        {
+          using Chain = FusedChain<SampleBlock, decltype(ont::amplify), decltype(ont::offset), decltype(ont::clip)>;
+          CHECK (3 == Chain::STAGES);
+          CHECK (2 == Chain::PARAMS);
+          CHECK (showType<Chain::Param>() == "tuple<float, float>"_expect);
+          
+          using Clip = FusedChain<SampleBlock, decltype(ont::clip), decltype(ont::amplify)>;
+          CHECK (showType<Clip::Param>() == "float"_expect);
+          
+          using Plain = FusedChain<SampleBlock, decltype(ont::clip)>;
+          CHECK (not Plain::hasParam());
+          
+          SampleBlock in, out;
+          ont::generateSamples (&in, 5);
+          Chain chain{ont::amplify, ont::offset, ont::clip};
+          chain.render (tuple{GAIN,DC}, in, out);
+          CHECK (out == expectedResult(5));
+          
+          // processing in-place
+          chain.render (tuple{GAIN,DC}, in, in);
+          CHECK (in == out);
+          
+          // the fused processing function is accepted by the Turnout
+          auto procFun = Chain{ont::amplify, ont::offset, ont::clip}.buildProcFun();
+          using Proto = ProcPrototype<decltype(procFun)>::Type;
+          CHECK (Proto::hasParam());
+          CHECK (1 == Proto::FAN_I);
+          CHECK (1 == Proto::FAN_O);
+          
+          CHECK (3 == countFusedConstituents ("gain+offset+clip(Samples)(Samples)"));
+          CHECK (1 == countFusedConstituents ("gain(Samples)(Samples)"));
+          CHECK (0 == countFusedConstituents ("(Samples)(Samples)"));
+          CHECK (0 == countFusedConstituents ("gain++clip(Samples)"));
+          CHECK (0 == countFusedConstituents ("gain+(Samples)"));
+          
+          CHECK (    matchFusedConstituents ("gain+offset+clip(Samples)(Samples)", {"gain","offset","clip"}));
+          CHECK (not matchFusedConstituents ("offset+gain+clip(Samples)(Samples)", {"gain","offset","clip"}));
+          CHECK (not matchFusedConstituents ("gain+offset+limit(Samples)(Samples)",{"gain","offset","clip"}));
+          CHECK (not matchFusedConstituents ("gain+offset(Samples)(Samples)",      {"gain","offset","clip"}));
+          CHECK (not matchFusedConstituents ("gain+offsetclip(Samples)(Samples)",  {"gain","offset","clip"}));
+        }
+      
+      
+      /** @test the fused node renders the same result as the chain of nodes,
+       *        and the constituent operations are visible in the spec of its port */
+      void
+      render_fusedNode()
+        {
+          deque<ProcNode> nodes;
+          ProcNode& chained = buildNodeChain (nodes);
+          ProcNode& fused   = buildFusedNode (nodes);
+          
+          for (FraNo n : {0,1,5,13})
+            {
+              SampleBlock result = pullBlock (fused, Time{FSecs(n)});
+              CHECK (result == expectedResult(n));
+              CHECK (result == pullBlock (chained, Time{FSecs(n)}));
+            }
+          
+          CHECK (watch(fused).getPortSpec(0)   == "fused.gain+offset+clip(Samples)(Samples)"_expect);
+          CHECK (watch(fused).getNodeSpec()    == "Test:fused◁—Test:gen-◎"_expect);
+          CHECK (watch(chained).getNodeSpec()  == "Test:clip◁—Test:offset┉┉{Test:gen}"_expect);
+        }
+      
+      
+      /** @test the spec for a fused node must name each constituent, in order */
+      void
+      reject_unnamedConstituents()
+        {
+          VERIFY_FAIL ("must name each of the 3 element operations"
+                      , prepareNode("Test:fused")
+                          .preparePort()
+                            .invokeFused<SampleBlock> ("gain+clip(Samples)(Samples)"
+                                                      , elmOp("gain",ont::amplify), elmOp("offset",ont::offset), elmOp("clip",ont::clip)));
+          VERIFY_FAIL ("must name each of the 2 element operations"
+                      , prepareNode("Test:fused")
+                          .preparePort()
+                            .invokeFused<SampleBlock> ("fused(Samples)(Samples)"
+                                                      , elmOp("offset",ont::offset), elmOp("clip",ont::clip)));
+          // correct count, yet wrong order or wrong names
+          VERIFY_FAIL ("in order, joined by '+' (expected: gain+offset+clip)"
+                      , prepareNode("Test:fused")
+                          .preparePort()
+                            .invokeFused<SampleBlock> ("offset+gain+clip(Samples)(Samples)"
+                                                      , elmOp("gain",ont::amplify), elmOp("offset",ont::offset), elmOp("clip",ont::clip)));
+          VERIFY_FAIL ("in order, joined by '+' (expected: offset+clip)"
+                      , prepareNode("Test:fused")
+                          .preparePort()
+                            .invokeFused<SampleBlock> ("offset+limit(Samples)(Samples)"
+                                                      , elmOp("offset",ont::offset), elmOp("clip",ont::clip)));
+        }
+      
+      
+      /** @test compare the time per frame of the fused node with the chain of nodes.
+       *        Each node in the chain reads and writes a complete buffer, while the
+       *        fused node passes over the data only once; the memory traffic saved
+       *        is reported, based on the buffer size.
+       */
+      void
+      benchmark_bandwidth()
+        {
+          const uint NUM_FRAMES = 500;
+          const uint ROUNDS = 4;
+          const uint STAGES = 3;
+          
+          deque<ProcNode> nodes;
+          ProcNode& chained = buildNodeChain (nodes);
+          ProcNode& fused   = buildFusedNode (nodes);
+          
+          auto invoke = [](ProcNode& node)
+                          {
+                            return [&node](size_t i) -> size_t
+                                      {
+                                        SampleBlock result = pullBlock (node, Time{FSecs(i)});
+                                        return size_t(1000 * result[i % SAMPLE_CNT]);
+                                      };
+                          };
+          auto pullChain = invoke (chained);
+          auto pullFused = invoke (fused);
+          CHECK (pullChain(7) == pullFused(7));
+          
+          // Note: measure in alternating rounds, since the diagnostic buffer provider
+          //       retains all buffers and thus becomes slower with each frame
+          double timeChain{0}, timeFused{0};
+          auto measure = [&](auto& invocation){ return microBenchmark (invocation, NUM_FRAMES).first / ROUNDS; };
+          for (uint r=0; r<ROUNDS; ++r)
+            if (r % 2)
+              {
+                timeFused += measure (pullFused);
+                timeChain += measure (pullChain);
+              }
+            else
+              {
+                timeChain += measure (pullChain);
+                timeFused += measure (pullFused);
+              }
+          
+          // each processing step reads an input buffer and writes an output buffer
+          size_t bytesChain = STAGES * 2 * sizeof(SampleBlock);
+          size_t bytesFused =          2 * sizeof(SampleBlock);
+          cout << _Fmt{"time per frame (%d element operations): node chain %5.2fµs  fused %5.2fµs"}
+                      % STAGES % timeChain % timeFused
+               << endl;
+          cout << _Fmt{"memory traffic per frame: node chain %d bytes  fused %d bytes  (saved %d bytes and %d buffers)"}
+                      % bytesChain % bytesFused % (bytesChain - bytesFused) % (STAGES-1)
+               << endl;
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (NodeFused_test, "unit node");
+  
+  
+  
+}}} // namespace steam::engine::test
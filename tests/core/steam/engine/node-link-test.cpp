@@ -61,6 +61,7 @@ namespace test  {
    *     - connectivity can be verified to match definition
    *     - TestFrame data can be computed in a complex processing network
    *     - parameters can be derived from time and fed into the nodes.
+   *     - processing can reuse the input buffers for output.
    */
   class NodeLink_test : public Test
     {
@@ -72,6 +73,7 @@ namespace test  {
           build_simple_node();
           build_connected_nodes();
           trigger_node_port_invocation();
+          use_inPlace_processing();
         }
       
       
@@ -509,6 +511,119 @@ namespace test  {
               CHECK (invoke (nomTime,port) == verify (nomTime,port));
             }
         }
+      
+      
+      
+      /** @test processing functions able to work in-place can reuse the input buffer.
+       *      - for each output slot, the builder determines if the lead port connected
+       *        to the input slot with same index delivers the same kind of buffer
+       *      - diagnostics report the buffer memory configured for in-place use
+       *      - the result is the same as with separate output buffers
+       *      - but a buffer provided by the caller is used for the final result
+       */
+      void
+      use_inPlace_processing()
+        {
+          auto testGen = testRand().setupGenerator();
+          auto testMan = testRand().setupManipulator();
+          auto testMix = testRand().setupCombinator();
+          
+          ont::FraNo frameNo{5};
+          ont::Param filterParam{23};
+          ont::Factr mixFactor{0.7};
+          
+          ProcNode srcA{prepareNode("srcA")
+                        .preparePort()
+                          .invoke(testGen.procID(), testGen.makeFun())
+                          .setParam(frameNo, SRC_A)
+                          .completePort()
+                        .build()};
+          ProcNode srcB{prepareNode("srcB")
+                        .preparePort()
+                          .invoke(testGen.procID(), testGen.makeFun())
+                          .setParam(frameNo, SRC_B)
+                          .completePort()
+                        .build()};
+          
+          // Filter and Mix, each with a flavour using separate buffers and an in-place flavour
+          ProcNode filter{prepareNode("filterA")
+                        .preparePort()
+                          .invoke(testMan.procID(), testMan.makeFun())
+                          .setParam(filterParam)
+                          .connectLeadPort(srcA,0)
+                          .completePort()
+                        .preparePort()
+                          .invoke(testMan.procID(), testMan.makeFun())
+                          .setParam(filterParam)
+                          .allowInPlace()
+                          .connectLeadPort(srcA,0)
+                          .completePort()
+                        .build()};
+          ProcNode mix{prepareNode("mix")
+                        .preparePort()
+                          .invoke(testMix.procID(), testMix.makeFun())
+                          .setParam(mixFactor)
+                          .connectLeadPort(filter,0)
+                          .connectLeadPort(srcB,0)
+                          .completePort()
+                        .preparePort()
+                          .invoke(testMix.procID(), testMix.makeFun())
+                          .setParam(mixFactor)
+                          .allowInPlace()
+                          .connectLeadPort(filter,1)
+                          .connectLeadPort(srcB,0)
+                          .completePort()
+                        .build()};
+          
+          CHECK (0 == watch(srcA).getInPlaceBytes());                          // source without input
+          CHECK (0 == watch(filter).watchPort(0).getInPlaceBytes());
+          CHECK (sizeof(TestFrame) == watch(filter).watchPort(1).getInPlaceBytes());
+          CHECK (sizeof(TestFrame) == watch(mix).getInPlaceBytes());           // only the first input of port#1
+          
+          TestFrame f1{uint(frameNo),SRC_A};
+          TestFrame f2{uint(frameNo),SRC_B};
+          ont::manipulateFrame (&f1, &f1, filterParam);
+          ont::combineFrames (&f1, &f1, &f2, mixFactor);
+          
+          BufferProvider& provider = DiagnosticBufferProvider::build();
+          auto invoke = [&](uint port)
+                            {
+                              BuffHandle buff = provider.lockBufferFor<TestFrame>();
+                              buff = mix.pull (port, buff, Time::ZERO, ProcessKey{});
+                              HashVal checksum = buff.accessAs<TestFrame>().getChecksum();
+                              buff.release();
+                              return checksum;
+                            };
+          CHECK (invoke(0) == f1.getChecksum());
+          CHECK (invoke(1) == f1.getChecksum());
+          
+          
+          // Verify the buffers actually passed to the processing function
+          using Buffs = array<uint*,2>;
+          uint* seenIn{nullptr};
+          uint* seenOut{nullptr};
+          auto src = [](uint* out){ *out = 1; };
+          auto inc = [&](uint* in, uint* out){ seenIn = in; seenOut = out; *out = *in + 1; };
+          auto add = [&](Buffs in, uint* out){ seenIn = in[0]; seenOut = out; *out = *in[0] + *in[1]; };
+          
+          ProcNode n1{prepareNode("src").preparePort().invoke("src()", src).completePort().build()};
+          ProcNode n2{prepareNode("inc").preparePort().invoke("inc()", inc).allowInPlace().connectLead(n1).completePort().build()};
+          ProcNode n3{prepareNode("add").preparePort().invoke("add()", add).allowInPlace().connectLead(n2).connectLead(n1).completePort().build()};
+          CHECK (sizeof(uint) == watch(n2).getInPlaceBytes());
+          CHECK (sizeof(uint) == watch(n3).getInPlaceBytes());
+          
+          BuffHandle buff = provider.lockBufferFor<uint>();
+          buff = n2.pull (0, buff, Time::ZERO, ProcessKey{});
+          CHECK (2 == buff.accessAs<uint>());
+          CHECK (seenIn != seenOut);                                           // result placed into the given buffer
+          buff.release();
+          
+          TurnoutSystem turnoutSys{Time::ZERO};
+          BuffHandle res = n3.getPort(0).weave (turnoutSys);                   // no output buffer given
+          CHECK (2+1 == res.accessAs<uint>());
+          CHECK (seenIn == seenOut);                                           // input buffer from n2 reused for the result
+          res.release();
+        }
     };
   
   
@@ -0,0 +1,298 @@
+/*
+  ParamAutomation(Test)  -  verify incremental evaluation of parameter automation
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file param-automation-test.cpp
+ ** unit test \ref ParamAutomation_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "steam/engine/param-automation.hpp"
+#include "steam/engine/node-builder.hpp"
+#include "steam/engine/diagnostic-buffer-provider.hpp"
+#include "steam/fixture/segment.hpp"
+#include "lib/format-string.hpp"
+#include "lib/time/timevalue.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using lib::test::microBenchmark;
+using lib::time::FrameRate;
+using lib::time::Offset;
+using lib::time::FSecs;
+using util::_Fmt;
+using std::cout;
+using std::endl;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  using automation::LINEAR;
+  using automation::STEP;
+  
+  namespace { // Test fixture
+    
+    const FrameRate FPS{25};
+    const double EPSILON = 1e-9;
+    
+    Time
+    frame (int64_t n)
+    {
+      return Time{Offset{n, FPS}};
+    }
+    
+    bool
+    near (double v1, double v2)
+    {
+      return std::abs (v1 - v2) < EPSILON * std::max (1.0, std::abs (v1));
+    }
+    
+    /** dense curve with keyframes every few frames */
+    AutomationCurve
+    denseCurve (uint keyCnt, uint framesPerKey)
+    {
+      AutomationCurve curve;
+      for (uint k=0; k < keyCnt; ++k)
+        curve.addKeyframe (frame (k*framesPerKey), std::sin (0.3*k) + 0.1*(k%7));
+      return curve;
+    }
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify evaluation of parameter automation by interpolating keyframes.
+   *       - keyframes are interpolated in stepped, linear or smooth mode
+   *       - the polynomials are precomputed for the time range of a Segment
+   *       - consecutive frames are computed incrementally by forward differencing
+   *       - a render node can be controlled by an automation curve
+   *       - compare per-frame cost with direct evaluation on a dense curve
+   * @see param-automation.hpp
+   */
+  class ParamAutomation_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          interpolate_keyframes();
+          precompute_plan();
+          evaluate_incrementally();
+          automate_node();
+          benchmark_denseCurve();
+        }
+      
+      
+      /** @test basic interpolation between keyframes */
+      void
+      interpolate_keyframes()
+        {
+          AutomationCurve linear{LINEAR};
+          CHECK (linear.empty());
+          CHECK (0.0 == linear.evaluate (Time::ZERO));
+          linear.addKeyframe (Time{FSecs(2)}, 4.0)
+                .addKeyframe (Time{FSecs(1)}, 2.0)
+                .addKeyframe (Time{FSecs(3)}, 1.0);
+          CHECK (3 == linear.size());
+          CHECK (Time{FSecs(1)} == linear[0].time);
+          CHECK (2.0 == linear.evaluate (Time::ZERO));              // constant before first keyframe
+          CHECK (2.0 == linear.evaluate (Time{FSecs(1)}));
+          CHECK (3.0 == linear.evaluate (Time{FSecs(3,2)}));
+          CHECK (4.0 == linear.evaluate (Time{FSecs(2)}));
+          CHECK (2.5 == linear.evaluate (Time{FSecs(5,2)}));
+          CHECK (1.0 == linear.evaluate (Time{FSecs(5)}));          // constant after last keyframe
+          
+          linear.addKeyframe (Time{FSecs(2)}, 6.0);                  // replace existing keyframe
+          CHECK (3 == linear.size());
+          CHECK (4.0 == linear.evaluate (Time{FSecs(3,2)}));
+          
+          AutomationCurve step{STEP};
+          step.addKeyframe (Time{FSecs(1)}, 2.0)
+              .addKeyframe (Time{FSecs(2)}, 4.0);
+          CHECK (2.0 == step.evaluate (Time{FSecs(19,10)}));
+          CHECK (4.0 == step.evaluate (Time{FSecs(2)}));
+          
+          // smooth interpolation passes through keyframes
+          AutomationCurve smooth = denseCurve (5, 10);
+          for (uint k=0; k<5; ++k)
+            CHECK (near (smooth[k].value, smooth.evaluate (frame (k*10))));
+          // ...and is continuous at keyframes
+          Time k2 = frame(20);
+          CHECK (std::abs (smooth.evaluate (k2 - Offset{FSecs(1,1000)}) - smooth.evaluate (k2)) < 0.01);
+          CHECK (std::abs (smooth.evaluate (k2 + Offset{FSecs(1,1000)}) - smooth.evaluate (k2)) < 0.01);
+        }
+      
+      
+      /** @test precompute the interpolation for the time range of a Segment */
+      void
+      precompute_plan()
+        {
+          AutomationCurve curve = denseCurve (10, 10);
+          
+          // covering the whole curve plus constant ends
+          AutomationPlan full{curve, TimeSpan{frame(-10), frame(100)}};
+          CHECK (9 + 2 == full.size());
+          for (int64_t f=-10; f < 100; ++f)
+            CHECK (near (curve.evaluate (frame(f)), full.evaluate (frame(f))));
+          
+          // a Segment only covers a part of the curve
+          fixture::Segment seg{TimeSpan{frame(25), frame(45)}};
+          AutomationPlan part{curve, seg};
+          CHECK (3 == part.size());                                  // intervals [20,30[ [30,40[ [40,50[
+          CHECK (frame(20) == part[0].start);
+          CHECK (frame(50) == part[2].end);
+          for (int64_t f=25; f < 45; ++f)
+            CHECK (near (curve.evaluate (frame(f)), part.evaluate (frame(f))));
+          CHECK (1 == part.locate (frame(35)));
+          CHECK (1 == part.locate (frame(35), 1));
+          CHECK (2 == part.locate (frame(42), 1));
+          CHECK (2 == part.locate (frame(99)));                      // clamped
+          
+          AutomationPlan empty{AutomationCurve{}, TimeSpan{frame(0), frame(10)}};
+          CHECK (1 == empty.size());
+          CHECK (0.0 == empty.evaluate (frame(5)));
+        }
+      
+      
+      /** @test consecutive frames are computed by forward differencing,
+       *        any other request is evaluated directly */
+      void
+      evaluate_incrementally()
+        {
+          AutomationCurve curve = denseCurve (10, 10);
+          AutomationCursor cursor{AutomationPlan::build (curve, TimeSpan{frame(0), frame(90)})};
+          
+          for (int64_t f=0; f < 90; ++f)
+            CHECK (near (curve.evaluate (frame(f)), cursor.evaluate (frame(f))));
+          // two direct evaluations to establish the step, one direct at each span boundary
+          CHECK (2 + 8 == cursor.cntDirect());
+          CHECK (90 - 10 == cursor.cntIncremental());
+          
+          // a jump is evaluated directly, subsequent frames incrementally
+          CHECK (near (curve.evaluate (frame(13)), cursor.evaluate (frame(13))));
+          CHECK (near (curve.evaluate (frame(14)), cursor.evaluate (frame(14))));
+          CHECK (near (curve.evaluate (frame(15)), cursor.evaluate (frame(15))));
+          CHECK (12 == cursor.cntDirect());
+          CHECK (81 == cursor.cntIncremental());
+          
+          // going backwards or repeating a frame is always evaluated directly
+          CHECK (near (curve.evaluate (frame(15)), cursor.evaluate (frame(15))));
+          CHECK (near (curve.evaluate (frame(14)), cursor.evaluate (frame(14))));
+          CHECK (near (curve.evaluate (frame(13)), cursor.evaluate (frame(13))));
+          CHECK (15 == cursor.cntDirect());
+          CHECK (81 == cursor.cntIncremental());
+          
+          // a copy of the cursor starts afresh
+          AutomationCursor other{cursor};
+          CHECK (0 == other.cntDirect());
+          CHECK (near (curve.evaluate (frame(50)), other.evaluate (frame(50))));
+          CHECK (1 == other.cntDirect());
+          
+          // on a long interval the differences are re-anchored periodically
+          AutomationCurve slow;
+          slow.addKeyframe (frame(0), 0.0)
+              .addKeyframe (frame(1000), 1.0);
+          AutomationCursor longRun{AutomationPlan::build (slow, TimeSpan{frame(0), frame(1000)})};
+          for (int64_t f=0; f < 1000; ++f)
+            CHECK (near (slow.evaluate (frame(f)), longRun.evaluate (frame(f))));
+          CHECK (32 == AutomationCursor::REANCHOR_STEPS);
+          CHECK (2 + 30 == longRun.cntDirect());                     // after each 32 steps one direct evaluation
+          CHECK (30*32 + 8 == longRun.cntIncremental());
+        }
+      
+      
+      /** @test control the parameter of a render node by automation;
+       *        the automation is covered by the processing hash of the port */
+      void
+      automate_node()
+        {
+          AutomationCurve curve = denseCurve (10, 10);
+          ProcNode node{prepareNode("Test:auto")
+                          .preparePort()
+                            .invoke ("auto()", [](double param, double* out){ *out = param; })
+                            .attachAutomation (curve, TimeSpan{frame(0), frame(90)})
+                            .completePort()
+                          .build()};
+          
+          BufferProvider& provider = DiagnosticBufferProvider::build();
+          for (int64_t f=0; f < 90; f += 3)
+            {
+              BuffHandle buff = provider.lockBufferFor<double>();
+              buff = node.pull (0, buff, frame(f), ProcessKey{});
+              CHECK (near (curve.evaluate (frame(f)), buff.accessAs<double>()));
+              buff.release();
+            }
+          
+          // the processing hash reflects the automation, to discern cached frames
+          auto hashWith = [](AutomationCurve const& automation)
+                            {
+                              ProcNode other{prepareNode("Test:auto")
+                                               .preparePort()
+                                                 .invoke ("auto()", [](double param, double* out){ *out = param; })
+                                                 .attachAutomation (automation, TimeSpan{frame(0), frame(90)})
+                                                 .completePort()
+                                               .build()};
+                              return watch(other).getPortHash(0);
+                            };
+          AutomationCurve changed = denseCurve (10, 10);
+          changed.addKeyframe (frame(45), 0.0);
+          CHECK (watch(node).getPortHash(0) == hashWith (curve));
+          CHECK (watch(node).getPortHash(0) != hashWith (changed));
+        }
+      
+      
+      /** @test compare the per-frame cost of direct evaluation with incremental evaluation
+       *        on a dense automation curve (one keyframe every 5 frames) */
+      void
+      benchmark_denseCurve()
+        {
+          const uint KEYS = 2000;
+          const uint FRAMES_PER_KEY = 5;
+          const uint FRAMES = KEYS * FRAMES_PER_KEY;
+          
+          AutomationCurve curve = denseCurve (KEYS, FRAMES_PER_KEY);
+          AutomationPlan::Shared plan = AutomationPlan::build (curve, TimeSpan{frame(0), frame(FRAMES)});
+          AutomationCursor cursor{plan};
+          std::vector<Time> frames;
+          for (uint f=0; f < FRAMES; ++f)
+            frames.push_back (frame(f));
+          
+          double sum{0};
+          auto direct      = [&](size_t i){ sum += curve.evaluate (frames[i % FRAMES]); return i; };
+          auto planned     = [&](size_t i){ sum += plan->evaluate (frames[i % FRAMES]); return i; };
+          auto incremental = [&](size_t i){ sum += cursor.evaluate (frames[i % FRAMES]); return i; };
+          
+          double timeDirect      = microBenchmark (direct, FRAMES).first;
+          double timePlanned     = microBenchmark (planned, FRAMES).first;
+          double timeIncremental = microBenchmark (incremental, FRAMES).first;
+          CHECK (sum != 0);
+          CHECK (cursor.cntIncremental() > cursor.cntDirect());
+          
+          cout << _Fmt{"automation with %d keyframes, per frame: direct %5.3fµs  precomputed %5.3fµs  incremental %5.3fµs"}
+                      % KEYS % timeDirect % timePlanned % timeIncremental
+               << endl;
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (ParamAutomation_test, "unit node");
+  
+  
+  
+}}} // namespace steam::engine::test
@@ -0,0 +1,274 @@
+/*
+  PooledBufferProvider(Test)  -  verify buffer management based on frame pools
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file pooled-buffer-provider-test.cpp
+ ** unit test \ref PooledBufferProvider_test
+ */
+
+
+#include "lib/error.hpp"
+#include "lib/test/run.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "steam/engine/pooled-buffer-provider.hpp"
+#include "steam/engine/buffhandle-attach.hpp"
+#include "steam/engine/testframe.hpp"
+#include "lib/format-string.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/sync-barrier.hpp"
+#include "lib/thread.hpp"
+#include "lib/util.hpp"
+
+#include <vector>
+
+using util::_Fmt;
+using util::isSameAdr;
+using lib::ThreadJoinable;
+using lib::SyncBarrier;
+using lib::test::microBenchmark;
+using std::vector;
+
+
+namespace steam  {
+namespace engine{
+namespace test  {
+  
+  namespace { // Test fixture
+    
+    const size_t FRAME_SIZ = 1000;
+    const uint   ANNOUNCED = 100;
+    const uint   HEADROOM  = pool::MAGAZINE_SIZE;   ///< frames possibly cached per thread (for small frames)
+    const size_t REPETITIONS = 1000000;
+    
+    bool
+    isAligned (BuffHandle const& buff)
+    {
+      return 0 == size_t(& *buff) % pool::FRAME_ALIGNMENT;
+    }
+  }
+  
+  
+  
+  /******************************************************************//**
+   * @test verify the BufferProvider for the render engine, which
+   *       recycles frames from pools organised by size class.
+   *       - frames are aligned and grouped by rounded size
+   *       - capacity is established when announcing buffers
+   *       - in steady state, no further storage is allocated
+   *       - released frames are cached by the releasing thread
+   *       - frames cached by a terminated thread return into the pool
+   * @see BufferProviderProtocol_test
+   * @see pooled-buffer-provider.hpp
+   */
+  class PooledBufferProvider_test : public Test
+    {
+      virtual void
+      run (Arg)
+        {
+          simpleUsage();
+          verifySizeClasses();
+          verifySteadyState();
+          verifyThreadCache();
+          benchmark_lockRelease();
+        }
+      
+      
+      /** @test lock a buffer, release it and get the same frame again */
+      void
+      simpleUsage()
+        {
+          PooledBufferProvider provider;
+          BuffDescr type = provider.getDescriptorFor (FRAME_SIZ);
+          
+          BuffHandle buff = provider.lockBuffer (type);
+          CHECK (buff.isValid());
+          CHECK (FRAME_SIZ == buff.size());
+          CHECK (isAligned (buff));
+          void* frame = & *buff;
+          
+          buff.accessAs<uint>() = 42;
+          buff.release();
+          CHECK (not buff.isValid());
+          
+          // the most recently released frame is handed out again
+          BuffHandle buff2 = provider.lockBuffer (type);
+          CHECK (isSameAdr (frame, *buff2));
+          buff2.release();
+          
+          // storage was allocated on demand
+          CHECK (1 == provider.cntSizeClasses());
+          CHECK (1 == provider.cntSlabs());
+          CHECK (pool::MIN_GROWTH == provider.capacity (FRAME_SIZ));
+          CHECK (pool::MIN_GROWTH == provider.cntFree (FRAME_SIZ));
+        }
+      
+      
+      /** @test buffer sizes are rounded up to the frame alignment;
+       *        buffer types of equal rounded size share a pool of frames.
+       */
+      void
+      verifySizeClasses()
+        {
+          PooledBufferProvider provider;
+          BuffHandle b1 = provider.lockBuffer (provider.getDescriptorFor (1000));
+          BuffHandle b2 = provider.lockBuffer (provider.getDescriptorFor (1024));
+          CHECK (1 == provider.cntSizeClasses());
+          CHECK (provider.capacity(1000) == provider.capacity(1024));
+          
+          BuffHandle b3 = provider.lockBuffer (provider.getDescriptorFor (1025));
+          CHECK (2 == provider.cntSizeClasses());
+          CHECK (isAligned (b3));
+          
+          // buffers with an embedded object
+          BuffHandle b4 = provider.lockBuffer (provider.getDescriptor<TestFrame>());
+          CHECK (isAligned (b4));
+          
+          TestFrame& frame = b4.accessAs<TestFrame>();
+          CHECK (frame.isSane());
+          b1.release();
+          b2.release();
+          b3.release();
+          b4.release();
+          CHECK (frame.isDead());
+          CHECK (provider.cntFree(1000) == provider.capacity(1000));
+        }
+      
+      
+      /** @test announcing buffers establishes the capacity beforehand,
+       *        including headroom for the frames cached by the attached thread;
+       *        afterwards frames can be locked and released repeatedly
+       *        without any further allocation of frame storage.
+       */
+      void
+      verifySteadyState()
+        {
+          PooledBufferProvider provider;
+          BuffDescr type = provider.getDescriptorFor (FRAME_SIZ);
+          CHECK (ANNOUNCED == provider.announce (ANNOUNCED, type));
+          CHECK (1 == provider.cntThreadCaches());
+          CHECK (ANNOUNCED+HEADROOM == provider.capacity (FRAME_SIZ));
+          CHECK (ANNOUNCED+HEADROOM == provider.cntFree (FRAME_SIZ));
+          CHECK (1 == provider.cntSlabs());
+          
+          vector<BuffHandle> buffers;
+          buffers.reserve (2*ANNOUNCED+1);
+          for (uint round=0; round < 10; ++round)
+            {
+              for (uint i=0; i < ANNOUNCED; ++i)
+                buffers.emplace_back (provider.lockBuffer (type));
+              CHECK (HEADROOM == provider.cntFree (FRAME_SIZ));
+              for (auto& buff : buffers)
+                buff.release();
+              buffers.clear();
+            }
+          CHECK (ANNOUNCED+HEADROOM == provider.cntFree (FRAME_SIZ));
+          CHECK (ANNOUNCED+HEADROOM == provider.capacity (FRAME_SIZ));
+          CHECK (1 == provider.cntSlabs());
+          
+          // announcements add up, irrespective of the frames currently free
+          buffers.emplace_back (provider.lockBuffer (type));
+          provider.announce (ANNOUNCED, type);
+          CHECK (2 == provider.cntSlabs());
+          CHECK (2*ANNOUNCED+HEADROOM == provider.capacity (FRAME_SIZ));
+          
+          // beyond the established capacity, the pool is extended
+          for (uint i=1; i < 2*ANNOUNCED+HEADROOM; ++i)
+            buffers.emplace_back (provider.lockBuffer (type));
+          CHECK (2*ANNOUNCED+HEADROOM == provider.capacity (FRAME_SIZ));
+          CHECK (2 == provider.cntSlabs());
+          buffers.emplace_back (provider.lockBuffer (type));
+          CHECK (3 == provider.cntSlabs());
+          CHECK (2*ANNOUNCED+HEADROOM < provider.capacity (FRAME_SIZ));
+          for (auto& buff : buffers)
+            buff.release();
+          CHECK (provider.cntFree(FRAME_SIZ) == provider.capacity(FRAME_SIZ));
+        }
+      
+      
+      /** @test frames released by a thread are retained in a thread-local cache;
+       *        each attached thread extends the headroom of announced pools,
+       *        and the frames of a terminated thread return into the pool.
+       */
+      void
+      verifyThreadCache()
+        {
+          PooledBufferProvider provider;
+          BuffDescr type = provider.getDescriptorFor (FRAME_SIZ);
+          provider.announce (ANNOUNCED, type);
+          CHECK (ANNOUNCED+HEADROOM == provider.capacity (FRAME_SIZ));
+          
+          void* frame{nullptr};
+          SyncBarrier cached, checked;
+          ThreadJoinable worker{"PooledBufferProvider_test: worker"
+                               ,[&]{
+                                     BuffHandle buff = provider.lockBuffer (type);
+                                     frame = & *buff;
+                                     buff.release();
+                                     cached.sync();
+                                     checked.sync();
+                                   }};
+          cached.sync();
+          CHECK (frame);
+          CHECK (2 == provider.cntThreadCaches());
+          CHECK (ANNOUNCED+2*HEADROOM == provider.capacity (FRAME_SIZ));
+          
+          // another thread does not get the frame cached by the worker
+          BuffHandle buff = provider.lockBuffer (type);
+          CHECK (not isSameAdr (frame, *buff));
+          CHECK (provider.capacity(FRAME_SIZ)-1 == provider.cntFree (FRAME_SIZ));
+          checked.sync();
+          worker.join();
+          
+          // the cache of the terminated worker was returned into the pool
+          CHECK (1 == provider.cntThreadCaches());
+          buff.release();
+          CHECK (provider.capacity(FRAME_SIZ) == provider.cntFree (FRAME_SIZ));
+          CHECK (ANNOUNCED+2*HEADROOM == provider.capacity (FRAME_SIZ));
+        }
+      
+      
+      /** @test measure the throughput of locking and releasing frames
+       * @note  includes the metadata management by the BufferProvider frontend.
+       */
+      void
+      benchmark_lockRelease()
+        {
+          PooledBufferProvider provider;
+          BuffDescr type = provider.getDescriptorFor (FRAME_SIZ);
+          provider.announce (10, type);
+          size_t slabs = provider.cntSlabs();
+          
+          auto lockRelease = [&](size_t i) -> size_t
+                                {
+                                  BuffHandle buff = provider.lockBuffer (type);
+                                  buff.accessAs<size_t>() = i;
+                                  size_t check = buff.accessAs<size_t>();
+                                  buff.release();
+                                  return check;
+                                };
+          auto [micros, checksum] = microBenchmark (lockRelease, REPETITIONS);
+          cout << _Fmt{"lock+release: %5.1fns  => %4.1f Mio frames/s"}
+                      % (micros*1000) % (1/micros)
+               << endl;
+          CHECK (checksum == REPETITIONS*(REPETITIONS-1)/2);
+          CHECK (slabs == provider.cntSlabs());     // no allocation of frame storage
+          CHECK (micros < 1.0);                     // > 1 million frames per second
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (PooledBufferProvider_test, "unit player");
+  
+  
+  
+}}} // namespace steam::engine::test
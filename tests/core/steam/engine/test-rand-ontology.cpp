@@ -41,6 +41,33 @@ namespace ont   {
     
     namespace { // hidden local support facilities....
       
+      /** number of samples processed together as a chunk;
+       *  chosen to fill the vector registers of common hardware */
+      const uint LANES = 8;
+      static_assert (0 == SAMPLE_CNT % LANES);
+      
+      /**
+       * Portable vectorisation scheme for the sample processing kernels:
+       * the operation is computed for a chunk of lanes into local storage,
+       * which is then stored into the output. Since the loads do not depend
+       * on preceding stores, the compiler is free to map the inner loops onto
+       * SIMD instructions, without the need for intrinsics; as a side effect,
+       * output and input may be the same buffer.
+       * @param op computation for a single sample, given its index
+       */
+      template<class OP>
+      inline void
+      processLanes (SampleBlock& out, OP op)
+      {
+        for (uint i=0; i<SAMPLE_CNT; i+=LANES)
+          {
+            Sampl chunk[LANES];
+            for (uint l=0; l<LANES; ++l)
+              chunk[l] = op(i+l);
+            for (uint l=0; l<LANES; ++l)
+              out[i+l] = chunk[l];
+          }
+      }
     } // (End) hidden impl details
     
     /** @remark will be returned from dummyOp() */
@@ -159,6 +186,88 @@ namespace ont   {
           res = lround((1-mix)*inA + mix*inB);
       out->markChecksum();
     }
+    
+    
+    
+    /* ========= Reference kernels for sample processing ========= */
+    
+    /**
+     * @param out     existing allocation to receive the random samples
+     * @param frameNr the frame of the »source feed« to generate (determines actual random data)
+     * @param flavour a further seed parameter to determine the actual (reproducibly) random data
+     * @remark uses a simple xor-shift generator, seeded by hash-combining the parameters
+     */
+    void
+    generateSamples (SampleBlock* out, FraNo frameNr, Flavr flavour)
+    {
+      REQUIRE (out);
+      uint64_t state{frameNr};
+      lib::hash::combine (state, flavour);
+      state |= 1;
+      for (Sampl& sample : *out)
+        {
+          state ^= state << 13;
+          state ^= state >> 7;
+          state ^= state << 17;
+          sample = Sampl(state >> 40) / (1 << 23) - 1;
+        }
+    }
+    
+    /**
+     * @param out  existing allocation to receive the amplified samples
+     * @param in   a buffer holding the input samples (may be the same as \a out)
+     * @param gain factor to apply to each sample
+     */
+    void
+    gainSamples (SampleBlock* out, SampleBlock const* in, Sampl gain)
+    {
+      REQUIRE (in);
+      REQUIRE (out);
+      SampleBlock const& src{*in};
+      processLanes (*out, [&](uint i){ return gain * src[i]; });
+    }
+    
+    /**
+     * @param out  existing allocation to receive the mixed samples
+     * @param srcA a buffer holding the samples of feed-A
+     * @param srcB a buffer holding the samples of feed-B
+     * @param mix  proportion of feed-B in the result: 1.0 means 100% feed-B
+     */
+    void
+    mixSamples (SampleBlock* out, SampleBlock const* srcA, SampleBlock const* srcB, Sampl mix)
+    {
+      REQUIRE (srcA);
+      REQUIRE (srcB);
+      REQUIRE (out);
+      SampleBlock const& a{*srcA};
+      SampleBlock const& b{*srcB};
+      processLanes (*out, [&](uint i){ return (1-mix)*a[i] + mix*b[i]; });
+    }
+    
+    /**
+     * @param out  existing allocation to receive the mixed samples
+     * @param srcA a buffer holding the samples of feed-A
+     * @param srcB a buffer holding the samples of feed-B
+     * @param from proportion of feed-B at start of the block
+     * @param to   proportion of feed-B at the end of the block
+     * @remark the proportion is interpolated linearly for each sample, so that
+     *         a sequence of blocks with consecutive ranges yields a smooth fade.
+     */
+    void
+    crossfadeSamples (SampleBlock* out, SampleBlock const* srcA, SampleBlock const* srcB, Sampl from, Sampl to)
+    {
+      REQUIRE (srcA);
+      REQUIRE (srcB);
+      REQUIRE (out);
+      SampleBlock const& a{*srcA};
+      SampleBlock const& b{*srcB};
+      Sampl step = (to-from) / SAMPLE_CNT;
+      processLanes (*out, [&](uint i)
+                            {
+                              Sampl mix = from + step*i;
+                              return (1-mix)*a[i] + mix*b[i];
+                            });
+    }
   }//(End)namespace ont
   
   
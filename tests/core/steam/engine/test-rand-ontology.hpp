@@ -27,6 +27,7 @@
 #include "lib/format-obj.hpp"
 #include "lib/format-string.hpp"
 #include "steam/engine/testframe.hpp"
+#include "steam/engine/feed-manifold.hpp"
 
 #include <array>
 #include <tuple>
@@ -96,6 +97,29 @@ namespace test  {
     /** mix two random data frames by a parameter-controlled proportion */
     void combineFrames (TestFrame* out, TestFrame const* srcA, TestFrame const* srcB, Factr mix);
     
+    
+    using Sampl = float;
+    const uint SAMPLE_CNT = 256;                ///< number of samples in a block of »audio« test data
+    const Literal TYPE_SAMPLES{"Samples"};      ///< a stream of blocks filled with (reproducible) random samples
+    using SampleBlock = std::array<Sampl, SAMPLE_CNT>;
+    
+    /** produce a block of (reproducible) random samples within [-1 … +1] */
+    void generateSamples (SampleBlock* out, FraNo frameNr =0, Flavr flavour =0);
+    
+    /** amplify a block of samples by a gain factor */
+    void gainSamples (SampleBlock* out, SampleBlock const* in, Sampl gain);
+    
+    /** mix two blocks of samples by a fixed proportion */
+    void mixSamples (SampleBlock* out, SampleBlock const* srcA, SampleBlock const* srcB, Sampl mix);
+    
+    /** mix two blocks of samples with a proportion changing linearly over the block */
+    void crossfadeSamples (SampleBlock* out, SampleBlock const* srcA, SampleBlock const* srcB, Sampl from, Sampl to);
+    
+    /* element-wise operations on a single sample, suitable to be combined into a FusedChain */
+    inline constexpr auto amplify = [](Sampl gain, Sampl s){ return gain * s; };
+    inline constexpr auto offset  = [](Sampl dc,   Sampl s){ return s + dc; };
+    inline constexpr auto clip    = [](Sampl s){ return s < -1? Sampl(-1) : 1 < s? Sampl(+1) : s; };
+    
   }//(End)namespace ont
   
   
@@ -125,6 +149,11 @@ namespace test  {
       auto setupGenerator();
       auto setupManipulator();
       auto setupCombinator();
+      
+      template<size_t K>  auto setupSampleGenerator();
+      template<size_t K>  auto setupGain();
+      template<size_t K>  auto setupSampleMix();
+      template<size_t K>  auto setupCrossfade();
     private:
     };
   
@@ -260,6 +289,122 @@ namespace test  {
                        % streamType;
           }
       };
+    
+    
+    /**
+     * extended config for batch operations on blocks of samples.
+     * The processing-functor is a _batch processing functor,_ invoked
+     * to render up to \a K consecutive frames; the actual operation on the samples
+     * is performed by the kernel function \a KER for each of these frames.
+     */
+    template<size_t K>
+    struct ConfSamples
+      {
+        template<typename X>
+        using Batch = FrameBatch<X,K>;
+        using Out = Batch<SampleBlock*>;
+        using In  = Batch<SampleBlock const*>;
+        using In2 = Batch<std::array<SampleBlock const*, 2>>;
+        
+        string streamType;
+        
+        ConfSamples(Spec const& spec)
+          : streamType{spec.BASE_TYPE}
+          { }
+        
+        /** @param args argument lists, with `%1%` as placeholder for the stream type */
+        string
+        procSpec (Literal args)
+          {
+            return _Fmt{"x%d%s"}
+                       % K
+                       % string(_Fmt{string{args}} % streamType);
+          }
+      };
+    
+    template<size_t K>
+    struct ConfSampleGen
+      : ConfSamples<K>
+      {
+        using _C = ConfSamples<K>;
+        using ConfSamples<K>::ConfSamples;
+        
+        string procSpec() { return _C::procSpec ("(%1%)"); }
+        
+        auto
+        binding()
+          {
+            return [](typename _C::template Batch<FraNo> frameNr, typename _C::Out out)
+                      {
+                        for (uint k=0; k<out.cnt; ++k)
+                          generateSamples (out[k], frameNr[k]);
+                      };
+          }
+      };
+    
+    template<size_t K>
+    struct ConfGain
+      : ConfSamples<K>
+      {
+        using _C = ConfSamples<K>;
+        using ConfSamples<K>::ConfSamples;
+        
+        string procSpec() { return _C::procSpec ("(%1%)(%1%)"); }
+        
+        auto
+        binding()
+          {
+            return [](typename _C::template Batch<Sampl> gain, typename _C::In in, typename _C::Out out)
+                      {
+                        for (uint k=0; k<out.cnt; ++k)
+                          gainSamples (out[k], in[k], gain[k]);
+                      };
+          }
+      };
+    
+    template<size_t K>
+    struct ConfSampleMix
+      : ConfSamples<K>
+      {
+        using _C = ConfSamples<K>;
+        using ConfSamples<K>::ConfSamples;
+        
+        string procSpec() { return _C::procSpec ("(%1%/2)(%1%)"); }
+        
+        auto
+        binding()
+          {
+            return [](typename _C::template Batch<Sampl> mix, typename _C::In2 in, typename _C::Out out)
+                      {
+                        for (uint k=0; k<out.cnt; ++k)
+                          mixSamples (out[k], in[k][0], in[k][1], mix[k]);
+                      };
+          }
+      };
+    
+    template<size_t K>
+    struct ConfCrossfade
+      : ConfSamples<K>
+      {
+        using _C = ConfSamples<K>;
+        using ConfSamples<K>::ConfSamples;
+        
+        string procSpec() { return _C::procSpec ("(%1%/2)(%1%)"); }
+        using Fade = tuple<Sampl,Sampl>;
+        
+        auto
+        binding()
+          {
+            return [](typename _C::template Batch<Fade> fade, typename _C::In2 in, typename _C::Out out)
+                      {
+                        for (uint k=0; k<out.cnt; ++k)
+                          {
+                            auto [from,to] = fade[k];
+                            crossfadeSamples (out[k], in[k][0], in[k][1], from, to);
+                          }
+                      };
+          }
+      };
   }//(End)namespace ont
   
   
@@ -296,6 +441,55 @@ namespace test  {
     return builder;
   }
   
+  /**
+   * Initiate configuration of a batch generator-node to produce blocks of samples
+   * @tparam K number of consecutive frames rendered with each invocation
+   */
+  template<size_t K>
+  inline auto
+  TestRandOntology::setupSampleGenerator()
+  {
+    Spec spec{"generate", ont::TYPE_SAMPLES};
+    Builder<ont::ConfSampleGen<K>> builder{spec};
+    return builder;
+  }
+  
+  /**
+   * Initiate configuration of a batch filter-node to amplify blocks of samples
+   */
+  template<size_t K>
+  inline auto
+  TestRandOntology::setupGain()
+  {
+    Spec spec{"gain", ont::TYPE_SAMPLES};
+    Builder<ont::ConfGain<K>> builder{spec};
+    return builder;
+  }
+  
+  /**
+   * Initiate configuration of a batch mixing-node to combine blocks of samples
+   */
+  template<size_t K>
+  inline auto
+  TestRandOntology::setupSampleMix()
+  {
+    Spec spec{"mix", ont::TYPE_SAMPLES};
+    Builder<ont::ConfSampleMix<K>> builder{spec};
+    return builder;
+  }
+  
+  /**
+   * Initiate configuration of a batch mixing-node to fade between blocks of samples
+   */
+  template<size_t K>
+  inline auto
+  TestRandOntology::setupCrossfade()
+  {
+    Spec spec{"crossfade", ont::TYPE_SAMPLES};
+    Builder<ont::ConfCrossfade<K>> builder{spec};
+    return builder;
+  }
+  
   /** Singleton accessor */
   extern lib::Depend<TestRandOntology> testRand;
   
@@ -0,0 +1,255 @@
+/*
+  FixtureSwitch(Test)  -  switch to a new Segmentation while job-planning continues
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file fixture-switch-test.cpp
+ ** unit test \ref FixtureSwitch_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "steam/fixture/fixture-switch.hpp"
+#include "steam/engine/mock-dispatcher.hpp"
+#include "lib/scoped-collection.hpp"
+#include "lib/thread.hpp"
+#include "lib/util.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+
+namespace steam {
+namespace fixture {
+namespace test  {
+  
+  using util::isSameObject;
+  using lib::time::Time;
+  using lib::ThreadJoinable;
+  using engine::test::MockSegmentation;
+  using engine::FrameCache;
+  using engine::FrameKey;
+  using engine::BuffHandle;
+  using std::make_unique;
+  using std::atomic_bool;
+  using std::atomic_uint;
+  using LERR_(STATE);
+  
+  namespace { // test fixture
+    
+    const uint THREADS = 4;
+    const uint VERSIONS = 500;
+    const size_t FRAME_SIZ = 100;
+    
+    /** a Segmentation with a single Segment `[n ... n+10[` */
+    unique_ptr<Segmentation>
+    buildVersion (int n)
+    {
+      auto segmentation = make_unique<MockSegmentation>();
+      segmentation->splitSplice (Time{n,0}, Time{n+10,0});
+      return segmentation;
+    }
+    
+    /** a Segmentation with Segments `[10 ... 20[` and `[20 ... split[` */
+    unique_ptr<Segmentation>
+    buildSplit (int split)
+    {
+      auto segmentation = make_unique<MockSegmentation>();
+      segmentation->splitSplice (Time{10,0}, Time{20,0});
+      segmentation->splitSplice (Time{20,0}, Time{split,0});
+      return segmentation;
+    }
+    
+    FrameKey
+    frameAt (int ms)
+    {
+      return FrameKey{0xBEEF, Time{ms,0}, 0};
+    }
+  }
+  
+  
+  
+  /*****************************************************************************//**
+   * @test verify the switch-over to a new version of the Segmentation.
+   *       - job-planning reads the current version without locking
+   *       - a superseded version remains intact while still read
+   *       - Segments are retained until the deadline of the latest job
+   *       - cached frames of changed Segments are invalidated
+   *       - concurrent lookup while switching to new versions
+   * @see steam::fixture::FixtureSwitch
+   * @see lib::EpochPublication
+   * @see SegmentationIndex_test
+   */
+  class FixtureSwitch_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          switchVersion();
+          retainSegments();
+          invalidateCache();
+          concurrentLookup();
+        }
+      
+      
+      /** @test publish a new Segmentation, while job-planning still uses the previous one */
+      void
+      switchVersion()
+        {
+          FixtureSwitch fixture{buildVersion (10)};
+          {
+            auto segmentation = fixture.access();
+            CHECK (3 == segmentation->size());
+            Segment const& seg = (*segmentation)[Time(15,0)];
+            CHECK (Time(10,0) == seg.start());
+            
+            fixture.publish (buildVersion (20));
+            CHECK (1 == fixture.cntRetired());
+            CHECK (Time(20,0) == (*fixture.access())[Time(25,0)].start());
+            
+            CHECK (isSameObject (seg, (*segmentation)[Time(15,0)]));          // superseded version remains usable
+            CHECK (1 == fixture.reclaim (Time(0,1)));                         // can not be discarded while in use
+          }
+          CHECK (0 == fixture.reclaim (Time(0,1)));
+          CHECK (0 == fixture.cntRetired());
+        }
+      
+      
+      /** @test a superseded Segmentation releases each Segment
+       *        when the latest job planned from it has passed */
+      void
+      retainSegments()
+        {
+          MockSegmentation segmentation;
+          segmentation.splitSplice (Time{10,0}, Time{20,0});
+          segmentation.splitSplice (Time{20,0}, Time{30,0});
+          CHECK (4 == segmentation.size());
+          Segment const& seg1 = segmentation[Time(10,0)];
+          Segment const& seg2 = segmentation[Time(20,0)];
+          
+          CHECK (not seg1.isRetainedAt (Time(0,1)));
+          seg1.retainUntil (Time(100,1));
+          seg2.retainUntil (Time(300,1));
+          seg2.retainUntil (Time(200,1));                                     // retention is never shortened
+          CHECK (seg1.isRetainedAt (Time(100,1)));
+          CHECK (not seg1.isRetainedAt (Time(101,1)));
+          CHECK (seg2.isRetainedAt (Time(250,1)));
+          
+          CHECK (not segmentation.releaseExpired (Time(0,1)));
+          CHECK (2 == segmentation.size());                                   // Segments without jobs released immediately
+          VERIFY_ERROR (STATE, segmentation[Time(10,0)]);                     // no lookup after releasing
+          CHECK (not segmentation.releaseExpired (Time(200,1)));
+          CHECK (1 == segmentation.size());
+          CHECK (Time(20,0) == segmentation.eachSeg()->start());
+          CHECK (segmentation.releaseExpired (Time(301,1)));
+          CHECK (0 == segmentation.size());
+          
+          // the same when switching the Fixture
+          FixtureSwitch fixture{buildVersion (10)};
+          Segment const& seg = (*fixture.access())[Time(10,0)];
+          seg.retainUntil (Time(100,1));
+          fixture.publish (buildVersion (20), Time(0,1));                     // publishing reclaims expired Segments
+          CHECK (1 == fixture.cntRetired());
+          CHECK (1 == fixture.reclaim (Time(50,1)));
+          CHECK (seg.isRetainedAt (Time(50,1)));                              // Segment still intact for pending jobs
+          CHECK (0 == fixture.reclaim (Time(101,1)));
+        }
+      
+      
+      /** @test frames cached for the time range of Segments
+       *        changed by the new version are discarded on the switch */
+      void
+      invalidateCache()
+        {
+          FrameCache cache{10*FRAME_SIZ};
+          auto render = [&](int ms)
+                          {
+                            BuffHandle buff = cache.lockBuffer (cache.getDescriptorFor (FRAME_SIZ));
+                            cache.remember (frameAt(ms), buff);
+                            buff.release();
+                          };
+          FixtureSwitch fixture{buildSplit (30)};
+          fixture.attachFrameCache (cache);
+          render (5); render (15); render (22); render (40);
+          CHECK (4 == cache.cntFrames());
+          
+          fixture.publish (buildSplit (30));                                  // same Segments rebuilt
+          CHECK (4 == cache.cntFrames());
+          
+          fixture.publish (buildSplit (25));                                  // Segments from 20ms onwards changed
+          CHECK (2 == cache.cntFrames());
+          CHECK (    cache.contains (frameAt(5)));
+          CHECK (    cache.contains (frameAt(15)));
+          CHECK (not cache.contains (frameAt(22)));
+          CHECK (not cache.contains (frameAt(40)));
+          CHECK (0 == fixture.reclaim (Time(0,1)));
+        }
+      
+      
+      /** @test several planning threads perform lookups into the current
+       *        Segmentation and mark the Segments as used, while new versions
+       *        are published concurrently and superseded versions reclaimed.
+       */
+      void
+      concurrentLookup()
+        {
+          FixtureSwitch fixture{buildVersion (0)};
+          atomic_bool done{false};
+          atomic_uint cntStarted{0};
+          atomic_uint cntLookups{0};
+          atomic_uint cntBroken{0};
+          
+          auto planning = [&]
+                            {
+                              ++cntStarted;
+                              while (not done)
+                                {
+                                  auto segmentation = fixture.access();
+                                  Segment const& seg = *++segmentation->eachSeg();      // Segment following the leading empty Segment
+                                  if (not isSameObject (seg, (*segmentation)[seg.start()])
+                                      or seg.after() != seg.start() + Time(10,0))
+                                    ++cntBroken;
+                                  seg.retainUntil (Time(0,1));
+                                  ++cntLookups;
+                                }
+                            };
+          {
+            lib::ScopedCollection<ThreadJoinable<>> workers{THREADS};
+            for (uint t=0; t<THREADS; ++t)
+              workers.emplace ("FixtureSwitch_test: planning", planning);
+            while (cntStarted < THREADS)
+              std::this_thread::yield();
+            for (uint n=1; n <= VERSIONS; ++n)
+              {
+                fixture.publish (buildVersion (n));
+                fixture.reclaim (Time(0,2));
+              }
+            done = true;
+            for (auto& worker : workers)
+              worker.join();
+          }
+          CHECK (0 == cntBroken);
+          CHECK (0 < cntLookups);
+          CHECK (0 == fixture.reclaim (Time(0,2)));
+          CHECK (Time(VERSIONS,0) == (*fixture.access())[Time(VERSIONS,0)].start());
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (FixtureSwitch_test, "unit fixture");
+  
+  
+  
+}}} // namespace steam::fixture::test
@@ -0,0 +1,242 @@
+/*
+  SegmentationIndex(Test)  -  time based lookup of Segments in the Fixture
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file segmentation-index-test.cpp
+ ** unit test \ref SegmentationIndex_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "steam/fixture/segmentation.hpp"
+#include "steam/engine/mock-dispatcher.hpp"
+#include "lib/format-string.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/util.hpp"
+
+#include <vector>
+
+
+namespace steam {
+namespace fixture {
+namespace test  {
+  
+  using util::_Fmt;
+  using util::isSameObject;
+  using lib::time::Time;
+  using lib::time::TimeValue;
+  using lib::time::TimeVar;
+  using lib::test::benchmarkTime;
+  using engine::test::MockSegmentation;
+  using lib::rani;
+  
+  namespace { // test fixture
+    
+    /** start of the n-th Segment in a regular Segmentation */
+    inline Time
+    segStart (uint n)
+    {
+      return Time{40*n, 0};
+    }
+    
+    /** time point immediately before the given time */
+    inline TimeValue
+    justBefore (Time time)
+    {
+      return TimeValue{_raw(time) - 1};
+    }
+    
+    /** verify each Segment can be retrieved at its start and end */
+    bool
+    isConsistent (Segmentation const& segmentation)
+    {
+      TimeVar prevAfter = Time::ANYTIME;
+      for (Segment const& seg : segmentation.eachSeg())
+        {
+          if (seg.start() != prevAfter) return false;
+          if (not isSameObject (seg, segmentation[seg.start()])) return false;
+          if (not isSameObject (seg, segmentation[justBefore(seg.after())])) return false;
+          prevAfter = seg.after();
+        }
+      return prevAfter == Time::NEVER;
+    }
+    
+    /** a Segmentation partitioned into the given number of regular Segments from t=0 */
+    void
+    splitRegular (Segmentation& segmentation, uint cntSegments)
+    {
+      for (uint n=0; n < cntSegments; ++n)
+        segmentation.splitSplice (segStart(n), segStart(n+1));
+    }
+  }
+  
+  
+  
+  /*****************************************************************************//**
+   * @test verify the index to retrieve the Segment covering a given time point.
+   *       - Segments are found by binary search in a sorted index
+   *       - the index is kept consistent when reworking the Segmentation
+   *       - a Cursor supports monotonic lookup, as used for playback
+   *       - compare lookup performance on a Segmentation with 10k Segments
+   * @see steam::fixture::Segmentation
+   * @see SplitSplice_test
+   * @see FixtureSegment_test
+   */
+  class SegmentationIndex_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          seedRand();
+          lookupSegment();
+          verifyConsistency();
+          cursorStepping();
+          benchmark_10kSegments();
+        }
+      
+      
+      /** @test find the Segment covering a time point */
+      void
+      lookupSegment()
+        {
+          MockSegmentation segmentation;
+          CHECK (1 == segmentation.size());
+          CHECK (Time::ANYTIME == segmentation[Time::ANYTIME].start());
+          CHECK (Time::NEVER   == segmentation[Time(0,1000)].after());
+          
+          segmentation.splitSplice (Time{0,10}, Time{0,20});
+          CHECK (3 == segmentation.size());
+          CHECK (Time(0,10) == segmentation[Time(0,10)].start());
+          CHECK (Time(0,10) == segmentation[Time(0,15)].start());
+          CHECK (Time(0,20) == segmentation[Time(0,20)].start());
+          CHECK (Time::ANYTIME == segmentation[Time(0,5)].start());
+          CHECK (Time::ANYTIME == segmentation[justBefore(Time(0,10))].start());
+          
+          segmentation.splitSplice (Time{0,12}, Time{0,15});           // split the middle Segment
+          CHECK (5 == segmentation.size());
+          CHECK (Time(0,10) == segmentation[Time(0,11)].start());
+          CHECK (Time(0,12) == segmentation[Time(0,14)].start());
+          CHECK (Time(0,15) == segmentation[Time(0,15)].start());
+          CHECK (Time(0,20) == segmentation[Time(0,15)].after());
+          
+          segmentation.splitSplice (Time{0,8}, Time{0,25});            // supersede all of them
+          CHECK (3 == segmentation.size());
+          CHECK (Time(0,8) == segmentation[Time(0,12)].start());
+          CHECK (Time(0,25) == segmentation[Time(0,12)].after());
+          CHECK (isConsistent (segmentation));
+        }
+      
+      
+      /** @test the index remains consistent on arbitrary changes */
+      void
+      verifyConsistency()
+        {
+          MockSegmentation segmentation;
+          for (uint i=0; i < 500; ++i)
+            {
+              int a = rani(1000),
+                  b = rani(1000);
+              if (a == b) continue;
+              switch (rani(4))
+                {
+                case 0:  segmentation.splitSplice (Time{a,0}, std::nullopt); break;
+                case 1:  segmentation.splitSplice (std::nullopt, Time{b,0}); break;
+                default: segmentation.splitSplice (Time{std::min(a,b),0}, Time{std::max(a,b),0});
+                }
+              CHECK (isConsistent (segmentation));
+            }
+          CHECK (1 < segmentation.size());
+        }
+      
+      
+      /** @test step through the Segmentation in ascending order of time */
+      void
+      cursorStepping()
+        {
+          MockSegmentation segmentation;
+          splitRegular (segmentation, 100);
+          CHECK (102 == segmentation.size());                            // plus empty Segments before and after
+          
+          auto cursor = segmentation.cursor();
+          for (uint n=0; n < 100*10; ++n)                                // 10 frames per Segment
+            {
+              Time frame{4*n, 0};
+              CHECK (isSameObject (cursor[frame], segmentation[frame]));
+            }
+          CHECK (0 == cursor.cntSearch());                               // resolved by stepping ahead
+          
+          CHECK (segStart(5) == cursor[segStart(5)].start());           // jump back
+          CHECK (1 == cursor.cntSearch());
+          CHECK (segStart(80) == cursor[segStart(80)].start());         // jump far ahead
+          CHECK (2 == cursor.cntSearch());
+          CHECK (segStart(81) == cursor[segStart(81)].start());
+          CHECK (2 == cursor.cntSearch());
+          
+          segmentation.splitSplice (segStart(81), segStart(90));         // change invalidates the current position
+          CHECK (segStart(90) == cursor[segStart(85)].after());
+          CHECK (3 == cursor.cntSearch());
+          CHECK (segStart(90) == cursor[segStart(90)].start());
+          CHECK (3 == cursor.cntSearch());
+        }
+      
+      
+      /** @test compare the lookup cost for a Segmentation with 10k Segments:
+       *        linear search through the list of Segments, binary search in
+       *        the index, and the Cursor for a sequence of frames in playback.
+       */
+      void
+      benchmark_10kSegments()
+        {
+          const uint SEGMENTS = 10000;
+          const uint FRAMES = 2*SEGMENTS;
+          
+          MockSegmentation segmentation;
+          double timeBuild = benchmarkTime ([&]{ splitRegular (segmentation, SEGMENTS); }, SEGMENTS);
+          CHECK (SEGMENTS+2 == segmentation.size());
+          CHECK (isConsistent (segmentation));
+          
+          std::vector<Time> frames;
+          for (uint n=0; n < FRAMES; ++n)
+            frames.push_back (Time{20*n, 0});
+          
+          auto linearSearch = [&](Time time) -> Segment const&
+                                {
+                                  for (Segment const& seg : segmentation.eachSeg())
+                                    if (seg.after() > time)
+                                      return seg;
+                                  NOTREACHED ("cover-all Segmentation");
+                                };
+          size_t checksum{0};
+          auto cursor = segmentation.cursor();
+          double timeLinear = benchmarkTime ([&]{ for (Time& t : frames) checksum += _raw(linearSearch(t).start()); }, FRAMES);
+          double timeIndex  = benchmarkTime ([&]{ for (Time& t : frames) checksum += _raw(segmentation[t].start()); }, FRAMES);
+          double timeCursor = benchmarkTime ([&]{ for (Time& t : frames) checksum += _raw(cursor[t].start()); },       FRAMES);
+          CHECK (checksum != 0);
+          CHECK (0 == cursor.cntSearch());
+          
+          cout << _Fmt{"%d Segments: splitSplice %5.3fµs, lookup per frame: linear %5.3fµs  index %5.3fµs  cursor %5.3fµs"}
+                      % SEGMENTS % timeBuild % timeLinear % timeIndex % timeCursor
+               << endl;
+          CHECK (timeIndex < timeLinear);
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (SegmentationIndex_test, "unit fixture");
+  
+  
+  
+}}} // namespace steam::fixture::test
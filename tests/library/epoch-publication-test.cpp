@@ -0,0 +1,252 @@
+/*
+  EpochPublication(Test)  -  publish new versions concurrently to wait-free readers
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file epoch-publication-test.cpp
+ ** unit test \ref EpochPublication_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/epoch-publication.hpp"
+#include "lib/scoped-collection.hpp"
+#include "lib/thread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using test::Test;
+using std::make_unique;
+using std::atomic_bool;
+using std::atomic_int;
+using std::atomic_uint;
+
+
+namespace lib {
+namespace test {
+  
+  using LERR_(STATE);
+  
+  namespace { // test fixture...
+    
+    const uint NUM_THREADS = 8;
+    const uint NUM_VERSIONS = 2000;
+    
+    atomic_int cntVersions{0};
+    
+    /** a version of some data, which can be checked for consistency */
+    struct Version
+      {
+        uint num;
+        uint twice;
+        
+        Version (uint n)
+          : num{n}
+          , twice{2*n}
+          {
+            ++cntVersions;
+          }
+       
+       ~Version()
+          {
+            twice = 0;       // render inconsistent
+            --cntVersions;
+          }
+        
+        bool isValid()  const { return twice == 2*num; }
+      };
+  }
+  
+  
+  
+  /*****************************************************************//**
+   * @test verify the publication of new versions of a data structure,
+   *       while concurrent readers access the preceding version.
+   *       - a retired version is kept alive while readers access it
+   *       - a release function can retain retired versions further
+   *       - a writer can block until ongoing readers have left
+   *       - stress test with concurrent readers checking consistency
+   * @see lib::EpochPublication
+   * @see steam::fixture::FixtureSwitch
+   */
+  class EpochPublication_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          simpleUsage();
+          retainWhileRead();
+          retainByPredicate();
+          awaitReaders();
+          concurrentReaders();
+          CHECK (0 == cntVersions);
+        }
+      
+      
+      /** @test publish a new version and discard the previous one */
+      void
+      simpleUsage()
+        {
+          EpochPublication<Version> published;
+          CHECK (not published.access());
+          VERIFY_ERROR (STATE, *published.access());
+          
+          published.publish (make_unique<Version> (1));
+          CHECK (0 == published.cntRetired());
+          CHECK (1 == published.access()->num);
+          
+          published.publish (make_unique<Version> (2));
+          CHECK (2 == published.access()->num);
+          CHECK (1 == published.cntRetired());
+          CHECK (2 == cntVersions);
+          
+          CHECK (0 == published.reclaim());
+          CHECK (1 == cntVersions);
+        }
+      
+      
+      /** @test a retired version remains accessible for ongoing readers */
+      void
+      retainWhileRead()
+        {
+          EpochPublication<Version> published{make_unique<Version> (1)};
+          {
+            auto reader = published.access();
+            published.publish (make_unique<Version> (2));
+            CHECK (1 == reader->num);                              // ongoing reader still sees the previous version
+            CHECK (2 == published.access()->num);                  // nested access started later sees the new version
+            CHECK (1 == published.reclaim());                      // can not be discarded yet
+            CHECK (reader->isValid());
+          }
+          CHECK (0 == published.reclaim());
+          CHECK (1 == cntVersions);
+          
+          auto reader = published.access();                        // a reader started after publication
+          published.publish (make_unique<Version> (3));            // blocks reclaiming the version it accesses,
+          published.publish (make_unique<Version> (4));            // and thus also all later retired versions
+          CHECK (2 == published.reclaim());
+          CHECK (3 == cntVersions);
+        }
+      
+      
+      /** @test the release function may retain a retired version beyond the last reader */
+      void
+      retainByPredicate()
+        {
+          EpochPublication<Version> published{make_unique<Version> (1)};
+          published.publish (make_unique<Version> (2));
+          published.publish (make_unique<Version> (3));
+          CHECK (2 == published.cntRetired());
+          
+          uint released{0};
+          auto evenOnly = [&](Version& v){ ++released; return v.num % 2 == 0; };
+          CHECK (1 == published.reclaim (evenOnly));
+          CHECK (2 == released);                                   // asked for each version no longer read
+          CHECK (2 == cntVersions);
+          
+          CHECK (0 == published.reclaim());
+          CHECK (1 == cntVersions);
+        }
+      
+      
+      /** @test a writer can wait for all readers of the current epoch to leave */
+      void
+      awaitReaders()
+        {
+          EpochDomain domain;
+          domain.synchronise();                                    // returns immediately without readers
+          
+          atomic_bool entered{false};
+          atomic_bool left{false};
+          ThreadJoinable<> reader{"EpochDomain reader"
+                                 ,[&]{
+                                       EpochDomain::Guard guard{domain};
+                                       entered = true;
+                                       std::this_thread::sleep_for (std::chrono::milliseconds{20});
+                                       left = true;
+                                     }};
+          while (not entered)
+            std::this_thread::yield();
+          domain.synchronise();                                    // blocks while the reader is in its critical section
+          CHECK (left);
+          reader.join(); // @suppress("Return value not evaluated")
+        }
+      
+      
+      /** @test publish a sequence of versions, while several threads
+       *        read the current version concurrently and verify it is intact.
+       *        Retired versions are reclaimed as soon as possible, and a
+       *        destroyed version would be detected as inconsistent.
+       */
+      void
+      concurrentReaders()
+        {
+          EpochPublication<Version> published{make_unique<Version> (0)};
+          atomic_bool done{false};
+          atomic_uint cntStarted{0};
+          atomic_uint cntReads{0};
+          atomic_uint cntBroken{0};
+          
+          using Threads = lib::ScopedCollection<ThreadJoinable<>>;
+          Threads threads{NUM_THREADS,
+                          [&](Threads::ElementHolder& storage)
+                             {
+                               storage.create<ThreadJoinable<>> ("EpochPublication reader"
+                                                                ,[&]{
+                                                                      uint prev{0};
+                                                                      ++cntStarted;
+                                                                      while (not done)
+                                                                        {
+                                                                          auto version = published.access();
+                                                                          if (version->num < prev)         // versions appear in order
+                                                                            ++cntBroken;
+                                                                          prev = version->num;
+                                                                          std::this_thread::yield();
+                                                                          if (not version->isValid())      // still intact after a while
+                                                                            ++cntBroken;
+                                                                          ++cntReads;
+                                                                        }
+                                                                    });
+                             }
+                         };
+          
+          while (cntStarted < NUM_THREADS)
+            std::this_thread::yield();
+          for (uint n=1; n <= NUM_VERSIONS; ++n)
+            {
+              published.publish (make_unique<Version> (n));
+              published.reclaim();
+            }
+          done = true;
+          for (auto& thread : threads)
+            thread.join(); // block until thread terminates   // @suppress("Return value not evaluated")
+          
+          CHECK (0 == cntBroken);
+          CHECK (0 < cntReads);
+          CHECK (NUM_VERSIONS == published.access()->num);
+          CHECK (0 == published.reclaim());
+          CHECK (1 == cntVersions);
+        }
+    };
+  
+  
+  
+  /** Register this test class... */
+  LAUNCHER (EpochPublication_test, "function common");
+  
+  
+  
+}} // namespace lib::test
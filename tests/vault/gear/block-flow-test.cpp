@@ -22,7 +22,9 @@
 #include "lib/test/microbenchmark.hpp"
 #include "lib/time/timevalue.hpp"
 #include "lib/meta/function.hpp"
+#include "lib/scoped-collection.hpp"
 #include "lib/format-cout.hpp"
+#include "lib/thread.hpp"
 #include "lib/util.hpp"
 
 #include <chrono>
@@ -34,6 +36,7 @@ using util::isSameObject;
 using lib::test::randTime;
 using lib::test::showType;
 using lib::time::Offset;
+using lib::ThreadJoinable;
 
 using std::vector;
 using std::pair;
@@ -79,6 +82,7 @@ namespace test {
            simpleUsage();
            handleEpoch();
            placeActivity();
+           allocationWindows();
            adjustEpochs();
            announceLoad();
            storageFlow();
@@ -306,6 +310,96 @@ namespace test {
       
       
       
+      /** @test allocate from thread-local windows
+       *        - each thread claims a run of slots from the Epoch at once
+       *        - subsequent allocations are placed consecutively into this window
+       *        - a thread can use windows from several Epochs in parallel
+       *        - all windows are invalidated when Epochs are discarded
+       *        - several threads can allocate concurrently into the same Epoch
+       */
+      void
+      allocationWindows()
+        {
+          using RenderFlow = gear::BlockFlow<blockFlow::RenderConfig>;
+          const size_t WINDOW = blockFlow::RenderConfig::ALLOC_WINDOW;
+          CHECK (1 < WINDOW);
+          
+          RenderFlow bFlow;
+          Time t1{0,10};
+          Time t2{0,20};
+          Activity& a1 = bFlow.until(t1).create();
+          Activity& a2 = bFlow.until(t1).create();
+          CHECK (&a2 == &a1 - 1);                              // placed consecutively (downwards) into the window
+          CHECK (2 == watch(bFlow).cntElm());                  // slots claimed but not yet used are not counted
+          CHECK (1 == watch(bFlow).cntThreads());
+          CHECK (2 == watch(bFlow).localUsed());
+          CHECK (watch(bFlow).threadFill()[0] == 2.0/WINDOW);
+          
+          // a second window for another Epoch
+          Activity& a3 = bFlow.until(t2).create();
+          CHECK (watch(bFlow).find(a3) > watch(bFlow).find(a1));
+          CHECK (3 == watch(bFlow).cntElm());
+          CHECK (watch(bFlow).threadFill()[0] == 3.0/(2*WINDOW));
+          
+          // exhaust the first window => claim the next run of slots
+          auto handle = bFlow.until(t1);
+          for (uint i=2; i < WINDOW; ++i)
+            handle.create();
+          Activity& a4 = handle.create();
+          CHECK (&a4 == &a1 - WINDOW);
+          CHECK (WINDOW+2 == watch(bFlow).cntElm());
+          
+          // discarding Epochs invalidates all windows, since storage will be re-used
+          bFlow.discardBefore (t1 + Time{0,1});
+          CHECK (watch(bFlow).first() > t1);
+          Activity& a5 = bFlow.until(t2).create();
+          CHECK (&a5 == &a3 - WINDOW);                         // can not use the remainder of the existing window
+          CHECK (2 + WINDOW-1 == watch(bFlow).cntElm());       // ...which now counts as filled
+          
+          // new Epoch placed into recycled storage
+          Activity& a6 = bFlow.until(Time{0,30}).create();
+          CHECK (watch(bFlow).find(a6) >= Time(0,30));
+          CHECK (2 + WINDOW-1 + 1 == watch(bFlow).cntElm());
+          
+          
+          // several threads allocating concurrently into the same Epoch
+          const uint THREADS = 4;
+          const uint CNT = 100;
+          RenderFlow flow;
+          Time deadline{0,5};
+          flow.until(deadline);                                // establish the Epoch beforehand
+          
+          vector<vector<Activity*>> allocated{THREADS};
+          auto planning = [&](size_t i)
+                            {
+                              for (size_t n=0; n < CNT; ++n)
+                                allocated[i].push_back (& flow.until(deadline).create (i, n));
+                            };
+          {
+            lib::ScopedCollection<ThreadJoinable<>> planners{THREADS};
+            for (uint i=0; i < THREADS; ++i)
+              planners.emplace ("BlockFlow_test: planner", planning, size_t(i));
+            for (auto& planner : planners)
+              planner.join();
+          }
+          CHECK (1 == watch(flow).cntEpochs());
+          CHECK (THREADS*CNT == watch(flow).cntElm());
+          CHECK (THREADS == watch(flow).cntThreads());
+          CHECK (0 == watch(flow).localUsed());
+          for (double fill : watch(flow).threadFill())
+            CHECK (fill > 0.9);
+          // each Activity was placed into a separate slot and retains its data
+          for (size_t i=0; i < THREADS; ++i)
+            for (size_t n=0; n < CNT; ++n)
+              {
+                Activity& act = *allocated[i][n];
+                CHECK (act.data_.feed.one == i);
+                CHECK (act.data_.feed.two == n);
+              }
+        }
+      
+      
+      
       /** @test load based regulation of Epoch spacing
        *        - on overflow, capacity is boosted by a fixed factor
        *        - on clean-up, a moving average of (in hindsight) optimal length
@@ -538,6 +632,38 @@ namespace test {
                               sum4 = runTest (allocate, invoke);
                             };
           
+          /* =========== Test-Setup-5: BlockFlow with Extents allocated from heap ========== */
+          
+          struct HeapRenderConfig
+            : blockFlow::RenderConfig
+            {
+              const mem::ExtentPolicy EXTENT_POLICY{};
+            };
+          size_t sum5{0};
+          gear::BlockFlow<HeapRenderConfig> heapBlockFlow;
+          auto heapBlockFlowAlloc = [&]{
+                              auto allocHandle = heapBlockFlow.until(Time{BASE_DEADLINE});
+                              auto allocate = [&, j=0](Time t, size_t check) mutable -> Activity&
+                                                  {
+                                                    if (++j >= 10)
+                                                      {
+                                                        allocHandle = heapBlockFlow.until(t);
+                                                        j = 0;
+                                                      }
+                                                    return allocHandle.create (check, size_t{55});
+                                                  };
+                              auto invoke   = [&, i=0](Activity& feedActivity) mutable
+                                                  {
+                                                    size_t check = feedActivity.data_.feed.one;
+                                                    if (i % CLEAN_UP == 0)
+                                                      heapBlockFlow.discardBefore (Time{TimeValue{i*STP}});
+                                                    ++i;
+                                                    return check;
+                                                  };
+                              
+                              sum5 = runTest (allocate, invoke);
+                            };
+          
           // INVOKE Setup-1
           auto time_noAlloc = benchmark(noAlloc);
           
@@ -552,6 +678,9 @@ namespace test {
           // INVOKE Setup-4
           auto time_blockFlow = benchmark(blockFlowAlloc);
           
+          // INVOKE Setup-5
+          auto time_heapBlockFlow = benchmark(heapBlockFlowAlloc);
+          
           Duration expectStep{FSecs{blockFlow.framesPerEpoch(), FPS} * 9/10};
           
           cout<<"\n___Microbenchmark____"
@@ -559,6 +688,7 @@ namespace test {
               <<"\nheapAlloc   : "<<time_heapAlloc
               <<"\nsharedAlloc : "<<time_sharedAlloc
               <<"\nblockFlow   : "<<time_blockFlow
+              <<"\n  (heap)    : "<<time_heapBlockFlow
               <<"\n_____________________\n"
               <<"\ninstances.... "<<INSTANCES
               <<"\nfps.......... "<<FPS
@@ -567,6 +697,7 @@ namespace test {
               <<"\nEpoch  (real) "<<blockFlow.getEpochStep()
               <<"\ncnt Epochs... "<<watch(blockFlow).cntEpochs()
               <<"\nalloc pool... "<<watch(blockFlow).poolSize()
+              <<"\nreserved.... "<<watch(blockFlow).reserved()
               <<endl;
           
           // all Activities have been read in all test cases,
@@ -574,6 +705,11 @@ namespace test {
           CHECK (sum1 == sum2);
           CHECK (sum1 == sum3);
           CHECK (sum1 == sum4);
+          CHECK (sum1 == sum5);
+          
+          // RenderConfig carves all Extents from a reserved address range
+          CHECK (watch(blockFlow).reserved() >= watch(blockFlow).poolSize() * sizeof(Activity) * blockFlow::RenderConfig::EPOCH_SIZ);
+          CHECK (watch(heapBlockFlow).reserved() == 0);
           
           // Epoch spacing regulation must be converge up to ±10ms
           CHECK (expectStep - blockFlow.getEpochStep() < Time(10,0));
@@ -0,0 +1,314 @@
+/*
+  EngineObserver(Test)  -  verify asynchronous collection of engine performance data
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file engine-observer-test.cpp
+ ** unit test \ref EngineObserver_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "vault/gear/engine-observer.hpp"
+#include "lib/scoped-collection.hpp"
+#include "lib/format-string.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/thread.hpp"
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+using test::Test;
+
+
+namespace vault{
+namespace gear {
+namespace test {
+  
+  using util::_Fmt;
+  using lib::ThreadJoinable;
+  using lib::test::threadBenchmark;
+  using observer::Histogram;
+  using std::this_thread::sleep_for;
+  using std::chrono::milliseconds;
+  
+  namespace {
+    const size_t REPETITIONS = 100000;
+    
+    ManifestationID manA{5};
+    ManifestationID manB{23};
+    
+    Time
+    at (int64_t micros)
+    {
+      return Time{TimeValue{micros}};
+    }
+  }
+  
+  
+  
+  
+  /*************************************************************************//**
+   * @test Render Engine performance data collection.
+   *       - events are passed through a ring buffer per emitting thread
+   *       - aggregation into histograms per Manifestation, asynchronously
+   *       - subscribers receive aggregated snapshots
+   *       - dispatching an event does not block
+   * @see engine-observer.hpp
+   * @see Scheduler::ExecutionCtx::work()
+   */
+  class EngineObserver_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+           simpleUsage();
+           verify_pairing();
+           verify_histogram();
+           verify_overflow();
+           verify_subscriber();
+           verify_concurrentEmitters();
+           benchmark_dispatch();
+        }
+      
+      
+      /** @test work timing events are aggregated per Manifestation
+       *      - queue latency: actual start relative to scheduled start
+       *      - work time: from WORKSTART to WORKSTOP with the same qualifier
+       *      - missed: WORKSTOP after deadline
+       */
+      void
+      simpleUsage()
+        {
+          EngineObserver watch;
+          watch.dispatchEvent (0, WorkTiming::start (at(110), at(100), manA));
+          watch.dispatchEvent (0, WorkTiming::stop  (at(150), at(200), manA));
+          watch.dispatchEvent (0, WorkTiming::start (at(210), at(200), manB));
+          watch.dispatchEvent (0, WorkTiming::stop  (at(500), at(400), manB));
+          watch.dispatchEvent (0, WorkTiming::start (at(600), at(200), manA));
+          watch.dispatchEvent (0, WorkTiming::stop  (at(700)));
+          
+          auto snapshot = watch.snapshot();
+          CHECK (6 == snapshot.events);
+          CHECK (0 == snapshot.dropped);
+          
+          auto& statA = snapshot[manA];
+          CHECK (2 == statA.queueLatency.cnt);
+          CHECK (10+400 == statA.queueLatency.sum);
+          CHECK (400 == statA.queueLatency.max);
+          CHECK (1 == statA.workTime.cnt);
+          CHECK (40 == statA.workTime.sum);
+          CHECK (0 == statA.missed);
+          
+          auto& statB = snapshot[manB];
+          CHECK (1 == statB.queueLatency.cnt);
+          CHECK (1 == statB.workTime.cnt);
+          CHECK (290 == statB.workTime.sum);
+          CHECK (1 == statB.missed);
+          
+          // the final stop event was emitted without Manifestation and deadline
+          auto& statNone = snapshot[ManifestationID()];
+          CHECK (0 == statNone.queueLatency.cnt);
+          CHECK (1 == statNone.workTime.cnt);
+          CHECK (100 == statNone.workTime.sum);
+          CHECK (0 == statNone.missed);
+          
+          CHECK (0 == snapshot[ManifestationID{99}].workTime.cnt);
+          CHECK (1 == watch.ringCnt());
+        }
+      
+      
+      /** @test start and stop are paired by qualifier, irrespective of the emitting thread
+       *      - a stop without preceding start is counted as unmatched
+       *      - a stop emitted by another thread is paired with its start
+       *      - a stop drained before its start is retained until the start arrives
+       */
+      void
+      verify_pairing()
+        {
+          EngineObserver watch;
+          watch.dispatchEvent (1, WorkTiming::stop  (at(100), Time::NEVER, manA));
+          watch.dispatchEvent (2, WorkTiming::start (at(200), at(200), manA));
+          ThreadJoinable completion{"EngineObserver_test: completion"
+                                   ,[&]{
+                                         watch.dispatchEvent (2, WorkTiming::stop (at(250), Time::NEVER, manA));
+                                       }};
+          completion.join();
+          auto snapshot = watch.snapshot();
+          CHECK (1 == snapshot[manA].workTime.cnt);
+          CHECK (50 == snapshot[manA].workTime.sum);
+          
+          // stop of the earlier stray event is superseded and thus counted unmatched
+          watch.dispatchEvent (1, WorkTiming::stop  (at(20'000'000), Time::NEVER, manB));
+          snapshot = watch.snapshot();
+          CHECK (1 == snapshot.unmatched);
+          CHECK (0 == snapshot[manB].workTime.cnt);
+          
+          // a start with same qualifier drained later still pairs with this stop
+          watch.dispatchEvent (1, WorkTiming::start (at(19'999'000), Time::ANYTIME, manB));
+          snapshot = watch.snapshot();
+          CHECK (1 == snapshot.unmatched);
+          CHECK (1 == snapshot[manB].workTime.cnt);
+          CHECK (1000 == snapshot[manB].workTime.sum);
+        }
+      
+      
+      /** @test logarithmic histogram of durations in µs */
+      void
+      verify_histogram()
+        {
+          CHECK ( 0 == Histogram::binOf (-5));
+          CHECK ( 0 == Histogram::binOf (0));
+          CHECK ( 1 == Histogram::binOf (1));
+          CHECK ( 2 == Histogram::binOf (2));
+          CHECK ( 2 == Histogram::binOf (3));
+          CHECK ( 3 == Histogram::binOf (4));
+          CHECK (10 == Histogram::binOf (1000));
+          CHECK (observer::HISTOGRAM_BINS-1 == Histogram::binOf (int64_t(1) << 40));
+          
+          Histogram hist;
+          CHECK (0.0 == hist.average());
+          for (uint i=0; i < 90; ++i)
+            hist.add (10);
+          for (uint i=0; i < 10; ++i)
+            hist.add (1000);
+          CHECK (100 == hist.cnt);
+          CHECK (90 == hist.bins[4]);
+          CHECK (10 == hist.bins[10]);
+          CHECK (109.0 == hist.average());
+          CHECK (1000 == hist.max);
+          CHECK (  16 == hist.percentile (0.5));
+          CHECK (1024 == hist.percentile (0.95));
+          CHECK (1024 == hist.percentile (1.0));
+        }
+      
+      
+      /** @test events beyond the capacity of a buffer are dropped and counted */
+      void
+      verify_overflow()
+        {
+          EngineObserver watch;
+          watch.flush();
+          ThreadJoinable emitter{"EngineObserver_test: emitter"
+                                ,[&]{
+                                      for (uint i=0; i < 2*observer::RING_CAPACITY; ++i)
+                                        watch.dispatchEvent (0, WorkTiming::start (at(i)));
+                                    }};
+          emitter.join();
+          
+          auto snapshot = watch.snapshot();
+          CHECK (snapshot.events + snapshot.dropped == 2*observer::RING_CAPACITY);
+          CHECK (snapshot.events >= observer::RING_CAPACITY);
+          CHECK (0 == watch.ringCnt());          // buffer of terminated thread was discarded
+        }
+      
+      
+      /** @test subscribers are notified asynchronously with aggregated data */
+      void
+      verify_subscriber()
+        {
+          EngineObserver watch;
+          std::atomic<size_t> seen{0};
+          watch.subscribe ([&](EngineObserver::Snapshot const& snapshot)
+                              {
+                                seen = snapshot[manA].workTime.cnt;
+                              });
+          watch.dispatchEvent (0, WorkTiming::start (at(10), at(10), manA));
+          watch.dispatchEvent (0, WorkTiming::stop  (at(20), at(99), manA));
+          
+          for (uint i=0; i < 100 and not seen; ++i)
+            sleep_for (milliseconds(10));
+          CHECK (1 == seen);
+        }
+      
+      
+      /** @test several threads emit events concurrently;
+       *        all events are accounted for, and aggregated per thread
+       */
+      void
+      verify_concurrentEmitters()
+        {
+          const uint THREADS = 8;
+          const uint CNT = 5000;
+          EngineObserver watch;
+          auto emit = [&](size_t i) -> size_t
+                        {
+                          ManifestationID manID(i+1);
+                          for (uint n=0; n < CNT; ++n)
+                            {
+                              watch.dispatchEvent (i, WorkTiming::start (at(2*n),   at(2*n), manID));
+                              watch.dispatchEvent (i, WorkTiming::stop  (at(2*n+1), Time::NEVER, manID));
+                              if (0 == n % 20)
+                                sleep_for (milliseconds(1));   // allow the drainer to keep up
+                            }
+                          return 1;
+                        };
+          lib::ScopedCollection<ThreadJoinable<size_t>> emitters{THREADS};
+          for (uint i=0; i < THREADS; ++i)
+            emitters.emplace ("EngineObserver_test: emitter", emit, size_t(i));
+          for (auto& emitter : emitters)
+            emitter.join();
+          
+          auto snapshot = watch.snapshot();
+          CHECK (2*THREADS*CNT == snapshot.events + snapshot.dropped);
+          CHECK (0 == watch.ringCnt());
+          if (snapshot.dropped)
+            cout << "dropped events: "<<snapshot.dropped<<endl;
+          else
+            for (uint i=0; i < THREADS; ++i)
+              {
+                auto& stat = snapshot[ManifestationID(i+1)];
+                CHECK (CNT == stat.queueLatency.cnt);
+                CHECK (CNT == stat.workTime.cnt);
+                CHECK (CNT == stat.workTime.sum);      // each work time is 1µs
+              }
+        }
+      
+      
+      /** @test measure the time to dispatch an event from the workers
+       * @note  target is < 50ns per event; results depend on the platform,
+       *        and thus only a coarse upper limit is verified.
+       */
+      void
+      benchmark_dispatch()
+        {
+          EngineObserver watch;
+          std::atomic<size_t> emitters{0};
+          auto emit = [&](size_t i) -> size_t
+                        {
+                          thread_local size_t qualifier = REPETITIONS * emitters++;     // distinct for each thread
+                          watch.dispatchEvent (qualifier + i, WorkTiming::start (at(i), at(i), manA));
+                          return 1;
+                        };
+          auto [micros1, cnt1] = threadBenchmark<1> (emit, REPETITIONS);
+          auto [micros8, cnt8] = threadBenchmark<8> (emit, REPETITIONS);
+          cout << _Fmt{"dispatch event: %5.1fns (1 thread)  %5.1fns (8 threads)"}
+                      % (micros1*1000) % (micros8*1000)
+               << endl;
+          CHECK (cnt1 == REPETITIONS);
+          CHECK (cnt8 == 8*REPETITIONS);
+          CHECK (micros1 < 1.0);
+          
+          auto snapshot = watch.snapshot();
+          CHECK (snapshot.events + snapshot.dropped == 9*REPETITIONS);
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (EngineObserver_test, "unit engine");
+  
+  
+  
+}}} // namespace vault::gear::test
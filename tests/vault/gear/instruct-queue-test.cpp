@@ -0,0 +1,323 @@
+/*
+  InstructQueue(Test)  -  verify the lock-free entrance queue of the scheduler
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file instruct-queue-test.cpp
+ ** unit test \ref InstructQueue_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/microbenchmark.hpp"
+#include "vault/gear/instruct-queue.hpp"
+#include "vault/gear/scheduler-invocation.hpp"
+#include "vault/gear/activity-lang.hpp"
+#include "lib/scoped-collection.hpp"
+#include "lib/format-string.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/thread.hpp"
+#include "lib/util.hpp"
+
+#include <boost/lockfree/queue.hpp>
+#include <thread>
+#include <vector>
+
+using test::Test;
+
+
+namespace vault{
+namespace gear {
+namespace test {
+  
+  using util::_Fmt;
+  using lib::ThreadJoinable;
+  using lib::test::threadBenchmark;
+  using std::this_thread::yield;
+  using std::vector;
+  using std::atomic_bool;
+  using LERR_(FATAL);
+  
+  namespace {
+    const size_t CAPACITY    = 4096;
+    const size_t REPETITIONS = 20000;
+    
+    Activity dummy;
+    
+    ActivationEvent
+    event (int64_t start)
+    {
+      return ActivationEvent{dummy, Time{TimeValue{start}}};
+    }
+    
+    /** Adapter: entrance based on the new ring buffer */
+    struct RingEntrance
+      {
+        InstructQueue<ActivationEvent> queue{CAPACITY};
+        
+        bool push (ActivationEvent const& evt) { return queue.push (evt); }
+        
+        template<class FUN>
+        size_t drain (FUN fun) { return queue.drain (fun); }
+      };
+    
+    /** Adapter: entrance as used previously by Layer-1 */
+    struct BoostEntrance
+      {
+        boost::lockfree::queue<ActivationEvent> queue{128};
+        
+        bool push (ActivationEvent const& evt) { return queue.push (evt); }
+        
+        template<class FUN>
+        size_t drain (FUN fun) { return queue.consume_all (fun); }
+      };
+  }
+  
+  
+  
+  
+  /*************************************************************************//**
+   * @test Scheduler entrance: bounded lock-free MPSC queue to pass new
+   *       ActivationEvents into Layer-1, allocation free after construction.
+   *       - basic properties and batch enqueue
+   *       - overflow handling and integration into Layer-1
+   *       - concurrent producers observed by a single consumer
+   *       - throughput compared to `boost::lockfree::queue`
+   * @see SchedulerInvocation_test
+   * @see SchedulerCommutator_test
+   */
+  class InstructQueue_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+           simpleUsage();
+           verify_batch();
+           verify_overflow();
+           verify_concurrentProducers();
+           benchmark_producers();
+        }
+      
+      
+      /** @test enqueue and retrieve elements in FIFO order,
+       *        wrapping around the ring storage repeatedly
+       */
+      void
+      simpleUsage()
+        {
+          InstructQueue<ActivationEvent> queue{5};
+          CHECK (8 == queue.capacity());
+          CHECK (queue.empty());
+          
+          CHECK (queue.push (event(1)));
+          CHECK (queue.push (event(2)));
+          CHECK (not queue.empty());
+          
+          ActivationEvent evt;
+          CHECK (queue.pop (evt));
+          CHECK (1 == evt.starting);
+          CHECK (queue.pop (evt));
+          CHECK (2 == evt.starting);
+          CHECK (not queue.pop (evt));
+          CHECK (queue.empty());
+          
+          int64_t expect{0}, next{0};
+          for (uint round=0; round < 10; ++round)
+            {
+              while (queue.push (event (next)))
+                ++next;
+              CHECK (next == int64_t((round+1) * 8));
+              size_t cnt = queue.drain ([&](ActivationEvent& e)
+                                          {
+                                            CHECK (e.starting == expect);
+                                            ++expect;
+                                          });
+              CHECK (8 == cnt);
+            }
+          CHECK (queue.empty());
+        }
+      
+      
+      /** @test a batch of elements is enqueued altogether or not at all;
+       *        the consumer may retrieve only part of the published elements
+       */
+      void
+      verify_batch()
+        {
+          InstructQueue<ActivationEvent> queue{8};
+          vector<ActivationEvent> batch;
+          for (uint i=0; i < 5; ++i)
+            batch.push_back (event (10+i));
+          
+          CHECK (queue.push (batch.data(), batch.size()));
+          CHECK (not queue.push (batch.data(), batch.size()));   // only 3 slots left
+          CHECK (queue.push (batch.data(), 3));
+          CHECK (not queue.push (event(99)));
+          
+          int64_t sum{0};
+          auto summing = [&](ActivationEvent& e){ sum += e.starting; };
+          CHECK (2 == queue.drain (summing, 2));
+          CHECK (21 == sum);
+          CHECK (queue.push (batch.data(), 2));
+          CHECK (8 == queue.drain (summing));
+          CHECK (21 + (12+13+14) + (10+11+12) + (10+11) == sum);
+          CHECK (queue.empty());
+        }
+      
+      
+      /** @test Layer-1 draws the entrance capacity from configuration
+       *        and fails fatally when this capacity is exhausted.
+       */
+      void
+      verify_overflow()
+        {
+          BlockFlowAlloc bFlow;
+          CHECK (4096 == SchedulerInvocation{bFlow.entranceCapacity()}.entranceCapacity());
+          
+          SchedulerInvocation sched{16};
+          CHECK (16 == sched.entranceCapacity());
+          
+          Activity act;
+          vector<ActivationEvent> batch (10, ActivationEvent{act, Time{5,5}});
+          sched.instruct (batch.data(), batch.size());
+          CHECK (sched.hasPendingInput());
+          VERIFY_ERROR (FATAL, sched.instruct (batch.data(), batch.size()) );
+          for (uint i=0; i < 6; ++i)
+            sched.instruct ({act, Time{5,5}});
+          VERIFY_ERROR (FATAL, sched.instruct ({act, Time{5,5}}) );
+          
+          CHECK (16 == sched.feedPrioritisation());
+          CHECK (not sched.hasPendingInput());
+          sched.instruct (batch.data(), batch.size());
+          CHECK (10 == sched.feedPrioritisation());
+          
+          sched.discardSchedule();
+          CHECK (sched.empty());
+        }
+      
+      
+      /** @test several producers enqueue concurrently, while the consumer
+       *        drains continuously; each producer's elements arrive in order
+       */
+      void
+      verify_concurrentProducers()
+        {
+          const uint PRODUCERS = 8;
+          const int64_t CNT = 10000;
+          InstructQueue<ActivationEvent> queue{64};
+          
+          vector<int64_t> seen(PRODUCERS, -1);
+          bool ordered{true};
+          size_t received{0};
+          auto consume = [&](ActivationEvent& e)
+                            {
+                              uint producer = e.starting % PRODUCERS;
+                              int64_t seq = e.starting / PRODUCERS;
+                              ordered &= (seq == seen[producer] + 1);
+                              seen[producer] = seq;
+                              ++received;
+                            };
+          auto produce = [&](size_t i) -> size_t
+                            {
+                              for (int64_t seq=0; seq < CNT; ++seq)
+                                while (not queue.push (event (seq*PRODUCERS + i)))
+                                  yield();
+                              return 1;
+                            };
+          ThreadJoinable consumer{"InstructQueue_test: consumer"
+                                 ,[&]{
+                                       while (received < PRODUCERS*CNT)
+                                         if (not queue.drain (consume))
+                                           yield();
+                                     }};
+          
+          // each of the producer threads invokes produce(i) with i ∈ [0..PRODUCERS)
+          lib::ScopedCollection<ThreadJoinable<size_t>> producers{PRODUCERS};
+          for (uint i=0; i < PRODUCERS; ++i)
+            producers.emplace ("InstructQueue_test: producer", produce, size_t(i));
+          for (auto& producer : producers)
+            producer.join();
+          consumer.join();
+          
+          CHECK (ordered);
+          CHECK (received == PRODUCERS*CNT);
+          CHECK (queue.empty());
+        }
+      
+      
+      /** @internal measure time per push with the given number of producer
+       *            threads, while a consumer thread continuously drains the queue.
+       */
+      template<size_t PRODUCERS, class ENT>
+      double
+      measureEntrance()
+        {
+          ENT entrance;
+          atomic_bool done{false};
+          size_t consumed{0};
+          auto summing = [&](ActivationEvent& e){ consumed += e.starting; };
+          ThreadJoinable consumer{"InstructQueue_test: consumer"
+                                 ,[&]{
+                                       while (not done)
+                                         if (not entrance.drain (summing))
+                                           yield();
+                                       entrance.drain (summing);
+                                     }};
+          auto produce = [&](size_t i) -> size_t
+                            {
+                              ActivationEvent evt = event (i+1);
+                              while (not entrance.push (evt))
+                                yield();
+                              return i+1;
+                            };
+          auto [micros, checksum] = threadBenchmark<PRODUCERS> (produce, REPETITIONS);
+          done = true;
+          consumer.join();
+          CHECK (consumed == checksum);
+          return micros;
+        }
+      
+      template<size_t PRODUCERS>
+      void
+      compareEntrance()
+        {
+          double ring  = measureEntrance<PRODUCERS, RingEntrance>();
+          double boost = measureEntrance<PRODUCERS, BoostEntrance>();
+          cout << _Fmt{"Entrance with %2d producers: ring-buffer %6.3fµs  boost::lockfree %6.3fµs  per push"}
+                      % PRODUCERS % ring % boost
+               << endl;
+        }
+      
+      
+      /** @test microbenchmark to compare the ring buffer against the
+       *        previously used `boost::lockfree::queue`, with 1, 8 and
+       *        64 producer threads and one consumer.
+       * @note  results depend heavily on the number of cores available;
+       *        thus only printed, not verified.
+       */
+      void
+      benchmark_producers()
+        {
+          compareEntrance<1>();
+          compareEntrance<8>();
+          compareEntrance<64>();
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (InstructQueue_test, "unit engine");
+  
+  
+  
+}}} // namespace vault::gear::test
@@ -0,0 +1,217 @@
+/*
+  SchedulerAsyncIO(Test)  -  IO jobs completed asynchronously, without blocking a worker
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file scheduler-async-io-test.cpp
+ ** unit test \ref SchedulerAsyncIO_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "test-chain-load.hpp"
+#include "vault/gear/scheduler.hpp"
+#include "vault/gear/async-job.hpp"
+#include "vault/gear/nop-job-functor.hpp"
+#include "vault/gear/special-job-fun.hpp"
+#include "lib/test/transiently.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/util.hpp"
+
+#include <atomic>
+#include <thread>
+
+using test::Test;
+
+
+namespace vault{
+namespace gear {
+namespace test {
+  
+  using std::this_thread::sleep_for;
+  using std::chrono_literals::operator ""ms;
+  using std::chrono_literals::operator ""us;
+  using LERR_(LOGIC);
+  
+  namespace { // Test fixture
+    
+    const uint WAIT_LIMIT = 500;            ///< give up waiting after 5 sec
+    
+    /** IO job closure which just captures the completion, to be invoked by the test */
+    class CapturedIO
+      : public NopJobFunctor
+      , public AsyncJob
+    {
+    public:
+      IoCompletion completion;
+      std::atomic_uint invoked{0};
+      
+      JobKind getJobKind()  const override { return LOAD_JOB; }
+      void invokeJobOperation (JobParameter)  override { ++invoked; }
+      
+      void
+      attachCompletion (InvocationInstanceID, IoCompletion token)  override
+        {
+          completion = token;
+        }
+    };
+    
+    template<class CNT>
+    void
+    waitFor (CNT const& cnt, uint expected)
+    {
+      for (uint i=0; i < WAIT_LIMIT and cnt < expected; ++i)
+        sleep_for (10ms);
+    }
+  }
+  
+  
+  
+  /*************************************************************************//**
+   * @test a job of kind `LOAD_JOB` only initiates an IO operation and returns;
+   *       the jobs depending on the loaded data are dispatched by the Scheduler
+   *       only after the completion was signalled from the IO subsystem.
+   * @see async-job.hpp
+   * @see vault::io::AsyncIO
+   * @see MediaRead_test
+   */
+  class SchedulerAsyncIO_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          completeFromForeignThread();
+          rejectPlainLoadJob();
+          ioBoundChainLoad();
+        }
+      
+      
+      /** @test the dependent job is released when the completion is invoked
+       *        from another thread, while the IO job returned immediately */
+      void
+      completeFromForeignThread()
+        {
+          BlockFlowAlloc bFlow;
+          EngineObserver watch;
+          Scheduler scheduler{bFlow, watch};
+          
+          CapturedIO io;
+          std::atomic_uint rendered{0};
+          SpecialJobFun renderFun{[&](JobParameter){ ++rendered; }};
+          
+          auto load = scheduler.defineSchedule(Job{io, InvocationInstanceID(), Time::ANYTIME})
+                               .startOffset(200us)
+                               .lifeWindow(2000ms);
+          auto render = scheduler.defineSchedule(Job{renderFun, InvocationInstanceID(), Time::ANYTIME})
+                                 .startOffset(200us)
+                                 .lifeWindow(2000ms);
+          load.linkToSuccessor (render);
+          CHECK (io.completion);                                     // token was attached when building the schedule
+          load.post();
+          
+          waitFor (io.invoked, 1);
+          CHECK (1 == io.invoked);
+          sleep_for (20ms);
+          CHECK (0 == rendered);                                     // IO job has returned, yet the render job is still blocked
+          
+          std::thread device{[&]{ io.completion(); }};               // signal completion from the »IO subsystem«
+          device.join();
+          waitFor (rendered, 1);
+          CHECK (1 == rendered);
+        }
+      
+      
+      /** @test an IO job must implement the AsyncJob interface to receive completion */
+      void
+      rejectPlainLoadJob()
+        {
+          BlockFlowAlloc bFlow;
+          EngineObserver watch;
+          Scheduler scheduler{bFlow, watch};
+          
+          class PlainLoad : public NopJobFunctor
+            {
+              JobKind getJobKind()  const override { return LOAD_JOB; }
+            }
+            plain;
+          VERIFY_ERROR (LOGIC, scheduler.defineSchedule(Job{plain, InvocationInstanceID(), Time::ANYTIME})
+                                        .startOffset(200us)
+                                        .lifeWindow(20ms)
+                                        .post());
+        }
+      
+      
+      /** @test an IO-bound computation graph keeps the workers busy:
+       *      - 64 isolated nodes, each preceded by an IO job with 20ms latency
+       *      - with blocking reads, 4 workers would lose > 300ms waiting
+       *      - since the IO jobs return immediately, the reads are pending
+       *        concurrently and the calculations follow the completions;
+       *        compared to a reference run without IO, the overall time
+       *        increases only by roughly a single IO latency
+       */
+      void
+      ioBoundChainLoad()
+        {
+          TestChainLoad testLoad{64};
+          testLoad.configure_isolated_nodes()
+                  .buildTopology();
+          size_t expectedHash = testLoad.getHash();
+          
+          TRANSIENTLY(work::Config::COMPUTATION_CAPACITY) = 4;
+          auto IO_LATENCY = 20ms;
+          auto LOAD_BASE = 100us;
+          uint WORKERS = work::Config::COMPUTATION_CAPACITY;
+          double blockingPenalty = _uSec(IO_LATENCY) * testLoad.size() / WORKERS;
+          
+          BlockFlowAlloc bFlow;
+          EngineObserver watch;
+          Scheduler scheduler{bFlow, watch};
+          
+          size_t maxPendingIO{0};
+          auto performRun = [&](microseconds ioLatency)
+                              {
+                                auto testSetup =
+                                  testLoad.setupSchedule(scheduler)
+                                          .withLoadTimeBase(LOAD_BASE)
+                                          .withIOLatency(ioLatency)
+                                          .withJobDeadline(500ms)
+                                          .withUpfrontPlanning();
+                                double runTime = testSetup.launch_and_wait();
+                                maxPendingIO = testSetup.getMaxPendingIO();
+                                return runTime;
+                              };
+          
+          ComputationalLoad().maybeCalibrate();                     // not to distort the reference run
+          double refTime = performRun (0us);
+          CHECK (expectedHash == testLoad.getHash());
+          CHECK (0 == maxPendingIO);
+          
+          double runTime = performRun (IO_LATENCY);
+          CHECK (expectedHash == testLoad.getHash());               // all calculations performed after loading
+          
+          cout << _Fmt{"IO-bound graph: %5.1fms (without IO: %5.1fms, blocking penalty: ≥%5.1fms)  max pending IO: %d"}
+                      % (runTime/1000) % (refTime/1000) % (blockingPenalty/1000) % maxPendingIO
+               << endl;
+          
+          CHECK (maxPendingIO > WORKERS);                            // more reads in flight than workers available
+          CHECK (runTime - refTime < blockingPenalty / 2);
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (SchedulerAsyncIO_test, "unit engine");
+  
+  
+  
+}}} // namespace vault::gear::test
@@ -90,6 +90,7 @@ namespace test {
           verify_GroomingGuard();
           torture_GroomingToken();
           verify_findWork();
+          verify_batchDispatch();
           verify_Significance();
           verify_postChain();
           verify_dispatch();
@@ -275,6 +276,67 @@ namespace test {
       
       
       
+      /** @test verify batched dispatch: the holder of the Grooming-Token
+       *        dequeues further due entries and passes those into hand-off slots,
+       *        where they can be picked up without the token. Only chains which
+       *        can be dispatched outside of »grooming mode« are handed off.
+       */
+      void
+      verify_batchDispatch()
+        { MARK_TEST_FUN
+          
+          SchedulerInvocation queue;
+          SchedulerCommutator sched;
+          ___ensureGroomingTokenReleased(sched);
+          auto myself = std::this_thread::get_id();
+          
+          Time t1{10,0};
+          Time t2{20,0};
+          Time t3{30,0};
+          Time now{t3};
+          
+          Activity work{Activity::WORKSTART};
+          Activity gate{1};                                            // GATE still awaiting a notification
+          gate.next = &work;
+          Activity p1{t1, Time::NEVER, &work};                         // POST with open time window
+          Activity p2{t2, Time::NEVER, &work};
+          Activity p3{t3, Time::NEVER, &work};
+          Activity pg{t2, Time::NEVER, &gate};
+          Activity a1{1u,1u};
+          
+          queue.instruct ({p1, t1});
+          queue.instruct ({p2, t2});
+          queue.instruct ({p3, t3});
+          CHECK (isSameObject (p1, *sched.findWork (queue, now, 3)));  // retrieve head...
+          CHECK (sched.holdsGroomingToken (myself));
+          CHECK (queue.hasHandoffWork());                              // ...and hand off further due entries
+          CHECK (not queue.peekHead());
+          sched.dropGroomingToken();
+          
+          CHECK (isSameObject (p2, *sched.findWork (queue, now, 3)));  // picked up without Grooming-Token
+          CHECK (isSameObject (p3, *sched.findWork (queue, now, 3)));
+          CHECK (not sched.holdsGroomingToken (myself));
+          CHECK (queue.empty());
+          
+          queue.instruct ({p1, t1});
+          queue.instruct ({pg, t2});
+          queue.instruct ({a1, t3});
+          CHECK (isSameObject (p1, *sched.findWork (queue, now, 3)));
+          CHECK (not queue.hasHandoffWork());                          // gated chain requires grooming mode
+          CHECK (isSameObject (pg, *sched.findWork (queue, now, 3)));
+          CHECK (isSameObject (a1, *sched.findWork (queue, now, 3)));
+          CHECK (queue.empty());
+          
+          queue.instruct ({p1, t1});
+          queue.instruct ({p2, t2});
+          CHECK (isSameObject (p1, *sched.findWork (queue, now)));     // without batch, nothing is handed off
+          CHECK (not queue.hasHandoffWork());
+          CHECK (isSameObject (p2, *sched.findWork (queue, now)));
+          sched.dropGroomingToken();
+        }
+      
+      
+      
       /** @test verify logic of queue updates and work prioritisation.
        */
       void
@@ -411,6 +473,15 @@ namespace test {
           CHECK (isSameObject (a3, *queue.peekHead()));
           CHECK (isSameObject (a4, *sched.findWork(queue, t4)));
           CHECK (queue.empty());
+          
+          // in overload, regular entries lacking slack are shed early
+          Offset margin{Time{15,0}};
+          queue.instruct ({a1, t1, t3});
+          queue.instruct ({a2, t2, t3, ManifestationID(), true});
+          queue.instruct ({a4, t2, t4});
+          CHECK (isSameObject (a2, *sched.findWork(queue, t2, 1, margin)));  // compulsory entry is never shed
+          CHECK (isSameObject (a4, *sched.findWork(queue, t2, 1, margin)));  // a1 was shed (would end past deadline)
+          CHECK (queue.empty());
         }
       
       
@@ -486,6 +557,21 @@ namespace test {
           CHECK (    queue.isDue(future));
           CHECK (sched.findWork(queue, future));
           CHECK (    queue.empty());
+          
+          // when the bounded Instruct-Queue is full, the GroomingToken is acquired to drain it
+          sched.dropGroomingToken();
+          SchedulerInvocation tinyQueue{2};
+          CHECK (activity::PASS == sched.postChain (makeEvent(future), tinyQueue));
+          CHECK (activity::PASS == sched.postChain (makeEvent(future), tinyQueue));
+          CHECK (not tinyQueue.peekHead());
+          CHECK (activity::PASS == sched.postChain (makeEvent(now), tinyQueue));
+          CHECK (not sched.holdsGroomingToken (myself));    // token was dropped after draining
+          CHECK (not tinyQueue.hasPendingInput());
+          CHECK (now == tinyQueue.headTime());             //  all three events moved into the Priority-Queue
+          tinyQueue.pullHead();
+          tinyQueue.pullHead();
+          tinyQueue.pullHead();
+          CHECK (tinyQueue.empty());
         }
       
       
@@ -20,6 +20,8 @@
 #include "vault/gear/scheduler-invocation.hpp"
 #include "lib/util.hpp"
 
+#include <queue>
+
 using test::Test;
 using util::isSameObject;
 
@@ -42,12 +44,19 @@ namespace test {
       virtual void
       run (Arg)
         {
+           seedRand();
            simpleUsage();
            verify_Queuing();
            verify_WaterLevel();
            verify_Significance();
            verify_stability();
            verify_isDue();
+           verify_deadlineOrder();
+           verify_localRunQueues();
+           verify_numaGrouping();
+           verify_handoffSlots();
+           verify_calendarQueue();
+           verify_speculativeWork();
         }
       
       
@@ -273,6 +282,409 @@ namespace test {
           CHECK (not sched.isDue      (Time{4,0}));
           CHECK (sched.empty());
         }
+      
+      
+      
+      /** @test verify ordering of entries with the same start time,
+       *        and the priority lane for compulsory entries
+       *      - with equal start: earliest deadline first, then compulsory first
+       *      - compulsory entries, once due, take precedence over regular entries,
+       *        even if those were due earlier; otherwise time order is retained
+       *      - regular entries lacking slack can be detected for early shedding
+       */
+      void
+      verify_deadlineOrder()
+        {
+          SchedulerInvocation sched;
+          Activity a1{1u,1u};
+          Activity a2{2u,2u};
+          Activity a3{3u,3u};
+          ManifestationID noID;
+          bool compulsory{true};
+          
+          Time t{5,0};
+          sched.feedPrioritisation ({a1, t, Time{50,0}});
+          sched.feedPrioritisation ({a2, t, Time{10,0}});
+          sched.feedPrioritisation ({a3, t, Time{30,0}});
+          CHECK (isSameObject (*sched.pullHead(), a2));
+          CHECK (isSameObject (*sched.pullHead(), a3));
+          CHECK (isSameObject (*sched.pullHead(), a1));
+          
+          sched.feedPrioritisation ({a1, t, Time{10,0}});
+          sched.feedPrioritisation ({a2, t, Time{10,0}, noID, compulsory});
+          CHECK (isSameObject (*sched.pullHead(), a2));
+          CHECK (isSameObject (*sched.pullHead(), a1));
+          CHECK (sched.empty());
+          
+          // compulsory entries are served first, once due
+          CHECK (sched.hasCompulsoryLane());
+          sched.feedPrioritisation ({a1, Time{1,0}, Time{50,0}});
+          sched.feedPrioritisation ({a2, Time{2,0}, Time{50,0}});
+          sched.feedPrioritisation ({a3, Time{3,0}, Time{8,0}, noID, compulsory});
+          sched.advanceTo (Time{2,0});
+          CHECK (isSameObject (*sched.peekHead(), a1));
+          CHECK (Time(1,0) == sched.headTime());
+          sched.advanceTo (Time{4,0});
+          CHECK (isSameObject (*sched.peekHead(), a3));
+          CHECK (Time(1,0) == sched.headTime());          // headTime still reports earliest start
+          CHECK (sched.isDue (Time{4,0}));
+          CHECK (isSameObject (*sched.pullHead(), a3));
+          CHECK (isSameObject (*sched.pullHead(), a1));
+          CHECK (isSameObject (*sched.pullHead(), a2));
+          CHECK (sched.empty());
+          
+          // detect entries to shed early
+          sched.feedPrioritisation ({a1, Time{1,0}, Time{10,0}});
+          CHECK (not sched.lacksSlack (Time{5,0}, Offset{Time{2,0}}));
+          CHECK (    sched.lacksSlack (Time{9,0}, Offset{Time{2,0}}));
+          CHECK (not sched.isOutdated (Time{9,0}));
+          sched.pullHead();
+          sched.feedPrioritisation ({a3, Time{1,0}, Time{10,0}, noID, compulsory});
+          CHECK (not sched.lacksSlack (Time{9,0}, Offset{Time{2,0}}));   // compulsory entries are never shed
+          sched.pullHead();
+          
+          // without priority lane, strict time order applies
+          sched.useCompulsoryLane (false);
+          sched.feedPrioritisation ({a1, Time{1,0}, Time{50,0}});
+          sched.feedPrioritisation ({a2, Time{2,0}, Time{50,0}});
+          sched.feedPrioritisation ({a3, Time{3,0}, Time{8,0}, noID, compulsory});
+          sched.advanceTo (Time{4,0});
+          CHECK (isSameObject (*sched.pullHead(), a1));
+          CHECK (isSameObject (*sched.pullHead(), a2));
+          CHECK (isSameObject (*sched.pullHead(), a3));
+          CHECK (sched.empty());
+        }
+      
+      
+      
+      /** @test verify the optional work-stealing mode with local run queues
+       *      - entries at head can be relocated into some local queue,
+       *        distributed round-robin
+       *      - the current thread retrieves from its own queue first,
+       *        then steals from the other queues, ordered by start time
+       *      - headTime() and empty() take local work into account
+       *      - local work past deadline is discarded on retrieval
+       */
+      void
+      verify_localRunQueues()
+        {
+          SchedulerInvocation sched;
+          Activity a1{1u,1u};
+          Activity a2{2u,2u};
+          Activity a3{3u,3u};
+          
+          CHECK (not sched.hasLocalQueues());
+          sched.useLocalQueues (2);
+          CHECK (sched.hasLocalQueues());
+          CHECK (2 == sched.localQueueSlots());
+          CHECK (not sched.hasLocalWork());
+          
+          sched.feedPrioritisation ({a1, Time{0,1}, Time{0,5}});
+          sched.feedPrioritisation ({a2, Time{0,2}, Time{0,5}});
+          sched.feedPrioritisation ({a3, Time{0,3}, Time{0,3}});
+          CHECK (sched.distributeLocal());
+          CHECK (sched.distributeLocal());
+          CHECK (sched.hasLocalWork());
+          CHECK (isSameObject (*sched.peekHead(), a3));
+          CHECK (Time(0,1) == sched.headTime());               // earliest start found in local queues
+          
+          CHECK (sched.distributeLocal());
+          CHECK (not sched.peekHead());
+          CHECK (not sched.empty());
+          CHECK (Time(0,1) == sched.headTime());
+          
+          // retrieve own and stolen entries, ordered by start time within each queue
+          auto r1 = sched.pullLocal (Time{0,2});
+          auto r2 = sched.pullLocal (Time{0,2});
+          auto r3 = sched.pullLocal (Time{0,2});
+          CHECK (r1 and r2 and r3);
+          CHECK (not sched.pullLocal (Time{0,2}));
+          CHECK (not sched.hasLocalWork());
+          CHECK (sched.empty());
+          CHECK (Time::NEVER == sched.headTime());
+          
+          // entries past their deadline are dropped silently
+          sched.feedPrioritisation ({a3, Time{0,3}, Time{0,3}});
+          sched.feedPrioritisation ({a1, Time{0,1}, Time{0,5}});
+          CHECK (sched.distributeLocal());
+          CHECK (sched.distributeLocal());
+          auto rr = sched.pullLocal (Time{0,4});
+          CHECK (isSameObject (*rr.activity, a1));
+          CHECK (not sched.pullLocal (Time{0,4}));
+          CHECK (sched.empty());
+          
+          sched.feedPrioritisation ({a2, Time{0,2}, Time{0,5}});
+          CHECK (sched.distributeLocal());
+          CHECK (sched.hasLocalWork());
+          sched.discardSchedule();
+          CHECK (not sched.hasLocalWork());
+          CHECK (sched.empty());
+        }
+      
+      
+      
+      /** @test verify the hand-off slots used for batched dispatch
+       *      - the head entry can be passed into a free slot
+       *      - the number of slots is limited
+       *      - headTime() and empty() take handed-off work into account
+       *      - entries past their deadline are discarded on retrieval
+       */
+      void
+      verify_handoffSlots()
+        {
+          SchedulerInvocation sched;
+          Activity a1{1u,1u};
+          Activity a2{2u,2u};
+          CHECK (not sched.hasHandoffWork());
+          
+          sched.feedPrioritisation ({a1, Time{0,1}, Time{0,5}});
+          sched.feedPrioritisation ({a2, Time{0,2}, Time{0,3}});
+          CHECK (sched.handOff());
+          CHECK (sched.hasHandoffWork());
+          CHECK (isSameObject (*sched.peekHead(), a2));
+          CHECK (Time(0,1) == sched.headTime());
+          CHECK (sched.handOff());
+          CHECK (not sched.peekHead());
+          CHECK (not sched.empty());
+          CHECK (Time(0,1) == sched.headTime());
+          
+          auto h1 = sched.pullHandoff (Time{0,2});
+          auto h2 = sched.pullHandoff (Time{0,2});
+          CHECK (h1 and h2);
+          CHECK (not isSameObject (*h1.activity, *h2.activity));
+          CHECK (not sched.pullHandoff (Time{0,2}));
+          CHECK (sched.empty());
+          CHECK (Time::NEVER == sched.headTime());
+          
+          // capacity is limited; further entries remain in the priority queue
+          for (uint i=0; i < 10; ++i)
+            sched.feedPrioritisation ({a1, Time{0,1}, Time{0,5}});
+          uint handed{0};
+          while (sched.handOff())
+            ++handed;
+          CHECK (8 == handed);
+          CHECK (sched.peekHead());
+          
+          // entries past their deadline are dropped silently
+          auto late = sched.pullHandoff (Time{0,6});
+          CHECK (not late);
+          CHECK (not sched.hasHandoffWork());
+          
+          sched.feedPrioritisation ({a2, Time{0,2}, Time{0,5}});
+          sched.pullHead();
+          CHECK (sched.handOff());
+          sched.discardSchedule();
+          CHECK (not sched.hasHandoffWork());
+          CHECK (sched.empty());
+        }
+      
+      
+      
+      /** @test verify local run queues grouped per NUMA node
+       *      - events with a NUMA hint are placed into a queue of that node
+       *      - a worker prefers the queues of its own node,
+       *        even when work on another node would be more urgent
+       *      - only when its own node ran dry, it steals across nodes
+       */
+      void
+      verify_numaGrouping()
+        {
+          SchedulerInvocation sched;
+          sched.useLocalQueues (4, 2);
+          Activity a0{1u,1u};
+          Activity a1{2u,2u};
+          
+          ActivationEvent e0{a0, Time{0,2}, Time{0,5}};
+          ActivationEvent e1{a1, Time{0,1}, Time{0,5}};
+          e0.numaNode = 0;
+          e1.numaNode = 1;
+          sched.feedPrioritisation (e0);
+          sched.feedPrioritisation (e1);
+          CHECK (sched.distributeLocal());
+          CHECK (sched.distributeLocal());
+          CHECK (Time(0,1) == sched.headTime());
+          
+          work::pinCurrentThread (work::Placement{-1, 0});    // just mark this thread as located at node-0
+          CHECK (0 == work::currentNode());
+          CHECK (isSameObject (*sched.pullLocal(Time{0,2}).activity, a0));
+          CHECK (isSameObject (*sched.pullLocal(Time{0,2}).activity, a1));   // stolen from node-1, since node-0 ran dry
+          CHECK (sched.empty());
+          
+          work::pinCurrentThread (work::Placement());
+          CHECK (work::NO_NODE == work::currentNode());
+        }
+      
+      
+      
+      /** @test verify the calendar queue as alternative prioritisation backend
+       *      - yields entries in the same order as the binary heap,
+       *        for random start times with interleaved insertions
+       *        and removals, including entries before the current head
+       *      - adapts bucket count and width while growing and shrinking
+       *      - can be selected in Layer-1 while the schedule is empty
+       */
+      void
+      verify_calendarQueue()
+        {
+          Activity dummy;
+          auto event = [&](int64_t start){ return ActivationEvent{dummy, Time{TimeValue{start}}}; };
+          
+          CalendarQueue calendar;
+          std::priority_queue<ActivationEvent> heap;
+          CHECK (calendar.empty());
+          CHECK (64 == calendar.bucketCnt());
+          
+          auto checkHead = [&]
+                              {
+                                CHECK (calendar.size() == heap.size());
+                                if (not heap.empty())
+                                  CHECK (calendar.top().starting == heap.top().starting);
+                              };
+          
+          // grow: entries spaced by ~100µs with some jitter
+          int64_t base{0};
+          for (uint i=0; i < 5000; ++i)
+            {
+              auto e = event (base + i*100 + rani(500));
+              calendar.push (e);
+              heap.push (e);
+              checkHead();
+            }
+          CHECK (calendar.bucketCnt() > 1000);
+          CHECK (calendar.bucketWidth() < 1000);
+          
+          // steady state: consume the head, add further entries ahead
+          // and occasionally some entry earlier than the current head
+          for (uint i=0; i < 10000; ++i)
+            {
+              int64_t head = heap.top().starting;
+              calendar.pop();
+              heap.pop();
+              checkHead();
+              auto e = event (0 == i % 7? head - rani(1000)
+                                        : head + rani(1000000));
+              calendar.push (e);
+              heap.push (e);
+              checkHead();
+            }
+          
+          // shrink: drain completely, in strict time order
+          int64_t prev = calendar.top().starting;
+          while (not heap.empty())
+            {
+              CHECK (prev <= calendar.top().starting);
+              prev = calendar.top().starting;
+              calendar.pop();
+              heap.pop();
+              checkHead();
+            }
+          CHECK (calendar.empty());
+          CHECK (64 == calendar.bucketCnt());
+          
+          // extreme values and entries separated by several »years«
+          calendar.push (event (_raw(Time::NEVER)));
+          calendar.push (event (_raw(Time::ANYTIME)));
+          int64_t farAway = 1000 * calendar.bucketWidth() * 64;
+          calendar.push (event (farAway));
+          calendar.push (event (-5));
+          CHECK (calendar.top().starting == _raw(Time::ANYTIME));   calendar.pop();
+          CHECK (calendar.top().starting == -5);                    calendar.pop();
+          CHECK (calendar.top().starting == farAway);               calendar.pop();
+          CHECK (calendar.top().starting == _raw(Time::NEVER));     calendar.pop();
+          CHECK (calendar.empty());
+          
+          // use as backend in Layer-1
+          SchedulerInvocation sched;
+          CHECK (not sched.isCalendarQueue());
+          sched.useCalendarQueue();
+          CHECK (sched.isCalendarQueue());
+          Activity a1{1u,1u};
+          Activity a2{2u,2u};
+          sched.feedPrioritisation ({a2, Time{0,2}});
+          sched.feedPrioritisation ({a1, Time{0,1}});
+          CHECK (Time(0,1) == sched.headTime());
+          CHECK (not sched.isDue (Time{500,0}));
+          CHECK (sched.isDue (Time{0,1}));
+          CHECK (isSameObject (*sched.pullHead(), a1));
+          CHECK (isSameObject (*sched.pullHead(), a2));
+          CHECK (sched.empty());
+        }
+      
+      
+      
+      /** @test verify speculative entries are kept aside from regular work
+       *      - not visible at the queue head and irrelevant for the head time,
+       *        while the earliest start is reported as speculative head
+       *      - retrieved in time order, once the start time is reached
+       *      - entries past deadline or of an inactive manifestation are discarded
+       *      - dropping a manifestation removes its speculative entries immediately
+       */
+      void
+      verify_speculativeWork()
+        {
+          SchedulerInvocation sched;
+          Activity a1{1u,1u};
+          Activity a2{2u,2u};
+          Activity a3{3u,3u};
+          auto speculative = [](ActivationEvent event)
+                                {
+                                  event.isSpeculative = true;
+                                  return event;
+                                };
+          
+          sched.instruct (speculative ({a2, Time{0,2}, Time{0,5}}));
+          sched.instruct (speculative ({a1, Time{0,1}, Time{0,5}}));
+          sched.feedPrioritisation();
+          CHECK (sched.hasSpeculativeWork());
+          CHECK (not sched.peekHead());
+          CHECK (not sched.isDue (Time{0,3}));
+          CHECK (Time::NEVER == sched.headTime());
+          CHECK (Time(0,1) == sched.speculativeHead());                     // reported separately
+          CHECK (not sched.empty());
+          
+          sched.feedPrioritisation ({a3, Time{0,4}, Time{0,5}});
+          CHECK (Time(0,4) == sched.headTime());
+          CHECK (isSameObject (*sched.peekHead(), a3));
+          
+          CHECK (not sched.pullSpeculative (Time{0,0}));                    // not yet startable
+          CHECK (isSameObject (*sched.pullSpeculative (Time{0,3}), a1));
+          CHECK (Time(0,2) == sched.speculativeHead());
+          CHECK (isSameObject (*sched.pullSpeculative (Time{0,3}), a2));
+          CHECK (not sched.pullSpeculative (Time{0,3}));
+          CHECK (not sched.hasSpeculativeWork());
+          CHECK (Time::NEVER == sched.speculativeHead());
+          
+          // entries past their deadline are discarded
+          sched.feedPrioritisation (speculative ({a1, Time{0,1}, Time{0,2}}));
+          sched.feedPrioritisation (speculative ({a2, Time{0,1}, Time{0,5}}));
+          CHECK (isSameObject (*sched.pullSpeculative (Time{0,3}), a2));
+          CHECK (not sched.hasSpeculativeWork());
+          
+          // speculation is typically tagged by a manifestation
+          ManifestationID specID{7};
+          sched.feedPrioritisation (speculative ({a1, Time{0,1}, Time{0,5}, specID}));
+          CHECK (not sched.pullSpeculative (Time{0,3}));                    // ignored unless activated
+          CHECK (not sched.hasSpeculativeWork());
+          
+          sched.activate (specID);
+          sched.feedPrioritisation (speculative ({a1, Time{0,1}, Time{0,5}, specID}));
+          sched.feedPrioritisation (speculative ({a2, Time{0,2}, Time{0,5}, specID}));
+          sched.feedPrioritisation (speculative ({a3, Time{0,3}, Time{0,5}}));
+          CHECK (isSameObject (*sched.pullSpeculative (Time{0,3}), a1));
+          
+          sched.drop (specID);                                                // immediately discards remaining speculation
+          CHECK (sched.hasSpeculativeWork());                                 // ...yet not other entries
+          CHECK (Time(0,3) == sched.speculativeHead());
+          CHECK (isSameObject (*sched.pullSpeculative (Time{0,3}), a3));
+          CHECK (not sched.hasSpeculativeWork());
+          
+          sched.pullHead();
+          CHECK (sched.empty());
+          sched.feedPrioritisation (speculative ({a1, Time{0,1}, Time{0,5}}));
+          sched.discardSchedule();
+          CHECK (not sched.hasSpeculativeWork());
+          CHECK (sched.empty());
+        }
     };
   
   
@@ -0,0 +1,130 @@
+/*
+  SchedulerLatency(Test)  -  verify reaction time of the scheduler on new work
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file scheduler-latency-test.cpp
+ ** unit test \ref SchedulerLatency_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "vault/gear/scheduler.hpp"
+#include "vault/gear/special-job-fun.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/transiently.hpp"
+#include "lib/format-string.hpp"
+#include "lib/format-cout.hpp"
+#include "lib/util.hpp"
+
+#include <atomic>
+#include <thread>
+
+using test::Test;
+
+
+namespace vault{
+namespace gear {
+namespace test {
+  
+  using util::_Fmt;
+  using util::max;
+  using std::atomic;
+  using std::this_thread::sleep_for;
+  using std::chrono::microseconds;
+  using namespace std::chrono_literals;
+  
+  
+  
+  
+  /*************************************************************************//**
+   * @test Scheduler reaction time: a job posted for immediate execution while
+   *       the Scheduler is running, but all workers have fallen asleep, must be
+   *       picked up promptly, without waiting for a worker's sleep cycle to end.
+   * @warning relies on empirical timings and can be brittle on a loaded system.
+   * @see WorkForce_test::verify_workerWakeup()
+   * @see SchedulerService_test
+   */
+  class SchedulerLatency_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          seedRand();
+           measureWakeupLatency();
+        }
+      
+      
+      /** @test measure the delay between posting a job and its invocation.
+       *      - the Scheduler is kept in running state by its duty cycle,
+       *        yet without any further work, so all workers go to sleep
+       *      - at random points in time, a job is posted to start right away
+       *      - the job records the actual time of invocation
+       *      - since one parked worker is woken up for each imminent job,
+       *        the latency remains far below the idle sleep period.
+       */
+      void
+      measureWakeupLatency()
+        {
+          MARK_TEST_FUN
+          TRANSIENTLY(work::Config::COMPUTATION_CAPACITY) = 4;
+          BlockFlowAlloc bFlow;
+          EngineObserver watch;
+          Scheduler scheduler{bFlow, watch};
+          
+          const uint ROUNDS = 20;
+          atomic<int64_t> invoked{0};
+          
+          auto postJob = [&](microseconds offset)
+                          {
+                            SpecialJobFun jobFun{[&](JobParameter){ invoked = _raw(RealClock::now()); }};
+                            Job job{jobFun, InvocationInstanceID(), Time::ANYTIME};
+                            scheduler.defineSchedule(job)
+                                     .startOffset(offset)
+                                     .lifeWindow(50ms)
+                                     .post();
+                          };
+          
+          postJob (5s);                            // ignite the Scheduler with some far-away job...
+          sleep_for (60ms);                        // ...and let the workers fall asleep
+          CHECK (not invoked);
+          CHECK (not scheduler.empty());           // duty cycle remains active
+          
+          int64_t sumLatency{0}, maxLatency{0};
+          for (uint i=0; i < ROUNDS; ++i)
+            {
+              sleep_for (std::chrono::milliseconds (5 + rani(25)));
+              invoked = 0;
+              int64_t posted = _raw(RealClock::now());
+              postJob (0us);
+              while (not invoked)
+                sleep_for (20us);
+              int64_t latency = invoked - posted;
+              sumLatency += latency;
+              maxLatency = max (maxLatency, latency);
+            }
+          double avgLatency = double(sumLatency) / ROUNDS;
+          
+          cout << _Fmt{"Wakeup latency: ∅%5.0fµs  max:%5dµs"}
+                      % avgLatency % maxLatency
+               << endl;
+          CHECK (avgLatency < 2000);               // well below the idle sleep period of 20ms
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (SchedulerLatency_test, "unit engine");
+  
+  
+  
+}}} // namespace vault::gear::test
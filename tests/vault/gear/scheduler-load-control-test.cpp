@@ -57,6 +57,9 @@ namespace test {
            classifyCapacity();
            scatteredReCheck();
            indicateAverageLoad();
+           adaptDispatchBatch();
+           shedInOverload();
+           limitSpeculation();
         }
       
       
@@ -348,6 +351,120 @@ namespace test {
           lctrl.markIncomingCapacity (head,curr);
           CHECK (-2581 == lctrl.averageLag());
         }
+      
+      
+      
+      /** @test verify the batch size for batched dispatch is derived from the load
+       *      - no batching below full load
+       *      - under overload, the batch grows with the load indicator
+       *      - but is limited by the number of active workers and a fixed maximum
+       */
+      void
+      adaptDispatchBatch()
+        {
+          uint maxThreads = 10;
+          uint currThreads = 5;
+          
+          LoadController::Wiring setup;
+          setup.maxCapacity       = [&]{ return maxThreads; };
+          setup.currWorkForceSize = [&]{ return currThreads; };
+          LoadController lctrl{move(setup)};
+          
+          lctrl.setCurrentAverageLag (200+500);
+          CHECK (1.0 == lctrl.effectiveLoad());
+          CHECK (2 == lctrl.dispatchBatchSize());
+          
+          lctrl.setCurrentAverageLag (200);
+          CHECK (0.5 == lctrl.effectiveLoad());
+          CHECK (1 == lctrl.dispatchBatchSize());
+          
+          currThreads = 10;
+          lctrl.setCurrentAverageLag (200+500+500);
+          CHECK (3.0 == lctrl.effectiveLoad());
+          CHECK (6 == lctrl.dispatchBatchSize());
+          
+          lctrl.setCurrentAverageLag (200+5000);
+          CHECK (8 == lctrl.dispatchBatchSize());           // limited to maximum batch size
+          
+          currThreads = 3;
+          CHECK (3 == lctrl.dispatchBatchSize());           // limited by number of active workers
+        }
+      
+      
+      
+      /** @test verify the margin used to shed regular entries early in overload
+       *      - no shedding while the load indicator remains below 100%
+       *      - in overload, the margin is the average lag beyond the standard lag
+       */
+      void
+      shedInOverload()
+        {
+          uint maxThreads = 10;
+          uint currThreads = 10;
+          
+          LoadController::Wiring setup;
+          setup.maxCapacity       = [&]{ return maxThreads; };
+          setup.currWorkForceSize = [&]{ return currThreads; };
+          LoadController lctrl{move(setup)};
+          
+          lctrl.setCurrentAverageLag (200);
+          CHECK (1.0 == lctrl.effectiveLoad());
+          CHECK (Offset::ZERO == lctrl.shedMargin());
+          
+          lctrl.setCurrentAverageLag (200+500);
+          CHECK (2.0 == lctrl.effectiveLoad());
+          CHECK (Offset{TimeValue{500}} == lctrl.shedMargin());
+          
+          currThreads = 4;                                  // not all workers engaged
+          CHECK (0.8 == lctrl.effectiveLoad());
+          CHECK (Offset::ZERO == lctrl.shedMargin());
+          
+          currThreads = 10;
+          lctrl.setCurrentAverageLag (-500);
+          CHECK (Offset::ZERO == lctrl.shedMargin());
+        }
+      
+      
+      
+      /** @test verify capacity for speculative work is limited
+       *      - only idle capacity may engage in speculation
+       *      - at most a share of the possible concurrency
+       *      - at least one worker, even with minimal concurrency
+       */
+      void
+      limitSpeculation()
+        {
+          CHECK (not LoadController::isIdle (Capacity::DISPATCH));
+          CHECK (not LoadController::isIdle (Capacity::TENDNEXT));
+          CHECK (not LoadController::isIdle (Capacity::SPINTIME));
+          CHECK (not LoadController::isIdle (Capacity::NEARTIME));
+          CHECK (    LoadController::isIdle (Capacity::WORKTIME));
+          CHECK (    LoadController::isIdle (Capacity::IDLEWAIT));
+          
+          uint maxThreads = 5;
+          LoadController::Wiring setup;
+          setup.maxCapacity = [&]{ return maxThreads; };
+          LoadController lctrl{move(setup)};
+          
+          CHECK (0 == lctrl.cntSpeculating());
+          CHECK (lctrl.allowsSpeculation());
+          {
+            auto spec1 = lctrl.engageSpeculation();
+            CHECK (1 == lctrl.cntSpeculating());
+            CHECK (lctrl.allowsSpeculation());
+            {
+              auto spec2 = lctrl.engageSpeculation();
+              CHECK (2 == lctrl.cntSpeculating());
+              CHECK (not lctrl.allowsSpeculation());        // 5/2 ⟹ 2 workers
+            }
+            CHECK (lctrl.allowsSpeculation());
+            
+            maxThreads = 1;
+            CHECK (not lctrl.allowsSpeculation());
+          }
+          CHECK (0 == lctrl.cntSpeculating());
+          CHECK (lctrl.allowsSpeculation());                  // always at least one worker
+        }
     };
   
   
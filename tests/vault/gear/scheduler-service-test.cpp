@@ -105,6 +105,10 @@ namespace test {
           
           sleep_for (20ms);
           CHECK (0 == task.remainingInvocations());
+          
+          auto stats = watch.snapshot()[ManifestationID()];
+          CHECK (1 == stats.workTime.cnt);  // work timing was observed
+          CHECK (4000 <= stats.workTime.sum);
         }             // task has been invoked
       
       
@@ -68,6 +68,10 @@ namespace test {
            search_breaking_point();
            watch_expenseFunction();
            investigateWorkProcessing();
+           investigate_localRunQueues();
+           investigate_batchDispatch();
+           investigate_calendarQueue();
+           investigate_compulsoryLane();
         }
       
       
@@ -491,6 +495,251 @@ namespace test {
           CHECK (3.2 < stat.avgConcurrency);
           CHECK (stat.coveredTime < 5 * time*1000);
         }
+      
+      
+      
+      /** @test compare processing of a load of independent short jobs
+       *      through the central queue and with optional local run queues.
+       *      - 1024 isolated nodes, each with a small computational load
+       *      - all jobs are planned upfront and become due quickly, so that
+       *        workers compete for the Grooming-Token when pulling work
+       *      - with local run queues, due jobs can be picked up without the token
+       *      - both variants must reproduce the same computation results
+       */
+      void
+      investigate_localRunQueues()
+        {
+          MARK_TEST_FUN
+          TestChainLoad testLoad{1024};
+          testLoad.configure_isolated_nodes()
+                  .buildTopology();
+          size_t expectedHash = testLoad.getHash();
+          
+          auto LOAD_BASE = 200us;
+          TRANSIENTLY(work::Config::COMPUTATION_CAPACITY) = 4;
+          
+          auto performRun = [&]
+                              {
+                                BlockFlowAlloc bFlow;
+                                EngineObserver watch;
+                                Scheduler scheduler{bFlow, watch};
+                                return testLoad.setupSchedule(scheduler)
+                                               .withLoadTimeBase(LOAD_BASE)
+                                               .withJobDeadline(100ms)
+                                               .withUpfrontPlanning()
+                                               .launch_and_wait();
+                              };
+          
+          double timeCentral = performRun();
+          CHECK (expectedHash == testLoad.getHash());
+          
+          double timeLocal{0};
+          {
+            TRANSIENTLY(work::Config::LOCAL_RUN_QUEUES) = true;
+            timeLocal = performRun();
+          }
+          CHECK (expectedHash == testLoad.getHash());
+          
+          cout << _Fmt{"central queue: %5.1fms  local run queues: %5.1fms  (%4.2f)"}
+                      % (timeCentral/1000) % (timeLocal/1000) % (timeLocal/timeCentral)
+               << endl;
+          CHECK (timeLocal < 1.2 * timeCentral);     // should at least not degrade throughput
+        }      
+      
+      
+      /** @test compare processing of very short jobs with and without batched dispatch.
+       *      - 1024 isolated nodes with a tiny computational load, all planned upfront
+       *      - with batched dispatch, the token holder dequeues several due jobs at once
+       *        and hands off further jobs to other workers; the batch size is adapted
+       *        by the LoadController and grows when the schedule is lagging behind
+       *      - both variants must reproduce the same computation results
+       */
+      void
+      investigate_batchDispatch()
+        {
+          MARK_TEST_FUN
+          TestChainLoad testLoad{1024};
+          testLoad.configure_isolated_nodes()
+                  .buildTopology();
+          size_t expectedHash = testLoad.getHash();
+          
+          auto LOAD_BASE = 20us;
+          TRANSIENTLY(work::Config::COMPUTATION_CAPACITY) = 4;
+          
+          auto performRun = [&]
+                              {
+                                BlockFlowAlloc bFlow;
+                                EngineObserver watch;
+                                Scheduler scheduler{bFlow, watch};
+                                return testLoad.setupSchedule(scheduler)
+                                               .withLoadTimeBase(LOAD_BASE)
+                                               .withJobDeadline(100ms)
+                                               .withUpfrontPlanning()
+                                               .launch_and_wait();
+                              };
+          
+          double timeSingle = performRun();
+          CHECK (expectedHash == testLoad.getHash());
+          
+          double timeBatch{0};
+          {
+            TRANSIENTLY(work::Config::BATCH_DISPATCH) = true;
+            timeBatch = performRun();
+          }
+          CHECK (expectedHash == testLoad.getHash());
+          
+          cout << _Fmt{"single dispatch: %5.1fms  batched dispatch: %5.1fms  (%4.2f)"}
+                      % (timeSingle/1000) % (timeBatch/1000) % (timeBatch/timeSingle)
+               << endl;
+          CHECK (timeBatch < 1.2 * timeSingle);      // should at least not degrade throughput
+        }
+      
+      
+      
+      /** @test benchmark the prioritisation backends of Layer-1
+       *      - several TestChainLoad topologies with 4096 nodes,
+       *        all planned upfront, so that the queue holds many entries
+       *      - computational load is deactivated, and the schedule is tight,
+       *        so that run time is dominated by scheduling overhead
+       *      - each topology is performed with the binary heap
+       *        and with the calendar queue; results must be identical
+       */
+      void
+      investigate_calendarQueue()
+        {
+          MARK_TEST_FUN
+          TRANSIENTLY(work::Config::COMPUTATION_CAPACITY) = 4;
+          
+          auto benchmark = [](string topology, TestChainLoad<>&& testLoad)
+                              {
+                                testLoad.buildTopology();
+                                size_t expectedHash = testLoad.getHash();
+                                
+                                auto performRun = [&]
+                                                    {
+                                                      BlockFlowAlloc bFlow;
+                                                      EngineObserver watch;
+                                                      Scheduler scheduler{bFlow, watch};
+                                                      return testLoad.setupSchedule(scheduler)
+                                                                     .deactivateLoad()
+                                                                     .withLevelDuration(20us)
+                                                                     .withJobDeadline(500ms)
+                                                                     .withUpfrontPlanning()
+                                                                     .launch_and_wait();
+                                                    };
+                                double timeHeap = performRun();
+                                CHECK (expectedHash == testLoad.getHash());
+                                
+                                double timeCalendar{0};
+                                {
+                                  TRANSIENTLY(work::Config::CALENDAR_QUEUE) = true;
+                                  timeCalendar = performRun();
+                                }
+                                CHECK (expectedHash == testLoad.getHash());
+                                
+                                cout << _Fmt{"%-28s heap: %6.1fms  calendar: %6.1fms  (%4.2f)"}
+                                            % topology % (timeHeap/1000) % (timeCalendar/1000) % (timeCalendar/timeHeap)
+                                     << endl;
+                                CHECK (timeCalendar < 1.5 * timeHeap);
+                              };
+          const size_t NODES = 4096;
+          benchmark ("isolated nodes",         TestChainLoad{NODES}.configure_isolated_nodes());
+          benchmark ("short chains",           TestChainLoad{NODES}.configureShape_short_chains3_interleaved());
+          benchmark ("interwoven segments",    TestChainLoad{NODES}.configureShape_short_segments3_interleaved());
+          benchmark ("load bursts",            TestChainLoad{NODES}.configureShape_chain_loadBursts());
+        }
+      
+      
+      
+      /** @test demonstrate the effect of the priority lane for compulsory jobs
+       *        and of early shedding in a persistent overload situation.
+       *      - deterministic simulation with a single worker on Layer-1 and Layer-2,
+       *        where the dispatch of each job advances the clock by 100µs
+       *      - regular jobs are due every 50µs with a deadline 2ms after start,
+       *        while every 20th slot also holds a compulsory job with 1ms deadline
+       *      - without the lane, compulsory jobs are queued behind the backlog
+       *        and will be missed; with the lane, they are served first
+       *      - with shedding, regular jobs lacking slack are discarded early,
+       *        so that more of the jobs actually processed end within deadline
+       */
+      void
+      investigate_compulsoryLane()
+        {
+          MARK_TEST_FUN
+          const size_t SLOTS = 2000;
+          const int64_t STEP = 50;     // µs
+          const int64_t COST = 100;
+          
+          struct Result { size_t missed{0}, onTime{0}, late{0}; };
+          
+          auto simulate = [&](bool useLane, bool shed)
+                              {
+                                LoadController::Wiring setup;
+                                setup.maxCapacity       = []{ return 1; };
+                                setup.currWorkForceSize = []{ return 1; };
+                                LoadController lctrl{std::move(setup)};
+                                SchedulerInvocation queue;
+                                SchedulerCommutator sched;
+                                queue.useCompulsoryLane (useLane);
+                                
+                                Activity work;
+                                for (size_t i=0; i < SLOTS; ++i)
+                                  {
+                                    int64_t start = i*STEP;
+                                    queue.feedPrioritisation ({work, Time{TimeValue{start}}, Time{TimeValue{start + 2000}}});
+                                    if (0 == i % 20)
+                                      queue.feedPrioritisation ({work, Time{TimeValue{start}}, Time{TimeValue{start + 1000}}
+                                                                ,ManifestationID(), true});
+                                  }
+                                Result res;
+                                TimeVar now{Time::ZERO};
+                                while (not queue.empty())
+                                  {
+                                    queue.advanceTo (now);
+                                    while (queue.isOutdated (now))
+                                      {
+                                        if (queue.isOutOfTime (now))
+                                          ++res.missed;
+                                        queue.pullHead();
+                                      }
+                                    if (queue.empty()) break;
+                                    lctrl.markIncomingCapacity (queue.headTime(), now);
+                                    Offset margin = shed? lctrl.shedMargin() : Offset::ZERO;
+                                    ActivationEvent evt = sched.findWork (queue, now, 1, margin);
+                                    if (not evt)
+                                      {
+                                        if (queue.headTime() > now)
+                                          now = queue.headTime();
+                                        continue;
+                                      }
+                                    now += Offset{TimeValue{COST}};
+                                    if (evt.isCompulsory and now > Time{TimeValue{evt.deadline}})
+                                      ++res.missed;
+                                    else
+                                    if (not evt.isCompulsory)
+                                      ++(now > Time{TimeValue{evt.deadline}}? res.late : res.onTime);
+                                  }
+                                return res;
+                              };
+          
+          Result merged = simulate (false, false);
+          Result lane   = simulate (true,  false);
+          Result shed   = simulate (true,  true);
+          
+          auto show = [](string variant, Result r)
+                          {
+                            cout << _Fmt{"%-14s compulsory missed: %3d  regular on time: %4d  late: %4d"}
+                                        % variant % r.missed % r.onTime % r.late
+                                 << endl;
+                          };
+          show ("no lane",       merged);
+          show ("priority lane", lane);
+          show ("lane+shedding", shed);
+          
+          CHECK (lane.missed < merged.missed);
+          CHECK (shed.missed <= lane.missed);
+          CHECK (shed.late < lane.late);
+        }
     };
   
   
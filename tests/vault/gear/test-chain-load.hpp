@@ -87,6 +87,11 @@
  ** complete graph, returning a observed runtime in microseconds from the nominal start point of
  ** the schedule.
  ** 
+ ** To emulate IO-bound processing, each seed node can be preceded by an asynchronous IO job
+ ** (see ScheduleCtx::withIOLatency), which just submits a »read« to an emulated device and
+ ** returns. The calculation of the seed node is released only when the device signals
+ ** completion after the configured latency, without occupying a worker in between.
+ ** 
  ** ## Observation tools
  ** The generated topology can be visualised as a graph, using the Graphviz-DOT language.
  ** Nodes are rendered from bottom to top, organised into strata according to the time-level
@@ -117,6 +122,7 @@
 #include "vault/gear/scheduler.hpp"
 #include "vault/gear/special-job-fun.hpp"
 #include "lib/uninitialised-storage.hpp"
+#include "lib/thread.hpp"
 #include "lib/test/microbenchmark.hpp"
 #include "lib/incidence-count.hpp"
 #include "lib/time/timevalue.hpp"
@@ -129,9 +135,12 @@
 #include "lib/util.hpp"
 
 #include <boost/functional/hash.hpp>
+#include <condition_variable>
 #include <functional>
 #include <utility>
 #include <future>
+#include <mutex>
+#include <queue>
 #include <memory>
 #include <string>
 #include <vector>
@@ -1685,6 +1694,123 @@ namespace test {
     };
   
   
+  /**
+   * Render JobFunctor to emulate an asynchronous IO operation (data loading)
+   * as prerequisite for a seed node. The job only submits the »read« to an
+   * emulated IO device and returns immediately; the device thread invokes
+   * the [completion](\ref async-job.hpp) after a fixed latency, which
+   * in turn releases the dependent calculation job in the Scheduler.
+   */
+  class RandomChainIoFunctor
+    : public ChainFunctor
+    , public AsyncJob
+    {
+      using Clock = std::chrono::steady_clock;
+      using Request = std::pair<Clock::time_point, size_t>;
+      using Queue = std::priority_queue<Request, std::vector<Request>, std::greater<Request>>;
+      
+      microseconds latency_;
+      std::vector<IoCompletion> completions_;
+      
+      std::mutex lock_;
+      std::condition_variable trigger_;
+      Queue pending_;
+      bool halt_{false};
+      size_t inFlight_{0};
+      size_t maxInFlight_{0};
+      size_t cntIO_{0};
+      
+      std::unique_ptr<lib::ThreadJoinable<>> device_;
+      
+    public:
+      RandomChainIoFunctor (size_t nodeCnt, microseconds latency)
+        : latency_{latency}
+        , completions_(nodeCnt)
+        {
+          device_.reset (new lib::ThreadJoinable<>{"Emulated IO", [this]{ emulateDevice(); }});
+        }
+      
+     ~RandomChainIoFunctor()
+        {
+          {
+            std::lock_guard<std::mutex> guard{lock_};
+            halt_ = true;
+          }
+          trigger_.notify_all();
+          device_->join();
+        }
+      
+      JobKind
+      getJobKind()  const override
+        {
+          return LOAD_JOB;
+        }
+      
+      /** IO job invocation: submit the »read« for one Node and return */
+      void
+      invokeJobOperation (JobParameter param)  override
+        {
+          size_t nodeIdx = decodeNodeID (param.invoKey);
+          {
+            std::lock_guard<std::mutex> guard{lock_};
+            pending_.emplace (Clock::now() + latency_, nodeIdx);
+            maxInFlight_ = max (maxInFlight_, ++inFlight_);
+            ++cntIO_;
+          }
+          trigger_.notify_one();
+        }
+      
+      void
+      attachCompletion (InvocationInstanceID invoKey, IoCompletion completion)  override
+        {
+          size_t nodeIdx = decodeNodeID (invoKey);
+          REQUIRE (nodeIdx < completions_.size());
+          completions_[nodeIdx] = completion;
+        }
+      
+      string diagnostic()  const override
+        {
+          return _Fmt{"ChainIO(%dµs)"} % latency_.count();
+        }
+      
+      size_t
+      getMaxInFlight()
+        {
+          std::lock_guard<std::mutex> guard{lock_};
+          return maxInFlight_;
+        }
+      
+      size_t
+      getCntIO()
+        {
+          std::lock_guard<std::mutex> guard{lock_};
+          return cntIO_;
+        }
+      
+    private:
+      void
+      emulateDevice()
+        {
+          std::unique_lock<std::mutex> guard{lock_};
+          while (not halt_)
+            if (pending_.empty())
+              trigger_.wait (guard);
+            else
+            if (Clock::now() < pending_.top().first)
+              trigger_.wait_until (guard, pending_.top().first);
+            else
+              {
+                size_t nodeIdx = pending_.top().second;
+                pending_.pop();
+                --inFlight_;
+                guard.unlock();
+                completions_[nodeIdx]();  // re-enter the Scheduler
+                guard.lock();
+              }
+        }
+    };
+  
+  
   
   
   /**
@@ -1728,6 +1854,10 @@ namespace test {
       std::unique_ptr<RandomChainCalcFunctor<maxFan>> calcFunctor_;
       std::unique_ptr<RandomChainPlanFunctor<maxFan>> planFunctor_;
       
+      microseconds ioLatency_{0us};
+      std::unique_ptr<RandomChainIoFunctor>             ioFunctor_;
+      lib::UninitialisedDynBlock<ScheduleSpec>         ioSchedule_;
+      
       std::unique_ptr<lib::IncidenceCount> watchInvocations_;
       
       
@@ -1742,12 +1872,30 @@ namespace test {
                                      .startTime (jobStartTime(level, idx))
                                      .lifeWindow (deadline_);
           Node& n = chainLoad_.nodes_[idx];
+          if (ioFunctor_ and isnil (n.pred))
+            disposeLoadStep (idx, level);
+          else
           if (isnil (n.pred)
               or schedDepends_)
             schedule_[idx].post();
         }// Node with dependencies will be triggered by NOTIFY
         //  and thus must not necessarily be scheduled explicitly.
       
+      /** place an IO job as prerequisite of a seed node */
+      void
+      disposeLoadStep (size_t idx, size_t level)
+        {
+          ioSchedule_[idx] = scheduler_.defineSchedule(ioJob (idx,level))
+                                       .manifestation(manID_)
+                                       .startTime (jobStartTime(level, idx))
+                                       .lifeWindow (deadline_);
+          bool unlimitedTime = not schedNotify_;
+          ioSchedule_[idx].linkToSuccessor (schedule_[idx], unlimitedTime);
+          ioSchedule_[idx].post();
+          if (schedDepends_)
+            schedule_[idx].post();
+        }// calculation will be triggered by the IO completion
+      
       /** Callback: define a dependency between scheduled jobs */
       void
       setDependency (Node* pred, Node* succ)
@@ -1797,6 +1945,13 @@ namespace test {
                                                                 ,[this](size_t s,size_t n,size_t l, bool w)
                                                                                        { continuation(s,n,l,w); }
                                                                 });
+          if (ioLatency_ > 0us)
+            {
+              ioSchedule_.allocate (numNodes);
+              ioFunctor_.reset (new RandomChainIoFunctor{numNodes, ioLatency_});
+            }
+          else
+            ioFunctor_.reset();
           startTime_ = anchorSchedule();
           scheduler_.seedCalcStream (planningJob(firstChunkEndNode)
                                     ,manID_
@@ -1866,6 +2021,13 @@ namespace test {
       
       double getStressFac() { return stressFac_; }
       
+      /** maximum number of IO jobs pending concurrently on the emulated device */
+      size_t
+      getMaxPendingIO()
+        {
+          return ioFunctor_? ioFunctor_->getMaxInFlight() : 0;
+        }
+      
       
       
       /* ===== Setter / builders for custom configuration ===== */
@@ -2019,6 +2181,15 @@ namespace test {
           return move(*this);
         }
       
+      /** precede each seed node by an asynchronous IO job,
+       *  which is completed by an emulated device after the given latency */
+      ScheduleCtx&&
+      withIOLatency (microseconds latency)
+        {
+          ioLatency_ = latency;
+          return move(*this);
+        }
+      
       ScheduleCtx&&
       withLoadMem (size_t sizeBase =LOAD_DEFAULT_MEM_SIZE)
         {
@@ -2061,6 +2232,15 @@ namespace test {
                     };
         }
       
+      Job
+      ioJob (size_t idx, size_t level)
+        {
+          return Job{*ioFunctor_
+                    , ioFunctor_->encodeNodeID(idx)
+                    , ioFunctor_->encodeLevel(level)
+                    };
+        }
+      
       Job
       planningJob (size_t endNodeIDX)
         {
@@ -20,10 +20,13 @@
 #include "vault/gear/work-force.hpp"
 #include "lib/thread.hpp"
 #include "lib/sync.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/transiently.hpp"
 
 #include <functional>
 #include <thread>
 #include <chrono>
+#include <vector>
 #include <set>
 
 using test::Test;
@@ -36,6 +39,7 @@ namespace test {
   using std::this_thread::sleep_for;
   using namespace std::chrono_literals;
   using std::chrono::milliseconds;
+  using std::vector;
   using lib::Thread;
   
   
@@ -111,6 +115,7 @@ namespace test {
           verify_pullWork();
           verify_workerHalt();
           verify_workerSleep();
+          verify_workerWakeup();
           verify_workerRetard();
           verify_workerDismiss();
           verify_finalHook();
@@ -119,6 +124,7 @@ namespace test {
           verify_scalePool();
           verify_countActive();
           verify_dtor_blocks();
+          verify_topology();
         }
       
       
@@ -220,6 +226,36 @@ namespace test {
       
       
       
+      /** @test a sleeping worker is parked and can be woken up
+       *        prematurely, when new work becomes available.
+       */
+      void
+      verify_workerWakeup()
+        {
+          atomic<uint> check{0};
+          WorkForce wof{setup ([&]{ ++check; return activity::WAIT; })
+                          .withSleepPeriod (500ms)};
+          
+          CHECK (0 == wof.wakeUp());                     // no effect when no worker is parked
+          wof.incScale();
+          sleep_for(5ms);
+          CHECK (1 == check);
+          CHECK (1 == wof.parking().parkedCnt());
+          
+          CHECK (1 == wof.wakeUp());
+          sleep_for(5ms);      // worker woken long before the sleep-period ends...
+          CHECK (2 == check);  // ...and invoked the work-functor again
+          CHECK (1 == wof.parking().parkedCnt());
+          
+          // parking is bounded by timeout
+          work::ParkingLot parking;
+          auto start = std::chrono::steady_clock::now();
+          CHECK (not parking.park (2ms));
+          CHECK (std::chrono::steady_clock::now() - start >= 2ms);
+        }
+      
+      
+      
       /** @test a worker can be retarded and throttled in case of contention.
        */
       void
@@ -286,10 +322,12 @@ namespace test {
           wof.activate();
           sleep_for(10ms);
           CHECK (wof.size() == work::Config::COMPUTATION_CAPACITY);
+          CHECK (wof.cntLive() == wof.size());
           CHECK (0 == exited);
           
           control = activity::HALT;
           sleep_for(10ms);
+          CHECK (0 == wof.cntLive());         // atomic count of live workers, usable concurrently
           CHECK (0 == wof.size());
           CHECK (exited == work::Config::COMPUTATION_CAPACITY);
         }
@@ -508,6 +546,78 @@ namespace test {
           CHECK (shutdown_done);
           CHECK (not operate);              // operate-thread has detached and terminated
         }
+      
+      
+      
+      /** @test discover the processor topology and pin workers
+       *        interleaved over NUMA nodes to individual cores.
+       */
+      void
+      verify_topology()
+        {
+          using work::Topology;
+          CHECK ((vector<int>{0,1,2,3,8,10,11}) == Topology::parseCpuList ("0-3,8,10-11"));
+          CHECK ((vector<int>{}) == Topology::parseCpuList (""));
+          
+          Topology topo{{{0,1,2}, {}, {4,5}}};    // empty node is dropped
+          CHECK (2 == topo.nodeCnt());
+          CHECK (5 == topo.cpuCnt());
+          auto place = [&](size_t i){ auto p = topo.placement(i); return std::make_pair (p.cpu, p.node); };
+          auto rank  = [&](size_t i){ return topo.placement(i).rank; };
+          CHECK (place(0) == std::make_pair(0,0u));
+          CHECK (place(1) == std::make_pair(4,1u));
+          CHECK (place(2) == std::make_pair(1,0u));
+          CHECK (place(3) == std::make_pair(5,1u));
+          CHECK (place(4) == std::make_pair(2,0u));
+          CHECK (place(5) == std::make_pair(4,1u));  // wrap around within node
+          CHECK (place(6) == std::make_pair(0,0u));
+          CHECK (0 == rank(0));
+          CHECK (0 == rank(1));
+          CHECK (1 == rank(2));                      // number of the worker within its node group
+          CHECK (2 == rank(5));
+          
+          Topology fallback = Topology::discover ("/non/existing/path");
+          CHECK (1 == fallback.nodeCnt());
+          CHECK (0 < fallback.cpuCnt());
+          CHECK (0 < Topology::system().nodeCnt());
+          
+          // workers pinned to cores know their NUMA node
+          TRANSIENTLY(work::Config::PIN_WORKERS) = true;
+          atomic<uint> node{work::NO_NODE};
+          WorkForce wof{setup ([&]{ node = work::currentNode(); return activity::HALT; })};
+          wof.incScale();
+          sleep_for(10ms);
+          CHECK (0 == node);
+          CHECK (work::NO_NODE == work::currentNode());      // while this thread is not pinned
+          
+          // the number of a terminated worker is reused, so that live workers never share a core
+          atomic<uint> leave{work::NO_WORKER};
+          atomic<uint> started[2] = {0,0};
+          WorkForce wof2{setup ([&]{
+                                    thread_local bool counted{false};
+                                    uint nr = work::currentPlacement().worker;
+                                    if (not counted and nr < 2)
+                                      ++started[nr];
+                                    counted = true;
+                                    if (nr == leave)
+                                      return activity::HALT;
+                                    sleep_for(100us);
+                                    return activity::PASS;
+                                  })};
+          wof2.incScale(2);
+          sleep_for(5ms);
+          CHECK (2 == wof2.size());
+          CHECK (1 == started[0] and 1 == started[1]);
+          leave = 0;
+          sleep_for(5ms);
+          CHECK (1 == wof2.size());
+          leave = work::NO_WORKER;
+          wof2.incScale();
+          sleep_for(5ms);
+          CHECK (2 == wof2.size());
+          CHECK (2 == started[0]);                           // replacement worker took the free number
+          CHECK (1 == started[1]);
+        }
     };
   
   
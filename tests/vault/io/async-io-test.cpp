@@ -0,0 +1,198 @@
+/*
+  AsyncIO(Test)  -  verify asynchronous reads by io_uring and IO thread pool
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file async-io-test.cpp
+ ** unit test \ref AsyncIO_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/temp-dir.hpp"
+#include "vault/io/async-io.hpp"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <fstream>
+#include <atomic>
+#include <vector>
+#include <thread>
+
+using lib::test::TempDir;
+using std::string;
+using std::this_thread::sleep_for;
+using std::chrono_literals::operator ""ms;
+
+
+namespace vault{
+namespace io   {
+namespace test {
+  
+  namespace { // Test fixture
+    
+    const size_t BLOCK = 4096;
+    const uint   BLOCKS = 200;
+    const uint   WAIT_LIMIT = 500;      ///< give up waiting after 5 sec
+    
+    /** write a file, where each byte of a block holds the block number */
+    string
+    writeBlocks (TempDir& temp)
+    {
+      auto path = temp.makeFile();
+      std::ofstream out{path, std::ios_base::binary};
+      for (uint b=0; b < BLOCKS; ++b)
+        out << string(BLOCK, char(b));
+      return path;
+    }
+    
+    bool
+    isBlock (const char* buff, uint blockNr)
+    {
+      for (size_t i=0; i < BLOCK; ++i)
+        if (buff[i] != char(blockNr))
+          return false;
+      return true;
+    }
+    
+    template<class CON>
+    void
+    awaitCompletion (CON const& cnt, uint expected)
+    {
+      for (uint i=0; i < WAIT_LIMIT and cnt < expected; ++i)
+        sleep_for (10ms);
+    }
+  }
+  
+  
+  
+  /***************************************************************//**
+   * @test verify asynchronous read operations, which are submitted
+   *       to the kernel through `io_uring` when possible, or performed
+   *       by a pool of IO threads as fall-back.
+   * @see async-io.hpp
+   * @see MediaRead_test
+   */
+  class AsyncIO_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          simpleUsage();
+          readBlocks (AsyncIOPolicy{});
+          readBlocks (AsyncIOPolicy{8, 2, true});                     // small ring: excess requests go to the pool
+          readBlocks (AsyncIOPolicy{128, 3, false});                  // thread pool only
+          reportFailure();
+        }
+      
+      
+      /** @test read a single block and perform a blocking operation */
+      void
+      simpleUsage()
+        {
+          TempDir temp;
+          int fd = ::open (writeBlocks(temp).c_str(), O_RDONLY);
+          CHECK (0 <= fd);
+          
+          std::vector<char> buff(BLOCK);
+          std::atomic<ssize_t> result{0};
+          std::atomic<ssize_t> advised{-1};
+          std::atomic_uint done{0};
+          void* mapped = ::mmap (nullptr, BLOCKS*BLOCK, PROT_READ, MAP_SHARED, fd, 0);
+          CHECK (mapped != MAP_FAILED);
+          {
+            AsyncIO asyncIO;
+            asyncIO.read (fd, 5*BLOCK, BLOCK, buff.data(), [&](ssize_t res){ result = res; ++done; });
+            asyncIO.advise (static_cast<char*> (mapped), BLOCKS*BLOCK, MADV_WILLNEED
+                           ,[&](ssize_t res){ advised = res; ++done; });
+            asyncIO.perform ([]{ return ssize_t(42); }
+                            ,[&](ssize_t res){ CHECK (42 == res); ++done; });
+            if (asyncIO.usesRing())
+              CHECK (2 == asyncIO.cntRing());                        // read and advice submitted to the kernel
+            CHECK (3 == asyncIO.cntRing() + asyncIO.cntPool());
+          }// destructor waits for completion
+          
+          CHECK (3 == done);
+          CHECK (ssize_t(BLOCK) == result);
+          CHECK (0 == advised);
+          CHECK (isBlock (buff.data(), 5));
+          CHECK (isBlock (static_cast<char*> (mapped) + 7*BLOCK, 7));
+          ::munmap (mapped, BLOCKS*BLOCK);
+          ::close (fd);
+        }
+      
+      
+      /** @test many concurrent reads, delivered in arbitrary order */
+      void
+      readBlocks (AsyncIOPolicy policy)
+        {
+          TempDir temp;
+          int fd = ::open (writeBlocks(temp).c_str(), O_RDONLY);
+          CHECK (0 <= fd);
+          
+          std::vector<char> buff(BLOCKS*BLOCK, -1);
+          std::atomic_uint done{0};
+          std::atomic_uint verified{0};
+          AsyncIO asyncIO{policy};
+          
+          for (uint b=0; b < BLOCKS; ++b)
+            {
+              char* target = &buff[b*BLOCK];
+              asyncIO.read (fd, b*BLOCK, BLOCK, target
+                           ,[&, b, target](ssize_t res)
+                              {
+                                if (ssize_t(BLOCK) == res and isBlock (target, b))
+                                  ++verified;
+                                ++done;
+                              });
+            }
+          awaitCompletion (done, BLOCKS);
+          CHECK (BLOCKS == done);
+          CHECK (BLOCKS == verified);
+          CHECK (0 == asyncIO.cntPending());
+          CHECK (BLOCKS == asyncIO.cntRing() + asyncIO.cntPool());
+          if (not policy.useRing)
+            CHECK (0 == asyncIO.cntRing());
+          ::close (fd);
+        }
+      
+      
+      /** @test failures are reported as negative `errno` to the completion */
+      void
+      reportFailure()
+        {
+          char buff[BLOCK];
+          std::atomic<ssize_t> viaRing{0};
+          std::atomic<ssize_t> viaPool{0};
+          {
+            AsyncIO asyncIO;
+            AsyncIO poolIO{AsyncIOPolicy{16, 1, false}};
+            asyncIO.read (-1, 0, BLOCK, buff, [&](ssize_t res){ viaRing = res; });
+            poolIO.read  (-1, 0, BLOCK, buff, [&](ssize_t res){ viaPool = res; });
+            poolIO.perform ([]() -> ssize_t { throw error::State{"IO device gone"}; }
+                           ,[&](ssize_t res){ CHECK (-EIO == res); });
+          }
+          CHECK (-EBADF == viaRing);
+          CHECK (-EBADF == viaPool);
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (AsyncIO_test, "unit backend");
+  
+  
+  
+}}} // namespace vault::io::test
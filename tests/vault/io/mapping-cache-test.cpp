@@ -0,0 +1,274 @@
+/*
+  MappingCache(Test)  -  verify bounded memory mapped access to media files
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file mapping-cache-test.cpp
+ ** unit test \ref MappingCache_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/temp-dir.hpp"
+#include "vault/io/mapping-cache.hpp"
+
+#include <fstream>
+#include <cstdint>
+
+using lib::test::TempDir;
+using LERR_(INDEX_BOUNDS);
+using LERR_(EXTERNAL);
+using LERR_(INVALID);
+
+
+namespace vault{
+namespace io   {
+namespace test {
+  
+  namespace { // Test fixture
+    
+    const size_t CHUNK = 64_KiB;
+    const size_t WORD = sizeof(uint32_t);
+    
+    /** write a file where each 32bit word holds its own index */
+    string
+    writeMediaFile (TempDir& temp, size_t bytes)
+    {
+      auto path = temp.makeFile();
+      std::ofstream out{path, std::ios_base::binary};
+      for (uint32_t i=0; i < bytes/WORD; ++i)
+        out.write (reinterpret_cast<const char*> (&i), WORD);
+      return path;
+    }
+    
+    /** verify the range holds the file content starting at the given offset */
+    bool
+    isContent (MappedRange const& range, size_t offset)
+    {
+      CHECK (0 == offset % WORD);
+      auto word = reinterpret_cast<const uint32_t*> (range.data());
+      for (size_t i=0; i < range.size()/WORD; ++i)
+        if (word[i] != offset/WORD + i)
+          return false;
+      return true;
+    }
+  }
+  
+  
+  
+  /***************************************************************//**
+   * @test verify access to media files by memory mapped windows,
+   *       while limiting the number of open files and mappings.
+   * @see mapping-cache.hpp
+   * @see MediaRead_test
+   */
+  class MappingCache_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          simpleUsage();
+          crossChunks();
+          limitMappings();
+          limitOpenFiles();
+          readAhead();
+        }
+      
+      
+      /** @test map a file and read some data */
+      void
+      simpleUsage()
+        {
+          TempDir temp;
+          string path = writeMediaFile (temp, 4*CHUNK + CHUNK/2);
+          MappingCache cache{MappingPolicy{CHUNK}};
+          CHECK (CHUNK == cache.chunkSize());
+          
+          FileID file = cache.open (path);
+          CHECK (1 == cache.cntFiles());
+          CHECK (1 == cache.cntOpenFiles());
+          CHECK (0 == cache.cntMappings());
+          CHECK (file == cache.open (path));
+          CHECK (1 == cache.cntFiles());
+          CHECK (4*CHUNK + CHUNK/2 == cache.fileSize (file));
+          
+          MappedRange frame = cache.access (file, 1000*WORD, 500*WORD);
+          CHECK (frame);
+          CHECK (500*WORD == frame.size());
+          CHECK (isContent (frame, 1000*WORD));
+          CHECK (1 == cache.cntMappings());
+          CHECK (1 == cache.cntMisses());
+          
+          MappedRange other = cache.access (file, 2000*WORD, 10*WORD);
+          CHECK (isContent (other, 2000*WORD));
+          CHECK (1 == cache.cntMappings());
+          CHECK (1 == cache.cntHits());
+          
+          // the last chunk is mapped only partially
+          MappedRange last = cache.access (file, 4*CHUNK, CHUNK/2);
+          CHECK (isContent (last, 4*CHUNK));
+          CHECK (2 == cache.cntMappings());
+          
+          frame.release();
+          CHECK (not frame);
+          CHECK (isContent (other, 2000*WORD));
+          
+          VERIFY_ERROR (INVALID, cache.access (file, 4*CHUNK, CHUNK));
+          VERIFY_ERROR (INDEX_BOUNDS, cache.access (file+1, 0, 1));
+          VERIFY_ERROR (EXTERNAL, cache.open (path+".nonexistent"));
+          CHECK (1 == cache.cntFiles());
+        }
+      
+      
+      /** @test a range crossing the boundary of chunks is mapped separately */
+      void
+      crossChunks()
+        {
+          TempDir temp;
+          string path = writeMediaFile (temp, 4*CHUNK);
+          MappingCache cache{MappingPolicy{CHUNK}};
+          FileID file = cache.open (path);
+          
+          MappedRange frame = cache.access (file, CHUNK - 100*WORD, 200*WORD);
+          CHECK (isContent (frame, CHUNK - 100*WORD));
+          CHECK (1 == cache.cntMappings());
+          CHECK (0 == cache.cntMisses());
+          
+          MappedRange inside = cache.access (file, CHUNK, 100*WORD);
+          CHECK (2 == cache.cntMappings());
+          
+          frame.release();
+          CHECK (1 == cache.cntMappings());
+          CHECK (isContent (inside, CHUNK));
+          
+          // moving the handle transfers the pin
+          MappedRange moved{std::move (inside)};
+          CHECK (not inside);
+          CHECK (isContent (moved, CHUNK));
+        }
+      
+      
+      /** @test unused windows are unmapped in LRU order beyond the limit,
+       *        while windows in use are retained */
+      void
+      limitMappings()
+        {
+          TempDir temp;
+          string path = writeMediaFile (temp, 8*CHUNK);
+          MappingCache cache{MappingPolicy{CHUNK, 4, 3}};
+          FileID file = cache.open (path);
+          
+          for (uint c=0; c < 8; ++c)
+            CHECK (isContent (cache.access (file, c*CHUNK, 64), c*CHUNK));
+          CHECK (3 == cache.cntMappings());
+          CHECK (8 == cache.cntMisses());
+          
+          // chunks 5,6,7 are still mapped, chunk 0 needs to be mapped again
+          CHECK (isContent (cache.access (file, 7*CHUNK, 64), 7*CHUNK));
+          CHECK (isContent (cache.access (file, 5*CHUNK, 64), 5*CHUNK));
+          CHECK (2 == cache.cntHits());
+          CHECK (isContent (cache.access (file, 0, 64), 0));
+          CHECK (9 == cache.cntMisses());
+          CHECK (3 == cache.cntMappings());
+          // ...thereby evicting chunk 6, which was the least recently used
+          CHECK (isContent (cache.access (file, 7*CHUNK, 64), 7*CHUNK));
+          CHECK (3 == cache.cntHits());
+          CHECK (isContent (cache.access (file, 6*CHUNK, 64), 6*CHUNK));
+          CHECK (10 == cache.cntMisses());
+          
+          // pinned windows exceed the limit temporarily
+          {
+            MappedRange r1 = cache.access (file, 1*CHUNK, 64);
+            MappedRange r2 = cache.access (file, 2*CHUNK, 64);
+            MappedRange r3 = cache.access (file, 3*CHUNK, 64);
+            MappedRange r4 = cache.access (file, 4*CHUNK, 64);
+            CHECK (4 == cache.cntMappings());
+            CHECK (isContent (r1, 1*CHUNK));
+          }
+          CHECK (3 == cache.cntMappings());
+        }
+      
+      
+      /** @test the number of open files is limited,
+       *        without affecting mappings already established */
+      void
+      limitOpenFiles()
+        {
+          TempDir temp;
+          string p1 = writeMediaFile (temp, 2*CHUNK);
+          string p2 = writeMediaFile (temp, CHUNK);
+          string p3 = writeMediaFile (temp, CHUNK);
+          MappingCache cache{MappingPolicy{CHUNK, 2}};
+          
+          FileID f1 = cache.open (p1);
+          MappedRange r1 = cache.access (f1, 0, CHUNK);
+          FileID f2 = cache.open (p2);
+          CHECK (2 == cache.cntOpenFiles());
+          FileID f3 = cache.open (p3);
+          CHECK (3 == cache.cntFiles());
+          CHECK (2 == cache.cntOpenFiles());                          // f1 was closed
+          CHECK (isContent (r1, 0));                                  // ...while its mapping remains valid
+          
+          MappedRange r3 = cache.access (f3, 0, CHUNK);
+          MappedRange r2 = cache.access (f2, 0, CHUNK);
+          r1.release();
+          r1 = cache.access (f1, 100*WORD, 100*WORD);                 // window of f1 still cached
+          CHECK (1 == cache.cntHits());
+          CHECK (2 == cache.cntOpenFiles());
+          CHECK (3 == cache.cntMappings());
+          
+          MappedRange next = cache.access (f1, CHUNK, CHUNK);         // f1 re-opened to map the next chunk
+          CHECK (isContent (next, CHUNK));
+          CHECK (2 == cache.cntOpenFiles());
+          CHECK (4 == cache.cntMappings());
+          CHECK (isContent (r2, 0));
+          CHECK (isContent (r3, 0));
+        }
+      
+      
+      /** @test read-ahead follows the direction of playback */
+      void
+      readAhead()
+        {
+          TempDir temp;
+          string path = writeMediaFile (temp, 4*CHUNK);
+          MappingCache cache{MappingPolicy{CHUNK}};
+          FileID file = cache.open (path);
+          
+          cache.access (file, 0, 64, FORWARD);                        // announce chunk 1
+          CHECK (1 == cache.cntAdvised());
+          cache.access (file, CHUNK, 64, FORWARD);                    // announce chunk 2
+          CHECK (2 == cache.cntAdvised());
+          cache.access (file, 3*CHUNK, 64, FORWARD);                  // no chunk beyond end of file
+          CHECK (2 == cache.cntAdvised());
+          cache.access (file, 3*CHUNK, 64, BACKWARD);                 // already mapped, read-ahead unchanged
+          CHECK (2 == cache.cntAdvised());
+          cache.access (file, 2*CHUNK, 64, BACKWARD);                 // announce chunk 1
+          CHECK (3 == cache.cntAdvised());
+          
+          MappingCache other{MappingPolicy{CHUNK}};
+          file = other.open (path);
+          other.access (file, 0, 64, BACKWARD);                       // no chunk before start of file
+          other.access (file, CHUNK, 64, RANDOM);
+          CHECK (0 == other.cntAdvised());
+          CHECK (2 == other.cntMappings());
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (MappingCache_test, "unit backend");
+  
+  
+  
+}}} // namespace vault::io::test
@@ -0,0 +1,205 @@
+/*
+  MediaRead(Test)  -  verify loading of media data by prerequisite IO jobs
+
+   Copyright (C)
+     2026,            Hermann Vosseler <Ichthyostega@web.de>
+
+  **Lumiera** is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2 of the License, or (at your
+  option) any later version. See the file COPYING for further details.
+
+* *****************************************************************/
+
+/** @file media-read-test.cpp
+ ** unit test \ref MediaRead_test
+ */
+
+
+#include "lib/test/run.hpp"
+#include "lib/test/test-helper.hpp"
+#include "lib/test/temp-dir.hpp"
+#include "vault/io/media-read.hpp"
+#include "vault/io/async-io.hpp"
+#include "vault/gear/special-job-fun.hpp"
+#include "vault/gear/scheduler.hpp"
+
+#include <fstream>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+
+using lib::test::TempDir;
+using std::this_thread::sleep_for;
+using std::chrono_literals::operator ""ms;
+using std::chrono_literals::operator ""us;
+
+
+namespace vault{
+namespace io   {
+namespace test {
+  
+  using gear::Job;
+  using gear::JobParameter;
+  using gear::SpecialJobFun;
+  using gear::BlockFlowAlloc;
+  using gear::EngineObserver;
+  using gear::Scheduler;
+  
+  namespace { // Test fixture
+    
+    const size_t FRAME = 16_KiB;
+    const uint   FRAMES = 25;
+    const uint   WAIT_LIMIT = 500;      ///< give up waiting for the jobs after 5 sec
+    
+    /** write a media file, where each byte of a frame holds the frame number */
+    string
+    writeMediaFile (TempDir& temp)
+    {
+      auto path = temp.makeFile();
+      std::ofstream out{path, std::ios_base::binary};
+      for (uint f=0; f < FRAMES; ++f)
+        out << string(FRAME, char(f));
+      return path;
+    }
+    
+    bool
+    isFrame (MappedRange const& data, uint frameNr)
+    {
+      if (FRAME != data.size()) return false;
+      for (size_t i=0; i < FRAME; ++i)
+        if (data.data()[i] != char(frameNr))
+          return false;
+      return true;
+    }
+  }
+  
+  
+  
+  /***************************************************************//**
+   * @test verify reading frames of media data by scheduling an IO job
+   *       as prerequisite of each render job, so that the render job
+   *       is dispatched only after the data was loaded.
+   * @see media-read.hpp
+   * @see MappingCache_test
+   */
+  class MediaRead_test : public Test
+    {
+      
+      virtual void
+      run (Arg)
+        {
+          simpleUsage();
+          readFrames();
+        }
+      
+      
+      /** @test the data can be loaded by job, or synchronously on demand */
+      void
+      simpleUsage()
+        {
+          TempDir temp;
+          MappingCache cache{MappingPolicy{4*FRAME}};
+          FileID file = cache.open (writeMediaFile (temp));
+          
+          MediaRead read{cache, file, 3*FRAME, FRAME};
+          CHECK (not read.isLoaded());
+          CHECK (isFrame (read.data(), 3));                          // loaded synchronously
+          CHECK (read.isLoaded());
+          CHECK (1 == cache.cntMappings());
+          
+          MediaRead pre{cache, file, 5*FRAME, FRAME, BACKWARD};
+          Job job = pre.prefetchJob();
+          CHECK (LOAD_JOB == job.getKind());
+          CHECK (not pre.isLoaded());
+          job.triggerJob();                                          // invoke the IO job directly
+          CHECK (pre.isLoaded());
+          CHECK (2 == cache.cntMappings());
+          CHECK (isFrame (pre.data(), 5));
+          CHECK (2 == cache.cntMisses());
+          
+          read.release();
+          pre.release();
+          CHECK (not read.data());
+          
+          // releasing an unused request neither maps nor loads the data
+          size_t accesses = cache.cntHits() + cache.cntMisses();
+          MediaRead unused{cache, file, 7*FRAME, FRAME};
+          unused.release();
+          CHECK (not unused.isLoaded());
+          CHECK (accesses == cache.cntHits() + cache.cntMisses());
+          
+          // the IO job does not keep the request alive
+          Job orphaned = MediaRead{cache, file, 9*FRAME, FRAME}.prefetchJob();
+          CHECK (LOAD_JOB == orphaned.getKind());
+          orphaned.triggerJob();                                     // request already gone: nothing to load
+          CHECK (accesses == cache.cntHits() + cache.cntMisses());
+        }
+      
+      
+      /** @test read a sequence of frames by IO jobs scheduled ahead of the render jobs;
+       *        the IO jobs hand over loading to the kernel through `io_uring` (or to the
+       *        IO pool, where not available), without blocking a worker */
+      void
+      readFrames()
+        {
+          TempDir temp;
+          MappingCache cache{MappingPolicy{4*FRAME}};
+          FileID file = cache.open (writeMediaFile (temp));
+          
+          BlockFlowAlloc bFlow;
+          EngineObserver watch;
+          Scheduler scheduler{bFlow, watch};
+          AsyncIO asyncIO;
+          
+          std::atomic_uint rendered{0};
+          std::atomic_uint verified{0};
+          std::atomic_uint prefetched{0};
+          for (uint f=0; f < FRAMES; ++f)
+            {
+              MediaRead read{cache, file, f*FRAME, FRAME, FORWARD};
+              SpecialJobFun renderFun{[&, read, f](JobParameter) mutable
+                                        {
+                                          if (read.isLoaded())
+                                            ++prefetched;
+                                          if (isFrame (read.data(), f))
+                                            ++verified;
+                                          read.release();
+                                          ++rendered;
+                                        }};
+              Job renderJob{renderFun, InvocationInstanceID(), Time::ANYTIME};
+              
+              auto load = scheduler.defineSchedule(read.prefetchJob(asyncIO))
+                                   .startOffset(100us + f*200us)
+                                   .lifeWindow(2000ms);
+              auto render = scheduler.defineSchedule(renderJob)
+                                     .startOffset(100us + f*200us)
+                                     .lifeWindow(2000ms);
+              load.linkToSuccessor (render);
+              load.post();
+              render.post();
+            }
+          
+          for (uint i=0; i < WAIT_LIMIT and rendered < FRAMES; ++i)
+            sleep_for (10ms);
+          CHECK (FRAMES == rendered);
+          CHECK (FRAMES == verified);
+          CHECK (FRAMES == prefetched);                             // render jobs were dispatched only after loading
+          CHECK (FRAMES/4 <= cache.cntAdvised());                   // next chunk announced for each new window
+          if (asyncIO.usesRing())
+            {
+              CHECK (FRAMES == asyncIO.cntRing());                  // loading was submitted to the io_uring
+              CHECK (0 == asyncIO.cntPool());                       // ...and completed by the kernel
+            }
+          else
+            CHECK (FRAMES == asyncIO.cntPool());                    // loading was performed by the IO pool
+        }
+    };
+  
+  
+  /** Register this test class... */
+  LAUNCHER (MediaRead_test, "unit backend");
+  
+  
+  
+}}} // namespace vault::io::test
@@ -57,6 +57,7 @@ namespace test {
            iteration();
            reuseUnclean();
            wrapAround();
+           reservedRange();
         }
       
       
@@ -332,6 +333,57 @@ namespace test {
           CHECK (19 == extents.begin().getIndex());        // ... yet address of the first Extent remains the same, just held in another slot
           CHECK (isSameObject (*extents.begin(), *snapshot.front()));
         }
+      
+      
+      
+      /** @test carve all extents from a contiguous reserved address range
+       *      - extents are placed consecutively into the range
+       *      - when expanding the pool, further extents follow seamlessly
+       *      - the range is used up to its limit, then the heap is used
+       *      - huge pages are a hint; the allocation works regardless
+       */
+      void
+      reservedRange()
+        {
+          ExtentPolicy policy;
+          policy.reserveRange = true;
+          policy.prefault = true;
+          policy.pages = ExtentPolicy::TRANSPARENT_HUGE;
+          
+          Extents extents{5, policy};
+          CHECK (5*sizeof(Extent) == watch(extents).reserved());
+          
+          extents.openNew(4);
+          Iter it = extents.begin();
+          int* prev = &(*it)[0];
+          for (++it; it; ++it)
+            {
+              CHECK (&(*it)[0] == prev + 10);   // consecutive storage
+              prev = &(*it)[0];
+            }
+          
+          extents.openNew(5);                 // expand the pool
+          CHECK (14 == watch(extents).size());
+          CHECK (14*sizeof(Extent) == watch(extents).reserved());
+          for (Extent& extent : extents)
+            extent[9] = 9;
+          
+          // when the range is exhausted, the heap is used
+          using BigExtents = ExtentFamily<int, 64*1024>;
+          ExtentPolicy tiny{policy};
+          tiny.reserve = 1_MiB;              // rounded up to 2MiB ≙ 8 Extents
+          tiny.pages = ExtentPolicy::EXPLICIT_HUGE;
+          BigExtents limited{2, tiny};
+          limited.openNew(10);
+          CHECK (15 == watch(limited).size());
+          CHECK ( 8 == watch(limited).reserved() / sizeof(BigExtents::Extent));
+          for (auto& extent : limited)
+            extent[0] = 1;
+          
+          Extents onHeap{5};
+          CHECK (0 == watch(onHeap).reserved());
+          CHECK (not watch(onHeap).hugePages());
+        }
     };
   
   